@@ -6,7 +6,11 @@ Flask Dashboard with Detailed Charts
 ====================================
 
 This Flask application:
-  - Parses sensor logs with a robust regex-based parser (for irregular lines).
+  - Reads the binary time-series logs (*.tsl) written by the ESP-IDF
+    firmware when they are present, using esp_mesh_server/tslog.py: either
+    the hourly segments under log/ of a copied SD card, or single files.
+  - Otherwise parses text logs with a robust regex-based parser (for
+    irregular lines).
   - Displays an HTML dashboard with Chart.js line graphs first (detailed lines,
     larger points, distinct colors).
   - Then shows tables of raw sensor data.
@@ -21,10 +25,16 @@ Usage:
 
 import os
 import re
+import sys
 import json
 import logging
+from datetime import datetime
 from flask import Flask, render_template
 
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                os.pardir, "esp_mesh_server"))
+import tslog  # noqa: E402
+
 logging.basicConfig(
     level=logging.INFO,
     format='%(asctime)s [%(levelname)s] %(name)s - %(message)s'
@@ -42,6 +52,45 @@ LOG_FILE_PATHS = {
     "QMC5883L": "qmc5883l.log"
 }
 
+# Directory holding a copy of the SD card; its log/ segments are read first.
+SD_CARD_ROOT = "."
+
+# Binary time-series logs copied from the SD card; preferred over the text logs.
+TSLOG_FILE_PATHS = {
+    "BH1750": "bh1750.tsl",
+    "DHT22": "dht22.tsl",
+    "MPU6050": "mpu6050.tsl",
+    "MQ135": "mq135.tsl",
+}
+
+def load_tslog(log_file_path, sensor_name):
+    """
+    Read a binary time-series log and return entries shaped like the ones
+    from parse_log_file_robust, so the template does not care which was used.
+    Hourly segments on the card copy are read when there are any, otherwise
+    the single file at log_file_path.
+    """
+    try:
+        if any(tslog.segment_paths(SD_CARD_ROOT, log_file_path)):
+            readings = tslog.read_segments(SD_CARD_ROOT, log_file_path)
+        elif os.path.isfile(log_file_path):
+            readings = tslog.read_range(log_file_path)
+        else:
+            return None
+    except (OSError, ValueError) as e:
+        logger.error(f"Error reading {log_file_path}: {e}")
+        return None
+
+    entries = []
+    for reading in readings:
+        timestamp = datetime.fromtimestamp(reading["timestamp_ms"] / 1000.0)
+        entry = {"timestamp": timestamp.strftime("%Y-%m-%d %H:%M:%S")}
+        entry.update(reading)
+        entries.append(entry)
+
+    logger.info(f"Loaded {len(entries)} entries from {sensor_name} time-series log.")
+    return entries
+
 def parse_log_file_robust(log_file_path, sensor_name):
     """
     Parse the specified log file and return a list of dicts.
@@ -97,7 +146,12 @@ def dashboard():
     """
     all_data = {}
     for sensor, path in LOG_FILE_PATHS.items():
-        parsed_entries = parse_log_file_robust(path, sensor)
+        parsed_entries = None
+        tslog_path = TSLOG_FILE_PATHS.get(sensor)
+        if tslog_path:
+            parsed_entries = load_tslog(tslog_path, sensor)
+        if parsed_entries is None:
+            parsed_entries = parse_log_file_robust(path, sensor)
         all_data[sensor] = parsed_entries
 
     return render_template("dashboard.html", all_data=all_data)
@@ -0,0 +1,144 @@
+"""Decoder for the binary sensor frames uploaded by the ESP-IDF helmets.
+
+The layout mirrors idf_py_version/components/sensors/sensor_frame. All fields
+are little-endian; frames are self-delimiting and may be concatenated.
+"""
+import struct
+
+FRAME_MAGIC = 0x4653
+FRAME_VERSION = 1
+FLAG_TIME_UNSYNCED = 0x01
+
+# magic, version, sensor id, flags, payload length, node id, sequence, timestamp (ms)
+HEADER = struct.Struct('<HBBBBIIQ')
+
+
+def _decode_dht22(payload):
+    temperature_c, humidity = struct.unpack('<hH', payload)
+    temperature_c /= 10.0
+    return {
+        "sensor_type": "temperature_humidity",
+        "temperature_f": round(temperature_c * 1.8 + 32.0, 2),
+        "temperature_c": temperature_c,
+        "humidity": humidity / 10.0,
+    }
+
+
+def _decode_ccs811(payload):
+    eco2, tvoc = struct.unpack('<HH', payload)
+    return {"sensor_type": "air_quality", "eCO2": eco2, "TVOC": tvoc}
+
+
+def _decode_mq135(payload):
+    raw_adc_value, gas_concentration = struct.unpack('<Hf', payload)
+    return {
+        "sensor_type": "gas",
+        "raw_adc_value": raw_adc_value,
+        "gas_concentration": gas_concentration,
+    }
+
+
+def _decode_gy_neo6mv2(payload):
+    latitude, longitude, speed, hdop, fix_status, satellite_count, time_ms = \
+        struct.unpack('<iiHHBBI', payload)
+    if time_ms == 0xFFFFFFFF:
+        time = ""
+    else:
+        seconds, millis = divmod(time_ms, 1000)
+        minutes, seconds = divmod(seconds, 60)
+        hours, minutes = divmod(minutes, 60)
+        time = f"{hours:02d}{minutes:02d}{seconds:02d}.{millis // 10:02d}"
+    return {
+        "sensor_type": "gps",
+        "latitude": latitude / 1e7,
+        "longitude": longitude / 1e7,
+        "speed": speed / 100.0,
+        "time": time,
+        "fix_status": fix_status,
+        "satellite_count": satellite_count,
+        "hdop": hdop / 100.0,
+    }
+
+
+def _decode_bh1750(payload):
+    (lux,) = struct.unpack('<f', payload)
+    return {"sensor_type": "light", "lux": lux}
+
+
+def _decode_mpu6050(payload):
+    ax, ay, az, gx, gy, gz, temperature = struct.unpack('<7h', payload)
+    return {
+        "sensor_type": "accelerometer_gyroscope",
+        "accel_x": ax / 1000.0,
+        "accel_y": ay / 1000.0,
+        "accel_z": az / 1000.0,
+        "gyro_x": gx / 10.0,
+        "gyro_y": gy / 10.0,
+        "gyro_z": gz / 10.0,
+        "temperature": temperature / 100.0,
+    }
+
+
+FALL_EVENTS = {1: "impact", 2: "fall"}
+
+
+def _decode_fall_alert(payload):
+    event, peak_g, free_fall_ms, orientation_change = struct.unpack('<BHHH', payload)
+    return {
+        "sensor_type": "fall_alert",
+        "event": FALL_EVENTS.get(event, f"unknown_{event}"),
+        "peak_g": peak_g / 100.0,
+        "free_fall_ms": free_fall_ms,
+        "orientation_change_deg": orientation_change / 10.0,
+    }
+
+
+# Sensor id -> payload decoder, keyed like sensor_frame_id_t
+DECODERS = {
+    1: _decode_dht22,
+    2: _decode_ccs811,
+    3: _decode_mq135,
+    4: _decode_gy_neo6mv2,
+    5: _decode_bh1750,
+    6: _decode_mpu6050,
+    7: _decode_fall_alert,
+}
+
+
+def decode_frames(body):
+    """Decode every frame in a request body.
+
+    Returns a list of dictionaries shaped like the JSON documents the helmets
+    used to send, extended with node_id, seq, timestamp_ms and time_synced.
+    Raises ValueError on a malformed or truncated frame.
+    """
+    readings = []
+    offset = 0
+    while offset < len(body):
+        if len(body) - offset < HEADER.size:
+            raise ValueError(f"truncated frame header at offset {offset}")
+
+        magic, version, sensor_id, flags, payload_len, node_id, seq, timestamp_ms = \
+            HEADER.unpack_from(body, offset)
+        if magic != FRAME_MAGIC:
+            raise ValueError(f"bad frame magic 0x{magic:04x} at offset {offset}")
+        if version != FRAME_VERSION:
+            raise ValueError(f"unsupported frame version {version}")
+        if sensor_id not in DECODERS:
+            raise ValueError(f"unknown sensor id {sensor_id}")
+
+        start = offset + HEADER.size
+        end = start + payload_len
+        if end > len(body):
+            raise ValueError(f"truncated frame payload at offset {offset}")
+
+        reading = DECODERS[sensor_id](body[start:end])
+        reading.update({
+            "node_id": f"{node_id:08x}",
+            "seq": seq,
+            "timestamp_ms": timestamp_ms,
+            "time_synced": not (flags & FLAG_TIME_UNSYNCED),
+        })
+        readings.append(reading)
+        offset = end
+    return readings
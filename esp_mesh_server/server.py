@@ -1,8 +1,12 @@
 from flask import Flask, request, jsonify, send_from_directory
 from flask_sqlalchemy import SQLAlchemy
+from werkzeug.serving import WSGIRequestHandler
+from collections import OrderedDict
 import datetime
 import json
 
+from sensor_frame import decode_frames
+
 app = Flask(__name__)
 
 # SQLite database configuration
@@ -22,6 +26,97 @@ with app.app_context():
     print("Database and tables created successfully.")
 
 
+# Sensor settings waiting to be delivered, keyed by node id. Helmets have no
+# inbound endpoint, so settings ride on the response to their next upload.
+pending_config = {}
+
+
+# Helmets replay readings from their SD card outbox after an outage, and a
+# batch whose response was lost is sent again. Remember the most recent
+# readings so duplicates are not stored twice.
+RECENT_READINGS_MAX = 50000
+recent_readings = OrderedDict()
+
+
+def reading_key(reading):
+    # Only binary frames carry a sequence number; JSON readings have no key
+    if not isinstance(reading, dict) or "seq" not in reading:
+        return None
+    return (reading.get("node_id"), reading.get("sensor_type"),
+            reading["seq"], reading.get("timestamp_ms"))
+
+
+def remember_readings(keys):
+    for key in keys:
+        recent_readings[key] = None
+    while len(recent_readings) > RECENT_READINGS_MAX:
+        recent_readings.popitem(last=False)
+
+
+def take_pending_config(data):
+    readings = data if isinstance(data, list) else [data]
+    node_ids = {r.get("node_id") for r in readings if isinstance(r, dict)}
+    config = []
+    for node_id in node_ids:
+        config.extend(pending_config.pop(node_id, []))
+    return config
+
+
+def server_time_ms():
+    return int(datetime.datetime.now(datetime.timezone.utc).timestamp() * 1000)
+
+
+def reading_time(reading):
+    # Helmets stamp readings when they are taken. Trust the stamp only once
+    # the helmet's clock is synced; otherwise arrival time is the best we have.
+    if isinstance(reading, dict) and reading.get("time_synced") and reading.get("timestamp_ms"):
+        return datetime.datetime.utcfromtimestamp(reading["timestamp_ms"] / 1000)
+    return datetime.datetime.utcnow()
+
+
+def upload_response(data, count):
+    # server_time_ms lets mesh bridges map mesh time onto wall clock time
+    response = {"status": "success", "message": f"Stored {count} readings",
+                "server_time_ms": server_time_ms()}
+    config = take_pending_config(data)
+    if config:
+        response["config"] = config
+    return jsonify(response), 200
+
+
+def read_request_readings():
+    # ESP-IDF helmets upload concatenated binary sensor frames; the Arduino
+    # mesh bridge still posts JSON
+    if request.mimetype == 'application/octet-stream':
+        return decode_frames(request.get_data())
+    return request.json
+
+
+def store_readings(data):
+    # Helmets batch several readings into one JSON array; store the whole
+    # batch in a single transaction. A plain object is treated as one reading.
+    readings = []
+    keys = set()
+    for reading in data if isinstance(data, list) else [data]:
+        key = reading_key(reading)
+        if key is not None and (key in recent_readings or key in keys):
+            continue
+        if key is not None:
+            keys.add(key)
+        readings.append(reading)
+    for reading in readings:
+        if isinstance(reading, dict) and reading.get("sensor_type") == "fall_alert":
+            print(f"ALERT: {reading.get('event')} on node {reading.get('node_id')} "
+                  f"(peak {reading.get('peak_g')} g)")
+    entries = [ESPData(timestamp=reading_time(reading), data=json.dumps(reading))
+               for reading in readings]
+    db.session.add_all(entries)
+    db.session.commit()
+    # Only once stored, so a batch that failed to commit is accepted on retry
+    remember_readings(keys)
+    return len(entries)
+
+
 @app.route('/data', methods=['GET', 'POST'])
 def data():
     if request.method == 'GET':
@@ -31,47 +126,62 @@ def data():
             result = [
                 {"server": "connected"}
             ]
-            return jsonify({"status": "success", "data": result}), 200
+            return jsonify({"status": "success", "data": result,
+                            "server_time_ms": server_time_ms()}), 200
         except Exception as e:
             return jsonify({"status": "error", "message": str(e)}), 500
 
     elif request.method == 'POST':
         # Handle POST request (data submission)
-        data = request.json  # Get JSON data from the request
+        try:
+            data = read_request_readings()
+        except ValueError as e:
+            return jsonify({"status": "error", "message": f"Malformed frame: {str(e)}"}), 400
         if not data:
             return jsonify({"status": "error", "message": "No data provided"}), 400
     
         try:
-            # Convert JSON to a properly formatted string
-            formatted_data = json.dumps(data)
-    
-            # Save the formatted JSON string to the database
-            new_entry = ESPData(data=formatted_data)
-            db.session.add(new_entry)
-            db.session.commit()
-            return jsonify({"status": "success", "message": "Data stored successfully"}), 200
+            # Save each reading as a formatted JSON string in the database
+            count = store_readings(data)
+            return upload_response(data, count)
         except Exception as e:
+            db.session.rollback()
             return jsonify({"status": "error", "message": f"Failed to store data: {str(e)}"}), 500
 
 @app.route('/sensors', methods=['POST'])
 def get_sensor():
     # Handle POST request (data submission)
-    data = request.json  # Get JSON data from the request
+    try:
+        data = read_request_readings()
+    except ValueError as e:
+        return jsonify({"status": "error", "message": f"Malformed frame: {str(e)}"}), 400
     if not data:
         return jsonify({"status": "error", "message": "No data provided"}), 400
 
     try:
-        # Convert JSON to a properly formatted string
-        formatted_data = json.dumps(data)
-
-        # Save the formatted JSON string to the database
-        new_entry = ESPData(data=formatted_data)
-        db.session.add(new_entry)
-        db.session.commit()
-        return jsonify({"status": "success", "message": "Data stored successfully"}), 200
+        # Save each reading as a formatted JSON string in the database
+        count = store_readings(data)
+        return upload_response(data, count)
     except Exception as e:
+        db.session.rollback()
         return jsonify({"status": "error", "message": f"Failed to store data: {str(e)}"}), 500
 
+@app.route('/config', methods=['POST'])
+def set_config():
+    # Queue sensor settings for a node, e.g.
+    # {"node_id": "a1b2c3d4", "config": [{"sensor": "mpu6050", "period_ms": 20}]}
+    # Each entry names a sensor and any of period_ms, enabled and worker; the
+    # node applies them and stores them in NVS when it next uploads.
+    body = request.json
+    if not isinstance(body, dict) or not body.get("node_id") or not isinstance(body.get("config"), list):
+        return jsonify({"status": "error", "message": "Expected node_id and a config list"}), 400
+    if not all(isinstance(entry, dict) and entry.get("sensor") for entry in body["config"]):
+        return jsonify({"status": "error", "message": "Every config entry needs a sensor"}), 400
+
+    pending_config.setdefault(body["node_id"], []).extend(body["config"])
+    return jsonify({"status": "success",
+                    "message": f"Queued {len(body['config'])} settings for {body['node_id']}"}), 200
+
 # Dashboard API endpoints
 
 @app.route('/latest', methods=['GET'])
@@ -96,4 +206,7 @@ def serve_dashboard():
     return send_from_directory('.', 'dashboard.html')
 
 if __name__ == '__main__':
+    # HTTP/1.1 keeps client connections open, so helmets can reuse one
+    # TCP connection for all their uplink requests
+    WSGIRequestHandler.protocol_version = "HTTP/1.1"
     app.run(host='0.0.0.0', port=5000)
@@ -0,0 +1,241 @@
+"""Reader for the binary time-series logs the ESP-IDF helmets write to SD.
+
+The layout mirrors idf_py_version/components/storage/ts_log. A log file holds
+the readings of one sensor: a 512-byte header, then 2048-byte blocks of
+fixed-size records. Every record carries its sequence number (its position
+in the file) and a CRC-32; a full block ends with a footer holding its record
+count, its time range and a CRC-32 of the whole block. The last block is
+usually still being filled and has no footer; its records are accepted up to
+the first one whose sequence number or CRC does not match.
+
+A sidecar `<log>.idx` file lists one entry per completed block, so a time
+range can be read without scanning the whole log. A missing, short or
+inconsistent index is rebuilt from the block footers.
+
+On the card, logs are split into hourly segments,
+`log/YYYYMMDD/HH/PP_<name>` (UTC), with a new part PP whenever a segment
+grows too large; `read_segments` reads a time range across them. Old IMU
+segments are replaced on the device by summaries (`PP_<sensor>_sum.tsl`,
+sensor id with SUMMARY_FLAG set) holding, per window of a dozen logged
+readings, the number of readings and the minimum, maximum and mean of
+every field. Firmware before that wrote one-second windows to
+`PP_<sensor>_1s.tsl`, which are read the same way.
+
+All fields are little-endian; times are milliseconds since the epoch.
+"""
+import os
+import struct
+import zlib
+from datetime import datetime, timezone
+
+from sensor_frame import DECODERS, FLAG_TIME_UNSYNCED
+
+FILE_MAGIC = 0x474C5354
+BLOCK_MAGIC = 0x4B4C4254
+VERSION = 2
+SUMMARY_FLAG = 0x80
+SEGMENT_ROOT = 'log'
+SEGMENT_SECONDS = 3600
+
+# magic, version, sensor id, record size, node id, block size, header size
+FILE_HEADER = struct.Struct('<IBBHIHH')
+# magic, block no, record count, record size, crc32, min time, max time
+BLOCK_FOOTER = struct.Struct('<IIHHIqq')
+# block no, record count, reserved, min time, max time
+INDEX_ENTRY = struct.Struct('<IHHqq')
+# sequence, time (ms), flags; the payload and a CRC-32 follow
+RECORD_HEADER = struct.Struct('<IqB')
+RECORD_TRAILER = struct.Struct('<I')
+# reading count; min, max and mean of each int16 field follow
+SUMMARY_COUNT = struct.Struct('<H')
+
+
+class TsLog:
+    """One open time-series log and its block index."""
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, 'rb') as file:
+            raw = file.read(FILE_HEADER.size)
+            if len(raw) < FILE_HEADER.size:
+                raise ValueError(f"{path}: truncated file header")
+            (magic, version, self.sensor_id, self.record_size, node_id,
+             self.block_size, self.header_size) = FILE_HEADER.unpack(raw)
+            if magic != FILE_MAGIC or version != VERSION:
+                raise ValueError(f"{path}: not a time-series log")
+            if self.record_size <= RECORD_HEADER.size + RECORD_TRAILER.size:
+                raise ValueError(f"{path}: bad record size {self.record_size}")
+            file.seek(0, os.SEEK_END)
+            size = file.tell()
+        self.node_id = f"{node_id:08x}"
+        self.capacity = (self.block_size - BLOCK_FOOTER.size) // self.record_size
+        self.block_count = max(0, -(-(size - self.header_size) // self.block_size))
+        self.index = self._load_index()
+
+    def _load_index(self):
+        """Return [(block_no, min_ms, max_ms)] covering every block of the log.
+
+        Entries from the index file are trusted only while they number the
+        blocks 0, 1, 2, ...; the remaining blocks are described from their
+        footers, or from their records when they have no footer yet.
+        """
+        entries = []
+        try:
+            with open(self.path + '.idx', 'rb') as file:
+                data = file.read()
+        except OSError:
+            data = b''
+        for offset in range(0, len(data) - INDEX_ENTRY.size + 1, INDEX_ENTRY.size):
+            block_no, _, _, min_ms, max_ms = INDEX_ENTRY.unpack_from(data, offset)
+            if block_no != len(entries) or block_no >= self.block_count:
+                break
+            entries.append((block_no, min_ms, max_ms))
+
+        with open(self.path, 'rb') as file:
+            for block_no in range(len(entries), self.block_count):
+                times = [time_ms for time_ms, _, _ in self._read_block(file, block_no)]
+                if times:
+                    entries.append((block_no, min(times), max(times)))
+        return entries
+
+    def _offset(self, block_no):
+        return self.header_size + block_no * self.block_size
+
+    def _read_block(self, file, block_no):
+        """Yield (time_ms, flags, payload) of one block.
+
+        A sealed block is accepted whole if its footer CRC matches. Otherwise
+        the block is treated as the unfinished tail: records are accepted in
+        order until one has a wrong sequence number or CRC.
+        """
+        file.seek(self._offset(block_no))
+        raw = file.read(self.block_size)
+        footer_at = self.block_size - BLOCK_FOOTER.size
+        count = None
+        if len(raw) == self.block_size:
+            magic, number, footer_count, record_size, crc, min_ms, max_ms = \
+                BLOCK_FOOTER.unpack_from(raw, footer_at)
+            footer = BLOCK_FOOTER.pack(magic, number, footer_count, record_size, 0, min_ms, max_ms)
+            end = footer_count * record_size
+            if (magic == BLOCK_MAGIC and number == block_no and
+                    record_size == self.record_size and footer_count <= self.capacity and
+                    zlib.crc32(footer, zlib.crc32(raw[:end])) == crc):
+                count = footer_count
+
+        payload_end = self.record_size - RECORD_TRAILER.size
+        for index in range(self.capacity if count is None else count):
+            offset = index * self.record_size
+            record = raw[offset:offset + self.record_size]
+            if len(record) < self.record_size:
+                return
+            seq, time_ms, flags = RECORD_HEADER.unpack_from(record)
+            if count is None:
+                (crc,) = RECORD_TRAILER.unpack_from(record, payload_end)
+                if seq != block_no * self.capacity + index or zlib.crc32(record[:payload_end]) != crc:
+                    return
+            yield time_ms, flags, record[RECORD_HEADER.size:payload_end]
+
+    def records(self, start_ms=None, end_ms=None):
+        """Yield (time_ms, flags, payload) for every record in [start_ms, end_ms].
+
+        Only the blocks whose time range overlaps the query are read.
+        """
+        with open(self.path, 'rb') as file:
+            for block_no, min_ms, max_ms in self.index:
+                if start_ms is not None and max_ms < start_ms:
+                    continue
+                if end_ms is not None and min_ms > end_ms:
+                    continue
+                for time_ms, flags, payload in self._read_block(file, block_no):
+                    if start_ms is not None and time_ms < start_ms:
+                        continue
+                    if end_ms is not None and time_ms > end_ms:
+                        continue
+                    yield time_ms, flags, payload
+
+    def readings(self, start_ms=None, end_ms=None):
+        """Return decoded readings, shaped like sensor_frame.decode_frames output.
+
+        Readings of a summary log carry the mean of each field under the
+        usual key, plus `<key>_min`, `<key>_max` and the reading `count`.
+        """
+        summary = bool(self.sensor_id & SUMMARY_FLAG)
+        decode = DECODERS.get(self.sensor_id & ~SUMMARY_FLAG)
+        if decode is None:
+            raise ValueError(f"{self.path}: unknown sensor id {self.sensor_id}")
+        readings = []
+        for time_ms, flags, payload in self.records(start_ms, end_ms):
+            reading = _decode_summary(decode, payload) if summary else decode(payload)
+            reading.update({
+                "node_id": self.node_id,
+                "timestamp_ms": time_ms,
+                "time_synced": not (flags & FLAG_TIME_UNSYNCED),
+            })
+            readings.append(reading)
+        return readings
+
+
+def _decode_summary(decode, payload):
+    """Decode a summary payload with the decoder of the summarized sensor."""
+    (count,) = SUMMARY_COUNT.unpack_from(payload)
+    fields = struct.unpack_from(f'<{(len(payload) - SUMMARY_COUNT.size) // 2}h',
+                                payload, SUMMARY_COUNT.size)
+    reading = decode(struct.pack(f'<{len(fields) // 3}h', *fields[2::3]))
+    for suffix, values in (("min", fields[0::3]), ("max", fields[1::3])):
+        for key, value in decode(struct.pack(f'<{len(values)}h', *values)).items():
+            if isinstance(value, (int, float)):
+                reading[f"{key}_{suffix}"] = value
+    reading["count"] = count
+    return reading
+
+
+def read_range(path, start_ms=None, end_ms=None):
+    """Decode the readings of a log between two times (inclusive, ms since epoch)."""
+    return TsLog(path).readings(start_ms, end_ms)
+
+
+def _hour_start_ms(day, hour):
+    """Start of a segment directory's hour, or None if it is not named like one."""
+    try:
+        start = datetime.strptime(day + hour, '%Y%m%d%H').replace(tzinfo=timezone.utc)
+    except ValueError:
+        return None
+    return int(start.timestamp() * 1000)
+
+
+def segment_paths(root, name, start_ms=None, end_ms=None):
+    """Yield the segments of a log (raw and summary) overlapping a time range, oldest first.
+
+    `root` is the SD card root; `name` the file name the firmware logs to,
+    e.g. "mpu6050.tsl". Hour directories outside the range are not opened.
+    """
+    stem, extension = os.path.splitext(name)
+    suffixes = ('_' + name, f'_{stem}_sum{extension}', f'_{stem}_1s{extension}')
+    base = os.path.join(root, SEGMENT_ROOT)
+    if not os.path.isdir(base):
+        return
+    for day in sorted(os.listdir(base)):
+        day_path = os.path.join(base, day)
+        if not os.path.isdir(day_path):
+            continue
+        for hour in sorted(os.listdir(day_path)):
+            hour_ms = _hour_start_ms(day, hour)
+            if hour_ms is None:
+                continue
+            if start_ms is not None and hour_ms + SEGMENT_SECONDS * 1000 <= start_ms:
+                continue
+            if end_ms is not None and hour_ms > end_ms:
+                continue
+            hour_path = os.path.join(day_path, hour)
+            for file_name in sorted(os.listdir(hour_path)):
+                if file_name.endswith(suffixes):
+                    yield os.path.join(hour_path, file_name)
+
+
+def read_segments(root, name, start_ms=None, end_ms=None):
+    """Decode the readings of every segment of a log between two times, sorted by time."""
+    readings = []
+    for path in segment_paths(root, name, start_ms, end_ms):
+        readings.extend(TsLog(path).readings(start_ms, end_ms))
+    readings.sort(key=lambda reading: reading["timestamp_ms"])
+    return readings
@@ -7,7 +7,7 @@
 
 #include "ov7670_hal.h"
 #include <inttypes.h>
-#include "common/i2c.h"
+#include "common/i2c_bus.h"
 #include "esp_log.h"
 #include "freertos/task.h"
 
@@ -34,6 +34,10 @@ const uint32_t   ov7670_polling_rate_ticks = pdMS_TO_TICKS(5000);
 const uint8_t    ov7670_scl_io             = GPIO_NUM_22;
 const uint8_t    ov7670_sda_io             = GPIO_NUM_21;
 
+/* Globals (Static) ***********************************************************/
+
+static i2c_bus_device_t s_ov7670_i2c_device; /**< Handle of the OV7670 SCCB port on the shared I2C bus */
+
 /* Private (Static) Functions *************************************************/
 
 #ifdef USE_OV7670_XCLK_GPIO_27
@@ -87,17 +91,15 @@ static esp_err_t priv_ov7670_apply_config(const ov7670_config_t *config)
 {
   /* Combine resolution and format into COM7 register. */
   uint8_t   com7_value = (uint8_t)(config->resolution | config->output_format);
-  esp_err_t ret        = priv_i2c_write_reg_byte(k_ov7670_reg_com7, com7_value,
-                                                 ov7670_i2c_bus, ov7670_i2c_address,
-                                                 ov7670_tag);
+  esp_err_t ret        = i2c_bus_write_reg_byte(&s_ov7670_i2c_device, k_ov7670_reg_com7, com7_value);
   if (ret != ESP_OK) {
     ESP_LOGE(ov7670_tag, "Failed to set COM7 (resolution/format).");
     return ret;
   }
 
   /* Set clock divider (CLKRC register). */
-  ret = priv_i2c_write_reg_byte(k_ov7670_reg_clkrc, (uint8_t)config->clock_divider,
-                                ov7670_i2c_bus, ov7670_i2c_address, ov7670_tag);
+  ret = i2c_bus_write_reg_byte(&s_ov7670_i2c_device, k_ov7670_reg_clkrc,
+                               (uint8_t)config->clock_divider);
   if (ret != ESP_OK) {
     ESP_LOGE(ov7670_tag, "Failed to set CLKRC (clock divider).");
     return ret;
@@ -134,9 +136,13 @@ esp_err_t ov7670_init(ov7670_data_t *camera_data)
   ESP_LOGI(ov7670_tag, "Initializing OV7670 Camera");
 
   /* 1. Initialize I2C interface */
-  esp_err_t ret = priv_i2c_init(ov7670_scl_io, ov7670_sda_io,
-                                ov7670_i2c_freq_hz, ov7670_i2c_bus,
-                                ov7670_tag);
+  esp_err_t ret = i2c_bus_init(ov7670_scl_io, ov7670_sda_io,
+                               ov7670_i2c_freq_hz, ov7670_i2c_bus,
+                               ov7670_tag);
+  if (ret == ESP_OK) {
+    ret = i2c_bus_add_device(ov7670_i2c_bus, ov7670_i2c_address, false, ov7670_tag,
+                             &s_ov7670_i2c_device);
+  }
   if (ret != ESP_OK) {
     ESP_LOGE(ov7670_tag, "I2C initialization failed");
     camera_data->state = k_ov7670_config_error;
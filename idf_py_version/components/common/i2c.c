@@ -1,13 +1,77 @@
 /* components/common/i2c.c */
 
 #include "common/i2c.h"
+#include <string.h>
 #include "driver/i2c.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 
 /* Constants ******************************************************************/
 
 const uint32_t i2c_timeout_ticks = pdMS_TO_TICKS(1000);
 
+/* Globals (Static) ***********************************************************/
+
+static i2c_bus_stats_t s_i2c_bus_stats[I2C_NUM_MAX] = { 0 };                          /**< Traffic statistics per bus */
+static portMUX_TYPE    s_i2c_stats_lock              = portMUX_INITIALIZER_UNLOCKED; /**< Guards `s_i2c_bus_stats` */
+
+/* Static (Private) Functions *************************************************/
+
+/**
+ * @brief Executes a command link and records it in the bus statistics.
+ *
+ * @param[in] i2c_bus I2C bus number.
+ * @param[in] cmd     Command link to execute.
+ * @param[in] bytes   Payload bytes moved by the command, for the statistics.
+ *
+ * @return The result of `i2c_master_cmd_begin`.
+ */
+static esp_err_t priv_i2c_execute(i2c_port_t i2c_bus, i2c_cmd_handle_t cmd, size_t bytes)
+{
+  int64_t   start_us = esp_timer_get_time();
+  esp_err_t ret      = i2c_master_cmd_begin(i2c_bus, cmd, i2c_timeout_ticks);
+  int64_t   elapsed  = esp_timer_get_time() - start_us;
+
+  if (i2c_bus >= 0 && i2c_bus < I2C_NUM_MAX) {
+    portENTER_CRITICAL(&s_i2c_stats_lock);
+    s_i2c_bus_stats[i2c_bus].transactions++;
+    s_i2c_bus_stats[i2c_bus].time_us += elapsed;
+    if (ret == ESP_OK) {
+      s_i2c_bus_stats[i2c_bus].bytes += bytes;
+    } else {
+      s_i2c_bus_stats[i2c_bus].errors++;
+    }
+    portEXIT_CRITICAL(&s_i2c_stats_lock);
+  }
+
+  return ret;
+}
+
+/**
+ * @brief Reserves a slot for one more operation in a transaction.
+ *
+ * @param[in,out] txn  Transaction to extend.
+ * @param[in]     data Data buffer of the operation.
+ * @param[in]     len  Length of the data buffer.
+ *
+ * @return
+ * - `ESP_OK` if the operation fits.
+ * - `ESP_ERR_INVALID_ARG` on a NULL pointer, zero length or uninitialized transaction.
+ * - `ESP_ERR_NO_MEM` if the transaction is full.
+ */
+static esp_err_t priv_i2c_transaction_reserve(i2c_transaction_t *txn, const uint8_t *data, size_t len)
+{
+  if (txn == NULL || txn->cmd == NULL || data == NULL || len == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (txn->op_count >= I2C_TRANSACTION_MAX_OPS) {
+    ESP_LOGE(txn->tag, "I2C transaction is full (%d operations)", I2C_TRANSACTION_MAX_OPS);
+    return ESP_ERR_NO_MEM;
+  }
+  return ESP_OK;
+}
+
 /* Private Functions **********************************************************/
 
 esp_err_t priv_i2c_init(uint8_t scl_io, uint8_t sda_io, uint32_t freq_hz,
@@ -37,8 +101,9 @@ esp_err_t priv_i2c_init(uint8_t scl_io, uint8_t sda_io, uint32_t freq_hz,
 esp_err_t priv_i2c_write_byte(uint8_t data, i2c_port_t i2c_bus,
                               uint8_t i2c_address, const char *tag)
 {
-  /* Create an I2C command link handle */
-  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  /* Create an I2C command link handle in stack storage */
+  uint8_t          link_buffer[I2C_LINK_RECOMMENDED_SIZE(1)];
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link_buffer, sizeof(link_buffer));
 
   /* Start I2C communication */
   i2c_master_start(cmd);
@@ -53,10 +118,10 @@ esp_err_t priv_i2c_write_byte(uint8_t data, i2c_port_t i2c_bus,
   i2c_master_stop(cmd);
 
   /* Execute the I2C command */
-  esp_err_t ret = i2c_master_cmd_begin(i2c_bus, cmd, i2c_timeout_ticks);
+  esp_err_t ret = priv_i2c_execute(i2c_bus, cmd, 1);
 
   /* Delete the command link after execution */
-  i2c_cmd_link_delete(cmd);
+  i2c_cmd_link_delete_static(cmd);
 
   /* Check for errors in the I2C command */
   if (ret != ESP_OK) {
@@ -69,8 +134,9 @@ esp_err_t priv_i2c_write_byte(uint8_t data, i2c_port_t i2c_bus,
 esp_err_t priv_i2c_read_bytes(uint8_t *data, size_t len, i2c_port_t i2c_bus,
                               uint8_t i2c_address, const char *tag)
 {
-  /* Create an I2C command link handle */
-  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  /* Create an I2C command link handle in stack storage */
+  uint8_t          link_buffer[I2C_LINK_RECOMMENDED_SIZE(1)];
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link_buffer, sizeof(link_buffer));
 
   /* Start I2C communication */
   i2c_master_start(cmd);
@@ -91,10 +157,10 @@ esp_err_t priv_i2c_read_bytes(uint8_t *data, size_t len, i2c_port_t i2c_bus,
   i2c_master_stop(cmd);
 
   /* Execute the I2C command */
-  esp_err_t ret = i2c_master_cmd_begin(i2c_bus, cmd, i2c_timeout_ticks);
+  esp_err_t ret = priv_i2c_execute(i2c_bus, cmd, len);
 
   /* Delete the command link after execution */
-  i2c_cmd_link_delete(cmd);
+  i2c_cmd_link_delete_static(cmd);
 
   /* Check for errors in the I2C command */
   if (ret != ESP_OK) {
@@ -108,7 +174,8 @@ esp_err_t priv_i2c_write_reg_byte(uint8_t reg_addr, uint8_t data,
                                   i2c_port_t i2c_bus, uint8_t i2c_address,
                                   const char *tag)
 {
-  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  uint8_t          link_buffer[I2C_LINK_RECOMMENDED_SIZE(1)];
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link_buffer, sizeof(link_buffer));
 
   i2c_master_start(cmd);
   i2c_master_write_byte(cmd, (i2c_address << 1) | I2C_MASTER_WRITE, true);
@@ -116,9 +183,9 @@ esp_err_t priv_i2c_write_reg_byte(uint8_t reg_addr, uint8_t data,
   i2c_master_write_byte(cmd, data, true);
   i2c_master_stop(cmd);
 
-  esp_err_t ret = i2c_master_cmd_begin(i2c_bus, cmd, i2c_timeout_ticks);
+  esp_err_t ret = priv_i2c_execute(i2c_bus, cmd, 2);
 
-  i2c_cmd_link_delete(cmd);
+  i2c_cmd_link_delete_static(cmd);
 
   if (ret != ESP_OK) {
     ESP_LOGE(tag, "I2C write to register 0x%02X failed: %s", reg_addr, esp_err_to_name(ret));
@@ -131,7 +198,8 @@ esp_err_t priv_i2c_read_reg_bytes(uint8_t reg_addr, uint8_t *data, size_t len,
                                   i2c_port_t i2c_bus, uint8_t i2c_address,
                                   const char *tag)
 {
-  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  uint8_t          link_buffer[I2C_LINK_RECOMMENDED_SIZE(2)];
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create_static(link_buffer, sizeof(link_buffer));
 
   /* Start I2C communication */
   i2c_master_start(cmd);
@@ -161,10 +229,10 @@ esp_err_t priv_i2c_read_reg_bytes(uint8_t reg_addr, uint8_t *data, size_t len,
   i2c_master_stop(cmd);
 
   /* Execute the I2C command */
-  esp_err_t ret = i2c_master_cmd_begin(i2c_bus, cmd, i2c_timeout_ticks);
+  esp_err_t ret = priv_i2c_execute(i2c_bus, cmd, 1 + len);
 
   /* Delete the command link after execution */
-  i2c_cmd_link_delete(cmd);
+  i2c_cmd_link_delete_static(cmd);
 
   /* Check for errors in the I2C command */
   if (ret != ESP_OK) {
@@ -174,3 +242,111 @@ esp_err_t priv_i2c_read_reg_bytes(uint8_t reg_addr, uint8_t *data, size_t len,
   return ret; /* Return the error status or ESP_OK */
 }
 
+
+/* Public Functions ***********************************************************/
+
+esp_err_t i2c_transaction_init(i2c_transaction_t *txn, i2c_port_t i2c_bus, const char *tag)
+{
+  if (txn == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  txn->i2c_bus  = i2c_bus;
+  txn->tag      = tag;
+  txn->op_count = 0;
+  txn->bytes    = 0;
+  txn->cmd      = i2c_cmd_link_create_static(txn->link_buffer, sizeof(txn->link_buffer));
+  if (txn->cmd == NULL) {
+    ESP_LOGE(tag, "Failed to create I2C transaction command link");
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+esp_err_t i2c_transaction_add_write_reg(i2c_transaction_t *txn, uint8_t i2c_address,
+                                        uint8_t reg_addr, const uint8_t *data, size_t len)
+{
+  esp_err_t ret = priv_i2c_transaction_reserve(txn, data, len);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  ret |= i2c_master_start(txn->cmd);
+  ret |= i2c_master_write_byte(txn->cmd, (i2c_address << 1) | I2C_MASTER_WRITE, true);
+  ret |= i2c_master_write_byte(txn->cmd, reg_addr, true);
+  ret |= i2c_master_write(txn->cmd, data, len, true);
+  ret |= i2c_master_stop(txn->cmd);
+  if (ret != ESP_OK) {
+    ESP_LOGE(txn->tag, "Failed to add write of register 0x%02X to I2C transaction", reg_addr);
+    return ESP_FAIL;
+  }
+
+  txn->op_count++;
+  txn->bytes += 1 + len;
+  return ESP_OK;
+}
+
+esp_err_t i2c_transaction_add_read_reg(i2c_transaction_t *txn, uint8_t i2c_address,
+                                       uint8_t reg_addr, uint8_t *data, size_t len)
+{
+  esp_err_t ret = priv_i2c_transaction_reserve(txn, data, len);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  ret |= i2c_master_start(txn->cmd);
+  ret |= i2c_master_write_byte(txn->cmd, (i2c_address << 1) | I2C_MASTER_WRITE, true);
+  ret |= i2c_master_write_byte(txn->cmd, reg_addr, true);
+  ret |= i2c_master_start(txn->cmd);
+  ret |= i2c_master_write_byte(txn->cmd, (i2c_address << 1) | I2C_MASTER_READ, true);
+  if (len > 1) {
+    ret |= i2c_master_read(txn->cmd, data, len - 1, I2C_MASTER_ACK);
+  }
+  ret |= i2c_master_read_byte(txn->cmd, data + len - 1, I2C_MASTER_NACK);
+  ret |= i2c_master_stop(txn->cmd);
+  if (ret != ESP_OK) {
+    ESP_LOGE(txn->tag, "Failed to add read of register 0x%02X to I2C transaction", reg_addr);
+    return ESP_FAIL;
+  }
+
+  txn->op_count++;
+  txn->bytes += 1 + len;
+  return ESP_OK;
+}
+
+esp_err_t i2c_transaction_execute(i2c_transaction_t *txn)
+{
+  if (txn == NULL || txn->cmd == NULL || txn->op_count == 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  esp_err_t ret = priv_i2c_execute(txn->i2c_bus, txn->cmd, txn->bytes);
+  if (ret != ESP_OK) {
+    ESP_LOGE(txn->tag, "I2C transaction of %u operations failed: %s",
+             txn->op_count, esp_err_to_name(ret));
+  }
+  return ret;
+}
+
+void i2c_transaction_deinit(i2c_transaction_t *txn)
+{
+  if (txn == NULL || txn->cmd == NULL) {
+    return;
+  }
+  i2c_cmd_link_delete_static(txn->cmd);
+  txn->cmd      = NULL;
+  txn->op_count = 0;
+  txn->bytes    = 0;
+}
+
+esp_err_t i2c_get_bus_stats(i2c_port_t i2c_bus, i2c_bus_stats_t *stats)
+{
+  if (stats == NULL || i2c_bus < 0 || i2c_bus >= I2C_NUM_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  portENTER_CRITICAL(&s_i2c_stats_lock);
+  *stats = s_i2c_bus_stats[i2c_bus];
+  portEXIT_CRITICAL(&s_i2c_stats_lock);
+  return ESP_OK;
+}
@@ -0,0 +1,246 @@
+/* components/common/i2c_bus.c */
+
+#include "common/i2c_bus.h"
+#include <inttypes.h>
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/* Constants ******************************************************************/
+
+const char    *i2c_bus_tag                = "I2C_BUS";
+const uint32_t i2c_bus_lock_timeout_ticks = pdMS_TO_TICKS(1000);
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Bookkeeping for one I2C bus.
+ */
+typedef struct {
+  bool              installed;        /**< Whether the driver has been installed on the bus. */
+  uint8_t           scl_io;           /**< SCL pin the bus was installed with. */
+  uint8_t           sda_io;           /**< SDA pin the bus was installed with. */
+  uint32_t          freq_hz;          /**< Clock frequency the bus was installed with. */
+  SemaphoreHandle_t mutex;            /**< Serializes access to the bus. */
+  StaticSemaphore_t mutex_buffer;     /**< Static storage for `mutex`. */
+  uint32_t          priority_waiting; /**< Number of priority devices waiting for the bus. */
+} i2c_bus_state_t;
+
+/* Globals (Static) ***********************************************************/
+
+static i2c_bus_state_t s_i2c_buses[I2C_NUM_MAX] = { 0 };                          /**< State of every bus */
+static portMUX_TYPE    s_i2c_bus_lock           = portMUX_INITIALIZER_UNLOCKED; /**< Guards `priority_waiting` */
+
+/* Static (Private) Functions *************************************************/
+
+/**
+ * @brief Returns the state of a bus.
+ *
+ * @param[in] i2c_bus I2C bus number.
+ *
+ * @return Pointer to the bus state, or NULL if the bus number is invalid or
+ *         its lock has not been created with `i2c_bus_create_locks`.
+ */
+static i2c_bus_state_t *priv_i2c_bus_get(i2c_port_t i2c_bus)
+{
+  if (i2c_bus < 0 || i2c_bus >= I2C_NUM_MAX || s_i2c_buses[i2c_bus].mutex == NULL) {
+    return NULL;
+  }
+  return &s_i2c_buses[i2c_bus];
+}
+
+/**
+ * @brief Returns the number of priority devices currently waiting for a bus.
+ *
+ * @param[in] state Bus state.
+ *
+ * @return Number of waiting priority devices.
+ */
+static uint32_t priv_i2c_bus_priority_waiting(i2c_bus_state_t *state)
+{
+  portENTER_CRITICAL(&s_i2c_bus_lock);
+  uint32_t waiting = state->priority_waiting;
+  portEXIT_CRITICAL(&s_i2c_bus_lock);
+  return waiting;
+}
+
+/* Public Functions ***********************************************************/
+
+esp_err_t i2c_bus_create_locks(void)
+{
+  for (int i = 0; i < I2C_NUM_MAX; i++) {
+    if (s_i2c_buses[i].mutex == NULL) {
+      s_i2c_buses[i].mutex = xSemaphoreCreateMutexStatic(&s_i2c_buses[i].mutex_buffer);
+    }
+    if (s_i2c_buses[i].mutex == NULL) {
+      ESP_LOGE(i2c_bus_tag, "Failed to create the lock of I2C bus %d", i);
+      return ESP_FAIL;
+    }
+  }
+  return ESP_OK;
+}
+
+esp_err_t i2c_bus_init(uint8_t scl_io, uint8_t sda_io, uint32_t freq_hz,
+                       i2c_port_t i2c_bus, const char *tag)
+{
+  if (i2c_bus < 0 || i2c_bus >= I2C_NUM_MAX) {
+    ESP_LOGE(tag, "Invalid I2C bus %d", i2c_bus);
+    return ESP_ERR_INVALID_ARG;
+  }
+  i2c_bus_state_t *state = priv_i2c_bus_get(i2c_bus);
+  if (state == NULL) {
+    ESP_LOGE(tag, "I2C bus locks not created; call i2c_bus_create_locks at startup");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  xSemaphoreTake(state->mutex, portMAX_DELAY);
+
+  esp_err_t ret = ESP_OK;
+  if (!state->installed) {
+    ret = priv_i2c_init(scl_io, sda_io, freq_hz, i2c_bus, tag);
+    if (ret == ESP_OK) {
+      state->installed = true;
+      state->scl_io    = scl_io;
+      state->sda_io    = sda_io;
+      state->freq_hz   = freq_hz;
+      ESP_LOGI(i2c_bus_tag, "I2C bus %d installed (SCL %u, SDA %u, %" PRIu32 " Hz)",
+               i2c_bus, scl_io, sda_io, freq_hz);
+    }
+  } else if (state->scl_io != scl_io || state->sda_io != sda_io || state->freq_hz != freq_hz) {
+    ESP_LOGE(tag, "I2C bus %d already installed with SCL %u, SDA %u, %" PRIu32 " Hz",
+             i2c_bus, state->scl_io, state->sda_io, state->freq_hz);
+    ret = ESP_ERR_INVALID_STATE;
+  }
+
+  xSemaphoreGive(state->mutex);
+  return ret;
+}
+
+esp_err_t i2c_bus_add_device(i2c_port_t i2c_bus, uint8_t i2c_address, bool priority,
+                             const char *tag, i2c_bus_device_t *device)
+{
+  if (device == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  i2c_bus_state_t *state = priv_i2c_bus_get(i2c_bus);
+  if (state == NULL || !state->installed) {
+    ESP_LOGE(tag, "I2C bus %d is not installed", i2c_bus);
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  device->i2c_bus     = i2c_bus;
+  device->i2c_address = i2c_address;
+  device->priority    = priority;
+  device->tag         = tag;
+  return ESP_OK;
+}
+
+esp_err_t i2c_bus_acquire(const i2c_bus_device_t *device, TickType_t timeout)
+{
+  i2c_bus_state_t *state = priv_i2c_bus_get(device->i2c_bus);
+  if (state == NULL || !state->installed) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  if (device->priority) {
+    /* Announce the wait so bulk users step aside, then queue on the mutex */
+    portENTER_CRITICAL(&s_i2c_bus_lock);
+    state->priority_waiting++;
+    portEXIT_CRITICAL(&s_i2c_bus_lock);
+
+    BaseType_t taken = xSemaphoreTake(state->mutex, timeout);
+
+    portENTER_CRITICAL(&s_i2c_bus_lock);
+    state->priority_waiting--;
+    portEXIT_CRITICAL(&s_i2c_bus_lock);
+    return (taken == pdTRUE) ? ESP_OK : ESP_ERR_TIMEOUT;
+  }
+
+  TickType_t start = xTaskGetTickCount();
+  while (true) {
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed > timeout ||
+        xSemaphoreTake(state->mutex, timeout - elapsed) != pdTRUE) {
+      ESP_LOGW(device->tag, "Timed out waiting for I2C bus %d", device->i2c_bus);
+      return ESP_ERR_TIMEOUT;
+    }
+    if (priv_i2c_bus_priority_waiting(state) == 0) {
+      return ESP_OK;
+    }
+
+    /* A priority device is waiting: let it go first */
+    xSemaphoreGive(state->mutex);
+    vTaskDelay(1);
+  }
+}
+
+void i2c_bus_release(const i2c_bus_device_t *device)
+{
+  i2c_bus_state_t *state = priv_i2c_bus_get(device->i2c_bus);
+  if (state != NULL) {
+    xSemaphoreGive(state->mutex);
+  }
+}
+
+esp_err_t i2c_bus_write_byte(const i2c_bus_device_t *device, uint8_t data)
+{
+  esp_err_t ret = i2c_bus_acquire(device, i2c_bus_lock_timeout_ticks);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  ret = priv_i2c_write_byte(data, device->i2c_bus, device->i2c_address, device->tag);
+  i2c_bus_release(device);
+  return ret;
+}
+
+esp_err_t i2c_bus_read_bytes(const i2c_bus_device_t *device, uint8_t *data, size_t len)
+{
+  esp_err_t ret = i2c_bus_acquire(device, i2c_bus_lock_timeout_ticks);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  ret = priv_i2c_read_bytes(data, len, device->i2c_bus, device->i2c_address, device->tag);
+  i2c_bus_release(device);
+  return ret;
+}
+
+esp_err_t i2c_bus_write_reg_byte(const i2c_bus_device_t *device, uint8_t reg_addr, uint8_t data)
+{
+  esp_err_t ret = i2c_bus_acquire(device, i2c_bus_lock_timeout_ticks);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  ret = priv_i2c_write_reg_byte(reg_addr, data, device->i2c_bus, device->i2c_address, device->tag);
+  i2c_bus_release(device);
+  return ret;
+}
+
+esp_err_t i2c_bus_read_reg_bytes(const i2c_bus_device_t *device, uint8_t reg_addr,
+                                 uint8_t *data, size_t len)
+{
+  esp_err_t ret = i2c_bus_acquire(device, i2c_bus_lock_timeout_ticks);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  ret = priv_i2c_read_reg_bytes(reg_addr, data, len, device->i2c_bus, device->i2c_address,
+                                device->tag);
+  i2c_bus_release(device);
+  return ret;
+}
+
+esp_err_t i2c_bus_execute(const i2c_bus_device_t *device, i2c_transaction_t *txn)
+{
+  if (txn == NULL || txn->i2c_bus != device->i2c_bus) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  esp_err_t ret = i2c_bus_acquire(device, i2c_bus_lock_timeout_ticks);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  ret = i2c_transaction_execute(txn);
+  i2c_bus_release(device);
+  return ret;
+}
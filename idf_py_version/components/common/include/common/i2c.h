@@ -15,6 +15,41 @@ extern "C" {
 
 extern const uint32_t i2c_timeout_ticks; /**< Timeout for I2C commands in ticks */
 
+/* Macros *********************************************************************/
+
+#define I2C_TRANSACTION_MAX_OPS   (4) /**< Maximum number of register operations in one transaction. */
+#define I2C_TRANSACTION_LINK_SIZE (I2C_LINK_RECOMMENDED_SIZE(2 * I2C_TRANSACTION_MAX_OPS)) /**< Command link storage for a full transaction. */
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief A prebuilt sequence of register accesses executed as one I2C command.
+ *
+ * The command link lives inside the structure, so building and executing a
+ * transaction never touches the heap. Operations may target different devices
+ * on the same bus. The transaction is built once and then executed as often as
+ * needed; the data buffers passed when adding operations are referenced, not
+ * copied, so callers refresh their contents between executions.
+ */
+typedef struct {
+  i2c_port_t       i2c_bus;                               /**< Bus the transaction runs on. */
+  const char      *tag;                                   /**< Logging tag for error messages. */
+  i2c_cmd_handle_t cmd;                                   /**< Command link built in `link_buffer`. */
+  uint8_t          op_count;                              /**< Number of operations added so far. */
+  size_t           bytes;                                 /**< Payload bytes moved per execution. */
+  uint8_t          link_buffer[I2C_TRANSACTION_LINK_SIZE]; /**< Static storage for the command link. */
+} i2c_transaction_t;
+
+/**
+ * @brief Traffic statistics of one I2C bus.
+ */
+typedef struct {
+  uint32_t transactions; /**< Number of commands executed on the bus. */
+  uint32_t bytes;        /**< Payload bytes written and read, excluding address bytes. */
+  uint32_t errors;       /**< Number of commands that failed. */
+  uint64_t time_us;      /**< Total time spent executing commands in microseconds. */
+} i2c_bus_stats_t;
+
 /* Private Functions **********************************************************/
 
 /**
@@ -125,6 +160,92 @@ esp_err_t priv_i2c_read_reg_bytes(uint8_t reg_addr, uint8_t *data, size_t len,
                                   i2c_port_t i2c_bus, uint8_t i2c_address,
                                   const char *tag);
 
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Prepares an empty transaction on an I2C bus.
+ *
+ * @param[out] txn     Transaction to initialize.
+ * @param[in]  i2c_bus I2C bus number the transaction will run on.
+ * @param[in]  tag     Logging tag for error messages.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - `ESP_ERR_INVALID_ARG` if `txn` is NULL.
+ * - `ESP_FAIL` if the command link could not be created.
+ */
+esp_err_t i2c_transaction_init(i2c_transaction_t *txn, i2c_port_t i2c_bus, const char *tag);
+
+/**
+ * @brief Appends a register write to a transaction.
+ *
+ * @param[in,out] txn         Transaction to extend.
+ * @param[in]     i2c_address 7-bit I2C address of the target device.
+ * @param[in]     reg_addr    Register address to write to.
+ * @param[in]     data        Bytes to write; must stay valid while the transaction is used.
+ * @param[in]     len         Number of bytes to write (at least 1).
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - `ESP_ERR_INVALID_ARG` on a NULL pointer or zero length.
+ * - `ESP_ERR_NO_MEM` if the transaction already holds `I2C_TRANSACTION_MAX_OPS` operations.
+ */
+esp_err_t i2c_transaction_add_write_reg(i2c_transaction_t *txn, uint8_t i2c_address,
+                                        uint8_t reg_addr, const uint8_t *data, size_t len);
+
+/**
+ * @brief Appends a register read to a transaction.
+ *
+ * @param[in,out] txn         Transaction to extend.
+ * @param[in]     i2c_address 7-bit I2C address of the target device.
+ * @param[in]     reg_addr    Starting register address to read from.
+ * @param[out]    data        Buffer filled on every execution; must stay valid while the transaction is used.
+ * @param[in]     len         Number of bytes to read (at least 1).
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - `ESP_ERR_INVALID_ARG` on a NULL pointer or zero length.
+ * - `ESP_ERR_NO_MEM` if the transaction already holds `I2C_TRANSACTION_MAX_OPS` operations.
+ */
+esp_err_t i2c_transaction_add_read_reg(i2c_transaction_t *txn, uint8_t i2c_address,
+                                       uint8_t reg_addr, uint8_t *data, size_t len);
+
+/**
+ * @brief Executes every operation of a transaction in one I2C command.
+ *
+ * @param[in] txn Transaction to execute.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - `ESP_ERR_INVALID_STATE` if the transaction is empty or not initialized.
+ * - Relevant `esp_err_t` error codes from the driver on failure.
+ *
+ * @note 
+ * - No concurrency protection is implemented.
+ */
+esp_err_t i2c_transaction_execute(i2c_transaction_t *txn);
+
+/**
+ * @brief Releases a transaction so it can be initialized again.
+ *
+ * @param[in,out] txn Transaction to release.
+ */
+void i2c_transaction_deinit(i2c_transaction_t *txn);
+
+/**
+ * @brief Returns a snapshot of the traffic statistics of an I2C bus.
+ *
+ * Every helper in this file and every transaction execution is counted.
+ *
+ * @param[in]  i2c_bus I2C bus number.
+ * @param[out] stats   Receives the statistics.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - `ESP_ERR_INVALID_ARG` if `stats` is NULL or the bus number is invalid.
+ */
+esp_err_t i2c_get_bus_stats(i2c_port_t i2c_bus, i2c_bus_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
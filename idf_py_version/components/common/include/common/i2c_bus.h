@@ -0,0 +1,186 @@
+/* components/common/include/common/i2c_bus.h */
+
+#ifndef SAFEHAT_WORKNET_I2C_BUS_H
+#define SAFEHAT_WORKNET_I2C_BUS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/i2c.h"
+#include "common/i2c.h"
+
+/* Constants ******************************************************************/
+
+extern const char    *i2c_bus_tag;                /**< Tag for logging */
+extern const uint32_t i2c_bus_lock_timeout_ticks; /**< Maximum time a device waits for the bus before giving up. */
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Handle of one device attached to a shared I2C bus.
+ *
+ * Obtained from `i2c_bus_add_device` and passed to every bus access, so the
+ * manager knows which bus to lock and whether the device may preempt others.
+ */
+typedef struct {
+  i2c_port_t  i2c_bus;     /**< Bus the device is attached to. */
+  uint8_t     i2c_address; /**< 7-bit I2C address of the device. */
+  bool        priority;    /**< Whether the device preempts non-priority devices waiting for the bus. */
+  const char *tag;         /**< Logging tag of the driver owning the device. */
+} i2c_bus_device_t;
+
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Creates the lock of every I2C bus.
+ *
+ * Must run once at startup, before any task calls another function of this
+ * module, so no bus lock is ever created while the bus is in use.
+ *
+ * @return
+ * - `ESP_OK` on success (or if the locks already exist).
+ * - `ESP_FAIL` if a lock could not be created.
+ */
+esp_err_t i2c_bus_create_locks(void);
+
+/**
+ * @brief Installs the I2C driver on a bus, once.
+ *
+ * The first call configures the bus and installs the driver; later calls for
+ * the same bus only check that the requested pins and frequency match, so
+ * every sensor driver can call this from its own init (and re-init) path.
+ *
+ * @param[in] scl_io  I2C clock line (SCL) pin number.
+ * @param[in] sda_io  I2C data line (SDA) pin number.
+ * @param[in] freq_hz Communication frequency in Hertz.
+ * @param[in] i2c_bus I2C bus number to use.
+ * @param[in] tag     Logging tag of the calling driver.
+ *
+ * @return
+ * - `ESP_OK` if the bus is installed (now or by an earlier call).
+ * - `ESP_ERR_INVALID_ARG` if the bus number is invalid.
+ * - `ESP_ERR_INVALID_STATE` if the bus locks were not created, or the bus was
+ *   installed with different pins or frequency.
+ * - Relevant `esp_err_t` error codes if the driver install fails.
+ */
+esp_err_t i2c_bus_init(uint8_t scl_io, uint8_t sda_io, uint32_t freq_hz,
+                       i2c_port_t i2c_bus, const char *tag);
+
+/**
+ * @brief Fills in a device handle for a device on an installed bus.
+ *
+ * @param[in]  i2c_bus     I2C bus the device is attached to.
+ * @param[in]  i2c_address 7-bit I2C address of the device.
+ * @param[in]  priority    `true` for latency-sensitive devices (the IMU), which
+ *                         get the bus ahead of every non-priority device.
+ * @param[in]  tag         Logging tag of the driver owning the device.
+ * @param[out] device      Handle to fill in.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - `ESP_ERR_INVALID_ARG` if `device` is NULL.
+ * - `ESP_ERR_INVALID_STATE` if the bus has not been installed with `i2c_bus_init`.
+ */
+esp_err_t i2c_bus_add_device(i2c_port_t i2c_bus, uint8_t i2c_address, bool priority,
+                             const char *tag, i2c_bus_device_t *device);
+
+/**
+ * @brief Takes exclusive ownership of the bus of a device.
+ *
+ * A priority device announces itself before waiting; non-priority devices
+ * step aside while a priority device is waiting, so the IMU never queues
+ * behind a run of bulk transfers.
+ *
+ * @param[in] device  Device that wants the bus.
+ * @param[in] timeout Maximum time to wait in ticks.
+ *
+ * @return
+ * - `ESP_OK` once the bus is owned.
+ * - `ESP_ERR_TIMEOUT` if the bus could not be taken in time.
+ * - `ESP_ERR_INVALID_STATE` if the bus has not been installed.
+ */
+esp_err_t i2c_bus_acquire(const i2c_bus_device_t *device, TickType_t timeout);
+
+/**
+ * @brief Releases the bus taken with `i2c_bus_acquire`.
+ *
+ * @param[in] device Device that owns the bus.
+ */
+void i2c_bus_release(const i2c_bus_device_t *device);
+
+/**
+ * @brief Writes a single byte to a device, holding the bus for the access.
+ *
+ * @param[in] device Target device.
+ * @param[in] data   Byte to write.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - Relevant `esp_err_t` error codes on failure.
+ */
+esp_err_t i2c_bus_write_byte(const i2c_bus_device_t *device, uint8_t data);
+
+/**
+ * @brief Reads bytes from a device, holding the bus for the access.
+ *
+ * @param[in]  device Target device.
+ * @param[out] data   Buffer to store the read data.
+ * @param[in]  len    Number of bytes to read.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - Relevant `esp_err_t` error codes on failure.
+ */
+esp_err_t i2c_bus_read_bytes(const i2c_bus_device_t *device, uint8_t *data, size_t len);
+
+/**
+ * @brief Writes a byte to a device register, holding the bus for the access.
+ *
+ * @param[in] device   Target device.
+ * @param[in] reg_addr Register address to write to.
+ * @param[in] data     Data byte to write.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - Relevant `esp_err_t` error codes on failure.
+ */
+esp_err_t i2c_bus_write_reg_byte(const i2c_bus_device_t *device, uint8_t reg_addr, uint8_t data);
+
+/**
+ * @brief Reads consecutive device registers, holding the bus for the access.
+ *
+ * @param[in]  device   Target device.
+ * @param[in]  reg_addr Starting register address to read from.
+ * @param[out] data     Buffer to store the read data.
+ * @param[in]  len      Number of bytes to read.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - Relevant `esp_err_t` error codes on failure.
+ */
+esp_err_t i2c_bus_read_reg_bytes(const i2c_bus_device_t *device, uint8_t reg_addr,
+                                 uint8_t *data, size_t len);
+
+/**
+ * @brief Executes a prebuilt transaction, holding the bus of a device for it.
+ *
+ * @param[in] device Device whose bus priority applies to the transaction.
+ * @param[in] txn    Transaction to execute; must be built for the same bus.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - `ESP_ERR_INVALID_ARG` if the transaction runs on a different bus.
+ * - Relevant `esp_err_t` error codes on failure.
+ */
+esp_err_t i2c_bus_execute(const i2c_bus_device_t *device, i2c_transaction_t *txn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFEHAT_WORKNET_I2C_BUS_H */
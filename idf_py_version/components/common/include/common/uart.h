@@ -10,6 +10,8 @@ extern "C" {
 #include <stdint.h>
 #include "esp_err.h"
 #include "driver/uart.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 
 /* Constants ******************************************************************/
 
@@ -67,6 +69,59 @@ esp_err_t priv_uart_init(uint8_t tx_io, uint8_t rx_io, uint32_t baud_rate,
 esp_err_t priv_uart_read(uint8_t *data, size_t len, int32_t *out_length,
                          uart_port_t uart_num, const char *tag);
 
+/**
+ * @brief Initializes the UART interface to report each delimited line as an event.
+ *
+ * Configures the UART like `priv_uart_init`, but installs the driver with an
+ * event queue and enables pattern detection on `pattern`. The driver then
+ * posts a `UART_PATTERN_DET` event each time the delimiter arrives, and the
+ * owner reads the line with `priv_uart_read_line` instead of polling.
+ *
+ * @param[in]  tx_io          Pin number for the TX (transmit) line.
+ * @param[in]  rx_io          Pin number for the RX (receive) line.
+ * @param[in]  baud_rate      Communication baud rate (e.g., 9600, 115200).
+ * @param[in]  uart_num       UART port number to configure.
+ * @param[in]  rx_buffer_size Size of the driver's RX ring buffer in bytes.
+ * @param[in]  pattern        Delimiter that ends a line, e.g. '\n'.
+ * @param[in]  queue_length   Length of both the event queue and the queue of pattern positions.
+ * @param[out] event_queue    Receives the driver's event queue.
+ * @param[in]  tag            Tag for logging errors and events.
+ *
+ * @return 
+ * - `ESP_OK` on successful initialization.
+ * - Error codes from `esp_err_t` on failure (e.g., invalid arguments or driver errors).
+ *
+ * @note This function assumes the UART driver is not already initialized on the given port.
+ */
+esp_err_t priv_uart_init_pattern(uint8_t tx_io, uint8_t rx_io, uint32_t baud_rate,
+                                 uart_port_t uart_num, size_t rx_buffer_size,
+                                 char pattern, uint8_t queue_length,
+                                 QueueHandle_t *event_queue, const char *tag);
+
+/**
+ * @brief Reads the line whose delimiter raised the oldest `UART_PATTERN_DET` event.
+ *
+ * Call once per `UART_PATTERN_DET` event. The line is already in the RX
+ * buffer, so the read does not wait. It includes the delimiter and is not
+ * null-terminated.
+ *
+ * @param[out] data       Buffer to store the line.
+ * @param[in]  len        Size of `data` in bytes.
+ * @param[out] out_length Number of bytes stored in `data`.
+ * @param[in]  uart_num   UART port number to read from.
+ * @param[in]  tag        Tag for logging errors and events.
+ *
+ * @return 
+ * - `ESP_OK`                if a line was read.
+ * - `ESP_ERR_INVALID_SIZE`  if the line did not fit in `data`; it is skipped.
+ * - `ESP_ERR_INVALID_STATE` if the pattern queue overflowed; buffered data is dropped.
+ * - `ESP_FAIL`              if the read failed.
+ *
+ * @note Requires `priv_uart_init_pattern`.
+ */
+esp_err_t priv_uart_read_line(uint8_t *data, size_t len, int32_t *out_length,
+                              uart_port_t uart_num, const char *tag);
+
 #ifdef __cplusplus
 }
 #endif
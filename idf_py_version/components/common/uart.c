@@ -8,10 +8,23 @@
 
 const uint32_t uart_timeout_ticks = pdMS_TO_TICKS(1000); /* Timeout for UART operations in ticks */
 
-/* Private Functions **********************************************************/
+/* Private (Static) Functions *************************************************/
 
-esp_err_t priv_uart_init(uint8_t tx_io, uint8_t rx_io, uint32_t baud_rate,
-                         uart_port_t uart_num, const char *tag)
+/**
+ * @brief Applies the line settings and pins shared by every UART user.
+ *
+ * @param[in] tx_io     Pin number for the TX line.
+ * @param[in] rx_io     Pin number for the RX line.
+ * @param[in] baud_rate Communication baud rate.
+ * @param[in] uart_num  UART port number to configure.
+ * @param[in] tag       Tag for logging errors.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - Error code from the UART driver otherwise.
+ */
+static esp_err_t priv_uart_configure(uint8_t tx_io, uint8_t rx_io, uint32_t baud_rate,
+                                     uart_port_t uart_num, const char *tag)
 {
   uart_config_t uart_config = {
     .baud_rate = baud_rate,                /* Set the baud rate (communication speed) */
@@ -32,6 +45,17 @@ esp_err_t priv_uart_init(uint8_t tx_io, uint8_t rx_io, uint32_t baud_rate,
   ret = uart_set_pin(uart_num, tx_io, rx_io, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
   if (ret != ESP_OK) {
     ESP_LOGE(tag, "UART pin configuration failed: %s", esp_err_to_name(ret));
+  }
+  return ret;
+}
+
+/* Private Functions **********************************************************/
+
+esp_err_t priv_uart_init(uint8_t tx_io, uint8_t rx_io, uint32_t baud_rate,
+                         uart_port_t uart_num, const char *tag)
+{
+  esp_err_t ret = priv_uart_configure(tx_io, rx_io, baud_rate, uart_num, tag);
+  if (ret != ESP_OK) {
     return ret;
   }
 
@@ -60,3 +84,70 @@ esp_err_t priv_uart_read(uint8_t *data, size_t len, int32_t *out_length,
     return ESP_FAIL;
   }
 }
+
+esp_err_t priv_uart_init_pattern(uint8_t tx_io, uint8_t rx_io, uint32_t baud_rate,
+                                 uart_port_t uart_num, size_t rx_buffer_size,
+                                 char pattern, uint8_t queue_length,
+                                 QueueHandle_t *event_queue, const char *tag)
+{
+  esp_err_t ret = priv_uart_configure(tx_io, rx_io, baud_rate, uart_num, tag);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  ret = uart_driver_install(uart_num, rx_buffer_size, 0, queue_length, event_queue, 0);
+  if (ret != ESP_OK) {
+    ESP_LOGE(tag, "UART driver installation failed: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  /* One pattern character, at most 9 bit times between repeats, no idle
+   * time required around it: every delimiter counts */
+  ret = uart_enable_pattern_det_baud_intr(uart_num, pattern, 1, 9, 0, 0);
+  if (ret == ESP_OK) {
+    ret = uart_pattern_queue_reset(uart_num, queue_length);
+  }
+  if (ret != ESP_OK) {
+    ESP_LOGE(tag, "UART pattern detection setup failed: %s", esp_err_to_name(ret));
+  }
+
+  return ret;
+}
+
+esp_err_t priv_uart_read_line(uint8_t *data, size_t len, int32_t *out_length,
+                              uart_port_t uart_num, const char *tag)
+{
+  *out_length = 0;
+
+  int32_t pos = uart_pattern_pop_pos(uart_num);
+  if (pos < 0) {
+    /* The pattern queue overflowed; its positions no longer match the buffer */
+    ESP_LOGW(tag, "UART pattern queue overflowed, dropping buffered data");
+    uart_flush_input(uart_num);
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  /* The line is already buffered, so none of these reads wait */
+  size_t line_len = (size_t)pos + 1; /* Up to and including the delimiter */
+  if (line_len > len) {
+    while (line_len > 0) {
+      int32_t skipped = uart_read_bytes(uart_num, data, (line_len < len) ? line_len : len,
+                                        uart_timeout_ticks);
+      if (skipped <= 0) {
+        break;
+      }
+      line_len -= skipped;
+    }
+    ESP_LOGW(tag, "UART line longer than %u bytes dropped", len);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  int32_t length = uart_read_bytes(uart_num, data, line_len, uart_timeout_ticks);
+  if (length <= 0) {
+    ESP_LOGE(tag, "UART read failed or timed out");
+    return ESP_FAIL;
+  }
+
+  *out_length = length;
+  return ESP_OK;
+}
@@ -3,8 +3,9 @@
 #include "bh1750_hal.h"
 #include "file_write_manager.h"
 #include "webserver_tasks.h"
+#include "sensor_frame.h"
 #include "cJSON.h"
-#include "common/i2c.h"
+#include "common/i2c_bus.h"
 #include "esp_log.h"
 #include "error_handler.h"
 
@@ -22,6 +23,10 @@ const uint8_t    bh1750_max_retries            = 4;
 const uint32_t   bh1750_initial_retry_interval = pdMS_TO_TICKS(15);
 const uint32_t   bh1750_max_backoff_interval   = pdMS_TO_TICKS(8 * 60);
 
+/* Globals (Static) ***********************************************************/
+
+static i2c_bus_device_t s_bh1750_i2c_device; /**< Handle of the BH1750 on the shared I2C bus */
+
 /* Public Functions ***********************************************************/
 
 char *bh1750_data_to_json(const bh1750_data_t *data)
@@ -74,16 +79,19 @@ esp_err_t bh1750_init(void *sensor_data)
                     bh1750_max_backoff_interval);
 
   /* Initialize the I2C bus */
-  esp_err_t ret = priv_i2c_init(bh1750_scl_io, bh1750_sda_io, bh1750_i2c_freq_hz,
-                                bh1750_i2c_bus, bh1750_tag);
+  esp_err_t ret = i2c_bus_init(bh1750_scl_io, bh1750_sda_io, bh1750_i2c_freq_hz,
+                               bh1750_i2c_bus, bh1750_tag);
+  if (ret == ESP_OK) {
+    ret = i2c_bus_add_device(bh1750_i2c_bus, bh1750_i2c_address, false, bh1750_tag,
+                             &s_bh1750_i2c_device);
+  }
   if (ret != ESP_OK) {
     ESP_LOGE(bh1750_tag, "I2C driver install failed: %s", esp_err_to_name(ret));
     return ret;
   }
 
   /* Power on the sensor */
-  ret = priv_i2c_write_byte(k_bh1750_power_on_cmd, bh1750_i2c_bus,
-                            bh1750_i2c_address, bh1750_tag);
+  ret = i2c_bus_write_byte(&s_bh1750_i2c_device, k_bh1750_power_on_cmd);
   if (ret != ESP_OK) {
     bh1750_data->state = k_bh1750_power_on_error;
     ESP_LOGE(bh1750_tag, "BH1750 Power On failed: %s", esp_err_to_name(ret));
@@ -92,8 +100,7 @@ esp_err_t bh1750_init(void *sensor_data)
   vTaskDelay(pdMS_TO_TICKS(10));
 
   /* Reset the sensor */
-  ret = priv_i2c_write_byte(k_bh1750_reset_cmd, bh1750_i2c_bus,
-                            bh1750_i2c_address, bh1750_tag);
+  ret = i2c_bus_write_byte(&s_bh1750_i2c_device, k_bh1750_reset_cmd);
   if (ret != ESP_OK) {
     bh1750_data->state = k_bh1750_reset_error;
     ESP_LOGE(bh1750_tag, "BH1750 Reset failed: %s", esp_err_to_name(ret));
@@ -102,8 +109,7 @@ esp_err_t bh1750_init(void *sensor_data)
   vTaskDelay(pdMS_TO_TICKS(10));
 
   /* Set continuous measurement mode (low res) */
-  ret = priv_i2c_write_byte(k_bh1750_cont_low_res_mode_cmd, bh1750_i2c_bus,
-                            bh1750_i2c_address, bh1750_tag);
+  ret = i2c_bus_write_byte(&s_bh1750_i2c_device, k_bh1750_cont_low_res_mode_cmd);
 
   if (ret != ESP_OK) {
     bh1750_data->state = k_bh1750_cont_low_res_error;
@@ -120,8 +126,7 @@ esp_err_t bh1750_init(void *sensor_data)
 esp_err_t bh1750_read(bh1750_data_t *sensor_data)
 {
   uint8_t   data[2]; /* TODO: Move 2 to an enum or explain via a comment */
-  esp_err_t ret = priv_i2c_read_bytes(data, 2, bh1750_i2c_bus, /* TODO: Move 2 to an enum or explain via a comment */
-                                      bh1750_i2c_address, bh1750_tag);
+  esp_err_t ret = i2c_bus_read_bytes(&s_bh1750_i2c_device, data, 2);
   if (ret != ESP_OK) {
     sensor_data->lux   = -1.0;
     sensor_data->state = k_bh1750_error;
@@ -137,23 +142,31 @@ esp_err_t bh1750_read(bh1750_data_t *sensor_data)
   return ESP_OK;
 }
 
-void bh1750_tasks(void *sensor_data)
+void bh1750_tick(void *sensor_data)
 {
   bh1750_data_t *bh1750_data = (bh1750_data_t *)sensor_data;
-  while (1) {
-    if (bh1750_read(bh1750_data) == ESP_OK) {
-      char *json = bh1750_data_to_json(bh1750_data);
-      send_sensor_data_to_webserver(json);
-      file_write_enqueue("bh1750.txt", json);
-      free(json);
-      bh1750_data->error_handler.fail_count = 0;
-    } else {
-      bh1750_data->error_handler.fail_count++;
-      error_handler_reset(&bh1750_data->error_handler,
-                         bh1750_data->error_handler.fail_count,
-                         bh1750_init,
-                         bh1750_data);
+  if (bh1750_read(bh1750_data) == ESP_OK) {
+    uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+    size_t  frame_len = 0;
+    if (sensor_frame_encode(k_sensor_frame_id_bh1750, bh1750_data, frame, sizeof(frame),
+                            &frame_len) == ESP_OK) {
+      webserver_enqueue_frame(frame, frame_len);
+      file_write_log_frame("bh1750.tsl", frame, frame_len);
     }
+    bh1750_data->error_handler.fail_count = 0;
+  } else {
+    bh1750_data->error_handler.fail_count++;
+    error_handler_reset(&bh1750_data->error_handler,
+                       bh1750_data->error_handler.fail_count,
+                       bh1750_init,
+                       bh1750_data);
+  }
+}
+
+void bh1750_tasks(void *sensor_data)
+{
+  while (1) {
+    bh1750_tick(sensor_data);
     vTaskDelay(bh1750_polling_rate_ticks);
   }
 }
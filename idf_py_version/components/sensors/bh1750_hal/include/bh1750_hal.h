@@ -137,6 +137,20 @@ esp_err_t bh1750_init(void *sensor_data);
  */
 esp_err_t bh1750_read(bh1750_data_t *sensor_data);
 
+/**
+ * @brief Runs one acquisition cycle of the BH1750.
+ *
+ * Reads the light level once, publishes the frame and the SD log line,
+ * and feeds a failure to the error handler. Never blocks for longer than
+ * the I2C access itself, so it can share a scheduler worker.
+ *
+ * @param[in,out] sensor_data Pointer to the `bh1750_data_t` structure for
+ *                            sensor data and error recovery.
+ *
+ * @note Called periodically by the sensor scheduler, or in a loop by `bh1750_tasks`.
+ */
+void bh1750_tick(void *sensor_data);
+
 /**
  * @brief Executes periodic tasks for the BH1750 sensor.
  *
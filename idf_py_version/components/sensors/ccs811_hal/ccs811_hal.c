@@ -5,8 +5,9 @@
 #include "ccs811_hal.h"
 #include "file_write_manager.h"
 #include "webserver_tasks.h"
+#include "sensor_frame.h"
 #include "cJSON.h"
-#include "common/i2c.h"
+#include "common/i2c_bus.h"
 #include "esp_log.h"
 #include "error_handler.h"
 #include "driver/gpio.h"
@@ -25,6 +26,10 @@ const uint32_t   ccs811_initial_retry_interval = pdMS_TO_TICKS(15 * 1000);
 const uint32_t   ccs811_max_backoff_interval   = pdMS_TO_TICKS(8 * 60 * 1000);
 const uint8_t    ccs811_allowed_fail_attempts  = 3;
 
+/* Globals (Static) ***********************************************************/
+
+static i2c_bus_device_t s_ccs811_i2c_device; /**< Handle of the CCS811 on the shared I2C bus */
+
 /* Public Functions ***********************************************************/
 
 char *ccs811_data_to_json(const ccs811_data_t *data)
@@ -85,16 +90,19 @@ esp_err_t ccs811_init(void *sensor_data)
                      ccs811_max_backoff_interval);
 
   /* Initialize I2C interface */
-  esp_err_t ret = priv_i2c_init(ccs811_scl_io, ccs811_sda_io, ccs811_i2c_freq_hz,
-                                ccs811_i2c_bus, ccs811_tag);
+  esp_err_t ret = i2c_bus_init(ccs811_scl_io, ccs811_sda_io, ccs811_i2c_freq_hz,
+                               ccs811_i2c_bus, ccs811_tag);
+  if (ret == ESP_OK) {
+    ret = i2c_bus_add_device(ccs811_i2c_bus, ccs811_i2c_address, false, ccs811_tag,
+                             &s_ccs811_i2c_device);
+  }
   if (ret != ESP_OK) {
     data->state = k_ccs811_error;
     return ret;
   }
 
   /* Start the application */
-  ret = priv_i2c_write_byte(k_ccs811_cmd_app_start, ccs811_i2c_bus,
-                           ccs811_i2c_address, ccs811_tag);
+  ret = i2c_bus_write_byte(&s_ccs811_i2c_device, k_ccs811_cmd_app_start);
   if (ret != ESP_OK) {
     ESP_LOGE(ccs811_tag, "Failed to start application: %s", esp_err_to_name(ret));
     data->state = k_ccs811_app_start_error;
@@ -115,9 +123,8 @@ esp_err_t ccs811_read(ccs811_data_t *sensor_data)
   uint8_t data[k_ccs811_alg_data_len];
 
   /* Read the algorithm results */
-  ret = priv_i2c_read_reg_bytes(k_ccs811_reg_alg_result_data, data,
-                               k_ccs811_alg_data_len, sensor_data->i2c_bus,
-                               sensor_data->i2c_address, ccs811_tag);
+  ret = i2c_bus_read_reg_bytes(&s_ccs811_i2c_device, k_ccs811_reg_alg_result_data, data,
+                               k_ccs811_alg_data_len);
   
   if (ret != ESP_OK) {
     ESP_LOGE(ccs811_tag, "Failed to read sensor data: %s", esp_err_to_name(ret));
@@ -135,27 +142,31 @@ esp_err_t ccs811_read(ccs811_data_t *sensor_data)
   return ESP_OK;
 }
 
-void ccs811_tasks(void *sensor_data)
+void ccs811_tick(void *sensor_data)
 {
   ccs811_data_t *ccs811_data = (ccs811_data_t *)sensor_data;
+  if (ccs811_read(ccs811_data) == ESP_OK) {
+    uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+    size_t  frame_len = 0;
+    if (sensor_frame_encode(k_sensor_frame_id_ccs811, ccs811_data, frame, sizeof(frame),
+                            &frame_len) == ESP_OK) {
+      webserver_enqueue_frame(frame, frame_len);
+      file_write_log_frame("ccs811.tsl", frame, frame_len);
+    }
+    ccs811_data->error_handler.fail_count = 0;
+  } else {
+    ccs811_data->error_handler.fail_count++;
+    error_handler_reset(&ccs811_data->error_handler,
+                        ccs811_data->error_handler.fail_count,
+                        ccs811_init,
+                        ccs811_data);
+  }
+}
 
+void ccs811_tasks(void *sensor_data)
+{
   while (1) {
-    if (ccs811_read(ccs811_data) == ESP_OK) {
-      char *json = ccs811_data_to_json(ccs811_data);
-      if (json) {
-        send_sensor_data_to_webserver(json);
-        file_write_enqueue("ccs811.txt", json);
-        free(json);
-      }
-      ccs811_data->error_handler.fail_count = 0;
-    } else {
-      ccs811_data->error_handler.fail_count++;
-      error_handler_reset(&ccs811_data->error_handler,
-                          ccs811_data->error_handler.fail_count,
-                          ccs811_init,
-                          ccs811_data);
-    }
-    
+    ccs811_tick(sensor_data);
     vTaskDelay(ccs811_polling_rate_ticks);
   }
 }
@@ -123,6 +123,19 @@ esp_err_t ccs811_init(void *sensor_data);
  */
 esp_err_t ccs811_read(ccs811_data_t *sensor_data);
 
+/**
+ * @brief Runs one acquisition cycle of the CCS811.
+ *
+ * Reads eCO2 and TVOC once and publishes them, or counts a failure and
+ * lets the error handler decide whether to re-initialize the sensor.
+ *
+ * @param[in,out] sensor_data Pointer to the `ccs811_data_t` structure for
+ *                            sensor data and state.
+ *
+ * @note Called periodically by the sensor scheduler, or in a loop by `ccs811_tasks`.
+ */
+void ccs811_tick(void *sensor_data);
+
 /**
  * @brief Executes periodic tasks for the CCS811 sensor.
  *
@@ -5,6 +5,7 @@
 #include <string.h>
 #include "file_write_manager.h"
 #include "webserver_tasks.h"
+#include "sensor_frame.h"
 #include "cJSON.h"
 #include "esp_log.h"
 #include "driver/gpio.h"
@@ -349,23 +350,31 @@ esp_err_t dht22_read(dht22_data_t *sensor_data)
   return ESP_OK;
 }
 
-void dht22_tasks(void *sensor_data)
+void dht22_tick(void *sensor_data)
 {
   dht22_data_t *dht22_data = (dht22_data_t *)sensor_data;
-  while (1) {
-    if (dht22_read(dht22_data) == ESP_OK) {
-      char *json = dht22_data_to_json(dht22_data);
-      send_sensor_data_to_webserver(json);
-      file_write_enqueue("dht22.txt", json);
-      free(json);
-      dht22_data->error_handler.fail_count = 0; /* Reset fail count on success */
-    } else {
-      dht22_data->error_handler.fail_count++;
-      error_handler_reset(&dht22_data->error_handler,
-                         dht22_data->error_handler.fail_count,
-                         dht22_init,
-                         dht22_data);
+  if (dht22_read(dht22_data) == ESP_OK) {
+    uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+    size_t  frame_len = 0;
+    if (sensor_frame_encode(k_sensor_frame_id_dht22, dht22_data, frame, sizeof(frame),
+                            &frame_len) == ESP_OK) {
+      webserver_enqueue_frame(frame, frame_len);
+      file_write_log_frame("dht22.tsl", frame, frame_len);
     }
+    dht22_data->error_handler.fail_count = 0; /* Reset fail count on success */
+  } else {
+    dht22_data->error_handler.fail_count++;
+    error_handler_reset(&dht22_data->error_handler,
+                       dht22_data->error_handler.fail_count,
+                       dht22_init,
+                       dht22_data);
+  }
+}
+
+void dht22_tasks(void *sensor_data)
+{
+  while (1) {
+    dht22_tick(sensor_data);
     vTaskDelay(dht22_polling_rate_ticks);
   }
 }
@@ -115,6 +115,20 @@ esp_err_t dht22_init(void *sensor_data);
  */
 esp_err_t dht22_read(dht22_data_t *sensor_data);
 
+/**
+ * @brief Runs one acquisition cycle of the DHT22.
+ *
+ * Performs one bit-banged DHT22 read and publishes the result. The read
+ * busy-waits through the start pulse and the bit stream, so keep this on the
+ * slow-sensor worker.
+ *
+ * @param[in,out] sensor_data Pointer to the `dht22_data_t` structure for
+ *                            sensor data and state.
+ *
+ * @note Called periodically by the sensor scheduler, or in a loop by `dht22_tasks`.
+ */
+void dht22_tick(void *sensor_data);
+
 /**
  * @brief Executes periodic tasks for the DHT22 sensor.
  *
@@ -0,0 +1,215 @@
+/* components/sensors/fall_detector/fall_detector.c */
+
+#include "fall_detector.h"
+#include <math.h>
+#include <string.h>
+
+/* Constants ******************************************************************/
+
+const float   fall_detector_free_fall_g           = 0.4f;
+const int64_t fall_detector_free_fall_min_us      = 80 * 1000;
+const float   fall_detector_impact_g              = 2.5f;
+const int64_t fall_detector_impact_window_us      = 500 * 1000;
+const float   fall_detector_still_accel_g         = 0.15f;
+const float   fall_detector_still_gyro_dps        = 20.0f;
+const int64_t fall_detector_still_duration_us     = 1000 * 1000;
+const int64_t fall_detector_post_impact_window_us = 4000 * 1000;
+const float   fall_detector_orientation_deg       = 45.0f;
+
+static const float fall_detector_gravity_alpha = 0.02f; /**< Low-pass weight of a new sample in the gravity estimate */
+static const float fall_detector_upright_tol_g = 0.2f;  /**< Max deviation of |a| from 1 g for a sample to update the gravity estimate */
+
+/* Private (Static) Functions *************************************************/
+
+/**
+ * @brief Returns the angle between two vectors in degrees.
+ *
+ * @param[in] a First vector.
+ * @param[in] b Second vector.
+ *
+ * @return Angle in degrees, or 0 if either vector has zero length.
+ */
+static float priv_angle_deg(const float a[3], const float b[3])
+{
+  float dot    = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+  float norm_a = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+  float norm_b = sqrtf(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+  if (norm_a == 0.0f || norm_b == 0.0f) {
+    return 0.0f;
+  }
+
+  float cosine = dot / (norm_a * norm_b);
+  cosine       = (cosine > 1.0f) ? 1.0f : ((cosine < -1.0f) ? -1.0f : cosine);
+  return acosf(cosine) * (180.0f / (float)M_PI);
+}
+
+/**
+ * @brief Switches the state machine to a new state.
+ *
+ * @param[in,out] detector     Detector state.
+ * @param[in]     state        State to enter.
+ * @param[in]     timestamp_us Time of the transition.
+ */
+static void priv_enter(fall_detector_t *detector, fall_detector_state_t state, int64_t timestamp_us)
+{
+  detector->state          = state;
+  detector->phase_start_us = timestamp_us;
+}
+
+/**
+ * @brief Starts tracking an impact peak.
+ *
+ * @param[in,out] detector     Detector state.
+ * @param[in]     timestamp_us Time of the first sample above the impact threshold.
+ * @param[in]     magnitude    Acceleration magnitude of that sample.
+ */
+static void priv_start_impact(fall_detector_t *detector, int64_t timestamp_us, float magnitude)
+{
+  detector->peak_g  = magnitude;
+  detector->peak_us = timestamp_us;
+  priv_enter(detector, k_fall_detector_impact, timestamp_us);
+}
+
+/**
+ * @brief Restarts the stillness run used to confirm a fall.
+ *
+ * @param[in,out] detector     Detector state.
+ * @param[in]     timestamp_us Time of the sample that broke stillness.
+ */
+static void priv_reset_stillness(fall_detector_t *detector, int64_t timestamp_us)
+{
+  detector->still_start_us = timestamp_us;
+  detector->still_count    = 0;
+  memset(detector->still_sum, 0, sizeof(detector->still_sum));
+}
+
+/* Public Functions ***********************************************************/
+
+void fall_detector_init(fall_detector_t *detector)
+{
+  memset(detector, 0, sizeof(*detector));
+  detector->state = k_fall_detector_idle;
+}
+
+bool fall_detector_update(fall_detector_t *detector, int64_t timestamp_us,
+                          const float accel_g[3], const float gyro_dps[3],
+                          fall_detector_event_t *event)
+{
+  float magnitude = sqrtf(accel_g[0] * accel_g[0] + accel_g[1] * accel_g[1] + accel_g[2] * accel_g[2]);
+  float gyro_rate = sqrtf(gyro_dps[0] * gyro_dps[0] + gyro_dps[1] * gyro_dps[1] + gyro_dps[2] * gyro_dps[2]);
+
+  switch (detector->state) {
+    case k_fall_detector_idle:
+      /* Track the resting orientation only from samples close to 1 g */
+      if (fabsf(magnitude - 1.0f) < fall_detector_upright_tol_g) {
+        for (uint8_t i = 0; i < 3; i++) {
+          detector->gravity[i] = detector->gravity_valid ?
+                                 detector->gravity[i] + fall_detector_gravity_alpha * (accel_g[i] - detector->gravity[i]) :
+                                 accel_g[i];
+        }
+        detector->gravity_valid = true;
+      }
+
+      if (magnitude < fall_detector_free_fall_g) {
+        memcpy(detector->reference, detector->gravity, sizeof(detector->reference));
+        detector->free_fall_start_us = timestamp_us;
+        priv_enter(detector, k_fall_detector_free_fall, timestamp_us);
+      } else if (magnitude > fall_detector_impact_g) {
+        memcpy(detector->reference, detector->gravity, sizeof(detector->reference));
+        detector->free_fall_ms = 0;
+        priv_start_impact(detector, timestamp_us, magnitude);
+      }
+      return false;
+
+    case k_fall_detector_free_fall:
+      if (magnitude < fall_detector_free_fall_g) {
+        return false;
+      }
+      detector->free_fall_ms = (uint32_t)((timestamp_us - detector->free_fall_start_us) / 1000);
+      if (magnitude > fall_detector_impact_g) {
+        priv_start_impact(detector, timestamp_us, magnitude);
+      } else if ((timestamp_us - detector->free_fall_start_us) >= fall_detector_free_fall_min_us) {
+        priv_enter(detector, k_fall_detector_impact_wait, timestamp_us);
+      } else {
+        priv_enter(detector, k_fall_detector_idle, timestamp_us);
+      }
+      return false;
+
+    case k_fall_detector_impact_wait:
+      if (magnitude > fall_detector_impact_g) {
+        priv_start_impact(detector, timestamp_us, magnitude);
+      } else if ((timestamp_us - detector->phase_start_us) > fall_detector_impact_window_us) {
+        priv_enter(detector, k_fall_detector_idle, timestamp_us);
+      }
+      return false;
+
+    case k_fall_detector_impact:
+      if (magnitude > fall_detector_impact_g) {
+        if (magnitude > detector->peak_g) {
+          detector->peak_g  = magnitude;
+          detector->peak_us = timestamp_us;
+        }
+        return false;
+      }
+
+      /* Peak is over: alert right away, then look for a fall */
+      event->type                   = k_fall_detector_event_impact;
+      event->timestamp_us           = detector->peak_us;
+      event->peak_g                 = detector->peak_g;
+      event->free_fall_ms           = detector->free_fall_ms;
+      event->orientation_change_deg = 0.0f;
+      priv_reset_stillness(detector, timestamp_us);
+      priv_enter(detector, k_fall_detector_post_impact, timestamp_us);
+      return true;
+
+    case k_fall_detector_post_impact: {
+      if (magnitude > fall_detector_impact_g) {
+        priv_start_impact(detector, timestamp_us, magnitude);
+        return false;
+      }
+
+      if ((timestamp_us - detector->phase_start_us) > fall_detector_post_impact_window_us) {
+        priv_enter(detector, k_fall_detector_idle, timestamp_us);
+        return false;
+      }
+
+      if (fabsf(magnitude - 1.0f) > fall_detector_still_accel_g || gyro_rate > fall_detector_still_gyro_dps) {
+        priv_reset_stillness(detector, timestamp_us);
+        return false;
+      }
+
+      for (uint8_t i = 0; i < 3; i++) {
+        detector->still_sum[i] += accel_g[i];
+      }
+      detector->still_count++;
+      if ((timestamp_us - detector->still_start_us) < fall_detector_still_duration_us) {
+        return false;
+      }
+
+      /* Still long enough: compare the resting orientation with the one before the event */
+      float resting[3];
+      for (uint8_t i = 0; i < 3; i++) {
+        resting[i] = detector->still_sum[i] / (float)detector->still_count;
+      }
+      float angle = priv_angle_deg(detector->reference, resting);
+
+      /* The wearer is at rest either way, so adopt the new orientation */
+      memcpy(detector->gravity, resting, sizeof(detector->gravity));
+      priv_enter(detector, k_fall_detector_idle, timestamp_us);
+
+      if (angle < fall_detector_orientation_deg) {
+        return false;
+      }
+      event->type                   = k_fall_detector_event_fall;
+      event->timestamp_us           = detector->peak_us;
+      event->peak_g                 = detector->peak_g;
+      event->free_fall_ms           = detector->free_fall_ms;
+      event->orientation_change_deg = angle;
+      return true;
+    }
+
+    default:
+      priv_enter(detector, k_fall_detector_idle, timestamp_us);
+      return false;
+  }
+}
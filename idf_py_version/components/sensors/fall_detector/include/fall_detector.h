@@ -0,0 +1,118 @@
+/* components/sensors/fall_detector/include/fall_detector.h */
+
+#ifndef SAFEHAT_WORKNET_FALL_DETECTOR_H
+#define SAFEHAT_WORKNET_FALL_DETECTOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Constants ******************************************************************/
+
+extern const float   fall_detector_free_fall_g;           /**< Acceleration magnitude below which the helmet is considered in free fall, in g. */
+extern const int64_t fall_detector_free_fall_min_us;      /**< Minimum free-fall duration that arms the impact check. */
+extern const float   fall_detector_impact_g;              /**< Acceleration magnitude above which a sample counts as an impact, in g. */
+extern const int64_t fall_detector_impact_window_us;      /**< Time after a free fall during which an impact is expected. */
+extern const float   fall_detector_still_accel_g;         /**< Maximum deviation of |a| from 1 g while lying still, in g. */
+extern const float   fall_detector_still_gyro_dps;        /**< Maximum angular rate while lying still, in °/s. */
+extern const int64_t fall_detector_still_duration_us;     /**< Stillness duration required to confirm a fall. */
+extern const int64_t fall_detector_post_impact_window_us; /**< Time after an impact during which a fall can be confirmed. */
+extern const float   fall_detector_orientation_deg;       /**< Minimum change of the gravity direction that confirms a fall, in degrees. */
+
+/* Enums **********************************************************************/
+
+/**
+ * @brief States of the fall detection state machine.
+ */
+typedef enum : uint8_t {
+  k_fall_detector_idle,        /**< Normal wear, tracking the resting gravity direction. */
+  k_fall_detector_free_fall,   /**< Acceleration magnitude dropped below the free-fall threshold. */
+  k_fall_detector_impact_wait, /**< Free fall ended, waiting for the impact. */
+  k_fall_detector_impact,      /**< Tracking the peak of an impact. */
+  k_fall_detector_post_impact, /**< Waiting for stillness to confirm or reject a fall. */
+} fall_detector_state_t;
+
+/**
+ * @brief Types of events raised by the fall detector.
+ *
+ * Values are sent to the server and must never be renumbered.
+ */
+typedef enum : uint8_t {
+  k_fall_detector_event_impact = 1, /**< An impact peak above `fall_detector_impact_g` ended. */
+  k_fall_detector_event_fall   = 2, /**< An impact was followed by stillness in a new orientation. */
+} fall_detector_event_type_t;
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Event raised by `fall_detector_update`.
+ */
+typedef struct {
+  fall_detector_event_type_t type;                   /**< Kind of event. */
+  int64_t                    timestamp_us;           /**< Time of the impact peak, in the sample time base. */
+  float                      peak_g;                 /**< Peak acceleration magnitude of the impact, in g. */
+  uint32_t                   free_fall_ms;           /**< Duration of the free fall preceding the impact (0 if none). */
+  float                      orientation_change_deg; /**< Angle between gravity before and after the event (fall events only). */
+} fall_detector_event_t;
+
+/**
+ * @brief State of one fall detector instance.
+ *
+ * Holds everything the detector needs between samples; no memory is
+ * allocated and each update runs in constant time.
+ */
+typedef struct {
+  fall_detector_state_t state;              /**< Current state of the state machine. */
+  float                 gravity[3];         /**< Low-pass estimate of the gravity direction while idle, in g. */
+  float                 reference[3];       /**< Gravity direction captured when the event started. */
+  int64_t               phase_start_us;     /**< Time the current state was entered. */
+  int64_t               free_fall_start_us; /**< Time the last free fall started. */
+  uint32_t              free_fall_ms;       /**< Duration of the last free fall. */
+  int64_t               peak_us;            /**< Time of the impact peak. */
+  float                 peak_g;             /**< Impact peak magnitude. */
+  int64_t               still_start_us;     /**< Start of the current stillness run. */
+  float                 still_sum[3];       /**< Sum of accelerations during the stillness run. */
+  uint32_t              still_count;        /**< Number of samples in the stillness run. */
+  bool                  gravity_valid;      /**< Whether `gravity` has been seeded. */
+} fall_detector_t;
+
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Resets a fall detector to the idle state.
+ *
+ * @param[out] detector Detector to initialize.
+ */
+void fall_detector_init(fall_detector_t *detector);
+
+/**
+ * @brief Feeds one IMU sample through the fall detector.
+ *
+ * Runs the state machine free fall -> impact -> post-impact stillness. An
+ * impact event is raised as soon as an impact peak ends (with or without a
+ * preceding free fall); a fall event follows once the wearer has been still
+ * for `fall_detector_still_duration_us` in an orientation that differs from
+ * the one before the event by at least `fall_detector_orientation_deg`.
+ *
+ * @param[in,out] detector     Detector state.
+ * @param[in]     timestamp_us Time of the sample in microseconds.
+ * @param[in]     accel_g      Acceleration X/Y/Z in g.
+ * @param[in]     gyro_dps     Angular rate X/Y/Z in °/s.
+ * @param[out]    event        Filled in when the function returns true.
+ *
+ * @return `true` if this sample raised an event, `false` otherwise.
+ *
+ * @note Samples must be fed in time order at a steady rate (100 Hz or more).
+ */
+bool fall_detector_update(fall_detector_t *detector, int64_t timestamp_us,
+                          const float accel_g[3], const float gyro_dps[3],
+                          fall_detector_event_t *event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFEHAT_WORKNET_FALL_DETECTOR_H */
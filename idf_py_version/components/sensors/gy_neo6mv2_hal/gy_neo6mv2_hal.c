@@ -8,11 +8,14 @@
 #include "esp_err.h"
 #include "file_write_manager.h"
 #include "webserver_tasks.h"
+#include "sensor_frame.h"
 #include "cJSON.h"
 #include "common/uart.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
 #include "error_handler.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 
 /* Constants *******************************************************************/
 
@@ -26,13 +29,41 @@ const uint8_t     gy_neo6mv2_max_retries            = 4;
 const uint32_t    gy_neo6mv2_initial_retry_interval = pdMS_TO_TICKS(15 * 1000);
 const uint32_t    gy_neo6mv2_max_backoff_interval   = pdMS_TO_TICKS(480 * 1000);
 const uint8_t     gy_neo6mv2_allowed_fail_attempts  = 3;
+const uint32_t    gy_neo6mv2_uart_rx_buffer_size    = 2 * 1024;
+const uint8_t     gy_neo6mv2_uart_queue_length      = 20;
+const uint32_t    gy_neo6mv2_parser_stack_depth     = 4096;
+const UBaseType_t gy_neo6mv2_parser_priority        = 5;
+const uint32_t    gy_neo6mv2_silence_timeout_ticks  = pdMS_TO_TICKS(3 * 1000);
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Latest navigation data decoded by the parser task.
+ *
+ * Written by the parser task as sentences arrive and copied out by
+ * `gy_neo6mv2_read`, both under `s_gy_neo6mv2_fix_lock`.
+ */
+typedef struct {
+  float      latitude;        /**< Latitude in decimal degrees, from RMC. */
+  float      longitude;       /**< Longitude in decimal degrees, from RMC. */
+  float      speed;           /**< Speed over ground, from RMC. */
+  char       time[11];        /**< UTC time of the last RMC sentence. */
+  uint8_t    fix_status;      /**< RMC status: 1 for a valid fix. */
+  uint8_t    satellite_count; /**< Satellites used in the solution, from GGA. */
+  float      hdop;            /**< Horizontal dilution of precision, from GGA. */
+  bool       updated;         /**< Set by each RMC sentence, cleared by `gy_neo6mv2_read`. */
+  TickType_t last_sentence;   /**< Tick of the last valid sentence of any type. */
+} gy_neo6mv2_fix_t;
 
 /* Globals (Static) ***********************************************************/
 
-static char        s_gy_neo6mv2_sentence_buffer[gy_neo6mv2_sentence_buffer_size]; /**< Buffer for assembling fragmented NMEA sentences received from the GPS module. */
-static uint32_t    s_gy_neo6mv2_sentence_index = 0;                               /**< Index tracking the current position in the sentence buffer. */
-static satellite_t s_gy_neo6mv2_satellites[gy_neo6mv2_max_satellites];            /**< Buffer to store parsed satellite information from GPGSV sentences. */
-static uint8_t     s_gy_neo6mv2_satellite_count = 0;                              /**< Counter for the number of satellites currently stored in the buffer. */
+static char             s_gy_neo6mv2_sentence_buffer[gy_neo6mv2_sentence_buffer_size]; /**< Sentence being parsed; owned by the parser task. */
+static satellite_t      s_gy_neo6mv2_satellites[gy_neo6mv2_max_satellites];            /**< Buffer to store parsed satellite information from GPGSV sentences. */
+static uint8_t          s_gy_neo6mv2_satellite_count = 0;                              /**< Counter for the number of satellites currently stored in the buffer. */
+static gy_neo6mv2_fix_t s_gy_neo6mv2_fix             = { 0 };                          /**< Latest decoded data, see `gy_neo6mv2_fix_t`. */
+static portMUX_TYPE     s_gy_neo6mv2_fix_lock        = portMUX_INITIALIZER_UNLOCKED;   /**< Guards `s_gy_neo6mv2_fix`. */
+static QueueHandle_t    s_gy_neo6mv2_uart_queue      = NULL;                           /**< UART driver events, one `UART_PATTERN_DET` per line. */
+static TaskHandle_t     s_gy_neo6mv2_parser_task     = NULL;                           /**< Parser task, created on the first init. */
 
 /* Static (Private) Functions *************************************************/
 
@@ -97,7 +128,9 @@ static bool priv_gy_neo6mv2_validate_nmea_checksum(const char *sentence)
  * @brief Splits an NMEA sentence into individual fields.
  *
  * Tokenizes an NMEA sentence using commas as delimiters and stores the extracted 
- * fields in the provided array. Unused fields are set to `NULL`.
+ * fields in the provided array. Empty fields stay in place as empty strings,
+ * so field numbers match the NMEA layout even without a fix. The checksum is
+ * cut off the last field. Unused fields are set to `NULL`.
  *
  * @param[in,out] sentence   Pointer to the NMEA sentence (modified in place).
  * @param[out]    fields     Array of pointers to store the extracted fields.
@@ -109,11 +142,19 @@ static void priv_gy_neo6mv2_split_nmea_sentence(char *sentence, char **fields, s
     return;
   }
 
+  char *checksum = strchr(sentence, '*');
+  if (checksum) {
+    *checksum = '\0';
+  }
+
   size_t index = 0;
-  char  *token = strtok(sentence, ",");
+  char  *token = sentence;
   while (token != NULL && index < max_fields) {
     fields[index++] = token;
-    token           = strtok(NULL, ",");
+    token           = strchr(token, ',');
+    if (token) {
+      *token++ = '\0';
+    }
   }
 
   for (; index < max_fields; index++) {
@@ -143,7 +184,7 @@ static void priv_gy_neo6mv2_add_satellite(uint8_t prn, uint8_t elevation, uint16
     sat->snr         = snr;
     s_gy_neo6mv2_satellite_count++;
 
-    ESP_LOGI(gy_neo6mv2_tag, "Satellite added: PRN=%d, Elevation=%d, Azimuth=%d, SNR=%d",
+    ESP_LOGD(gy_neo6mv2_tag, "Satellite added: PRN=%d, Elevation=%d, Azimuth=%d, SNR=%d",
              prn, elevation, azimuth, snr);
   } else {
     ESP_LOGW(gy_neo6mv2_tag, "Satellite buffer full, cannot add PRN=%d", prn);
@@ -160,28 +201,185 @@ static void priv_gy_neo6mv2_clear_satellites(void)
 {
   s_gy_neo6mv2_satellite_count = 0;
   memset(s_gy_neo6mv2_satellites, 0, sizeof(s_gy_neo6mv2_satellites));
-  ESP_LOGI(gy_neo6mv2_tag, "Satellite buffer cleared.");
+  ESP_LOGD(gy_neo6mv2_tag, "Satellite buffer cleared.");
 }
 
 /**
- * @brief Retrieves satellite data from the buffer.
+ * @brief Checks the sentence type, whatever the talker.
+ *
+ * Matches e.g. both `$GPRMC` and `$GNRMC` for "RMC", so receivers that
+ * combine several constellations are understood too.
+ *
+ * @param[in] sentence NMEA sentence.
+ * @param[in] type     Three-letter sentence type.
  *
- * Copies satellite data from the internal buffer into the provided output buffer 
- * for external processing.
+ * @return `true` if `sentence` is of type `type`.
+ */
+static bool priv_gy_neo6mv2_is_type(const char *sentence, const char *type)
+{
+  return sentence[0] == '$' && strlen(sentence) > 6 && strncmp(&sentence[3], type, 3) == 0;
+}
+
+/**
+ * @brief Parses one complete NMEA sentence and updates the latest fix.
+ *
+ * Understands RMC (position, speed, time and fix status), GGA (satellites
+ * used and HDOP) and GPGSV (satellites in view). Other sentences only count
+ * as a sign of life.
+ *
+ * @param[in,out] sentence Null-terminated sentence without line ending; split in place.
+ */
+static void priv_gy_neo6mv2_parse_sentence(char *sentence)
+{
+  ESP_LOGD(gy_neo6mv2_tag, "Raw NMEA sentence: %s", sentence);
+
+  /* Validate checksum */
+  if (!priv_gy_neo6mv2_validate_nmea_checksum(sentence)) {
+    ESP_LOGW(gy_neo6mv2_tag, "Invalid NMEA checksum: %s", sentence);
+    return;
+  }
+
+  TickType_t now = xTaskGetTickCount();
+  if (priv_gy_neo6mv2_is_type(sentence, "RMC")) {
+    char *fields[gy_neo6mv2_rmc_fields] = { 0 };
+    priv_gy_neo6mv2_split_nmea_sentence(sentence, fields, gy_neo6mv2_rmc_fields);
+
+    /* Process only valid readings; a truncated sentence has no position,
+     * and an empty coordinate would read as 0 degrees */
+    bool valid = fields[1] && fields[2] && fields[2][0] == 'A';
+    for (int i = 3; valid && i <= 6; i++) {
+      valid = fields[i] && fields[i][0] != '\0';
+    }
+
+    float latitude  = valid ? priv_gy_neo6mv2_parse_coordinate(fields[3], fields[4]) : 0.0;
+    float longitude = valid ? priv_gy_neo6mv2_parse_coordinate(fields[5], fields[6]) : 0.0;
+    float speed     = (valid && fields[7]) ? atof(fields[7]) : 0.0;
+
+    portENTER_CRITICAL(&s_gy_neo6mv2_fix_lock);
+    if (valid) {
+      s_gy_neo6mv2_fix.latitude  = latitude;
+      s_gy_neo6mv2_fix.longitude = longitude;
+      s_gy_neo6mv2_fix.speed     = speed;
+      strncpy(s_gy_neo6mv2_fix.time, fields[1], sizeof(s_gy_neo6mv2_fix.time) - 1);
+    }
+    s_gy_neo6mv2_fix.fix_status    = valid ? 1 : 0;
+    s_gy_neo6mv2_fix.updated       = true;
+    s_gy_neo6mv2_fix.last_sentence = now;
+    portEXIT_CRITICAL(&s_gy_neo6mv2_fix_lock);
+
+    if (valid) {
+      ESP_LOGD(gy_neo6mv2_tag, "Valid fix: Lat=%f, Lon=%f, Speed=%f", latitude, longitude, speed);
+    } else {
+      ESP_LOGD(gy_neo6mv2_tag, "RMC without a fix.");
+    }
+    return;
+  }
+
+  if (priv_gy_neo6mv2_is_type(sentence, "GGA")) {
+    char *fields[gy_neo6mv2_gga_fields] = { 0 };
+    priv_gy_neo6mv2_split_nmea_sentence(sentence, fields, gy_neo6mv2_gga_fields);
+
+    portENTER_CRITICAL(&s_gy_neo6mv2_fix_lock);
+    if (fields[7] && fields[7][0] != '\0') {
+      s_gy_neo6mv2_fix.satellite_count = (uint8_t)atoi(fields[7]);
+    }
+    if (fields[8] && fields[8][0] != '\0') {
+      s_gy_neo6mv2_fix.hdop = atof(fields[8]);
+    }
+    s_gy_neo6mv2_fix.last_sentence = now;
+    portEXIT_CRITICAL(&s_gy_neo6mv2_fix_lock);
+    return;
+  }
+
+  if (strncmp(sentence, "$GPGSV", 6) == 0) {
+    /* Parse GPGSV sentence for satellite information */
+    char *fields[gy_neo6mv2_gsv_fields] = { 0 };
+    priv_gy_neo6mv2_split_nmea_sentence(sentence, fields, gy_neo6mv2_gsv_fields);
+
+    uint8_t total_sentences  = fields[1] ? (uint8_t)atoi(fields[1]) : 0;
+    uint8_t sentence_number  = fields[2] ? (uint8_t)atoi(fields[2]) : 0;
+    uint8_t total_satellites = fields[3] ? (uint8_t)atoi(fields[3]) : 0;
+
+    ESP_LOGD(gy_neo6mv2_tag, "GPGSV: Sentence %u of %u, Total Satellites in view: %u",
+             sentence_number, total_sentences, total_satellites);
+
+    /* Clear satellite data if this is the first sentence */
+    if (sentence_number == 1) {
+      priv_gy_neo6mv2_clear_satellites();
+    }
+
+    /* Each GPGSV sentence has up to 4 satellites of 4 fields each, after the 4 header fields */
+    for (uint8_t i = 4; i + 3 < gy_neo6mv2_gsv_fields; i += 4) {
+      if (fields[i] && fields[i + 1] && fields[i + 2] && fields[i + 3]) {
+        uint8_t prn       = (uint8_t)atoi(fields[i]);      /* Satellite ID (PRN) */
+        uint8_t elevation = (uint8_t)atoi(fields[i + 1]);  /* Elevation in degrees */
+        uint16_t azimuth  = (uint16_t)atoi(fields[i + 2]); /* Azimuth in degrees */
+        uint8_t snr       = (uint8_t)atoi(fields[i + 3]);  /* SNR (Signal-to-Noise Ratio) */
+
+        /* Store satellite data */
+        priv_gy_neo6mv2_add_satellite(prn, elevation, azimuth, snr);
+      }
+    }
+  }
+
+  portENTER_CRITICAL(&s_gy_neo6mv2_fix_lock);
+  s_gy_neo6mv2_fix.last_sentence = now;
+  portEXIT_CRITICAL(&s_gy_neo6mv2_fix_lock);
+}
+
+/**
+ * @brief Task that parses NMEA sentences as the UART driver reports them.
  *
- * @param[out] satellites Pointer to the buffer where satellite data will be stored.
- * @param[in]  max_count  Maximum number of satellites to copy.
+ * The driver detects each '\n' and posts a `UART_PATTERN_DET` event, so the
+ * task sleeps until a whole sentence is buffered, reads exactly that
+ * sentence and parses it. Sentences are parsed at whatever rate the module
+ * sends them, independent of the sensor scheduler. On an RX overflow the
+ * buffered data is dropped and parsing resumes with the next complete line.
  *
- * @return The number of satellites copied into the output buffer.
+ * @param[in] param Unused.
  */
-static uint8_t priv_gy_neo6mv2_get_satellites(satellite_t *satellites, uint8_t max_count)
+static void priv_gy_neo6mv2_parser_task(void *param)
 {
-  uint8_t count = (s_gy_neo6mv2_satellite_count < max_count) ?
-                   s_gy_neo6mv2_satellite_count : max_count;
+  uart_event_t event;
 
-  memcpy(satellites, s_gy_neo6mv2_satellites, count * sizeof(satellite_t));
-  ESP_LOGI(gy_neo6mv2_tag, "Retrieved %d satellites from the buffer.", count);
-  return count;
+  while (1) {
+    if (xQueueReceive(s_gy_neo6mv2_uart_queue, &event, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+
+    switch (event.type) {
+      case UART_PATTERN_DET: {
+        int32_t   length = 0;
+        esp_err_t ret    = priv_uart_read_line((uint8_t *)s_gy_neo6mv2_sentence_buffer,
+                                               sizeof(s_gy_neo6mv2_sentence_buffer) - 1, &length,
+                                               gy_neo6mv2_uart_num, gy_neo6mv2_tag);
+        if (ret != ESP_OK) {
+          break;
+        }
+
+        /* Strip trailing \r and \n characters */
+        while (length > 0 && (s_gy_neo6mv2_sentence_buffer[length - 1] == '\r' ||
+                              s_gy_neo6mv2_sentence_buffer[length - 1] == '\n')) {
+          length--;
+        }
+        s_gy_neo6mv2_sentence_buffer[length] = '\0'; /* Null-terminate */
+        priv_gy_neo6mv2_parse_sentence(s_gy_neo6mv2_sentence_buffer);
+        break;
+      }
+
+      case UART_FIFO_OVF:
+      case UART_BUFFER_FULL:
+        /* The parser fell behind; restart from a clean buffer */
+        ESP_LOGW(gy_neo6mv2_tag, "UART RX overflow, dropping buffered NMEA data.");
+        uart_flush_input(gy_neo6mv2_uart_num);
+        xQueueReset(s_gy_neo6mv2_uart_queue);
+        break;
+
+      default:
+        /* Data without a line ending yet, or line errors the checksum catches */
+        break;
+    }
+  }
 }
 
 /* Public Functions ***********************************************************/
@@ -246,21 +444,38 @@ esp_err_t gy_neo6mv2_init(void *sensor_data)
                     gy_neo6mv2_initial_retry_interval,
                     gy_neo6mv2_max_backoff_interval);
 
-  /* Initialize UART */
-  esp_err_t ret = priv_uart_init(gy_neo6mv2_tx_io,
-                                gy_neo6mv2_rx_io,
-                                gy_neo6mv2_uart_baudrate,
-                                gy_neo6mv2_uart_num,
-                                gy_neo6mv2_tag);
-  if (ret != ESP_OK) {
-    ESP_LOGE(gy_neo6mv2_tag, "UART initialization failed");
-    return ret;
-  }
+  /* Clear the decoded data; silence is measured from now */
+  portENTER_CRITICAL(&s_gy_neo6mv2_fix_lock);
+  memset(&s_gy_neo6mv2_fix, 0, sizeof(s_gy_neo6mv2_fix));
+  s_gy_neo6mv2_fix.hdop          = 99.99;
+  s_gy_neo6mv2_fix.last_sentence = xTaskGetTickCount();
+  portEXIT_CRITICAL(&s_gy_neo6mv2_fix_lock);
+
+  /* The UART and the parser task survive a reset by the error handler;
+   * only the first init sets them up */
+  if (s_gy_neo6mv2_parser_task == NULL) {
+    esp_err_t ret = priv_uart_init_pattern(gy_neo6mv2_tx_io,
+                                           gy_neo6mv2_rx_io,
+                                           gy_neo6mv2_uart_baudrate,
+                                           gy_neo6mv2_uart_num,
+                                           gy_neo6mv2_uart_rx_buffer_size,
+                                           '\n',
+                                           gy_neo6mv2_uart_queue_length,
+                                           &s_gy_neo6mv2_uart_queue,
+                                           gy_neo6mv2_tag);
+    if (ret != ESP_OK) {
+      ESP_LOGE(gy_neo6mv2_tag, "UART initialization failed");
+      return ret;
+    }
 
-  /* Clear buffers */
-  s_gy_neo6mv2_sentence_index = 0;
-  memset(s_gy_neo6mv2_sentence_buffer, 0, sizeof(s_gy_neo6mv2_sentence_buffer));
-  priv_gy_neo6mv2_clear_satellites();
+    if (xTaskCreate(priv_gy_neo6mv2_parser_task, "gy_neo6mv2_nmea", gy_neo6mv2_parser_stack_depth,
+                    NULL, gy_neo6mv2_parser_priority, &s_gy_neo6mv2_parser_task) != pdPASS) {
+      ESP_LOGE(gy_neo6mv2_tag, "Failed to create NMEA parser task");
+      s_gy_neo6mv2_parser_task = NULL;
+      uart_driver_delete(gy_neo6mv2_uart_num);
+      return ESP_FAIL;
+    }
+  }
 
   gy_neo6mv2_data->state = k_gy_neo6mv2_ready;
   ESP_LOGI(gy_neo6mv2_tag, "GY-NEO6MV2 Configuration Complete");
@@ -269,150 +484,58 @@ esp_err_t gy_neo6mv2_init(void *sensor_data)
 
 esp_err_t gy_neo6mv2_read(gy_neo6mv2_data_t *sensor_data)
 {
-  uint8_t uart_rx_buffer[gy_neo6mv2_sentence_buffer_size];
-  int32_t length = 0;
-
-  /* Read from UART */
-  esp_err_t ret = priv_uart_read(uart_rx_buffer, sizeof(uart_rx_buffer),
-                                 &length, gy_neo6mv2_uart_num, gy_neo6mv2_tag);
-
-  if (ret == ESP_OK && length > 0) {
-    for (uint32_t i = 0; i < length; i++) {
-      char c = uart_rx_buffer[i];
-
-      /* Accumulate characters in the sentence buffer */
-      if (s_gy_neo6mv2_sentence_index < sizeof(s_gy_neo6mv2_sentence_buffer) - 1) {
-        s_gy_neo6mv2_sentence_buffer[s_gy_neo6mv2_sentence_index++] = c;
-      }
-
-      /* Process a complete sentence (ends with \n) */
-      if (c == '\n') {
-        s_gy_neo6mv2_sentence_buffer[s_gy_neo6mv2_sentence_index] = '\0'; /* Null-terminate */
-
-        /* Strip trailing \r and \n characters */
-        while (s_gy_neo6mv2_sentence_index > 0 &&
-            (s_gy_neo6mv2_sentence_buffer[s_gy_neo6mv2_sentence_index - 1] == '\r' ||
-             s_gy_neo6mv2_sentence_buffer[s_gy_neo6mv2_sentence_index - 1] == '\n')) {
-          s_gy_neo6mv2_sentence_buffer[--s_gy_neo6mv2_sentence_index] = '\0';
-        }
-
-        /* Log raw sentence */
-        ESP_LOGI(gy_neo6mv2_tag, "Raw NMEA sentence: %s", s_gy_neo6mv2_sentence_buffer);
-
-        /* Validate checksum */
-        if (!priv_gy_neo6mv2_validate_nmea_checksum(s_gy_neo6mv2_sentence_buffer)) {
-          ESP_LOGW(gy_neo6mv2_tag, "Invalid NMEA checksum: %s", s_gy_neo6mv2_sentence_buffer);
-          s_gy_neo6mv2_sentence_index = 0;
-          continue;
-        }
-
-        /* Parse specific sentences */
-        if (strstr(s_gy_neo6mv2_sentence_buffer, "$GPRMC") == s_gy_neo6mv2_sentence_buffer) {
-          /* Parse GPRMC sentence */
-          char *fields[12] = { 0 };
-          priv_gy_neo6mv2_split_nmea_sentence(s_gy_neo6mv2_sentence_buffer, fields, 12);
-
-          /* Extract and log status */
-          if (fields[2]) {
-            const char *status = fields[2];
-            ESP_LOGI(gy_neo6mv2_tag, "GPRMC Status: %s (%s)",
-                     status, (status[0] == 'A') ? "Fix acquired" : "No fix");
-
-            /* Process only valid readings */
-            if (status[0] == 'A') {
-              /* Extract latitude, longitude, and other data */
-              sensor_data->latitude  = priv_gy_neo6mv2_parse_coordinate(fields[3], fields[4]);
-              sensor_data->longitude = priv_gy_neo6mv2_parse_coordinate(fields[5], fields[6]);
-              sensor_data->speed     = fields[7] ? atof(fields[7]) : 0.0;
-
-              /* Update valid fix status */
-              sensor_data->fix_status = 1; /* Fix acquired */
-              strncpy(sensor_data->time, fields[1], sizeof(sensor_data->time) - 1);
-
-              ESP_LOGI(gy_neo6mv2_tag, "Valid fix: Lat=%f, Lon=%f, Speed=%f",
-                       sensor_data->latitude, sensor_data->longitude, 
-                       sensor_data->speed);
-            } else {
-              sensor_data->fix_status = 0; /* No fix */
-              ESP_LOGW(gy_neo6mv2_tag, "Skipping invalid GPS reading.");
-            }
-          }
-        } else if (strstr(s_gy_neo6mv2_sentence_buffer, "$GPGSV") == s_gy_neo6mv2_sentence_buffer) {
-          /* Parse GPGSV sentence for satellite information */
-          char *fields[20] = { 0 }; /* TODO: Move 20 to an enum or const */
-          priv_gy_neo6mv2_split_nmea_sentence(s_gy_neo6mv2_sentence_buffer, fields, 20); /* TODO: Move 20 to an enum or const */
-
-          uint8_t total_sentences  = fields[1] ? (uint8_t)atoi(fields[1]) : 0;
-          uint8_t sentence_number  = fields[2] ? (uint8_t)atoi(fields[2]) : 0;
-          uint8_t total_satellites = fields[3] ? (uint8_t)atoi(fields[3]) : 0;
-
-          ESP_LOGI(gy_neo6mv2_tag, "GPGSV: Sentence %u of %u, Total Satellites in view: %u",
-                   sentence_number, total_sentences, total_satellites);
-
-          /* Clear satellite data if this is the first sentence */
-          if (sentence_number == 1) {
-            priv_gy_neo6mv2_clear_satellites();
-          }
-
-          /* Parse satellite details (up to 4 satellites per GPGSV sentence) */
-          for (uint8_t i = 4; i < 20; i += 4) { /* TODO: Move 4 and 20 either into enum / const / add a comment */
-            if (fields[i] && fields[i + 1] && fields[i + 2] && fields[i + 3]) {
-              uint8_t prn       = (uint8_t)atoi(fields[i]);      /* Satellite ID (PRN) */
-              uint8_t elevation = (uint8_t)atoi(fields[i + 1]);  /* Elevation in degrees */
-              uint16_t azimuth  = (uint16_t)atoi(fields[i + 2]); /* Azimuth in degrees */
-              uint8_t snr       = (uint8_t)atoi(fields[i + 3]);  /* SNR (Signal-to-Noise Ratio) */
-
-              /* Store satellite data */
-              priv_gy_neo6mv2_add_satellite(prn, elevation, azimuth, snr);
-            }
-          }
-        }
-
-        /* Reset buffer for next sentence */
-        s_gy_neo6mv2_sentence_index = 0;
-      }
-    }
+  portENTER_CRITICAL(&s_gy_neo6mv2_fix_lock);
+  bool       updated       = s_gy_neo6mv2_fix.updated;
+  TickType_t last_sentence = s_gy_neo6mv2_fix.last_sentence;
+  if (updated) {
+    sensor_data->latitude   = s_gy_neo6mv2_fix.latitude;
+    sensor_data->longitude  = s_gy_neo6mv2_fix.longitude;
+    sensor_data->speed      = s_gy_neo6mv2_fix.speed;
+    sensor_data->fix_status = s_gy_neo6mv2_fix.fix_status;
+    memcpy(sensor_data->time, s_gy_neo6mv2_fix.time, sizeof(sensor_data->time));
+    s_gy_neo6mv2_fix.updated = false;
+  }
+  sensor_data->satellite_count = s_gy_neo6mv2_fix.satellite_count;
+  sensor_data->hdop            = s_gy_neo6mv2_fix.hdop;
+  portEXIT_CRITICAL(&s_gy_neo6mv2_fix_lock);
 
-    /* After processing sentences, retrieve satellite data */
-    satellite_t local_satellites[gy_neo6mv2_max_satellites];
-    uint8_t     satellite_count = priv_gy_neo6mv2_get_satellites(local_satellites, 
-                                                                 gy_neo6mv2_max_satellites);
+  if ((xTaskGetTickCount() - last_sentence) > gy_neo6mv2_silence_timeout_ticks) {
+    ESP_LOGE(gy_neo6mv2_tag, "Failed to read from GPS module");
+    sensor_data->state = k_gy_neo6mv2_error;
+    return ESP_FAIL;
+  }
 
-    /* Update sensor_data with satellite count */
-    sensor_data->satellite_count = satellite_count;
+  sensor_data->state = updated ? k_gy_neo6mv2_data_updated : k_gy_neo6mv2_ready;
+  return ESP_OK;
+}
 
-    /* Process satellite data as needed */
-    for (uint8_t i = 0; i < satellite_count; i++) {
-      ESP_LOGI(gy_neo6mv2_tag, "Retrieved Satellite PRN=%d, Elevation=%d, Azimuth=%d, SNR=%d",
-               local_satellites[i].prn, local_satellites[i].elevation,
-               local_satellites[i].azimuth, local_satellites[i].snr);
+void gy_neo6mv2_tick(void *sensor_data)
+{
+  gy_neo6mv2_data_t *gy_neo6mv2_data = (gy_neo6mv2_data_t *)sensor_data;
+  if (gy_neo6mv2_read(gy_neo6mv2_data) == ESP_OK) {
+    uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+    size_t  frame_len = 0;
+    /* Each RMC sentence is published once, however often the tick runs */
+    if (gy_neo6mv2_data->state == k_gy_neo6mv2_data_updated &&
+        sensor_frame_encode(k_sensor_frame_id_gy_neo6mv2, gy_neo6mv2_data, frame, sizeof(frame),
+                            &frame_len) == ESP_OK) {
+      webserver_enqueue_frame(frame, frame_len);
+      file_write_log_frame("gy_neo6mv2.tsl", frame, frame_len);
     }
-
-    return ESP_OK;
+    gy_neo6mv2_data->error_handler.fail_count = 0; /* Reset fail count on success */
   } else {
-    ESP_LOGE(gy_neo6mv2_tag, "Failed to read from GPS module");
-    sensor_data->state = k_gy_neo6mv2_error;
-    return ESP_FAIL;
+    gy_neo6mv2_data->error_handler.fail_count++;
+    error_handler_reset(&gy_neo6mv2_data->error_handler,
+                       gy_neo6mv2_data->error_handler.fail_count,
+                       gy_neo6mv2_init,
+                       gy_neo6mv2_data);
   }
 }
 
 void gy_neo6mv2_tasks(void *sensor_data)
 {
-  gy_neo6mv2_data_t *gy_neo6mv2_data = (gy_neo6mv2_data_t *)sensor_data;
   while (1) {
-    if (gy_neo6mv2_read(gy_neo6mv2_data) == ESP_OK) {
-      char *json = gy_neo6mv2_data_to_json(gy_neo6mv2_data);
-      send_sensor_data_to_webserver(json);
-      file_write_enqueue("gy_neo6mv2.txt", json);
-      free(json);
-      gy_neo6mv2_data->error_handler.fail_count = 0; /* Reset fail count on success */
-    } else {
-      gy_neo6mv2_data->error_handler.fail_count++;
-      error_handler_reset(&gy_neo6mv2_data->error_handler,
-                         gy_neo6mv2_data->error_handler.fail_count,
-                         gy_neo6mv2_init,
-                         gy_neo6mv2_data);
-    }
+    gy_neo6mv2_tick(sensor_data);
     vTaskDelay(gy_neo6mv2_polling_rate_ticks);
   }
 }
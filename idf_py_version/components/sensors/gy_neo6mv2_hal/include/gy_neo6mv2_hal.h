@@ -20,17 +20,25 @@ extern const char       *gy_neo6mv2_tag;                    /**< Logging tag for
 extern const uint8_t     gy_neo6mv2_tx_io;                  /**< GPIO pin for UART TX line to the GY-NEO6MV2 module. */
 extern const uint8_t     gy_neo6mv2_rx_io;                  /**< GPIO pin for UART RX line from the GY-NEO6MV2 module. */
 extern const uart_port_t gy_neo6mv2_uart_num;               /**< UART number used for GY-NEO6MV2 communication. */
-extern const uint32_t    gy_neo6mv2_uart_baudrate;          /**< UART baud rate for GY-NEO6MV2 communication (default 9600). */
+extern const uint32_t    gy_neo6mv2_uart_baudrate;          /**< UART baud rate for GY-NEO6MV2 communication (default 9600; raise it with the module's rate for 5-10 Hz output). */
 extern const uint32_t    gy_neo6mv2_polling_rate_ticks;     /**< Polling interval for GY-NEO6MV2 in system ticks. */
 extern const uint8_t     gy_neo6mv2_max_retries;            /**< Maximum retry attempts for GY-NEO6MV2 reinitialization. */
 extern const uint32_t    gy_neo6mv2_initial_retry_interval; /**< Initial retry interval for GY-NEO6MV2 in system ticks. */
 extern const uint32_t    gy_neo6mv2_max_backoff_interval;   /**< Maximum backoff interval for GY-NEO6MV2 retries in ticks. */
 extern const uint8_t     gy_neo6mv2_allowed_fail_attempts;  /**< Number of allowed consecutive failures before reset. */
+extern const uint32_t    gy_neo6mv2_uart_rx_buffer_size;    /**< Size of the UART driver's RX ring buffer in bytes. */
+extern const uint8_t     gy_neo6mv2_uart_queue_length;      /**< Length of the UART event queue and of the line position queue. */
+extern const uint32_t    gy_neo6mv2_parser_stack_depth;     /**< Stack depth of the NMEA parser task. */
+extern const UBaseType_t gy_neo6mv2_parser_priority;        /**< Priority of the NMEA parser task. */
+extern const uint32_t    gy_neo6mv2_silence_timeout_ticks;  /**< Time without a valid sentence after which a read fails. */
 
 /* Macros *********************************************************************/
 
 #define gy_neo6mv2_sentence_buffer_size (128) /**< Maximum buffer size for NMEA sentences from the GY-NEO6MV2 module. */
 #define gy_neo6mv2_max_satellites       (32)  /**< Maximum number of satellites' data to store in the buffer. */
+#define gy_neo6mv2_rmc_fields           (13)  /**< Fields of an RMC sentence, including the sentence type. */
+#define gy_neo6mv2_gga_fields           (15)  /**< Fields of a GGA sentence, including the sentence type. */
+#define gy_neo6mv2_gsv_fields           (20)  /**< Fields of a GPGSV sentence: 4 header fields and 4 per satellite for up to 4 satellites. */
 
 /* Enums **********************************************************************/
 
@@ -101,7 +109,10 @@ char *gy_neo6mv2_data_to_json(const gy_neo6mv2_data_t *data);
  * @brief Initializes the GY-NEO6MV2 GPS module over UART.
  *
  * Sets up the UART connection for communication with the GY-NEO6MV2 GPS module and 
- * prepares the `gy_neo6mv2_data_t` structure for receiving GPS data.
+ * prepares the `gy_neo6mv2_data_t` structure for receiving GPS data. The first
+ * call also starts the NMEA parser task, which the UART driver wakes for each
+ * complete sentence. Later calls, e.g. from the error handler, only reset the
+ * decoded data.
  *
  * @param[in,out] sensor_data Pointer to the `gy_neo6mv2_data_t` structure to initialize.
  *
@@ -116,21 +127,37 @@ esp_err_t gy_neo6mv2_init(void *sensor_data);
 /**
  * @brief Reads GPS data from the GY-NEO6MV2 GPS module.
  *
- * Processes NMEA sentences received over UART and updates the `gy_neo6mv2_data_t` 
- * structure with the latest GPS information.
+ * Copies the latest data decoded by the parser task into the `gy_neo6mv2_data_t` 
+ * structure. Does not wait: the state is `k_gy_neo6mv2_data_updated` if an RMC
+ * sentence arrived since the previous read, and `k_gy_neo6mv2_ready` otherwise.
  *
  * @param[in,out] sensor_data Pointer to the `gy_neo6mv2_data_t` structure to 
  *                            store the latest GPS data.
  *
  * @return 
  * - `ESP_OK`   on successful read.
- * - `ESP_FAIL` on unsuccessful read.
+ * - `ESP_FAIL` if no valid sentence arrived within `gy_neo6mv2_silence_timeout_ticks`.
  *
  * @note Ensure the GPS module is initialized with `gy_neo6mv2_init` before 
  *       calling this function.
  */
 esp_err_t gy_neo6mv2_read(gy_neo6mv2_data_t *sensor_data);
 
+/**
+ * @brief Runs one acquisition cycle of the GY-NEO6MV2.
+ *
+ * Publishes the latest fix if a new RMC sentence arrived since the last tick,
+ * and handles a silent module through the error handler. Never blocks, so it
+ * can share a scheduler worker with other sensors; run it at the module's
+ * output rate to publish every fix.
+ *
+ * @param[in,out] sensor_data Pointer to the `gy_neo6mv2_data_t` structure for
+ *                            GPS data and error management.
+ *
+ * @note Called periodically by the sensor scheduler, or in a loop by `gy_neo6mv2_tasks`.
+ */
+void gy_neo6mv2_tick(void *sensor_data);
+
 /**
  * @brief Periodically reads GPS data and manages errors for the GY-NEO6MV2 GPS module.
  *
@@ -8,6 +8,8 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "driver/i2c.h"
@@ -29,6 +31,18 @@ extern const uint8_t    mpu6050_max_retries;        /**< Maximum retry attempts
 extern const uint32_t   mpu6050_initial_retry_interval; /**< Initial retry interval for MPU6050 in system ticks. */
 extern const uint32_t   mpu6050_max_backoff_interval;   /**< Maximum backoff interval for MPU6050 retries in ticks. */
 extern const uint8_t    mpu6050_allowed_fail_attempts;  /**< Number of allowed consecutive failures before reset. */
+extern const bool       mpu6050_fifo_enabled;           /**< Acquire samples through the on-chip FIFO instead of polling the data registers. */
+extern const uint8_t    mpu6050_fifo_sample_rate_div;   /**< Sample rate divider in FIFO mode (1 kHz / (1 + div), 4 gives 200 Hz). */
+extern const uint8_t    mpu6050_fifo_burst_samples;     /**< Number of data-ready interrupts to accumulate before draining the FIFO. */
+extern const uint32_t   mpu6050_fifo_timeout_ticks;     /**< Longest wait for the drain signal before draining anyway (missed interrupt guard). */
+extern const uint32_t   mpu6050_tick_period_ticks;      /**< Scheduling period of `mpu6050_tick`; bounded by the FIFO capacity at the FIFO sample rate. */
+extern const uint32_t   mpu6050_max_tick_period_ticks;  /**< Longest `mpu6050_tick` period that drains the FIFO before it fills (73 samples, 365 ms at 200 Hz). */
+
+/* Macros *********************************************************************/
+
+#define MPU6050_FIFO_SIZE        (1024) /**< Size of the MPU6050 on-chip FIFO in bytes. */
+#define MPU6050_SAMPLE_SIZE      (14)   /**< Bytes per sample: accel X/Y/Z, temperature, gyro X/Y/Z, big-endian. */
+#define MPU6050_SAMPLE_RING_SIZE (256)  /**< Number of timestamped samples kept for consumers (~1.3 s at 200 Hz). */
 
 /* Enums **********************************************************************/
 
@@ -126,6 +140,12 @@ typedef enum : uint8_t {
   k_mpu6050_int_enable_cmd      = 0x38, /**< Interrupt Enable register. */
   k_mpu6050_int_status_cmd      = 0x3A, /**< Interrupt Status register. */
 
+  /* FIFO Configuration Commands */
+  k_mpu6050_user_ctrl_cmd       = 0x6A, /**< User Control register (FIFO enable and reset). */
+  k_mpu6050_user_ctrl_fifo_en   = 0x40, /**< USER_CTRL bit enabling the FIFO. */
+  k_mpu6050_user_ctrl_fifo_rst  = 0x04, /**< USER_CTRL bit resetting the FIFO (self-clearing). */
+  k_mpu6050_fifo_en_all_sensors = 0xF8, /**< FIFO_EN bits for temperature, gyroscope X/Y/Z and accelerometer. */
+
   /* Configuration Values */
   k_mpu6050_who_am_i_response   = 0x68, /**< Expected response from the WHO_AM_I register. */
   k_mpu6050_config_dlpf_260hz   = 0x00, /**< DLPF: 260Hz bandwidth, 0ms delay. */
@@ -158,12 +178,14 @@ typedef enum : uint8_t {
   k_mpu6050_gyro_zout_h_cmd     = 0x47, /**< Gyroscope Z-axis High byte. */
   k_mpu6050_gyro_zout_l_cmd     = 0x48, /**< Gyroscope Z-axis Low byte. */
 
-  /* Unused or Optional Commands */
-  k_mpu6050_pwr_mgmt_2_cmd      = 0x6C, /**< Power Management 2 register. */
+  /* FIFO Data Commands */
   k_mpu6050_fifo_en_cmd         = 0x23, /**< FIFO Enable register. */
   k_mpu6050_fifo_count_h_cmd    = 0x72, /**< FIFO Count High byte. */
   k_mpu6050_fifo_count_l_cmd    = 0x73, /**< FIFO Count Low byte. */
   k_mpu6050_fifo_r_w_cmd        = 0x74, /**< FIFO Read/Write register. */
+
+  /* Unused or Optional Commands */
+  k_mpu6050_pwr_mgmt_2_cmd      = 0x6C, /**< Power Management 2 register. */
   k_mpu6050_temp_out_h_cmd      = 0x41, /**< Temperature High byte. */
   k_mpu6050_temp_out_l_cmd      = 0x42, /**< Temperature Low byte. */
 
@@ -206,6 +228,25 @@ typedef struct {
   float   gyro_scale;  /**< Scaling factor to convert raw data to angular velocity in °/s. */
 } mpu6050_gyro_config_t;
 
+/**
+ * @brief A single timestamped sample of all seven MPU6050 channels.
+ *
+ * All channels of a sample come from the same sensor update. In FIFO mode,
+ * timestamps are reconstructed from the drain time and the configured sample
+ * period, so consecutive samples are spaced evenly even though they are read
+ * from the sensor in bursts.
+ */
+typedef struct {
+  int64_t timestamp_us; /**< Time of the sample in microseconds since boot (`esp_timer_get_time`). */
+  float   accel_x;      /**< X-axis acceleration in g. */
+  float   accel_y;      /**< Y-axis acceleration in g. */
+  float   accel_z;      /**< Z-axis acceleration in g. */
+  float   gyro_x;       /**< X-axis angular velocity in °/s. */
+  float   gyro_y;       /**< Y-axis angular velocity in °/s. */
+  float   gyro_z;       /**< Z-axis angular velocity in °/s. */
+  float   temperature;  /**< Die temperature in degrees Celsius. */
+} mpu6050_sample_t;
+
 /**
  * @brief Structure to store MPU6050 sensor data and state.
  *
@@ -222,8 +263,12 @@ typedef struct {
   float             gyro_y;         /**< Measured Y-axis angular velocity in °/s. */
   float             gyro_z;         /**< Measured Z-axis angular velocity in °/s. */
   float             temperature;    /**< Measured temperature from the sensor in degrees Celsius. */
+  int64_t           timestamp_us;   /**< Time of the latest sample in microseconds since boot. */
   uint8_t           state;          /**< Current operational state of the sensor (see `mpu6050_states_t`). */
-  SemaphoreHandle_t data_ready_sem; /**< Semaphore to signal when new data is available. */
+  SemaphoreHandle_t data_ready_sem; /**< Semaphore to signal when new data is available; created by `mpu6050_tasks`. */
+  uint32_t          fifo_drains;    /**< Number of FIFO burst reads performed. */
+  uint32_t          fifo_samples;   /**< Number of samples read from the FIFO. */
+  uint32_t          fifo_overflows; /**< Number of times the FIFO overflowed and was reset. */
   error_handler_t   error_handler;  /**< Error handler for managing sensor errors and recovery. */
 } mpu6050_data_t;
 
@@ -265,10 +310,13 @@ char *mpu6050_data_to_json(const mpu6050_data_t *data);
 esp_err_t mpu6050_init(void *sensor_data);
 
 /**
- * @brief Reads accelerometer and gyroscope data from the MPU6050 sensor.
+ * @brief Reads accelerometer, temperature and gyroscope data from the MPU6050 sensor.
  *
- * Retrieves the latest measurements from the MPU6050 sensor and updates the 
- * `mpu6050_data_t` structure with the new data.
+ * Reads all 14 data bytes (ACCEL_XOUT_H through GYRO_ZOUT_L) in a single I2C
+ * burst, so every channel comes from the same sensor update, stores the
+ * timestamped sample in the `mpu6050_data_t` structure and appends it to the
+ * sample ring. The I2C command link for the burst is built once by
+ * `mpu6050_init` and reused on every read.
  *
  * @param[in,out] sensor_data Pointer to the `mpu6050_data_t` structure to store
  *                            the sensor data and read status.
@@ -282,17 +330,80 @@ esp_err_t mpu6050_init(void *sensor_data);
  */
 esp_err_t mpu6050_read(mpu6050_data_t *sensor_data);
 
+/**
+ * @brief Drains the MPU6050 FIFO in a single I2C burst.
+ *
+ * Reads the FIFO byte count, then reads every complete sample in one burst
+ * from the FIFO data register. Each sample is converted to physical units,
+ * timestamped and pushed into the sample ring buffer; the newest sample is
+ * also copied into `sensor_data`. If the FIFO overflowed, it is reset and the
+ * samples it held are discarded.
+ *
+ * @param[in,out] sensor_data Pointer to the `mpu6050_data_t` structure to update.
+ *
+ * @return
+ * - `ESP_OK`   if the FIFO was drained (possibly with zero samples).
+ * - `ESP_FAIL` on an I2C error.
+ *
+ * @note Only valid when `mpu6050_fifo_enabled` is true.
+ */
+esp_err_t mpu6050_fifo_drain(mpu6050_data_t *sensor_data);
+
+/**
+ * @brief Copies samples from the sample ring buffer without removing them.
+ *
+ * Every reader keeps its own cursor, so readers do not take samples away
+ * from each other or from the fall detector. Copies the samples from
+ * `*cursor` on, oldest first, and advances `*cursor` past them.
+ *
+ * @param[in,out] cursor      Position of the reader. Start from
+ *                            `mpu6050_samples_cursor()` for new samples only.
+ * @param[out]    samples     Array receiving the samples, oldest first.
+ * @param[in]     max_samples Capacity of `samples`.
+ *
+ * @return Number of samples copied.
+ *
+ * @note The ring keeps the newest `MPU6050_SAMPLE_RING_SIZE` samples. A
+ *       reader that falls further behind continues from the oldest one kept.
+ */
+size_t mpu6050_copy_samples(uint32_t *cursor, mpu6050_sample_t *samples, size_t max_samples);
+
+/**
+ * @brief Returns the cursor of the next sample to be stored in the ring.
+ *
+ * @return Cursor for `mpu6050_copy_samples` that skips every sample stored so far.
+ */
+uint32_t mpu6050_samples_cursor(void);
+
+/**
+ * @brief Runs one acquisition cycle of the MPU6050.
+ *
+ * Drains the FIFO (or, without FIFO mode, reads the data registers once),
+ * feeds every new sample through the fall detector, and publishes the newest
+ * sample once every `mpu6050_polling_rate_ticks`. Impact or fall events are
+ * raised at once through the uplink alert queue. Errors are handled by the
+ * error handler for recovery.
+ *
+ * @param[in,out] sensor_data Pointer to the `mpu6050_data_t` structure for managing
+ *                            sensor data and error recovery.
+ *
+ * @note Call every `mpu6050_tick_period_ticks` so the FIFO never overflows.
+ */
+void mpu6050_tick(void *sensor_data);
+
 /**
  * @brief Executes periodic tasks for the MPU6050 sensor.
  *
- * Periodically reads data and handles errors for the MPU6050 sensor using
- * the error handler for recovery. Intended to run in a FreeRTOS task.
+ * Runs `mpu6050_tick` in a loop. In FIFO mode it enables the data-ready
+ * interrupt, and each cycle waits for it to signal that a burst of samples
+ * is queued in the sensor; otherwise it waits `mpu6050_tick_period_ticks`.
+ * Intended to run in a dedicated FreeRTOS task when the sensor scheduler is
+ * not used. Under the scheduler the interrupt stays disabled.
  *
  * @param[in,out] sensor_data Pointer to the `mpu6050_data_t` structure for managing
  *                            sensor data and error recovery.
  *
  * @note 
- * - Should run at intervals defined by `mpu6050_polling_rate_ticks`.
  * - Uses error_handler_t for error recovery to maintain stable operation.
  */
 void mpu6050_tasks(void *sensor_data);
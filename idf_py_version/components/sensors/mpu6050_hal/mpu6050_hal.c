@@ -5,9 +5,14 @@
 #include "mpu6050_hal.h"
 #include "file_write_manager.h"
 #include "webserver_tasks.h"
+#include "sensor_frame.h"
+#include "fall_detector.h"
+#include <stdio.h>
+#include <string.h>
 #include "cJSON.h"
-#include "common/i2c.h"
+#include "common/i2c_bus.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "error_handler.h"
 
@@ -27,6 +32,12 @@ const uint8_t    mpu6050_max_retries            = 4;
 const uint32_t   mpu6050_initial_retry_interval = pdMS_TO_TICKS(15 * 1000);
 const uint32_t   mpu6050_max_backoff_interval   = pdMS_TO_TICKS(480 * 1000);
 const uint8_t    mpu6050_allowed_fail_attempts  = 3;
+const bool       mpu6050_fifo_enabled           = true;
+const uint8_t    mpu6050_fifo_sample_rate_div   = 4;
+const uint8_t    mpu6050_fifo_burst_samples     = 20;
+const uint32_t   mpu6050_fifo_timeout_ticks     = pdMS_TO_TICKS(500);
+const uint32_t   mpu6050_tick_period_ticks      = pdMS_TO_TICKS(100);
+const uint32_t   mpu6050_max_tick_period_ticks  = pdMS_TO_TICKS(250);
 
 /**
  * @brief Static constant array of accelerometer configurations and scaling factors.
@@ -85,6 +96,22 @@ static const mpu6050_gyro_config_t mpu6050_gyro_configs[] = {
 static const uint8_t mpu6050_gyro_config_idx  = 3; /**< Index of chosen values from above (0: ±250°/s, 1: ±500°/s, etc.) */
 static const uint8_t mpu6050_accel_config_idx = 3; /**< Index of chosen values from above (0: ±2g, 1: ±4g, etc.) */
 
+/* Globals (Static) ***********************************************************/
+
+static volatile uint8_t  s_mpu6050_pending_samples = 0;                            /**< Data-ready interrupts since the last drain signal */
+static bool              s_mpu6050_use_interrupt   = false;                        /**< Set by `mpu6050_tasks`; the scheduler polls `mpu6050_tick` instead */
+static uint32_t          s_mpu6050_samples_total   = 0;                            /**< Number of samples ever pushed; sample `n` is at `n % MPU6050_SAMPLE_RING_SIZE` */
+static uint32_t          s_mpu6050_detector_cursor = 0;                            /**< Next sample for the fall detector */
+static portMUX_TYPE      s_mpu6050_samples_lock    = portMUX_INITIALIZER_UNLOCKED; /**< Guards the sample ring */
+static uint8_t           s_mpu6050_fifo_buffer[MPU6050_FIFO_SIZE];                 /**< Burst read buffer for the FIFO contents */
+static mpu6050_sample_t  s_mpu6050_samples[MPU6050_SAMPLE_RING_SIZE];              /**< Ring buffer of timestamped samples */
+static fall_detector_t   s_mpu6050_fall_detector;                                  /**< Fall detector fed from the sample ring */
+static uint8_t           s_mpu6050_burst_data[MPU6050_SAMPLE_SIZE];                /**< Destination of the prebuilt burst read */
+static i2c_transaction_t s_mpu6050_burst;                                          /**< Prebuilt transaction reading all seven channels */
+static bool              s_mpu6050_burst_ready     = false;                        /**< Whether `s_mpu6050_burst` has been built */
+static i2c_bus_device_t  s_mpu6050_i2c_device;                                     /**< Handle of the MPU6050 on the shared I2C bus */
+static TickType_t        s_mpu6050_last_publish    = 0;                            /**< Tick of the last published reading */
+
 /* Static (Private) Functions **************************************************/
 
 /**
@@ -92,7 +119,9 @@ static const uint8_t mpu6050_accel_config_idx = 3; /**< Index of chosen values f
  *
  * This function is called when the MPU6050 asserts its INT pin, indicating that new data
  * is ready to be read. It gives the `data_ready_sem` semaphore to unblock the task waiting
- * to read the data.
+ * to read the data. In FIFO mode the semaphore is only given every
+ * `mpu6050_fifo_burst_samples` interrupts, so the task wakes once per burst.
+ * Installed only for `mpu6050_tasks`.
  *
  * @param[in] arg Pointer to the `mpu6050_data_t` structure.
  *
@@ -104,6 +133,11 @@ static void IRAM_ATTR priv_mpu6050_interrupt_handler(void *arg)
   mpu6050_data_t *sensor_data              = (mpu6050_data_t *)arg;
   BaseType_t      xHigherPriorityTaskWoken = pdFALSE;
 
+  if (mpu6050_fifo_enabled && ++s_mpu6050_pending_samples < mpu6050_fifo_burst_samples) {
+    return;
+  }
+  s_mpu6050_pending_samples = 0;
+
   /* Give the semaphore to signal that data is ready */
   xSemaphoreGiveFromISR(sensor_data->data_ready_sem, &xHigherPriorityTaskWoken);
 
@@ -112,6 +146,268 @@ static void IRAM_ATTR priv_mpu6050_interrupt_handler(void *arg)
   }
 }
 
+/**
+ * @brief Routes the data-ready interrupt to `data_ready_sem`.
+ *
+ * Creates the semaphore, installs the GPIO interrupt handler and enables the
+ * data-ready interrupt in the sensor. Only `mpu6050_tasks` waits on the
+ * interrupt; under the sensor scheduler it stays disabled, so the sensor
+ * does not interrupt the CPU at the sample rate for nothing.
+ *
+ * @param[in] sensor_data Pointer to the `mpu6050_data_t` structure.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - Relevant `esp_err_t` code on failure.
+ */
+static esp_err_t priv_mpu6050_enable_interrupt(mpu6050_data_t *sensor_data)
+{
+  /* Create the data ready semaphore (kept across re-initialization) */
+  if (sensor_data->data_ready_sem == NULL) {
+    sensor_data->data_ready_sem = xSemaphoreCreateBinary();
+  }
+  if (sensor_data->data_ready_sem == NULL) {
+    ESP_LOGE(mpu6050_tag, "Failed to create data ready semaphore");
+    return ESP_FAIL;
+  }
+
+  /* Configure GPIO for interrupt */
+  gpio_config_t io_conf = {
+    .pin_bit_mask = (1ULL << mpu6050_int_io),
+    .mode         = GPIO_MODE_INPUT,
+    .pull_up_en   = GPIO_PULLUP_ENABLE,
+    .pull_down_en = GPIO_PULLDOWN_DISABLE,
+    .intr_type    = GPIO_INTR_POSEDGE,
+  };
+
+  esp_err_t ret = gpio_config(&io_conf);
+  if (ret != ESP_OK) {
+    ESP_LOGE(mpu6050_tag, "GPIO configuration failed");
+    return ret;
+  }
+
+  /* Install GPIO ISR service and add ISR handler */
+  ret = gpio_install_isr_service(0);
+  if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+    ESP_LOGE(mpu6050_tag, "GPIO ISR service installation failed");
+    return ret;
+  }
+
+  ret = gpio_isr_handler_add(mpu6050_int_io, priv_mpu6050_interrupt_handler, sensor_data);
+  if (ret != ESP_OK) {
+    ESP_LOGE(mpu6050_tag, "GPIO ISR handler addition failed");
+    return ret;
+  }
+
+  /* Enable data ready interrupt */
+  s_mpu6050_pending_samples = 0;
+  ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_int_enable_cmd,
+                               k_mpu6050_int_enable_data_rdy);
+  if (ret != ESP_OK) {
+    ESP_LOGE(mpu6050_tag, "MPU6050 interrupt enable failed");
+  }
+  return ret;
+}
+
+/**
+ * @brief Stops, clears and restarts the MPU6050 FIFO.
+ *
+ * Disables FIFO writes, resets the FIFO to drop any partial sample, then
+ * re-enables writes of all seven channels so the stream restarts on a sample
+ * boundary.
+ *
+ * @param[in] sensor_data Pointer to the `mpu6050_data_t` structure.
+ *
+ * @return
+ * - `ESP_OK` on success.
+ * - Relevant `esp_err_t` code on I2C failure.
+ */
+static esp_err_t priv_mpu6050_fifo_reset(mpu6050_data_t *sensor_data)
+{
+  esp_err_t ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_fifo_en_cmd, 0x00);
+  if (ret == ESP_OK) {
+    ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_user_ctrl_cmd,
+                                 k_mpu6050_user_ctrl_fifo_rst);
+  }
+  if (ret == ESP_OK) {
+    ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_user_ctrl_cmd,
+                                 k_mpu6050_user_ctrl_fifo_en);
+  }
+  if (ret == ESP_OK) {
+    ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_fifo_en_cmd,
+                                 k_mpu6050_fifo_en_all_sensors);
+  }
+  s_mpu6050_pending_samples = 0;
+  return ret;
+}
+
+/**
+ * @brief Builds the transaction for the 14-byte data burst, once.
+ *
+ * The transaction reads the 14 data registers starting at ACCEL_XOUT_H into
+ * `s_mpu6050_burst_data`. It is reused by every `mpu6050_read`, so reads
+ * neither allocate nor rebuild the command list.
+ *
+ * @param[in] i2c_bus     I2C bus number.
+ * @param[in] i2c_address I2C address of the sensor.
+ *
+ * @return
+ * - `ESP_OK` on success (or if the transaction already exists).
+ * - Relevant `esp_err_t` error codes on failure.
+ */
+static esp_err_t priv_mpu6050_build_burst(i2c_port_t i2c_bus, uint8_t i2c_address)
+{
+  if (s_mpu6050_burst_ready) {
+    return ESP_OK;
+  }
+
+  esp_err_t ret = i2c_transaction_init(&s_mpu6050_burst, i2c_bus, mpu6050_tag);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  ret = i2c_transaction_add_read_reg(&s_mpu6050_burst, i2c_address, k_mpu6050_accel_xout_h_cmd,
+                                     s_mpu6050_burst_data, MPU6050_SAMPLE_SIZE);
+  if (ret != ESP_OK) {
+    i2c_transaction_deinit(&s_mpu6050_burst);
+    return ret;
+  }
+
+  s_mpu6050_burst_ready = true;
+  return ESP_OK;
+}
+
+/**
+ * @brief Converts one 14-byte register/FIFO sample to physical units.
+ *
+ * @param[in]  raw          Big-endian accel X/Y/Z, temperature, gyro X/Y/Z.
+ * @param[in]  timestamp_us Time to stamp the sample with.
+ * @param[out] sample       Converted sample.
+ */
+static void priv_mpu6050_parse_sample(const uint8_t *raw, int64_t timestamp_us,
+                                      mpu6050_sample_t *sample)
+{
+  float accel_sensitivity = mpu6050_accel_configs[mpu6050_accel_config_idx].accel_scale;
+  float gyro_sensitivity  = mpu6050_gyro_configs[mpu6050_gyro_config_idx].gyro_scale;
+
+  sample->timestamp_us = timestamp_us;
+  sample->accel_x      = (int16_t)((raw[0] << 8) | raw[1]) / accel_sensitivity;
+  sample->accel_y      = (int16_t)((raw[2] << 8) | raw[3]) / accel_sensitivity;
+  sample->accel_z      = (int16_t)((raw[4] << 8) | raw[5]) / accel_sensitivity;
+  sample->temperature  = (int16_t)((raw[6] << 8) | raw[7]) / 340.0f + 36.53f; /* Datasheet formula */
+  sample->gyro_x       = (int16_t)((raw[8] << 8) | raw[9]) / gyro_sensitivity;
+  sample->gyro_y       = (int16_t)((raw[10] << 8) | raw[11]) / gyro_sensitivity;
+  sample->gyro_z       = (int16_t)((raw[12] << 8) | raw[13]) / gyro_sensitivity;
+}
+
+/**
+ * @brief Copies a sample into the latest-reading fields of `sensor_data`.
+ *
+ * @param[out] sensor_data Pointer to the `mpu6050_data_t` structure to update.
+ * @param[in]  sample      Sample to copy.
+ */
+static void priv_mpu6050_store_latest(mpu6050_data_t *sensor_data, const mpu6050_sample_t *sample)
+{
+  sensor_data->timestamp_us = sample->timestamp_us;
+  sensor_data->accel_x      = sample->accel_x;
+  sensor_data->accel_y      = sample->accel_y;
+  sensor_data->accel_z      = sample->accel_z;
+  sensor_data->gyro_x       = sample->gyro_x;
+  sensor_data->gyro_y       = sample->gyro_y;
+  sensor_data->gyro_z       = sample->gyro_z;
+  sensor_data->temperature  = sample->temperature;
+}
+
+/**
+ * @brief Appends a sample to the ring buffer, overwriting the oldest when full.
+ *
+ * Consumers read the ring through their own cursor, so nothing is removed
+ * by reading; samples only leave the ring when newer ones overwrite them.
+ *
+ * @param[in] sample Sample to store.
+ */
+static void priv_mpu6050_push_sample(const mpu6050_sample_t *sample)
+{
+  taskENTER_CRITICAL(&s_mpu6050_samples_lock);
+  s_mpu6050_samples[s_mpu6050_samples_total % MPU6050_SAMPLE_RING_SIZE] = *sample;
+  s_mpu6050_samples_total++;
+  taskEXIT_CRITICAL(&s_mpu6050_samples_lock);
+}
+
+/**
+ * @brief Publishes the latest reading to the web server and the SD card log.
+ *
+ * @param[in] sensor_data Pointer to the `mpu6050_data_t` structure with the reading.
+ */
+static void priv_mpu6050_publish(mpu6050_data_t *sensor_data)
+{
+  uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+  size_t  frame_len = 0;
+  if (sensor_frame_encode(k_sensor_frame_id_mpu6050, sensor_data, frame, sizeof(frame),
+                          &frame_len) == ESP_OK) {
+    webserver_enqueue_frame(frame, frame_len);
+    file_write_log_frame("mpu6050.tsl", frame, frame_len);
+  }
+}
+
+/**
+ * @brief Raises a fall detector event as a prioritized alert.
+ *
+ * Sends the event through the uplink alert queue, which bypasses batching,
+ * and records it in `alerts.txt` on the SD card.
+ *
+ * @param[in] event Event raised by the fall detector.
+ */
+static void priv_mpu6050_raise_alert(const fall_detector_event_t *event)
+{
+  const char *type = (event->type == k_fall_detector_event_fall) ? "fall" : "impact";
+  ESP_LOGW(mpu6050_tag, "Alert: %s (peak %.2f g, free fall %lu ms, orientation change %.0f deg)",
+           type, event->peak_g, event->free_fall_ms, event->orientation_change_deg);
+
+  uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+  size_t  frame_len = 0;
+  if (sensor_frame_encode(k_sensor_frame_id_fall_alert, event, frame, sizeof(frame),
+                          &frame_len) == ESP_OK) {
+    webserver_enqueue_alert(frame, frame_len);
+  }
+
+  /* Format straight into the SD card log's ring buffer */
+  file_write_reservation_t record;
+  if (file_write_reserve("alerts.txt", 160, &record) == ESP_OK) {
+    snprintf(record.data, record.capacity,
+             "{\"sensor_type\":\"fall_alert\",\"event\":\"%s\",\"peak_g\":%.2f,"
+             "\"free_fall_ms\":%lu,\"orientation_change_deg\":%.1f}",
+             type, event->peak_g, event->free_fall_ms, event->orientation_change_deg);
+    file_write_commit(&record, strnlen(record.data, record.capacity));
+  }
+}
+
+/**
+ * @brief Runs the fall detector over every sample it has not seen yet.
+ *
+ * Runs right after each FIFO drain, so detection has at most one burst of
+ * latency. The detector reads through its own cursor, so other readers of
+ * `mpu6050_copy_samples` get the same samples.
+ */
+static void priv_mpu6050_detect_falls(void)
+{
+  mpu6050_sample_t      samples[32];
+  fall_detector_event_t event;
+  size_t                count;
+
+  while ((count = mpu6050_copy_samples(&s_mpu6050_detector_cursor, samples,
+                                       sizeof(samples) / sizeof(samples[0]))) > 0) {
+    for (size_t i = 0; i < count; i++) {
+      const float accel[3] = { samples[i].accel_x, samples[i].accel_y, samples[i].accel_z };
+      const float gyro[3]  = { samples[i].gyro_x, samples[i].gyro_y, samples[i].gyro_z };
+      if (fall_detector_update(&s_mpu6050_fall_detector, samples[i].timestamp_us,
+                               accel, gyro, &event)) {
+        priv_mpu6050_raise_alert(&event);
+      }
+    }
+  }
+}
+
 /* Public Functions ***********************************************************/
 
 char *mpu6050_data_to_json(const mpu6050_data_t *data)
@@ -133,7 +429,8 @@ char *mpu6050_data_to_json(const mpu6050_data_t *data)
       !cJSON_AddNumberToObject(json, "accel_z", data->accel_z) ||
       !cJSON_AddNumberToObject(json, "gyro_x", data->gyro_x) ||
       !cJSON_AddNumberToObject(json, "gyro_y", data->gyro_y) ||
-      !cJSON_AddNumberToObject(json, "gyro_z", data->gyro_z)) {
+      !cJSON_AddNumberToObject(json, "gyro_z", data->gyro_z) ||
+      !cJSON_AddNumberToObject(json, "temperature", data->temperature)) {
     ESP_LOGE(mpu6050_tag, "Failed to add sensor data to JSON.");
     cJSON_Delete(json);
     return NULL;
@@ -171,16 +468,21 @@ esp_err_t mpu6050_init(void *sensor_data)
                     mpu6050_max_backoff_interval);
 
   /* Initialize I2C */
-  esp_err_t ret = priv_i2c_init(mpu6050_scl_io, mpu6050_sda_io,
-                                mpu6050_i2c_freq_hz, mpu6050_i2c_bus, mpu6050_tag);
+  esp_err_t ret = i2c_bus_init(mpu6050_scl_io, mpu6050_sda_io,
+                               mpu6050_i2c_freq_hz, mpu6050_i2c_bus, mpu6050_tag);
+  if (ret == ESP_OK) {
+    /* The IMU is the priority device on the shared bus */
+    ret = i2c_bus_add_device(mpu6050_i2c_bus, mpu6050_i2c_address, true, mpu6050_tag,
+                             &s_mpu6050_i2c_device);
+  }
   if (ret != ESP_OK) {
     ESP_LOGE(mpu6050_tag, "I2C driver install failed: %s", esp_err_to_name(ret));
     return ret;
   }
 
   /* Wake up the MPU6050 sensor */
-  ret = priv_i2c_write_reg_byte(k_mpu6050_pwr_mgmt_1_cmd, k_mpu6050_power_on_cmd,
-                                mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag);
+  ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_pwr_mgmt_1_cmd,
+                               k_mpu6050_power_on_cmd);
   if (ret != ESP_OK) {
     ESP_LOGE(mpu6050_tag, "MPU6050 power on failed");
     mpu6050_data->state = k_mpu6050_power_on_error;
@@ -189,8 +491,8 @@ esp_err_t mpu6050_init(void *sensor_data)
   vTaskDelay(pdMS_TO_TICKS(10));
 
   /* Reset the MPU6050 sensor */
-  ret = priv_i2c_write_reg_byte(k_mpu6050_pwr_mgmt_1_cmd, k_mpu6050_reset_cmd,
-                                mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag);
+  ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_pwr_mgmt_1_cmd,
+                               k_mpu6050_reset_cmd);
   if (ret != ESP_OK) {
     ESP_LOGE(mpu6050_tag, "MPU6050 reset failed");
     mpu6050_data->state = k_mpu6050_reset_error;
@@ -199,8 +501,8 @@ esp_err_t mpu6050_init(void *sensor_data)
   vTaskDelay(pdMS_TO_TICKS(10));
 
   /* Wake up the sensor again after reset */
-  ret = priv_i2c_write_reg_byte(k_mpu6050_pwr_mgmt_1_cmd, k_mpu6050_power_on_cmd,
-                                mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag);
+  ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_pwr_mgmt_1_cmd,
+                               k_mpu6050_power_on_cmd);
   if (ret != ESP_OK) {
     ESP_LOGE(mpu6050_tag, "MPU6050 power on after reset failed");
     mpu6050_data->state = k_mpu6050_power_on_error;
@@ -209,16 +511,15 @@ esp_err_t mpu6050_init(void *sensor_data)
   vTaskDelay(pdMS_TO_TICKS(10));
 
   /* Configure the sample rate divider */
-  ret = priv_i2c_write_reg_byte(k_mpu6050_smplrt_div_cmd, mpu6050_sample_rate_div,
-                                mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag);
+  ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_smplrt_div_cmd,
+                               mpu6050_fifo_enabled ? mpu6050_fifo_sample_rate_div : mpu6050_sample_rate_div);
   if (ret != ESP_OK) {
     ESP_LOGE(mpu6050_tag, "MPU6050 sample rate configuration failed");
     return ret;
   }
 
   /* Configure the Digital Low Pass Filter (DLPF) */
-  ret = priv_i2c_write_reg_byte(k_mpu6050_config_cmd, mpu6050_config_dlpf,
-                                mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag);
+  ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_config_cmd, mpu6050_config_dlpf);
   if (ret != ESP_OK) {
     ESP_LOGE(mpu6050_tag, "MPU6050 DLPF configuration failed");
     mpu6050_data->state = k_mpu6050_dlp_config_error;
@@ -226,63 +527,43 @@ esp_err_t mpu6050_init(void *sensor_data)
   }
 
   /* Configure the gyroscope and accelerometer */
-  ret = priv_i2c_write_reg_byte(k_mpu6050_gyro_config_cmd,
-                                mpu6050_gyro_configs[mpu6050_gyro_config_idx].gyro_config,
-                                mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag);
+  ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_gyro_config_cmd,
+                               mpu6050_gyro_configs[mpu6050_gyro_config_idx].gyro_config);
   if (ret != ESP_OK) {
     ESP_LOGE(mpu6050_tag, "MPU6050 gyroscope configuration failed");
     return ret;
   }
 
-  ret = priv_i2c_write_reg_byte(k_mpu6050_accel_config_cmd,
-                                mpu6050_accel_configs[mpu6050_accel_config_idx].accel_config,
-                                mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag);
+  ret = i2c_bus_write_reg_byte(&s_mpu6050_i2c_device, k_mpu6050_accel_config_cmd,
+                               mpu6050_accel_configs[mpu6050_accel_config_idx].accel_config);
   if (ret != ESP_OK) {
     ESP_LOGE(mpu6050_tag, "MPU6050 accelerometer configuration failed");
     return ret;
   }
 
-  /* Create the data ready semaphore */
-  mpu6050_data->data_ready_sem = xSemaphoreCreateBinary();
-  if (mpu6050_data->data_ready_sem == NULL) {
-    ESP_LOGE(mpu6050_tag, "Failed to create data ready semaphore");
-    return ESP_FAIL;
-  }
-
-  /* Configure GPIO for interrupt */
-  gpio_config_t io_conf = {
-    .pin_bit_mask = (1ULL << mpu6050_int_io),
-    .mode         = GPIO_MODE_INPUT,
-    .pull_up_en   = GPIO_PULLUP_ENABLE,
-    .pull_down_en = GPIO_PULLDOWN_DISABLE,
-    .intr_type    = GPIO_INTR_POSEDGE,
-  };
+  fall_detector_init(&s_mpu6050_fall_detector);
 
-  ret = gpio_config(&io_conf);
+  ret = priv_mpu6050_build_burst(mpu6050_i2c_bus, mpu6050_i2c_address);
   if (ret != ESP_OK) {
-    ESP_LOGE(mpu6050_tag, "GPIO configuration failed");
-    return ret;
-  }
-
-  /* Install GPIO ISR service and add ISR handler */
-  ret = gpio_install_isr_service(0);
-  if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-    ESP_LOGE(mpu6050_tag, "GPIO ISR service installation failed");
+    ESP_LOGE(mpu6050_tag, "MPU6050 burst read setup failed");
     return ret;
   }
 
-  ret = gpio_isr_handler_add(mpu6050_int_io, priv_mpu6050_interrupt_handler, mpu6050_data);
-  if (ret != ESP_OK) {
-    ESP_LOGE(mpu6050_tag, "GPIO ISR handler addition failed");
-    return ret;
+  /* Start the FIFO before enabling the interrupt, so counted samples are buffered */
+  if (mpu6050_fifo_enabled) {
+    ret = priv_mpu6050_fifo_reset(mpu6050_data);
+    if (ret != ESP_OK) {
+      ESP_LOGE(mpu6050_tag, "MPU6050 FIFO configuration failed");
+      return ret;
+    }
   }
 
-  /* Enable data ready interrupt */
-  ret = priv_i2c_write_reg_byte(k_mpu6050_int_enable_cmd, k_mpu6050_int_enable_data_rdy,
-                                mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag);
-  if (ret != ESP_OK) {
-    ESP_LOGE(mpu6050_tag, "MPU6050 interrupt enable failed");
-    return ret;
+  /* The reset left the interrupt disabled; only `mpu6050_tasks` wants it back */
+  if (s_mpu6050_use_interrupt) {
+    ret = priv_mpu6050_enable_interrupt(mpu6050_data);
+    if (ret != ESP_OK) {
+      return ret;
+    }
   }
 
   mpu6050_data->state = k_mpu6050_ready;
@@ -297,59 +578,127 @@ esp_err_t mpu6050_read(mpu6050_data_t *sensor_data)
     return ESP_FAIL;
   }
 
-  uint8_t accel_data[6];
-  uint8_t gyro_data[6];
+  if (!s_mpu6050_burst_ready) {
+    ESP_LOGE(mpu6050_tag, "Burst read is not initialized");
+    sensor_data->state = k_mpu6050_error;
+    return ESP_FAIL;
+  }
 
-  /* Read accelerometer data starting from ACCEL_XOUT_H */
-  esp_err_t ret = priv_i2c_read_reg_bytes(k_mpu6050_accel_xout_h_cmd, accel_data, 6,
-                                          sensor_data->i2c_bus, sensor_data->i2c_address,
-                                          mpu6050_tag);
+  /* One transaction for all seven channels, using the prebuilt command link */
+  int64_t   timestamp_us = esp_timer_get_time();
+  esp_err_t ret          = i2c_bus_execute(&s_mpu6050_i2c_device, &s_mpu6050_burst);
   if (ret != ESP_OK) {
-    ESP_LOGE(mpu6050_tag, "Failed to read accelerometer data from MPU6050");
+    ESP_LOGE(mpu6050_tag, "Failed to read sensor data from MPU6050: %s", esp_err_to_name(ret));
     sensor_data->state = k_mpu6050_error;
     return ESP_FAIL;
   }
 
-  /* Read gyroscope data starting from GYRO_XOUT_H */
-  ret = priv_i2c_read_reg_bytes(k_mpu6050_gyro_xout_h_cmd, gyro_data, 6,
-                                sensor_data->i2c_bus, 
-                                sensor_data->i2c_address, mpu6050_tag);
+  mpu6050_sample_t sample;
+  priv_mpu6050_parse_sample(s_mpu6050_burst_data, timestamp_us, &sample);
+  priv_mpu6050_store_latest(sensor_data, &sample);
+  priv_mpu6050_push_sample(&sample);
+
+  ESP_LOGI(mpu6050_tag, "Accel: [%f, %f, %f] g, Gyro: [%f, %f, %f] deg/s, Temp: %.2f C",
+           sensor_data->accel_x, sensor_data->accel_y, sensor_data->accel_z,
+           sensor_data->gyro_x, sensor_data->gyro_y, sensor_data->gyro_z,
+           sensor_data->temperature);
+
+  sensor_data->state = k_mpu6050_data_updated;
+  return ESP_OK;
+}
+
+esp_err_t mpu6050_fifo_drain(mpu6050_data_t *sensor_data)
+{
+  if (sensor_data == NULL) {
+    ESP_LOGE(mpu6050_tag, "Sensor data pointer is NULL");
+    return ESP_FAIL;
+  }
+
+  uint8_t   count_data[2];
+  esp_err_t ret = i2c_bus_read_reg_bytes(&s_mpu6050_i2c_device, k_mpu6050_fifo_count_h_cmd,
+                                         count_data, 2);
   if (ret != ESP_OK) {
-    ESP_LOGE(mpu6050_tag, "Failed to read gyroscope data from MPU6050");
+    ESP_LOGE(mpu6050_tag, "Failed to read FIFO count from MPU6050");
     sensor_data->state = k_mpu6050_error;
     return ESP_FAIL;
   }
 
-  /* Combine high and low bytes to form the raw accelerometer data */
-  int16_t accel_x_raw = (int16_t)((accel_data[0] << 8) | accel_data[1]);
-  int16_t accel_y_raw = (int16_t)((accel_data[2] << 8) | accel_data[3]);
-  int16_t accel_z_raw = (int16_t)((accel_data[4] << 8) | accel_data[5]);
-
-  /* Combine high and low bytes to form the raw gyroscope data */
-  int16_t gyro_x_raw = (int16_t)((gyro_data[0] << 8) | gyro_data[1]);
-  int16_t gyro_y_raw = (int16_t)((gyro_data[2] << 8) | gyro_data[3]);
-  int16_t gyro_z_raw = (int16_t)((gyro_data[4] << 8) | gyro_data[5]);
+  /* A full or misaligned FIFO means samples were lost, so restart on a sample boundary */
+  uint16_t fifo_count = (uint16_t)((count_data[0] << 8) | count_data[1]);
+  if (fifo_count >= MPU6050_FIFO_SIZE || (fifo_count % MPU6050_SAMPLE_SIZE) != 0) {
+    ESP_LOGW(mpu6050_tag, "FIFO overflow (%u bytes), resetting", fifo_count);
+    sensor_data->fifo_overflows++;
+    if (priv_mpu6050_fifo_reset(sensor_data) != ESP_OK) {
+      sensor_data->state = k_mpu6050_error;
+      return ESP_FAIL;
+    }
+    return ESP_OK;
+  }
 
-  /* Convert raw data to physical units by dividing by sensitivity */
-  float accel_sensitivity = mpu6050_accel_configs[mpu6050_accel_config_idx].accel_scale;
-  float gyro_sensitivity  = mpu6050_gyro_configs[mpu6050_gyro_config_idx].gyro_scale;
+  size_t sample_count = fifo_count / MPU6050_SAMPLE_SIZE;
+  if (sample_count == 0) {
+    return ESP_OK;
+  }
 
-  sensor_data->accel_x = accel_x_raw / accel_sensitivity;
-  sensor_data->accel_y = accel_y_raw / accel_sensitivity;
-  sensor_data->accel_z = accel_z_raw / accel_sensitivity;
+  /* Read every complete sample in one transaction */
+  int64_t drain_time_us = esp_timer_get_time();
+  ret = i2c_bus_read_reg_bytes(&s_mpu6050_i2c_device, k_mpu6050_fifo_r_w_cmd,
+                               s_mpu6050_fifo_buffer, sample_count * MPU6050_SAMPLE_SIZE);
+  if (ret != ESP_OK) {
+    ESP_LOGE(mpu6050_tag, "Failed to read FIFO data from MPU6050");
+    sensor_data->state = k_mpu6050_error;
+    return ESP_FAIL;
+  }
 
-  sensor_data->gyro_x = gyro_x_raw / gyro_sensitivity;
-  sensor_data->gyro_y = gyro_y_raw / gyro_sensitivity;
-  sensor_data->gyro_z = gyro_z_raw / gyro_sensitivity;
+  int64_t sample_period_us = (1 + mpu6050_fifo_sample_rate_div) * 1000;
 
-  ESP_LOGI(mpu6050_tag, "Accel: [%f, %f, %f] g, Gyro: [%f, %f, %f] deg/s",
-           sensor_data->accel_x, sensor_data->accel_y, sensor_data->accel_z,
-           sensor_data->gyro_x, sensor_data->gyro_y, sensor_data->gyro_z);
+  mpu6050_sample_t sample;
+  for (size_t i = 0; i < sample_count; i++) {
+    /* The newest sample was taken just before the drain; space the rest back from it */
+    priv_mpu6050_parse_sample(&s_mpu6050_fifo_buffer[i * MPU6050_SAMPLE_SIZE],
+                              drain_time_us - (int64_t)(sample_count - 1 - i) * sample_period_us,
+                              &sample);
+    priv_mpu6050_push_sample(&sample);
+  }
+  priv_mpu6050_store_latest(sensor_data, &sample);
 
-  sensor_data->state = k_mpu6050_data_updated;
+  sensor_data->fifo_drains++;
+  sensor_data->fifo_samples += sample_count;
+  sensor_data->state         = k_mpu6050_data_updated;
   return ESP_OK;
 }
 
+size_t mpu6050_copy_samples(uint32_t *cursor, mpu6050_sample_t *samples, size_t max_samples)
+{
+  if (cursor == NULL || samples == NULL) {
+    return 0;
+  }
+
+  taskENTER_CRITICAL(&s_mpu6050_samples_lock);
+  /* A reader that fell behind continues from the oldest sample still kept */
+  uint32_t pending = s_mpu6050_samples_total - *cursor;
+  if (pending > MPU6050_SAMPLE_RING_SIZE) {
+    pending = MPU6050_SAMPLE_RING_SIZE;
+    *cursor = s_mpu6050_samples_total - MPU6050_SAMPLE_RING_SIZE;
+  }
+  size_t count = (pending < max_samples) ? pending : max_samples;
+  for (size_t i = 0; i < count; i++) {
+    samples[i] = s_mpu6050_samples[(*cursor + i) % MPU6050_SAMPLE_RING_SIZE];
+  }
+  *cursor += (uint32_t)count;
+  taskEXIT_CRITICAL(&s_mpu6050_samples_lock);
+
+  return count;
+}
+
+uint32_t mpu6050_samples_cursor(void)
+{
+  taskENTER_CRITICAL(&s_mpu6050_samples_lock);
+  uint32_t cursor = s_mpu6050_samples_total;
+  taskEXIT_CRITICAL(&s_mpu6050_samples_lock);
+  return cursor;
+}
+
 void mpu6050_reset_on_error(mpu6050_data_t *sensor_data)
 {
   /* Check if the state indicates any error */
@@ -369,23 +718,48 @@ void mpu6050_reset_on_error(mpu6050_data_t *sensor_data)
   }
 }
 
+void mpu6050_tick(void *sensor_data)
+{
+  mpu6050_data_t *mpu6050_data = (mpu6050_data_t *)sensor_data;
+
+  esp_err_t ret = mpu6050_fifo_enabled ? mpu6050_fifo_drain(mpu6050_data) :
+                                         mpu6050_read(mpu6050_data);
+  if (ret != ESP_OK) {
+    mpu6050_data->error_handler.fail_count++;
+    error_handler_reset(&mpu6050_data->error_handler,
+                       mpu6050_data->error_handler.fail_count,
+                       mpu6050_init,
+                       mpu6050_data);
+    return;
+  }
+
+  mpu6050_data->error_handler.fail_count = 0; /* Reset fail count on success */
+  priv_mpu6050_detect_falls();
+  if ((xTaskGetTickCount() - s_mpu6050_last_publish) >= mpu6050_polling_rate_ticks) {
+    priv_mpu6050_publish(mpu6050_data);
+    s_mpu6050_last_publish = xTaskGetTickCount();
+  }
+}
+
 void mpu6050_tasks(void *sensor_data)
 {
   mpu6050_data_t *mpu6050_data = (mpu6050_data_t *)sensor_data;
+
+  /* Only this loop waits for the interrupt; without it, fall back to the tick period */
+  if (mpu6050_fifo_enabled) {
+    s_mpu6050_use_interrupt = true;
+    if (priv_mpu6050_enable_interrupt(mpu6050_data) != ESP_OK) {
+      s_mpu6050_use_interrupt = false;
+    }
+  }
+
   while (1) {
-    if (mpu6050_read(mpu6050_data) == ESP_OK) {
-      char *json = mpu6050_data_to_json(mpu6050_data);
-      send_sensor_data_to_webserver(json);
-      file_write_enqueue("mpu6050.txt", json);
-      free(json);
-      mpu6050_data->error_handler.fail_count = 0; /* Reset fail count on success */
+    if (s_mpu6050_use_interrupt) {
+      /* Woken once per burst by the ISR; the timeout covers a missed interrupt */
+      xSemaphoreTake(mpu6050_data->data_ready_sem, mpu6050_fifo_timeout_ticks);
     } else {
-      mpu6050_data->error_handler.fail_count++;
-      error_handler_reset(&mpu6050_data->error_handler,
-                         mpu6050_data->error_handler.fail_count,
-                         mpu6050_init,
-                         mpu6050_data);
+      vTaskDelay(mpu6050_tick_period_ticks);
     }
-    vTaskDelay(mpu6050_polling_rate_ticks);
+    mpu6050_tick(mpu6050_data);
   }
 }
@@ -109,6 +109,19 @@ esp_err_t mq135_init(void *sensor_data);
  */
 esp_err_t mq135_read(mq135_data_t *sensor_data);
 
+/**
+ * @brief Runs one acquisition cycle of the MQ135.
+ *
+ * Samples the ADC once, publishes the gas reading and handles failures
+ * through the error handler.
+ *
+ * @param[in,out] sensor_data Pointer to the `mq135_data_t` structure for
+ *                            sensor data and error recovery.
+ *
+ * @note Called periodically by the sensor scheduler, or in a loop by `mq135_tasks`.
+ */
+void mq135_tick(void *sensor_data);
+
 /**
  * @brief Executes periodic tasks for the MQ135 sensor.
  *
@@ -4,6 +4,7 @@
 #include <math.h>
 #include "file_write_manager.h"
 #include "webserver_tasks.h"
+#include "sensor_frame.h"
 #include "cJSON.h"
 #include "esp_log.h"
 #include "esp_adc/adc_oneshot.h"
@@ -149,23 +150,31 @@ esp_err_t mq135_read(mq135_data_t *sensor_data)
   return ESP_OK;
 }
 
-void mq135_tasks(void *sensor_data)
+void mq135_tick(void *sensor_data)
 {
   mq135_data_t *mq135_data = (mq135_data_t *)sensor_data;
-  while (1) {
-    if (mq135_read(mq135_data) == ESP_OK) {
-      char *json = mq135_data_to_json(mq135_data);
-      send_sensor_data_to_webserver(json);
-      file_write_enqueue("mq135.txt", json);
-      free(json);
-      mq135_data->error_handler.fail_count = 0; /* Reset fail count on success */
-    } else {
-      mq135_data->error_handler.fail_count++;
-      error_handler_reset(&mq135_data->error_handler,
-                         mq135_data->error_handler.fail_count,
-                         mq135_init,
-                         mq135_data);
+  if (mq135_read(mq135_data) == ESP_OK) {
+    uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+    size_t  frame_len = 0;
+    if (sensor_frame_encode(k_sensor_frame_id_mq135, mq135_data, frame, sizeof(frame),
+                            &frame_len) == ESP_OK) {
+      webserver_enqueue_frame(frame, frame_len);
+      file_write_log_frame("mq135.tsl", frame, frame_len);
     }
+    mq135_data->error_handler.fail_count = 0; /* Reset fail count on success */
+  } else {
+    mq135_data->error_handler.fail_count++;
+    error_handler_reset(&mq135_data->error_handler,
+                       mq135_data->error_handler.fail_count,
+                       mq135_init,
+                       mq135_data);
+  }
+}
+
+void mq135_tasks(void *sensor_data)
+{
+  while (1) {
+    mq135_tick(sensor_data);
     vTaskDelay(mq135_polling_rate_ticks);
   }
 }
@@ -0,0 +1,131 @@
+/* components/sensors/sensor_frame/include/sensor_frame.h */
+
+#ifndef SAFEHAT_WORKNET_SENSOR_FRAME_H
+#define SAFEHAT_WORKNET_SENSOR_FRAME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/* Constants ******************************************************************/
+
+extern const char *sensor_frame_tag; /**< Tag for logging */
+
+/* Macros *********************************************************************/
+
+#define SENSOR_FRAME_MAGIC       (0x4653) /**< "SF" in little-endian byte order, marks the start of a frame. */
+#define SENSOR_FRAME_VERSION     (1)      /**< Layout version, bumped on any incompatible change. */
+#define SENSOR_FRAME_HEADER_SIZE (22)     /**< Size of the fixed frame header in bytes. */
+#define SENSOR_FRAME_MAX_SIZE    (48)     /**< Upper bound on the size of any encoded frame in bytes. */
+
+/* Enums **********************************************************************/
+
+/**
+ * @brief Identifies the sensor a frame was produced by.
+ *
+ * Values are part of the wire format and must never be renumbered.
+ */
+typedef enum : uint8_t {
+  k_sensor_frame_id_dht22      = 1, /**< DHT22 temperature and humidity sensor. */
+  k_sensor_frame_id_ccs811     = 2, /**< CCS811 air quality sensor. */
+  k_sensor_frame_id_mq135      = 3, /**< MQ135 gas sensor. */
+  k_sensor_frame_id_gy_neo6mv2 = 4, /**< GY-NEO6MV2 GPS module. */
+  k_sensor_frame_id_bh1750     = 5, /**< BH1750 light sensor. */
+  k_sensor_frame_id_mpu6050    = 6, /**< MPU6050 accelerometer and gyroscope. */
+  k_sensor_frame_id_fall_alert = 7, /**< Fall or impact event raised by the fall detector. */
+  k_sensor_frame_id_count,          /**< Number of sensor ids, used for bounds checks. */
+} sensor_frame_id_t;
+
+/**
+ * @brief Bit flags carried in the frame header.
+ */
+typedef enum : uint8_t {
+  k_sensor_frame_flag_time_unsynced = 0x01, /**< Timestamp was taken before the clock was synchronized. */
+} sensor_frame_flags_t;
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Decoded header of an encoded frame.
+ */
+typedef struct {
+  sensor_frame_id_t sensor_id;    /**< Sensor that produced the reading. */
+  uint8_t           flags;        /**< `sensor_frame_flags_t` bits. */
+  uint8_t           payload_len;  /**< Length of the payload in bytes. */
+  uint32_t          node_id;      /**< Node that encoded the frame. */
+  uint32_t          sequence;     /**< Per-sensor sequence number. */
+  int64_t           timestamp_ms; /**< Timestamp in milliseconds since epoch. */
+  const uint8_t    *payload;      /**< Points at the payload inside the parsed frame. */
+} sensor_frame_header_t;
+
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Encodes a sensor reading into a binary frame.
+ *
+ * Writes a fixed-layout, little-endian frame into a caller-provided buffer
+ * without any heap allocation. Every frame starts with the following header:
+ *
+ * | Offset | Size | Field                                  |
+ * |--------|------|----------------------------------------|
+ * | 0      | 2    | Magic (`SENSOR_FRAME_MAGIC`)           |
+ * | 2      | 1    | Version (`SENSOR_FRAME_VERSION`)       |
+ * | 3      | 1    | Sensor id (`sensor_frame_id_t`)        |
+ * | 4      | 1    | Flags (`sensor_frame_flags_t`)         |
+ * | 5      | 1    | Payload length in bytes                |
+ * | 6      | 4    | Node id (low 32 bits of the STA MAC)   |
+ * | 10     | 4    | Per-sensor sequence number             |
+ * | 14     | 8    | Timestamp in milliseconds since epoch  |
+ *
+ * The header is followed by a sensor-specific payload of fixed-point fields
+ * (see `sensor_frame.c` and `esp_mesh_server/sensor_frame.py`). Frames are
+ * self-delimiting, so several of them can be concatenated in one upload.
+ *
+ * @param[in]  sensor_id   Sensor that produced the reading.
+ * @param[in]  sensor_data Pointer to the HAL data structure matching `sensor_id`
+ *                         (e.g. `dht22_data_t` for `k_sensor_frame_id_dht22`,
+ *                         `fall_detector_event_t` for `k_sensor_frame_id_fall_alert`).
+ * @param[out] buffer      Buffer receiving the encoded frame.
+ * @param[in]  buffer_size Size of `buffer` in bytes. `SENSOR_FRAME_MAX_SIZE`
+ *                         is always large enough.
+ * @param[out] frame_len   Number of bytes written to `buffer`.
+ *
+ * @return
+ * - ESP_OK               on success.
+ * - ESP_ERR_INVALID_ARG  if a pointer is NULL or `sensor_id` is unknown.
+ * - ESP_ERR_INVALID_SIZE if `buffer` is too small for the frame.
+ *
+ * @note Each call advances the sequence number of `sensor_id`, so a gap seen
+ *       by the server means frames were lost on the way.
+ */
+esp_err_t sensor_frame_encode(sensor_frame_id_t sensor_id, const void *sensor_data,
+                              uint8_t *buffer, size_t buffer_size, size_t *frame_len);
+
+/**
+ * @brief Decodes the header of a frame produced by `sensor_frame_encode`.
+ *
+ * Lets local consumers such as the SD card log store the payload without
+ * re-encoding the reading.
+ *
+ * @param[in]  frame     Encoded frame.
+ * @param[in]  frame_len Number of bytes available at `frame`.
+ * @param[out] header    Receives the decoded header; `payload` points into `frame`.
+ *
+ * @return
+ * - ESP_OK                on success.
+ * - ESP_ERR_INVALID_ARG   if a pointer is NULL or `frame_len` is shorter than a header.
+ * - ESP_ERR_INVALID_STATE if the magic, version or sensor id is not recognized.
+ * - ESP_ERR_INVALID_SIZE  if the payload extends past `frame_len`.
+ */
+esp_err_t sensor_frame_parse_header(const uint8_t *frame, size_t frame_len,
+                                    sensor_frame_header_t *header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFEHAT_WORKNET_SENSOR_FRAME_H */
@@ -0,0 +1,271 @@
+/* components/sensors/sensor_frame/sensor_frame.c */
+
+#include "sensor_frame.h"
+#include <math.h>
+#include <string.h>
+#include <sys/time.h>
+#include "sensor_hal.h"
+#include "fall_detector.h"
+#include "time_manager.h"
+#include "esp_mac.h"
+#include "esp_log.h"
+
+/* Constants ******************************************************************/
+
+const char *sensor_frame_tag = "SENSOR_FRAME";
+
+/* Globals (Static) ***********************************************************/
+
+static uint32_t s_node_id                           = 0;     /**< Low 32 bits of the STA MAC, read on first use */
+static uint32_t s_sequence[k_sensor_frame_id_count] = { 0 }; /**< Next sequence number per sensor id */
+
+/* Private (Static) Functions *************************************************/
+
+/**
+ * @brief Appends little-endian integers to a frame buffer.
+ *
+ * Each helper writes its value at `*offset` and advances the offset. Bounds
+ * are checked once by the caller against `SENSOR_FRAME_MAX_SIZE`.
+ */
+static inline void priv_put_u8(uint8_t *buffer, size_t *offset, uint8_t value)
+{
+  buffer[(*offset)++] = value;
+}
+
+static inline void priv_put_u16(uint8_t *buffer, size_t *offset, uint16_t value)
+{
+  buffer[(*offset)++] = (uint8_t)(value);
+  buffer[(*offset)++] = (uint8_t)(value >> 8);
+}
+
+static inline void priv_put_u32(uint8_t *buffer, size_t *offset, uint32_t value)
+{
+  priv_put_u16(buffer, offset, (uint16_t)(value));
+  priv_put_u16(buffer, offset, (uint16_t)(value >> 16));
+}
+
+static inline void priv_put_u64(uint8_t *buffer, size_t *offset, uint64_t value)
+{
+  priv_put_u32(buffer, offset, (uint32_t)(value));
+  priv_put_u32(buffer, offset, (uint32_t)(value >> 32));
+}
+
+static inline void priv_put_f32(uint8_t *buffer, size_t *offset, float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  priv_put_u32(buffer, offset, bits);
+}
+
+/**
+ * @brief Reads little-endian integers from a frame buffer.
+ */
+static inline uint16_t priv_get_u16(const uint8_t *buffer)
+{
+  return (uint16_t)(buffer[0] | (buffer[1] << 8));
+}
+
+static inline uint32_t priv_get_u32(const uint8_t *buffer)
+{
+  return (uint32_t)priv_get_u16(buffer) | ((uint32_t)priv_get_u16(&buffer[2]) << 16);
+}
+
+static inline uint64_t priv_get_u64(const uint8_t *buffer)
+{
+  return (uint64_t)priv_get_u32(buffer) | ((uint64_t)priv_get_u32(&buffer[4]) << 32);
+}
+
+/**
+ * @brief Converts a value to a fixed-point integer, saturating at the limits.
+ *
+ * @param[in] value Value to convert.
+ * @param[in] scale Multiplier applied before rounding (e.g. 10 for 0.1 units).
+ * @param[in] min   Smallest representable value.
+ * @param[in] max   Largest representable value.
+ *
+ * @return The rounded, clamped fixed-point value.
+ */
+static int32_t priv_fixed_point(float value, float scale, int32_t min, int32_t max)
+{
+  float scaled = roundf(value * scale);
+  if (isnan(scaled) || scaled < (float)min) {
+    return min;
+  }
+  if (scaled > (float)max) {
+    return max;
+  }
+  return (int32_t)scaled;
+}
+
+/**
+ * @brief Converts an NMEA `HHMMSS.SS` time string to milliseconds of the day.
+ *
+ * @param[in] time NMEA UTC time string from the GPS module.
+ *
+ * @return Milliseconds since midnight UTC, or `UINT32_MAX` if no time is known.
+ */
+static uint32_t priv_gps_time_to_ms(const char *time)
+{
+  if (strlen(time) < 6) {
+    return UINT32_MAX;
+  }
+
+  uint32_t hours   = (time[0] - '0') * 10 + (time[1] - '0');
+  uint32_t minutes = (time[2] - '0') * 10 + (time[3] - '0');
+  uint32_t seconds = (time[4] - '0') * 10 + (time[5] - '0');
+  uint32_t millis  = 0;
+  if (time[6] == '.') {
+    for (uint8_t i = 7, scale = 100; i < 10 && time[i] >= '0' && time[i] <= '9'; i++, scale /= 10) {
+      millis += (time[i] - '0') * scale;
+    }
+  }
+  return ((hours * 60 + minutes) * 60 + seconds) * 1000 + millis;
+}
+
+/**
+ * @brief Writes the sensor-specific payload of a frame.
+ *
+ * @param[in]     sensor_id   Sensor that produced the reading.
+ * @param[in]     sensor_data HAL data structure matching `sensor_id`.
+ * @param[out]    buffer      Frame buffer, at least `SENSOR_FRAME_MAX_SIZE` bytes.
+ * @param[in,out] offset      Write position, advanced past the payload.
+ *
+ * @return
+ * - ESP_OK              on success.
+ * - ESP_ERR_INVALID_ARG if `sensor_id` is unknown.
+ */
+static esp_err_t priv_sensor_frame_put_payload(sensor_frame_id_t sensor_id, const void *sensor_data,
+                                               uint8_t *buffer, size_t *offset)
+{
+  switch (sensor_id) {
+    case k_sensor_frame_id_dht22: {
+      const dht22_data_t *data = (const dht22_data_t *)sensor_data;
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->temperature_c, 10.0f, INT16_MIN, INT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->humidity, 10.0f, 0, UINT16_MAX));
+      return ESP_OK;
+    }
+    case k_sensor_frame_id_ccs811: {
+      const ccs811_data_t *data = (const ccs811_data_t *)sensor_data;
+      priv_put_u16(buffer, offset, data->eco2);
+      priv_put_u16(buffer, offset, data->tvoc);
+      return ESP_OK;
+    }
+    case k_sensor_frame_id_mq135: {
+      const mq135_data_t *data = (const mq135_data_t *)sensor_data;
+      priv_put_u16(buffer, offset, data->raw_adc_value);
+      priv_put_f32(buffer, offset, data->gas_concentration);
+      return ESP_OK;
+    }
+    case k_sensor_frame_id_gy_neo6mv2: {
+      const gy_neo6mv2_data_t *data = (const gy_neo6mv2_data_t *)sensor_data;
+      priv_put_u32(buffer, offset, (uint32_t)priv_fixed_point(data->latitude, 1e7f, -900000000, 900000000));
+      priv_put_u32(buffer, offset, (uint32_t)priv_fixed_point(data->longitude, 1e7f, -1800000000, 1800000000));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->speed, 100.0f, 0, UINT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->hdop, 100.0f, 0, UINT16_MAX));
+      priv_put_u8(buffer, offset, data->fix_status);
+      priv_put_u8(buffer, offset, data->satellite_count);
+      priv_put_u32(buffer, offset, priv_gps_time_to_ms(data->time));
+      return ESP_OK;
+    }
+    case k_sensor_frame_id_bh1750: {
+      const bh1750_data_t *data = (const bh1750_data_t *)sensor_data;
+      priv_put_f32(buffer, offset, data->lux);
+      return ESP_OK;
+    }
+    case k_sensor_frame_id_mpu6050: {
+      const mpu6050_data_t *data = (const mpu6050_data_t *)sensor_data;
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->accel_x, 1000.0f, INT16_MIN, INT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->accel_y, 1000.0f, INT16_MIN, INT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->accel_z, 1000.0f, INT16_MIN, INT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->gyro_x, 10.0f, INT16_MIN, INT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->gyro_y, 10.0f, INT16_MIN, INT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->gyro_z, 10.0f, INT16_MIN, INT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(data->temperature, 100.0f, INT16_MIN, INT16_MAX));
+      return ESP_OK;
+    }
+    case k_sensor_frame_id_fall_alert: {
+      const fall_detector_event_t *event = (const fall_detector_event_t *)sensor_data;
+      priv_put_u8(buffer, offset, event->type);
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(event->peak_g, 100.0f, 0, UINT16_MAX));
+      priv_put_u16(buffer, offset, (uint16_t)(event->free_fall_ms > UINT16_MAX ? UINT16_MAX : event->free_fall_ms));
+      priv_put_u16(buffer, offset, (uint16_t)priv_fixed_point(event->orientation_change_deg, 10.0f, 0, UINT16_MAX));
+      return ESP_OK;
+    }
+    default:
+      return ESP_ERR_INVALID_ARG;
+  }
+}
+
+/* Public Functions ***********************************************************/
+
+esp_err_t sensor_frame_encode(sensor_frame_id_t sensor_id, const void *sensor_data,
+                              uint8_t *buffer, size_t buffer_size, size_t *frame_len)
+{
+  if (sensor_data == NULL || buffer == NULL || frame_len == NULL ||
+      sensor_id == 0 || sensor_id >= k_sensor_frame_id_count) {
+    ESP_LOGE(sensor_frame_tag, "Invalid arguments.");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  /* Payloads are fixed per sensor, so checking against the upper bound is enough */
+  if (buffer_size < SENSOR_FRAME_MAX_SIZE) {
+    ESP_LOGE(sensor_frame_tag, "Buffer too small for a frame (%u bytes).", buffer_size);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  if (s_node_id == 0) {
+    uint8_t mac[6] = { 0 };
+    esp_read_mac(mac, ESP_MAC_WIFI_STA);
+    s_node_id = ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) |
+                ((uint32_t)mac[4] << 8)  | (uint32_t)mac[5];
+  }
+
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  uint64_t timestamp_ms = (uint64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+  uint8_t  flags        = time_manager_is_synced() ? 0 : k_sensor_frame_flag_time_unsynced;
+
+  size_t offset = 0;
+  priv_put_u16(buffer, &offset, SENSOR_FRAME_MAGIC);
+  priv_put_u8(buffer, &offset, SENSOR_FRAME_VERSION);
+  priv_put_u8(buffer, &offset, sensor_id);
+  priv_put_u8(buffer, &offset, flags);
+  priv_put_u8(buffer, &offset, 0); /* Payload length, patched below */
+  priv_put_u32(buffer, &offset, s_node_id);
+  priv_put_u32(buffer, &offset, s_sequence[sensor_id]++);
+  priv_put_u64(buffer, &offset, timestamp_ms);
+
+  esp_err_t ret = priv_sensor_frame_put_payload(sensor_id, sensor_data, buffer, &offset);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  buffer[5]  = (uint8_t)(offset - SENSOR_FRAME_HEADER_SIZE);
+  *frame_len = offset;
+  return ESP_OK;
+}
+
+esp_err_t sensor_frame_parse_header(const uint8_t *frame, size_t frame_len,
+                                    sensor_frame_header_t *header)
+{
+  if (frame == NULL || header == NULL || frame_len < SENSOR_FRAME_HEADER_SIZE) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (priv_get_u16(&frame[0]) != SENSOR_FRAME_MAGIC || frame[2] != SENSOR_FRAME_VERSION ||
+      frame[3] == 0 || frame[3] >= k_sensor_frame_id_count) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (SENSOR_FRAME_HEADER_SIZE + (size_t)frame[5] > frame_len) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  header->sensor_id    = (sensor_frame_id_t)frame[3];
+  header->flags        = frame[4];
+  header->payload_len  = frame[5];
+  header->node_id      = priv_get_u32(&frame[6]);
+  header->sequence     = priv_get_u32(&frame[10]);
+  header->timestamp_ms = (int64_t)priv_get_u64(&frame[14]);
+  header->payload      = &frame[SENSOR_FRAME_HEADER_SIZE];
+  return ESP_OK;
+}
@@ -40,6 +40,9 @@ extern const uint32_t          sd_card_retry_delay_ms;       /**< The delay betw
  * with a FAT filesystem for successful mounting. Uses the SPI host configured in
  * `sd_card_spi_host`.
  *
+ * After mounting, the logs on the card are scanned and any data torn by a
+ * power loss is truncated, so the file write manager can append safely.
+ *
  * @return
  * - `ESP_OK`         if the initialization is successful.
  * - `ESP_ERR_NO_MEM` if there is insufficient memory.
@@ -47,6 +50,56 @@ extern const uint32_t          sd_card_retry_delay_ms;       /**< The delay betw
  */
 esp_err_t sd_card_init(void);
 
+/**
+ * @brief Repairs the logs in one directory of the mounted card.
+ *
+ * Runs the same scan `sd_card_init` runs on the mount point, for logs kept
+ * in subdirectories.
+ *
+ * @param[in] dir_path Full path of the directory; subdirectories are not entered.
+ *
+ * @return
+ * - `ESP_OK`                if the directory was scanned.
+ * - `ESP_ERR_INVALID_STATE` if the card is not mounted.
+ * - `ESP_FAIL`              if the directory could not be opened.
+ */
+esp_err_t sd_card_recover_dir(const char *dir_path);
+
+/**
+ * @brief Repairs the logs in one directory after an unclean shutdown.
+ *
+ * Power can fail in the middle of a write, leaving a torn record, or after
+ * the file size was updated but before the data reached the card, leaving
+ * stale sectors at the end of a file. Time-series logs are cut back to
+ * their last record with a valid sequence number and CRC (`ts_log_recover`)
+ * and text logs to their last complete line, so writers always append
+ * behind consistent data. Only the end of each file is read.
+ *
+ * This is the scan behind `sd_card_init` and `sd_card_recover_dir`. It does
+ * not check that the card is mounted, and needs nothing but the file system,
+ * so it also runs on a host directory.
+ *
+ * @param[in] dir_path Directory to scan; subdirectories are not entered.
+ *
+ * @return
+ * - `ESP_OK`   if the directory was scanned.
+ * - `ESP_FAIL` if the directory could not be opened.
+ */
+esp_err_t sd_card_recover_scan(const char *dir_path);
+
+/**
+ * @brief Reports the size and free space of the mounted file system.
+ *
+ * @param[out] total_bytes Receives the size of the file system.
+ * @param[out] free_bytes  Receives the free space.
+ *
+ * @return
+ * - `ESP_OK`                on success.
+ * - `ESP_ERR_INVALID_STATE` if the card is not mounted.
+ * - Error from `esp_vfs_fat_info` otherwise.
+ */
+esp_err_t sd_card_get_usage(uint64_t *total_bytes, uint64_t *free_bytes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -24,7 +24,7 @@ const uint8_t           sd_card_clk                  = GPIO_NUM_14;
 const uint8_t           sd_card_data_from_card       = GPIO_NUM_19;
 const uint32_t          sd_card_spi_freq_hz          = 1000000;     /* 1 MHz SPI frequency */
 const spi_host_device_t sd_card_spi_host             = SPI2_HOST;
-const uint8_t           sd_card_max_files            = 5;
+const uint8_t           sd_card_max_files            = 13;
 const uint32_t          sd_card_allocation_unit_size = 16 * 1024;
 const uint32_t          sd_card_max_transfer_sz      = 4092;        /* Default size in Bytes */
 const uint8_t           sd_card_max_retries          = 5;
@@ -100,6 +100,7 @@ esp_err_t sd_card_init(void)
     if (ret == ESP_OK) {
       /* Log SD card information */
       sdmmc_card_print_info(stdout, s_card);
+      sd_card_recover_scan(sd_card_mount_path);
       ESP_LOGI(sd_card_tag, "SD card initialized successfully");
       return ESP_OK;
     } else {
@@ -114,3 +115,18 @@ esp_err_t sd_card_init(void)
   return ESP_FAIL;
 }
 
+esp_err_t sd_card_recover_dir(const char *dir_path)
+{
+  if (s_card == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  return sd_card_recover_scan(dir_path);
+}
+
+esp_err_t sd_card_get_usage(uint64_t *total_bytes, uint64_t *free_bytes)
+{
+  if (s_card == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  return esp_vfs_fat_info(sd_card_mount_path, total_bytes, free_bytes);
+}
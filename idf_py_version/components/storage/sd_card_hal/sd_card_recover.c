@@ -0,0 +1,110 @@
+/* components/storage/sd_card_hal/sd_card_recover.c */
+
+/* The power-loss recovery scan of sd_card_hal.c. It only uses stdio and
+ * POSIX calls, so the host tests build it on its own. */
+
+#include "sd_card_hal.h"
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include "ts_log.h"
+#include "esp_log.h"
+#include "esp_err.h"
+
+/* Private (Static) Functions *************************************************/
+
+/**
+ * @brief Reports whether a file name ends with the given extension.
+ */
+static bool priv_sd_card_has_extension(const char *name, const char *extension)
+{
+  size_t name_len      = strlen(name);
+  size_t extension_len = strlen(extension);
+  return name_len > extension_len && strcasecmp(&name[name_len - extension_len], extension) == 0;
+}
+
+/**
+ * @brief Cuts a text log back to its last complete line.
+ *
+ * A line torn by a power loss, or zeros left by a cluster that was
+ * allocated but never written, end up after the last newline.
+ *
+ * @param[in] file_path Full path of the text log.
+ *
+ * @return Number of bytes removed.
+ */
+static long priv_sd_card_recover_text(const char *file_path)
+{
+  FILE *file = fopen(file_path, "rb");
+  if (file == NULL) {
+    return 0;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  long keep = 0;
+
+  /* Search backwards, one sector at a time, for the last newline */
+  char chunk[512];
+  long end = size;
+  while (end > 0 && keep == 0) {
+    long start = (end > (long)sizeof(chunk)) ? end - (long)sizeof(chunk) : 0;
+    if (fseek(file, start, SEEK_SET) != 0 ||
+        fread(chunk, 1, (size_t)(end - start), file) != (size_t)(end - start)) {
+      break;
+    }
+    for (long i = end - start - 1; i >= 0; i--) {
+      if (chunk[i] == '\n') {
+        keep = start + i + 1;
+        break;
+      }
+    }
+    end = start;
+  }
+  fclose(file);
+
+  if (keep >= size || truncate(file_path, keep) != 0) {
+    return 0;
+  }
+  return size - keep;
+}
+
+/* Public Functions ***********************************************************/
+
+esp_err_t sd_card_recover_scan(const char *dir_path)
+{
+  DIR *dir = opendir(dir_path);
+  if (dir == NULL) {
+    ESP_LOGE(sd_card_tag, "Failed to open %s for the recovery scan", dir_path);
+    return ESP_FAIL;
+  }
+
+  uint32_t       repaired = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    char file_path[128];
+    snprintf(file_path, sizeof(file_path), "%s/%s", dir_path, entry->d_name);
+
+    if (priv_sd_card_has_extension(entry->d_name, ".tsl")) {
+      size_t    truncated = 0;
+      esp_err_t ret       = ts_log_recover(file_path, &truncated);
+      if (ret != ESP_OK) {
+        ESP_LOGW(sd_card_tag, "Could not check %s: %s", file_path, esp_err_to_name(ret));
+      } else if (truncated > 0) {
+        repaired++;
+      }
+    } else if (priv_sd_card_has_extension(entry->d_name, ".txt")) {
+      long truncated = priv_sd_card_recover_text(file_path);
+      if (truncated > 0) {
+        ESP_LOGW(sd_card_tag, "%s: cut %ld bytes of an incomplete line", file_path, truncated);
+        repaired++;
+      }
+    }
+  }
+  closedir(dir);
+
+  ESP_LOGI(sd_card_tag, "Recovery scan of %s done, %" PRIu32 " files repaired", dir_path, repaired);
+  return ESP_OK;
+}
@@ -0,0 +1,262 @@
+/* components/storage/ts_log/include/ts_log.h */
+
+#ifndef SAFEHAT_WORKNET_TS_LOG_H
+#define SAFEHAT_WORKNET_TS_LOG_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "esp_err.h"
+
+/* Constants ******************************************************************/
+
+extern const char *ts_log_tag; /**< Tag for logging */
+
+/* Macros *********************************************************************/
+
+#define TS_LOG_FILE_MAGIC        (0x474C5354) /**< "TSLG" in little-endian byte order, starts every log file. */
+#define TS_LOG_BLOCK_MAGIC       (0x4B4C4254) /**< "TBLK" in little-endian byte order, starts every block footer. */
+#define TS_LOG_VERSION           (2)          /**< Layout version, bumped on any incompatible change. */
+#define TS_LOG_FILE_HEADER_SIZE  (512)        /**< Space reserved for the file header, so blocks start on a sector. */
+#define TS_LOG_BLOCK_SIZE        (2048)       /**< Size of every data block, a multiple of the SD sector size. */
+#define TS_LOG_BLOCK_FOOTER_SIZE (32)         /**< Size of `ts_log_block_footer_t`. */
+#define TS_LOG_RECORD_HEADER     (13)         /**< Bytes in front of each record payload (sequence, time, flags). */
+#define TS_LOG_RECORD_TRAILER    (4)          /**< Bytes behind each record payload (CRC-32). */
+#define TS_LOG_MAX_RECORD_SIZE   (64)         /**< Largest record accepted, header and trailer included. */
+#define TS_LOG_INDEX_SUFFIX      ".idx"       /**< Appended to a log's path to name its index file. */
+#define TS_LOG_SUMMARY_FLAG      (0x80)       /**< Set in the header's `sensor_id` when records hold per-window summaries, not readings. */
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Header at offset 0 of a time-series log file.
+ *
+ * One file holds the readings of one sensor of one node, so the sensor id,
+ * the node id and the record size are stored once here instead of in every
+ * record. The header is padded with zeros to `TS_LOG_FILE_HEADER_SIZE`.
+ */
+typedef struct __attribute__((packed)) {
+  uint32_t magic;       /**< `TS_LOG_FILE_MAGIC`. */
+  uint8_t  version;     /**< `TS_LOG_VERSION`. */
+  uint8_t  sensor_id;   /**< `sensor_frame_id_t` of the logged sensor. */
+  uint16_t record_size; /**< Size of every record, header and trailer included. */
+  uint32_t node_id;     /**< Node that wrote the log (low 32 bits of the STA MAC). */
+  uint16_t block_size;  /**< `TS_LOG_BLOCK_SIZE` at the time the file was created. */
+  uint16_t header_size; /**< `TS_LOG_FILE_HEADER_SIZE` at the time the file was created. */
+} ts_log_file_header_t;
+
+/**
+ * @brief Footer closing a full data block.
+ *
+ * The footer is written once, together with the last records of the block,
+ * so bytes already on the card are never rewritten. Its CRC covers the
+ * records followed by the footer itself (with `crc32` set to 0).
+ */
+typedef struct __attribute__((packed)) {
+  uint32_t magic;        /**< `TS_LOG_BLOCK_MAGIC`. */
+  uint32_t block_no;     /**< Position of the block in the file, starting at 0. */
+  uint16_t record_count; /**< Number of valid records in the block. */
+  uint16_t record_size;  /**< Copy of the file's record size. */
+  uint32_t crc32;        /**< CRC-32 (IEEE 802.3) of records and footer. */
+  int64_t  min_time_ms;  /**< Earliest record time, milliseconds since epoch. */
+  int64_t  max_time_ms;  /**< Latest record time, milliseconds since epoch. */
+} ts_log_block_footer_t;
+
+/**
+ * @brief A data block: a run of fixed-size records and a footer.
+ *
+ * Each record is a journal entry: a little-endian `uint32_t` sequence number
+ * (the record's position in the file, counted from 0), an `int64_t` time in
+ * milliseconds since epoch, one flags byte (`sensor_frame_flags_t`), the
+ * sensor payload exactly as in a sensor frame, and a CRC-32 of everything
+ * before it. The records of the block being filled are appended as they
+ * are flushed; a record only counts if both its sequence number and its CRC
+ * match, so a torn tail or stale sectors behind it are recognized.
+ *
+ * While the block is in memory, `footer` tracks the records it holds.
+ */
+typedef struct {
+  uint8_t               records[TS_LOG_BLOCK_SIZE - TS_LOG_BLOCK_FOOTER_SIZE]; /**< Record run, zero-filled at the end. */
+  ts_log_block_footer_t footer;                                                /**< Block footer. */
+} ts_log_block_t;
+
+/**
+ * @brief Entry of the index file that accompanies every log file.
+ *
+ * The index (`<log>.idx`) holds one entry per completed block, so a reader
+ * can find the blocks overlapping a time range without touching the others.
+ */
+typedef struct __attribute__((packed)) {
+  uint32_t block_no;     /**< Block the entry describes. */
+  uint16_t record_count; /**< Number of records in the block. */
+  uint16_t reserved;     /**< Zero. */
+  int64_t  min_time_ms;  /**< Earliest record time in the block. */
+  int64_t  max_time_ms;  /**< Latest record time in the block. */
+} ts_log_index_entry_t;
+
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Fills in the header of a new log file.
+ *
+ * @param[out] header       Header to fill in.
+ * @param[in]  sensor_id    Sensor the file logs.
+ * @param[in]  node_id      Node writing the file.
+ * @param[in]  payload_size Size of the sensor payload of each record.
+ */
+void ts_log_file_header_init(ts_log_file_header_t *header, uint8_t sensor_id,
+                             uint32_t node_id, size_t payload_size);
+
+/**
+ * @brief Checks that a file header was written by a compatible writer.
+ *
+ * @param[in] header Header read from offset 0 of a log file.
+ *
+ * @return
+ * - ESP_OK                if the header is valid.
+ * - ESP_ERR_INVALID_STATE if the magic, version or geometry does not match.
+ */
+esp_err_t ts_log_file_header_check(const ts_log_file_header_t *header);
+
+/**
+ * @brief Empties a block and gives it its position in the file.
+ *
+ * @param[out] block       Block to reset.
+ * @param[in]  block_no    Position of the block in the file.
+ * @param[in]  record_size Size of each record, from the file header.
+ */
+void ts_log_block_init(ts_log_block_t *block, uint32_t block_no, uint16_t record_size);
+
+/**
+ * @brief Appends one record to a block.
+ *
+ * The sequence number and the CRC are filled in here.
+ *
+ * @param[in,out] block        Block to append to.
+ * @param[in]     time_ms      Time of the reading, milliseconds since epoch.
+ * @param[in]     flags        Sensor frame flags of the reading.
+ * @param[in]     payload      Sensor payload.
+ * @param[in]     payload_size Size of `payload`; must match the block's record size.
+ *
+ * @return
+ * - ESP_OK               if the record was added.
+ * - ESP_ERR_NO_MEM       if the block is full.
+ * - ESP_ERR_INVALID_SIZE if the payload does not match the record size.
+ */
+esp_err_t ts_log_block_append(ts_log_block_t *block, int64_t time_ms, uint8_t flags,
+                              const uint8_t *payload, size_t payload_size);
+
+/**
+ * @brief Reports whether a block has room for another record.
+ */
+bool ts_log_block_is_full(const ts_log_block_t *block);
+
+/**
+ * @brief Returns the number of record bytes a block holds.
+ */
+size_t ts_log_block_used(const ts_log_block_t *block);
+
+/**
+ * @brief Computes the footer CRC of a full block before it is written.
+ *
+ * @param[in,out] block Block whose `crc32` field is updated.
+ */
+void ts_log_block_seal(ts_log_block_t *block);
+
+/**
+ * @brief Checks the footer and CRC of a full block read back from a file.
+ *
+ * @param[in] block    Block to check.
+ * @param[in] block_no Position the block was read from.
+ *
+ * @return `true` if the block is intact and sealed.
+ */
+bool ts_log_block_verify(const ts_log_block_t *block, uint32_t block_no);
+
+/**
+ * @brief Counts the valid records at the start of an unsealed block.
+ *
+ * The caller initializes the block with `ts_log_block_init` and reads the
+ * bytes of the block that are on the card into `records`. Records are
+ * accepted in order until one has a wrong sequence number or CRC; the
+ * footer then describes exactly the accepted ones.
+ *
+ * @param[in,out] block  Block to scan.
+ * @param[in]     length Number of bytes read into `records`.
+ *
+ * @return Number of bytes taken by the accepted records.
+ */
+size_t ts_log_block_scan(ts_log_block_t *block, size_t length);
+
+/**
+ * @brief Returns the file offset of a block.
+ */
+static inline long ts_log_block_offset(uint32_t block_no)
+{
+  return (long)TS_LOG_FILE_HEADER_SIZE + (long)block_no * TS_LOG_BLOCK_SIZE;
+}
+
+/**
+ * @brief Returns the size of a record holding a payload of the given size.
+ */
+static inline size_t ts_log_record_size(size_t payload_size)
+{
+  return TS_LOG_RECORD_HEADER + payload_size + TS_LOG_RECORD_TRAILER;
+}
+
+/**
+ * @brief Builds the index entry describing a block.
+ *
+ * @param[in]  block Block to describe.
+ * @param[out] entry Receives the entry.
+ */
+void ts_log_index_entry_init(const ts_log_block_t *block, ts_log_index_entry_t *entry);
+
+/**
+ * @brief Loads the block new records of an existing log go to.
+ *
+ * Checks the last full block of the file; if it is not sealed, it becomes
+ * the tail block again. The records of the tail block are then read and
+ * scanned with `ts_log_block_scan`.
+ *
+ * @param[in]  file        Log opened for reading, its header already checked.
+ * @param[in]  file_size   Size of the file.
+ * @param[in]  record_size Record size from the file header.
+ * @param[out] block       Receives the tail block; it may be full if only
+ *                         its footer is missing.
+ *
+ * @return File offset just past the last valid record. Anything between
+ *         it and `file_size` is torn or stale.
+ */
+long ts_log_read_tail(FILE *file, long file_size, uint16_t record_size, ts_log_block_t *block);
+
+/**
+ * @brief Cuts a log back to its last intact record after a power loss.
+ *
+ * Only the end of the file is examined: the last full block must carry a
+ * valid footer, and the records after it must have matching sequence
+ * numbers and CRCs. Anything behind the last valid record is truncated, as
+ * are index entries for blocks that no longer exist. A full block whose
+ * footer was lost is cut back to its records, so the writer seals it again.
+ *
+ * @param[in]  file_path       Full path of the log.
+ * @param[out] truncated_bytes Optional; receives the number of bytes removed.
+ *
+ * @return
+ * - ESP_OK                if the log is consistent (possibly after truncation).
+ * - ESP_ERR_INVALID_STATE if the file is not a log of a compatible version.
+ * - ESP_ERR_NO_MEM        if the scan buffer could not be allocated.
+ * - ESP_FAIL              if the file could not be read or truncated.
+ */
+esp_err_t ts_log_recover(const char *file_path, size_t *truncated_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFEHAT_WORKNET_TS_LOG_H */
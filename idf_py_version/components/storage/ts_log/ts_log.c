@@ -0,0 +1,292 @@
+/* components/storage/ts_log/ts_log.c */
+
+#include "ts_log.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+
+/* Constants ******************************************************************/
+
+const char *ts_log_tag = "TS_LOG";
+
+_Static_assert(sizeof(ts_log_block_footer_t) == TS_LOG_BLOCK_FOOTER_SIZE,
+               "Block footer size does not match TS_LOG_BLOCK_FOOTER_SIZE");
+_Static_assert(sizeof(ts_log_block_t) == TS_LOG_BLOCK_SIZE,
+               "Block layout does not match TS_LOG_BLOCK_SIZE");
+
+/* Private (Static) Functions *************************************************/
+
+/**
+ * @brief Number of records of a given size that fit in one block.
+ */
+static inline uint16_t priv_block_capacity(uint16_t record_size)
+{
+  return (uint16_t)(sizeof(((ts_log_block_t *)0)->records) / record_size);
+}
+
+/**
+ * @brief Sequence number of a record, from its position in the file.
+ */
+static inline uint32_t priv_record_seq(uint32_t block_no, uint16_t record_size, uint16_t index)
+{
+  return block_no * priv_block_capacity(record_size) + index;
+}
+
+/**
+ * @brief CRC of a block's records and footer (with a zero CRC field).
+ */
+static uint32_t priv_block_crc(const ts_log_block_t *block)
+{
+  ts_log_block_footer_t footer = block->footer;
+  footer.crc32                 = 0;
+
+  uint32_t crc = esp_rom_crc32_le(0, block->records,
+                                  (uint32_t)block->footer.record_count * block->footer.record_size);
+  return esp_rom_crc32_le(crc, (const uint8_t *)&footer, sizeof(footer));
+}
+
+/**
+ * @brief Checks the sequence number and CRC of one record of a block.
+ *
+ * @param[in] block Block holding the record; `footer.block_no` and
+ *                  `footer.record_size` must be set.
+ * @param[in] index Position of the record in the block.
+ *
+ * @return `true` if the record belongs at this position and is intact.
+ */
+static bool priv_record_valid(const ts_log_block_t *block, uint16_t index)
+{
+  uint16_t       record_size = block->footer.record_size;
+  const uint8_t *record      = &block->records[(size_t)index * record_size];
+  size_t         crc_offset  = record_size - TS_LOG_RECORD_TRAILER;
+
+  uint32_t seq;
+  uint32_t crc;
+  memcpy(&seq, record, sizeof(seq));
+  memcpy(&crc, &record[crc_offset], sizeof(crc));
+  return seq == priv_record_seq(block->footer.block_no, record_size, index) &&
+         crc == esp_rom_crc32_le(0, record, (uint32_t)crc_offset);
+}
+
+/**
+ * @brief Widens a block's time range to include one record.
+ */
+static void priv_block_add_time(ts_log_block_footer_t *footer, int64_t time_ms)
+{
+  if (footer->record_count == 0 || time_ms < footer->min_time_ms) {
+    footer->min_time_ms = time_ms;
+  }
+  if (footer->record_count == 0 || time_ms > footer->max_time_ms) {
+    footer->max_time_ms = time_ms;
+  }
+}
+
+/* Public Functions ***********************************************************/
+
+void ts_log_file_header_init(ts_log_file_header_t *header, uint8_t sensor_id,
+                             uint32_t node_id, size_t payload_size)
+{
+  memset(header, 0, sizeof(*header));
+  header->magic       = TS_LOG_FILE_MAGIC;
+  header->version     = TS_LOG_VERSION;
+  header->sensor_id   = sensor_id;
+  header->record_size = (uint16_t)ts_log_record_size(payload_size);
+  header->node_id     = node_id;
+  header->block_size  = TS_LOG_BLOCK_SIZE;
+  header->header_size = TS_LOG_FILE_HEADER_SIZE;
+}
+
+esp_err_t ts_log_file_header_check(const ts_log_file_header_t *header)
+{
+  if (header->magic != TS_LOG_FILE_MAGIC || header->version != TS_LOG_VERSION ||
+      header->block_size != TS_LOG_BLOCK_SIZE || header->header_size != TS_LOG_FILE_HEADER_SIZE ||
+      header->record_size <= ts_log_record_size(0) || header->record_size > TS_LOG_MAX_RECORD_SIZE) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  return ESP_OK;
+}
+
+void ts_log_block_init(ts_log_block_t *block, uint32_t block_no, uint16_t record_size)
+{
+  memset(block, 0, sizeof(*block));
+  block->footer.magic       = TS_LOG_BLOCK_MAGIC;
+  block->footer.block_no    = block_no;
+  block->footer.record_size = record_size;
+}
+
+esp_err_t ts_log_block_append(ts_log_block_t *block, int64_t time_ms, uint8_t flags,
+                              const uint8_t *payload, size_t payload_size)
+{
+  ts_log_block_footer_t *footer = &block->footer;
+  if (ts_log_record_size(payload_size) != footer->record_size) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  if (ts_log_block_is_full(block)) {
+    return ESP_ERR_NO_MEM;
+  }
+
+  /* The ESP32 is little-endian, so the fields are stored as they are */
+  uint8_t *record = &block->records[(size_t)footer->record_count * footer->record_size];
+  uint32_t seq    = priv_record_seq(footer->block_no, footer->record_size, footer->record_count);
+  memcpy(record, &seq, sizeof(seq));
+  memcpy(&record[sizeof(seq)], &time_ms, sizeof(time_ms));
+  record[sizeof(seq) + sizeof(time_ms)] = flags;
+  memcpy(&record[TS_LOG_RECORD_HEADER], payload, payload_size);
+
+  uint32_t crc = esp_rom_crc32_le(0, record, (uint32_t)(TS_LOG_RECORD_HEADER + payload_size));
+  memcpy(&record[TS_LOG_RECORD_HEADER + payload_size], &crc, sizeof(crc));
+
+  priv_block_add_time(footer, time_ms);
+  footer->record_count++;
+  return ESP_OK;
+}
+
+bool ts_log_block_is_full(const ts_log_block_t *block)
+{
+  return block->footer.record_count >= priv_block_capacity(block->footer.record_size);
+}
+
+size_t ts_log_block_used(const ts_log_block_t *block)
+{
+  return (size_t)block->footer.record_count * block->footer.record_size;
+}
+
+void ts_log_block_seal(ts_log_block_t *block)
+{
+  block->footer.crc32 = priv_block_crc(block);
+}
+
+bool ts_log_block_verify(const ts_log_block_t *block, uint32_t block_no)
+{
+  const ts_log_block_footer_t *footer = &block->footer;
+  if (footer->magic != TS_LOG_BLOCK_MAGIC || footer->block_no != block_no ||
+      footer->record_size <= ts_log_record_size(0) || footer->record_size > TS_LOG_MAX_RECORD_SIZE ||
+      footer->record_count > priv_block_capacity(footer->record_size)) {
+    return false;
+  }
+  return footer->crc32 == priv_block_crc(block);
+}
+
+size_t ts_log_block_scan(ts_log_block_t *block, size_t length)
+{
+  ts_log_block_footer_t *footer   = &block->footer;
+  uint16_t               capacity = priv_block_capacity(footer->record_size);
+  uint16_t               count    = 0;
+
+  footer->record_count = 0;
+  while (count < capacity && (size_t)(count + 1) * footer->record_size <= length &&
+         priv_record_valid(block, count)) {
+    int64_t time_ms;
+    memcpy(&time_ms, &block->records[(size_t)count * footer->record_size + sizeof(uint32_t)],
+           sizeof(time_ms));
+    priv_block_add_time(footer, time_ms);
+    footer->record_count = ++count;
+  }
+
+  /* Whatever follows the last valid record is not part of the block */
+  size_t used = ts_log_block_used(block);
+  memset(&block->records[used], 0, sizeof(block->records) - used);
+  return used;
+}
+
+void ts_log_index_entry_init(const ts_log_block_t *block, ts_log_index_entry_t *entry)
+{
+  memset(entry, 0, sizeof(*entry));
+  entry->block_no     = block->footer.block_no;
+  entry->record_count = block->footer.record_count;
+  entry->min_time_ms  = block->footer.min_time_ms;
+  entry->max_time_ms  = block->footer.max_time_ms;
+}
+
+long ts_log_read_tail(FILE *file, long file_size, uint16_t record_size, ts_log_block_t *block)
+{
+  uint32_t full_blocks = (file_size > TS_LOG_FILE_HEADER_SIZE)
+                           ? (uint32_t)((file_size - TS_LOG_FILE_HEADER_SIZE) / TS_LOG_BLOCK_SIZE)
+                           : 0;
+  uint32_t tail_no     = full_blocks;
+
+  /* Only the last write can have been cut short, so only the last full block is checked */
+  if (full_blocks > 0) {
+    bool sealed = fseek(file, ts_log_block_offset(full_blocks - 1), SEEK_SET) == 0 &&
+                  fread(block, 1, sizeof(*block), file) == sizeof(*block) &&
+                  ts_log_block_verify(block, full_blocks - 1) &&
+                  block->footer.record_size == record_size;
+    if (!sealed) {
+      tail_no = full_blocks - 1;
+    }
+  }
+
+  long   tail_offset = ts_log_block_offset(tail_no);
+  size_t read        = 0;
+  ts_log_block_init(block, tail_no, record_size);
+  if (file_size > tail_offset && fseek(file, tail_offset, SEEK_SET) == 0) {
+    size_t length = (size_t)(file_size - tail_offset);
+    if (length > sizeof(block->records)) {
+      length = sizeof(block->records);
+    }
+    read = fread(block->records, 1, length, file);
+  }
+  return tail_offset + (long)ts_log_block_scan(block, read);
+}
+
+esp_err_t ts_log_recover(const char *file_path, size_t *truncated_bytes)
+{
+  if (truncated_bytes != NULL) {
+    *truncated_bytes = 0;
+  }
+
+  FILE *file = fopen(file_path, "rb");
+  if (file == NULL) {
+    ESP_LOGE(ts_log_tag, "Failed to open %s", file_path);
+    return ESP_FAIL;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  long keep = 0;
+
+  /* A file cut off inside its header holds no records; the writer starts it over */
+  ts_log_file_header_t header;
+  if (size >= TS_LOG_FILE_HEADER_SIZE) {
+    if (fseek(file, 0, SEEK_SET) != 0 || fread(&header, 1, sizeof(header), file) != sizeof(header) ||
+        ts_log_file_header_check(&header) != ESP_OK) {
+      fclose(file);
+      return ESP_ERR_INVALID_STATE;
+    }
+
+    ts_log_block_t *block = malloc(sizeof(*block));
+    if (block == NULL) {
+      fclose(file);
+      return ESP_ERR_NO_MEM;
+    }
+    keep = ts_log_read_tail(file, size, header.record_size, block);
+
+    /* Index entries are only written for sealed blocks in front of the tail */
+    char        index_path[128];
+    struct stat index_stat;
+    off_t       index_size = (off_t)block->footer.block_no * sizeof(ts_log_index_entry_t);
+    snprintf(index_path, sizeof(index_path), "%s" TS_LOG_INDEX_SUFFIX, file_path);
+    if (stat(index_path, &index_stat) == 0 && index_stat.st_size > index_size) {
+      truncate(index_path, index_size);
+    }
+    free(block);
+  }
+  fclose(file);
+
+  if (keep >= size) {
+    return ESP_OK;
+  }
+  if (truncate(file_path, keep) != 0) {
+    ESP_LOGE(ts_log_tag, "Failed to truncate %s to %ld bytes", file_path, keep);
+    return ESP_FAIL;
+  }
+  ESP_LOGW(ts_log_tag, "%s: cut %ld bytes of torn or stale data", file_path, size - keep);
+  if (truncated_bytes != NULL) {
+    *truncated_bytes = (size_t)(size - keep);
+  }
+  return ESP_OK;
+}
@@ -0,0 +1,239 @@
+/* host_test/fall_detector_replay.c
+ *
+ * Feeds recorded or synthetic IMU traces through fall_detector.c and
+ * reports the CPU time of every `fall_detector_update` call and how the
+ * raised events compare with the labels in the trace.
+ *
+ * A trace is a CSV file with the columns
+ *
+ *   timestamp_ms,accel_x_g,accel_y_g,accel_z_g,gyro_x_dps,gyro_y_dps,gyro_z_dps,label
+ *
+ * Lines starting with '#' and the header line are skipped. `label` is empty
+ * except on the sample where an event happened: "impact" for a knock the
+ * wearer walks away from, "fall" for the impact of a fall. A label is
+ * detected when the detector raises an event of that type whose impact peak
+ * lies within `MATCH_WINDOW_MS` of it; the impact event that precedes every
+ * fall event counts as part of the fall. Any other event is a false alarm.
+ * The detection delay is the time from the label to the sample that raised
+ * the event.
+ *
+ * Usage: fall_detector_replay <trace.csv>...
+ * Exits with 1 if any label was missed or any false alarm was raised.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fall_detector.h"
+
+#define MATCH_WINDOW_MS (250)
+#define MAX_SAMPLES     (200000) /* ~16 minutes at 200 Hz */
+#define MAX_LABELS      (64)
+
+typedef struct {
+  int64_t timestamp_us;
+  float   accel[3];
+  float   gyro[3];
+} replay_sample_t;
+
+typedef struct {
+  int64_t                    timestamp_us;
+  fall_detector_event_type_t type;
+  bool                       matched;
+  int64_t                    delay_us;
+} replay_label_t;
+
+typedef struct {
+  uint32_t labels;
+  uint32_t detected;
+  uint32_t missed;
+  uint32_t false_alarms;
+} replay_score_t;
+
+static replay_sample_t s_samples[MAX_SAMPLES];
+static uint32_t        s_update_ns[MAX_SAMPLES];
+static replay_label_t  s_labels[MAX_LABELS];
+
+static int64_t priv_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int priv_compare_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* Reads a trace; returns the number of samples or -1 on error */
+static long priv_load(const char *path, size_t *label_count)
+{
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  char   line[256];
+  long   count  = 0;
+  size_t number = 0;
+  *label_count  = 0;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    number++;
+    if (line[0] == '#' || line[0] == '\n' || strncmp(line, "timestamp", 9) == 0) {
+      continue;
+    }
+    if (count == MAX_SAMPLES) {
+      fprintf(stderr, "%s: more than %d samples\n", path, MAX_SAMPLES);
+      fclose(file);
+      return -1;
+    }
+
+    double           time_ms;
+    char             label[32] = "";
+    replay_sample_t *sample    = &s_samples[count];
+    int fields = sscanf(line, "%lf,%f,%f,%f,%f,%f,%f,%31[a-z]", &time_ms,
+                        &sample->accel[0], &sample->accel[1], &sample->accel[2],
+                        &sample->gyro[0], &sample->gyro[1], &sample->gyro[2], label);
+    if (fields < 7) {
+      fprintf(stderr, "%s:%zu: expected 7 numbers\n", path, number);
+      fclose(file);
+      return -1;
+    }
+    sample->timestamp_us = llround(time_ms * 1000.0);
+
+    if (label[0] != '\0') {
+      fall_detector_event_type_t type;
+      if (strcmp(label, "fall") == 0) {
+        type = k_fall_detector_event_fall;
+      } else if (strcmp(label, "impact") == 0) {
+        type = k_fall_detector_event_impact;
+      } else {
+        fprintf(stderr, "%s:%zu: unknown label '%s'\n", path, number, label);
+        fclose(file);
+        return -1;
+      }
+      if (*label_count < MAX_LABELS) {
+        s_labels[(*label_count)++] = (replay_label_t){ .timestamp_us = sample->timestamp_us, .type = type };
+      }
+    }
+    count++;
+  }
+  fclose(file);
+  return count;
+}
+
+/* Matches an event against the labels; returns whether it is expected */
+static bool priv_match(const fall_detector_event_t *event, int64_t raised_us, size_t label_count)
+{
+  for (size_t i = 0; i < label_count; i++) {
+    replay_label_t *label = &s_labels[i];
+    if (llabs(event->timestamp_us - label->timestamp_us) > MATCH_WINDOW_MS * 1000) {
+      continue;
+    }
+    if (event->type == label->type && !label->matched) {
+      label->matched  = true;
+      label->delay_us = raised_us - label->timestamp_us;
+      return true;
+    }
+    if (event->type == k_fall_detector_event_impact && label->type == k_fall_detector_event_fall) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void priv_replay(const char *path, replay_score_t *total, uint32_t *all_ns, size_t *all_count)
+{
+  size_t label_count = 0;
+  long   count       = priv_load(path, &label_count);
+  if (count < 0) {
+    total->missed++;
+    return;
+  }
+
+  fall_detector_t       detector;
+  fall_detector_event_t event;
+  replay_score_t        score = { .labels = (uint32_t)label_count };
+  fall_detector_init(&detector);
+
+  for (long i = 0; i < count; i++) {
+    int64_t start_ns = priv_now_ns();
+    bool    raised   = fall_detector_update(&detector, s_samples[i].timestamp_us,
+                                            s_samples[i].accel, s_samples[i].gyro, &event);
+    s_update_ns[i] = (uint32_t)(priv_now_ns() - start_ns);
+
+    if (raised && !priv_match(&event, s_samples[i].timestamp_us, label_count)) {
+      score.false_alarms++;
+      printf("  %s: false %s at %.2f s (peak %.2f g)\n", path,
+             event.type == k_fall_detector_event_fall ? "fall" : "impact",
+             event.timestamp_us / 1e6, event.peak_g);
+    }
+  }
+
+  int64_t max_delay_us = 0;
+  for (size_t i = 0; i < label_count; i++) {
+    if (s_labels[i].matched) {
+      score.detected++;
+      max_delay_us = (s_labels[i].delay_us > max_delay_us) ? s_labels[i].delay_us : max_delay_us;
+    } else {
+      score.missed++;
+      printf("  %s: missed %s at %.2f s\n", path,
+             s_labels[i].type == k_fall_detector_event_fall ? "fall" : "impact",
+             s_labels[i].timestamp_us / 1e6);
+    }
+  }
+
+  memcpy(&all_ns[*all_count], s_update_ns, count * sizeof(uint32_t));
+  *all_count += count;
+  qsort(s_update_ns, count, sizeof(uint32_t), priv_compare_u32);
+  double mean_ns = 0;
+  for (long i = 0; i < count; i++) {
+    mean_ns += s_update_ns[i];
+  }
+  mean_ns /= (count > 0) ? count : 1;
+
+  const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+  printf("%-22s %7ld %6u %8u %6u %6u %9.0f %8.0f %8u %8u\n", name, count, score.labels,
+         score.detected, score.missed, score.false_alarms, max_delay_us / 1000.0, mean_ns,
+         count ? s_update_ns[(count * 99) / 100] : 0, count ? s_update_ns[count - 1] : 0);
+
+  total->labels       += score.labels;
+  total->detected     += score.detected;
+  total->missed       += score.missed;
+  total->false_alarms += score.false_alarms;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <trace.csv>...\n", argv[0]);
+    return 2;
+  }
+
+  static uint32_t all_ns[MAX_SAMPLES * 4];
+  size_t          all_count = 0;
+  replay_score_t  total     = { 0 };
+
+  printf("%-22s %7s %6s %8s %6s %6s %9s %8s %8s %8s\n", "trace", "samples", "labels",
+         "detected", "missed", "false", "delay ms", "mean ns", "p99 ns", "max ns");
+  for (int i = 1; i < argc; i++) {
+    if (all_count + MAX_SAMPLES > sizeof(all_ns) / sizeof(all_ns[0])) {
+      all_count = 0; /* Only the latency summary loses history */
+    }
+    priv_replay(argv[i], &total, all_ns, &all_count);
+  }
+
+  qsort(all_ns, all_count, sizeof(uint32_t), priv_compare_u32);
+  printf("fall_detector_replay: %u/%u labels detected, %u missed, %u false alarms; "
+         "update p50 %u ns, p99 %u ns over %zu samples\n",
+         total.detected, total.labels, total.missed, total.false_alarms,
+         all_count ? all_ns[all_count / 2] : 0, all_count ? all_ns[(all_count * 99) / 100] : 0,
+         all_count);
+  return (total.missed || total.false_alarms) ? 1 : 0;
+}
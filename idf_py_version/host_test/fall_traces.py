@@ -0,0 +1,151 @@
+"""Writes synthetic MPU6050 traces for fall_detector_replay.
+
+Each trace is a CSV of 200 Hz samples in the units the HAL hands to the
+detector (g and deg/s) with sensor noise, and a label column naming the
+event a correct detector raises around that sample. Recordings from a
+helmet in the same format can be replayed next to these.
+
+Usage: fall_traces.py <output directory>
+"""
+import math
+import os
+import random
+import sys
+
+RATE_HZ = 200
+HEADER = "timestamp_ms,accel_x_g,accel_y_g,accel_z_g,gyro_x_dps,gyro_y_dps,gyro_z_dps,label"
+
+
+class Trace:
+    def __init__(self, seed):
+        self.rng = random.Random(seed)
+        self.rows = []
+        self.t_ms = 0.0
+        self.gravity = (0.0, 0.0, 1.0)
+
+    def _emit(self, accel, gyro, label=""):
+        noisy_a = [a + self.rng.gauss(0.0, 0.02) for a in accel]
+        noisy_g = [g + self.rng.gauss(0.0, 1.0) for g in gyro]
+        self.rows.append((self.t_ms, *noisy_a, *noisy_g, label))
+        self.t_ms += 1000.0 / RATE_HZ
+
+    def still(self, seconds, gravity=None):
+        if gravity is not None:
+            self.gravity = gravity
+        for _ in range(int(seconds * RATE_HZ)):
+            self._emit(self.gravity, (0.0, 0.0, 0.0))
+
+    def walk(self, seconds, amplitude_g=0.3, step_hz=1.8):
+        for i in range(int(seconds * RATE_HZ)):
+            phase = 2 * math.pi * step_hz * i / RATE_HZ
+            bounce = amplitude_g * math.sin(phase)
+            sway = 0.1 * math.sin(phase / 2)
+            accel = (self.gravity[0] + sway, self.gravity[1], self.gravity[2] + bounce)
+            self._emit(accel, (15 * math.sin(phase / 2), 8 * math.cos(phase), 5.0))
+
+    def free_fall(self, seconds, residual_g=0.08):
+        for _ in range(int(seconds * RATE_HZ)):
+            self._emit((residual_g, 0.0, residual_g), (90.0, 40.0, 0.0))
+
+    def impact(self, peak_g, seconds=0.03, direction=(0.7, 0.0, 0.7), label=""):
+        samples = max(1, int(seconds * RATE_HZ))
+        norm = math.sqrt(sum(d * d for d in direction))
+        for i in range(samples):
+            # Half-sine pulse; the label sits on the peak sample
+            level = peak_g * math.sin(math.pi * (i + 0.5) / samples)
+            accel = tuple(level * d / norm for d in direction)
+            self._emit(accel, (250.0, 120.0, 60.0), label if i == samples // 2 else "")
+
+    def rotate_to(self, gravity, seconds, rate_dps=60.0):
+        start = self.gravity
+        steps = int(seconds * RATE_HZ)
+        for i in range(1, steps + 1):
+            f = i / steps
+            g = [start[k] + f * (gravity[k] - start[k]) for k in range(3)]
+            n = math.sqrt(sum(x * x for x in g))
+            self._emit(tuple(x / n for x in g), (rate_dps, 0.0, 0.0))
+        self.gravity = gravity
+
+    def write(self, path):
+        with open(path, "w") as f:
+            f.write(HEADER + "\n")
+            for row in self.rows:
+                f.write("%.1f,%.4f,%.4f,%.4f,%.2f,%.2f,%.2f,%s\n" % row)
+
+
+SIDE = (1.0, 0.0, 0.0)
+UPRIGHT = (0.0, 0.0, 1.0)
+
+
+def fall_from_height(t):
+    t.walk(3)
+    t.free_fall(0.35)
+    t.impact(5.0, label="fall")
+    t.still(3, SIDE)
+
+
+def trip_and_fall(t):
+    """No free fall: a stumble straight into the ground"""
+    t.walk(3)
+    t.impact(3.5, seconds=0.05, label="fall")
+    t.still(3, SIDE)
+
+
+def fall_then_stir(t):
+    """Lies down after the impact but moves for a while before settling"""
+    t.still(2)
+    t.free_fall(0.25)
+    t.impact(4.0, label="fall")
+    t.rotate_to(SIDE, 0.4)
+    t.walk(1.0, amplitude_g=0.4)
+    t.still(2.5, SIDE)
+
+
+def head_bump(t):
+    """Knocks the helmet on a beam and walks on"""
+    t.walk(3)
+    t.impact(3.2, seconds=0.02, direction=(0.0, 1.0, 0.3), label="impact")
+    t.walk(4)
+
+
+def jump_down(t):
+    """Jumps off a step and lands upright"""
+    t.walk(2)
+    t.free_fall(0.2)
+    t.impact(2.9, seconds=0.06, direction=(0.0, 0.0, 1.0), label="impact")
+    t.walk(4)
+
+
+def sit_down(t):
+    t.walk(2)
+    for _ in range(int(0.15 * RATE_HZ)):
+        t._emit((0.0, 0.0, 0.55), (0.0, 20.0, 0.0))
+    t.still(4)
+
+
+def lie_down(t):
+    """Lies down on purpose: new orientation without an impact"""
+    t.walk(2)
+    t.rotate_to(SIDE, 1.5)
+    t.still(4, SIDE)
+
+
+def walk(t):
+    t.walk(10, amplitude_g=0.6)
+
+
+TRACES = [fall_from_height, trip_and_fall, fall_then_stir, head_bump, jump_down,
+          sit_down, lie_down, walk]
+
+
+def main(out_dir):
+    os.makedirs(out_dir, exist_ok=True)
+    for seed, build in enumerate(TRACES):
+        trace = Trace(seed)
+        build(trace)
+        trace.write(os.path.join(out_dir, build.__name__ + ".csv"))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1]))
@@ -0,0 +1,233 @@
+/* host_test/file_write_bench.c
+ *
+ * Pushes a helmet-like mix of records through file_write_manager.c and
+ * reports records/s, bytes/s, write calls and opens, next to the writer it
+ * replaced, which opened, appended to and closed the file for every record.
+ *
+ * Each cycle of the mix is eight MPU6050 frames, one frame each from the
+ * DHT22, MQ135 and GPS, and one alert line. The producer keeps at most
+ * `WINDOW` records in flight so the ring buffer never rejects one. The run
+ * ends with a flush that is allowed no time at all, a few more records and
+ * the shutdown handlers `esp_restart` would call. A flush after that must
+ * find nothing left to write, which checks that the late wakeup of the
+ * timed-out flush cannot end the shutdown flush early.
+ *
+ * Usage: file_write_bench [directory]
+ * The directory defaults to build/sdcard. Pointing it at a loop-mounted FAT
+ * image measures the host's FAT driver instead of its native file system.
+ */
+
+#include <dirent.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "file_write_manager.h"
+#include "idf_host.h"
+#include "sd_card_hal.h"
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+
+#define CYCLES (20000)
+#define WINDOW (48)
+
+typedef struct {
+  const char *name;
+  uint8_t     data[64];
+  size_t      len;
+  bool        frame;
+} bench_record_t;
+
+static bench_record_t s_mix[12];
+static size_t         s_mix_len = 0;
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+static int64_t priv_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void priv_add_frame(const char *name, sensor_frame_id_t sensor_id, const void *data)
+{
+  bench_record_t *record = &s_mix[s_mix_len++];
+  record->name  = name;
+  record->frame = true;
+  sensor_frame_encode(sensor_id, data, record->data, sizeof(record->data), &record->len);
+}
+
+static void priv_add_text(const char *name, const char *text)
+{
+  bench_record_t *record = &s_mix[s_mix_len++];
+  record->name  = name;
+  record->frame = false;
+  record->len   = strnlen(text, sizeof(record->data));
+  memcpy(record->data, text, record->len);
+}
+
+static void priv_build_mix(void)
+{
+  mpu6050_data_t    mpu6050 = { .accel_x = 0.012f, .accel_y = -0.981f, .accel_z = 0.1234f,
+                                .gyro_x = 1.25f, .gyro_y = -2.5f, .gyro_z = 0.31f, .temperature = 31.3f };
+  dht22_data_t      dht22   = { .temperature_c = 23.47f, .temperature_f = 74.246f, .humidity = 41.26f };
+  mq135_data_t      mq135   = { .raw_adc_value = 2871, .gas_concentration = 418.375f };
+  gy_neo6mv2_data_t gps     = { .latitude = -33.8568f, .longitude = 151.2153f, .speed = 1.42f,
+                                .time = "093015.25", .fix_status = 1, .satellite_count = 7, .hdop = 1.3f };
+
+  for (int i = 0; i < 8; i++) {
+    priv_add_frame("mpu6050.tsl", k_sensor_frame_id_mpu6050, &mpu6050);
+  }
+  priv_add_frame("dht22.tsl", k_sensor_frame_id_dht22, &dht22);
+  priv_add_frame("mq135.tsl", k_sensor_frame_id_mq135, &mq135);
+  priv_add_frame("gy_neo6mv2.tsl", k_sensor_frame_id_gy_neo6mv2, &gps);
+  priv_add_text("alerts.txt", "impact peak=3.42g duration=18ms orientation=upright");
+}
+
+/* Waits until the write task has taken all but `window` of `sent` records */
+static void priv_wait_window(uint32_t sent, uint32_t window)
+{
+  file_write_stats_t stats;
+  do {
+    file_write_manager_get_stats(&stats);
+    if (sent - stats.records - stats.records_dropped <= window) {
+      return;
+    }
+    sched_yield();
+  } while (1);
+}
+
+static void priv_send(const bench_record_t *record)
+{
+  if (record->frame) {
+    file_write_log_frame(record->name, record->data, record->len);
+  } else {
+    file_write_reservation_t reservation;
+    if (file_write_reserve(record->name, record->len, &reservation) == ESP_OK) {
+      memcpy(reservation.data, record->data, record->len);
+      file_write_commit(&reservation, record->len);
+    }
+  }
+}
+
+/* Sums the sizes of the regular files below `path` */
+static uint64_t priv_tree_size(const char *path)
+{
+  uint64_t size = 0;
+  DIR     *dir  = opendir(path);
+  if (dir == NULL) {
+    return 0;
+  }
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    char        child[512];
+    struct stat st;
+    snprintf(child, sizeof(child), "%s/%s", path, entry->d_name);
+    if (stat(child, &st) != 0) {
+      continue;
+    }
+    size += S_ISDIR(st.st_mode) ? priv_tree_size(child) : (uint64_t)st.st_size;
+  }
+  closedir(dir);
+  return size;
+}
+
+/* The replaced writer: one fopen/fwrite/fclose per record, with the line formatted by the producer */
+static void priv_bench_legacy(uint32_t records)
+{
+  char dir_path[256];
+  snprintf(dir_path, sizeof(dir_path), "%s/legacy", sd_card_mount_path);
+  mkdir(dir_path, 0775);
+
+  uint64_t bytes = 0;
+  int64_t  start = priv_now_ns();
+  for (uint32_t i = 0; i < records; i++) {
+    const bench_record_t *record = &s_mix[i % s_mix_len];
+    char                  path[MAX_FILE_PATH_LENGTH * 4];
+    char                  line[FILE_WRITE_TIMESTAMP_LENGTH + sizeof(record->data) + 1];
+    time_t                now = time(NULL);
+    snprintf(path, sizeof(path), "%s/%s", dir_path, record->name);
+    size_t len = strftime(line, sizeof(line), "%Y-%m-%d %H:%M:%S ", localtime(&now));
+    memcpy(&line[len], record->data, record->len);
+    len += record->len;
+    line[len++] = '\n';
+
+    FILE *file = fopen(path, "a");
+    if (file != NULL) {
+      bytes += fwrite(line, 1, len, file);
+      fclose(file);
+    }
+  }
+  double seconds = (priv_now_ns() - start) / 1e9;
+
+  printf("%-8s %9u %11.0f %8.2f %12u %7u\n", "legacy", records, records / seconds,
+         bytes / seconds / 1e6, records, records);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1) {
+    sd_card_mount_path = argv[1];
+  }
+  priv_build_mix();
+  if (file_write_manager_init() != ESP_OK) {
+    fprintf(stderr, "file_write_manager_init failed\n");
+    return 1;
+  }
+
+  printf("file_write_bench: %d cycles of %zu records into %s\n", CYCLES, s_mix_len, sd_card_mount_path);
+  printf("%-8s %9s %11s %8s %12s %7s\n", "writer", "records", "records/s", "MB/s", "write calls", "opens");
+
+  uint32_t sent  = 0;
+  int64_t  start = priv_now_ns();
+  for (int cycle = 0; cycle < CYCLES; cycle++) {
+    for (size_t i = 0; i < s_mix_len; i++) {
+      priv_wait_window(sent, WINDOW);
+      priv_send(&s_mix[i]);
+      sent++;
+    }
+  }
+  file_write_manager_flush(portMAX_DELAY);
+  double seconds = (priv_now_ns() - start) / 1e9;
+
+  file_write_stats_t stats;
+  file_write_manager_get_stats(&stats);
+  printf("%-8s %9u %11.0f %8.2f %12u %7u\n", "manager", stats.records, stats.records / seconds,
+         stats.bytes_written / seconds / 1e6, stats.write_calls, stats.opens);
+  printf("%-8s ring peak %u of %u bytes, %.1f records per write call, %u flushes\n", "",
+         stats.ring_peak_bytes, (unsigned)file_write_ring_size,
+         (double)stats.records / (stats.write_calls ? stats.write_calls : 1), stats.flushes);
+
+  priv_bench_legacy(sent);
+
+  /* Shutdown path: a flush that times out at once leaves its wakeup behind */
+  char log_path[256];
+  snprintf(log_path, sizeof(log_path), "%s/%s", sd_card_mount_path, file_write_segment_root);
+  file_write_manager_flush(0);
+  for (size_t i = 0; i < s_mix_len; i++) {
+    priv_send(&s_mix[i]);
+    sent++;
+  }
+  host_run_shutdown_handlers();
+  uint64_t after_shutdown = priv_tree_size(log_path);
+  file_write_manager_flush(portMAX_DELAY);
+  uint64_t after_flush = priv_tree_size(log_path);
+  file_write_manager_get_stats(&stats);
+
+  /* Anything a second flush still writes was missed by the shutdown flush */
+  bool ok = (stats.records == sent && stats.records_dropped == 0 && stats.bytes_dropped == 0 &&
+             after_shutdown == after_flush);
+  printf("file_write_bench: shutdown flush %s (%u of %u records accepted, %llu of %llu bytes on disk)\n",
+         ok ? "ok" : "FAILED", stats.records, sent, (unsigned long long)after_shutdown,
+         (unsigned long long)after_flush);
+  return ok ? 0 : 1;
+}
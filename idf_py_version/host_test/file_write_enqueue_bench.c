@@ -0,0 +1,256 @@
+/* host_test/file_write_enqueue_bench.c
+ *
+ * Measures what a producer pays to hand a record to the SD card writer and
+ * how much RAM records occupy while they wait, for the reserve/commit ring
+ * buffer of file_write_manager.c and for the request queue it replaced:
+ * ten 320-byte `file_write_request_t` items copied by value, with the path
+ * and the timestamped line formatted by the producer.
+ *
+ * Every call is timed on its own while the write task drains the ring into
+ * a host directory, so the percentiles include contention with it. The
+ * replaced path is rebuilt here on a host FreeRTOS queue drained by its own
+ * task, and gets the JSON document the HALs used to log for each reading.
+ * Preparing a record is timed apart from handing it over: encoding the
+ * frame for the ring, formatting the timestamped line for the queue. The
+ * "bytes" column is the encoded or formatted size for those rows, and what
+ * a record occupies while waiting for the others. The write task parses
+ * and stores every frame between the calls while the replaced queue's task
+ * only takes them, so the ring rows also pay for the cache lines the write
+ * task displaces.
+ *
+ * Before the timed runs the MPU6050 burst pattern (twenty frames and an
+ * alert at once, every 100 ms) is sent to report the ring's peak occupancy,
+ * followed by one 600-byte record the old queue would have cut to 256 bytes.
+ *
+ * Usage: file_write_enqueue_bench [directory]
+ */
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "file_write_manager.h"
+#include "idf_host.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "sd_card_hal.h"
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+
+#define CALLS       (100000)
+#define WINDOW      (48)
+#define RING_HEADER (8) /* Header the ESP-IDF ring buffer puts in front of each item */
+
+/* The request of the replaced queue */
+typedef struct {
+  char file_path[MAX_FILE_PATH_LENGTH];
+  char data[256];
+} legacy_request_t;
+
+static const char   *s_mpu6050_json = "{\"sensor_type\":\"accelerometer_gyroscope\",\"accel_x\":0.012,"
+                                      "\"accel_y\":-0.981,\"accel_z\":0.1234,\"gyro_x\":1.25,"
+                                      "\"gyro_y\":-2.5,\"gyro_z\":0.31,\"temperature\":31.3}";
+static const char   *s_alert        = "impact peak=3.42g duration=18ms orientation=upright";
+static uint32_t      s_call_ns[CALLS];
+static QueueHandle_t s_legacy_queue = NULL;
+static uint32_t      s_sent         = 0;
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+static int64_t priv_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int priv_compare_u32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *)a;
+  uint32_t y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+/* Waits until the write task has taken all but `WINDOW` of the records sent */
+static void priv_wait_window(void)
+{
+  file_write_stats_t stats;
+  do {
+    file_write_manager_get_stats(&stats);
+    if (s_sent - stats.records - stats.records_dropped <= WINDOW) {
+      return;
+    }
+    sched_yield();
+  } while (1);
+}
+
+/* Bytes one record occupies in the ring, as laid out by the manager */
+static size_t priv_ring_bytes(const char *name, size_t data_len)
+{
+  /* time_t, data_len, name_len and type, padded like file_write_record_t */
+  size_t record = sizeof(time_t) + sizeof(uint16_t) + 2 * sizeof(uint8_t);
+  record        = (record + sizeof(time_t) - 1) & ~(sizeof(time_t) - 1);
+  return RING_HEADER + ((record + strlen(name) + data_len + 3) & ~(size_t)3);
+}
+
+/* A capacity of 0 marks a step that holds no record */
+static void priv_report(const char *path, size_t bytes, size_t capacity)
+{
+  char held[16] = "-";
+  if (capacity > 0) {
+    snprintf(held, sizeof(held), "%zu", capacity / bytes);
+  }
+  qsort(s_call_ns, CALLS, sizeof(uint32_t), priv_compare_u32);
+  printf("%-14s %8u %8u %9u %9zu %12s\n", path, s_call_ns[CALLS / 2], s_call_ns[(CALLS * 99) / 100],
+         s_call_ns[CALLS - 1], bytes, held);
+}
+
+static void priv_bench_encode(void)
+{
+  mpu6050_data_t mpu6050 = { .accel_x = 0.012f, .accel_y = -0.981f, .accel_z = 0.1234f,
+                             .gyro_x = 1.25f, .gyro_y = -2.5f, .gyro_z = 0.31f, .temperature = 31.3f };
+  uint8_t        frame[SENSOR_FRAME_MAX_SIZE];
+  size_t         frame_len = 0;
+
+  for (int i = 0; i < CALLS; i++) {
+    int64_t start = priv_now_ns();
+    sensor_frame_encode(k_sensor_frame_id_mpu6050, &mpu6050, frame, sizeof(frame), &frame_len);
+    s_call_ns[i] = (uint32_t)(priv_now_ns() - start);
+  }
+  priv_report("frame encode", frame_len, 0);
+}
+
+static void priv_bench_frame(void)
+{
+  mpu6050_data_t mpu6050 = { .accel_x = 0.012f, .accel_y = -0.981f, .accel_z = 0.1234f,
+                             .gyro_x = 1.25f, .gyro_y = -2.5f, .gyro_z = 0.31f, .temperature = 31.3f };
+  uint8_t        frame[SENSOR_FRAME_MAX_SIZE];
+  size_t         frame_len = 0;
+  sensor_frame_encode(k_sensor_frame_id_mpu6050, &mpu6050, frame, sizeof(frame), &frame_len);
+
+  for (int i = 0; i < CALLS; i++) {
+    priv_wait_window();
+    int64_t start = priv_now_ns();
+    file_write_log_frame("mpu6050.tsl", frame, frame_len);
+    s_call_ns[i] = (uint32_t)(priv_now_ns() - start);
+    s_sent++;
+  }
+  priv_report("ring frame", priv_ring_bytes("mpu6050.tsl", frame_len), file_write_ring_size);
+}
+
+static void priv_bench_text(void)
+{
+  size_t len = strlen(s_alert);
+  for (int i = 0; i < CALLS; i++) {
+    priv_wait_window();
+    int64_t                  start = priv_now_ns();
+    file_write_reservation_t reservation;
+    if (file_write_reserve("alerts.txt", len, &reservation) == ESP_OK) {
+      memcpy(reservation.data, s_alert, len);
+      file_write_commit(&reservation, len);
+    }
+    s_call_ns[i] = (uint32_t)(priv_now_ns() - start);
+    s_sent++;
+  }
+  priv_report("ring text", priv_ring_bytes("alerts.txt", len), file_write_ring_size);
+}
+
+/* Drains the replaced queue; the writes themselves are left out */
+static void priv_legacy_task(void *param)
+{
+  legacy_request_t request;
+  while (1) {
+    xQueueReceive(s_legacy_queue, &request, portMAX_DELAY);
+    __asm__ volatile("" : : "r"(&request) : "memory");
+  }
+}
+
+/* The formatting half of the replaced `file_write_enqueue`, minus its log line */
+static void priv_legacy_format(legacy_request_t *request, const char *file_path, const char *data)
+{
+  char      timestamp[32] = { '\0' };
+  time_t    now           = time(NULL);
+  struct tm timeinfo;
+
+  localtime_r(&now, &timeinfo);
+  strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &timeinfo);
+  snprintf(request->file_path, MAX_FILE_PATH_LENGTH, "%s/%s", sd_card_mount_path, file_path);
+  snprintf(request->data, sizeof(request->data), "%s %s\n", timestamp, data);
+}
+
+static void priv_bench_legacy(void)
+{
+  legacy_request_t request;
+  s_legacy_queue = xQueueCreate(10, sizeof(legacy_request_t));
+  xTaskCreate(priv_legacy_task, "legacy", 4096, NULL, 3, NULL);
+
+  for (int i = 0; i < CALLS; i++) {
+    int64_t start = priv_now_ns();
+    priv_legacy_format(&request, "mpu6050.txt", s_mpu6050_json);
+    s_call_ns[i] = (uint32_t)(priv_now_ns() - start);
+  }
+  priv_report("legacy format", strlen(request.data), 0);
+
+  for (int i = 0; i < CALLS; i++) {
+    int64_t start = priv_now_ns();
+    xQueueSend(s_legacy_queue, &request, portMAX_DELAY);
+    s_call_ns[i] = (uint32_t)(priv_now_ns() - start);
+  }
+  priv_report("legacy queue", sizeof(legacy_request_t), 10 * sizeof(legacy_request_t));
+}
+
+/* The MPU6050 drains 20 samples every 100 ms and may raise an alert with them */
+static void priv_bench_burst(void)
+{
+  mpu6050_data_t mpu6050 = { .accel_z = 1.0f };
+  uint8_t        frame[SENSOR_FRAME_MAX_SIZE];
+  size_t         frame_len = 0;
+
+  for (int burst = 0; burst < 50; burst++) {
+    for (int i = 0; i < 20; i++) {
+      sensor_frame_encode(k_sensor_frame_id_mpu6050, &mpu6050, frame, sizeof(frame), &frame_len);
+      file_write_log_frame("mpu6050.tsl", frame, frame_len);
+    }
+    file_write_enqueue("alerts.txt", s_alert);
+    vTaskDelay(pdMS_TO_TICKS(100));
+  }
+
+  file_write_manager_flush(portMAX_DELAY);
+  file_write_stats_t stats;
+  file_write_manager_get_stats(&stats);
+
+  char large[600];
+  memset(large, 'x', sizeof(large));
+  large[sizeof(large) - 1] = '\0';
+  esp_err_t large_ret      = file_write_enqueue("imu_burst.txt", large);
+  s_sent += 20 * 50 + 50 + 1;
+
+  printf("burst: ring peak %u of %u bytes, %u records dropped; %zu-byte record %s\n",
+         stats.ring_peak_bytes, (unsigned)file_write_ring_size, stats.records_dropped,
+         sizeof(large) - 1, large_ret == ESP_OK ? "kept whole" : "rejected");
+}
+
+int main(int argc, char **argv)
+{
+  host_time_scale    = 10.0; /* Only shortens the 100 ms gaps between bursts */
+  sd_card_mount_path = (argc > 1) ? argv[1] : "build/sdcard_enqueue";
+  if (file_write_manager_init() != ESP_OK) {
+    fprintf(stderr, "file_write_manager_init failed\n");
+    return 1;
+  }
+
+  printf("file_write_enqueue_bench: %d calls per path; RAM is what the records wait in\n", CALLS);
+  priv_bench_burst();
+  printf("%-14s %8s %8s %9s %9s %12s\n", "path", "p50 ns", "p99 ns", "max ns", "bytes", "records held");
+  priv_bench_encode();
+  priv_bench_frame();
+  priv_bench_text();
+  priv_bench_legacy();
+  printf("legacy producer stack: %zu bytes for the request and timestamp\n", sizeof(legacy_request_t) + 32);
+  return 0;
+}
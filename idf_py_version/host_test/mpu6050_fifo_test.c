@@ -0,0 +1,440 @@
+/* host_test/mpu6050_fifo_test.c
+ *
+ * Runs mpu6050_hal.c, the I2C layers and the fall detector against the
+ * register/FIFO model in mpu6050_model.c:
+ *
+ * - init leaves the sample rate, ranges and FIFO configured, and the
+ *   data-ready interrupt off, as the sensor scheduler polls;
+ * - draining every `mpu6050_tick_period_ticks`, every sample arrives once,
+ *   in order and aligned, with a timestamp close to the time the model
+ *   produced it, for a fraction of a bus transaction each, and the sensor
+ *   raises no interrupt;
+ * - a stalled drain overflows the FIFO, which is counted and reset, and the
+ *   stream resumes aligned;
+ * - a fall waveform through `mpu6050_tick` raises an impact and a fall alert,
+ *   and a second reader of the sample ring still gets every sample the fall
+ *   detector read;
+ * - per sample, the 14-byte burst of `mpu6050_read` takes half the commands
+ *   of the two 6-byte reads it replaced and builds no command link, and the
+ *   FIFO drain takes less bus time than either;
+ * - `mpu6050_tasks` enables the interrupt and drains once per burst.
+ *
+ * Prints the timestamp error and the bus cost of each phase.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "idf_host.h"
+#include "mpu6050_model.h"
+#include "mpu6050_hal.h"
+#include "common/i2c.h"
+#include "common/i2c_bus.h"
+#include "file_write_manager.h"
+#include "sensor_frame.h"
+#include "fall_detector.h"
+
+static int s_failures = 0;
+
+#define CHECK(cond) do {                                                      \
+    if (!(cond)) {                                                            \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      s_failures++;                                                           \
+    }                                                                         \
+  } while (0)
+
+/* Stand-ins for the modules the HAL publishes to *****************************/
+
+static uint32_t s_frames_logged = 0;
+static uint32_t s_frames_queued = 0;
+static uint32_t s_alerts_logged = 0;
+static uint32_t s_alerts_sent   = 0;
+static uint8_t  s_alert_types[8];
+static char     s_alert_record[160];
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+esp_err_t file_write_log_frame(const char *file_name, const uint8_t *frame, size_t frame_len)
+{
+  CHECK(strcmp(file_name, "mpu6050.tsl") == 0);
+  s_frames_logged++;
+  return ESP_OK;
+}
+
+esp_err_t file_write_reserve(const char *file_name, size_t capacity,
+                             file_write_reservation_t *reservation)
+{
+  CHECK(strcmp(file_name, "alerts.txt") == 0);
+  CHECK(capacity <= sizeof(s_alert_record));
+  memset(reservation, 0, sizeof(*reservation));
+  reservation->data     = s_alert_record;
+  reservation->capacity = capacity;
+  return ESP_OK;
+}
+
+esp_err_t file_write_commit(file_write_reservation_t *reservation, size_t length)
+{
+  CHECK(reservation->data == s_alert_record && length > 0);
+  s_alerts_logged++;
+  return ESP_OK;
+}
+
+esp_err_t webserver_enqueue_frame(const uint8_t *frame, size_t frame_len)
+{
+  sensor_frame_header_t header;
+  CHECK(sensor_frame_parse_header(frame, frame_len, &header) == ESP_OK);
+  CHECK(header.sensor_id == k_sensor_frame_id_mpu6050);
+  s_frames_queued++;
+  return ESP_OK;
+}
+
+esp_err_t webserver_enqueue_alert(const uint8_t *frame, size_t frame_len)
+{
+  sensor_frame_header_t header;
+  CHECK(sensor_frame_parse_header(frame, frame_len, &header) == ESP_OK);
+  CHECK(header.sensor_id == k_sensor_frame_id_fall_alert);
+  if (s_alerts_sent < sizeof(s_alert_types)) {
+    s_alert_types[s_alerts_sent] = header.payload[0];
+  }
+  s_alerts_sent++;
+  return ESP_OK;
+}
+
+/* Helpers ********************************************************************/
+
+static mpu6050_data_t s_mpu6050;
+static uint32_t       s_cursor = 0; /* The test's own position in the sample ring */
+
+static uint32_t priv_bus_transactions(void)
+{
+  i2c_bus_stats_t stats;
+  i2c_get_bus_stats(mpu6050_i2c_bus, &stats);
+  return stats.transactions;
+}
+
+typedef struct {
+  uint32_t drains;
+  uint32_t samples;
+  uint32_t transactions;
+  uint32_t gaps;
+  uint32_t misaligned;
+  int64_t  max_error_us;
+  int64_t  total_error_us;
+} stream_result_t;
+
+/* Drains every tick period, as the scheduler does, for `duration_us` and
+ * checks each sample against the default waveform of the model */
+static void priv_stream(int64_t duration_us, stream_result_t *result)
+{
+  memset(result, 0, sizeof(*result));
+  uint32_t drains_before       = s_mpu6050.fifo_drains;
+  uint32_t transactions_before = priv_bus_transactions();
+  int64_t  end_us              = host_now_us() + duration_us;
+  int64_t  next_index          = -1;
+  int64_t  previous_us         = 0;
+
+  while (host_now_us() < end_us) {
+    vTaskDelay(mpu6050_tick_period_ticks);
+    CHECK(mpu6050_fifo_drain(&s_mpu6050) == ESP_OK);
+
+    mpu6050_sample_t samples[MPU6050_SAMPLE_RING_SIZE];
+    size_t           count = mpu6050_copy_samples(&s_cursor, samples, MPU6050_SAMPLE_RING_SIZE);
+    for (size_t i = 0; i < count; i++) {
+      /* Sample index in accel X, its negation in accel Y, 46.53 C */
+      int32_t index = (int32_t)lroundf(samples[i].accel_x * 2048.0f);
+      if (lroundf(samples[i].accel_y * 2048.0f) != -index ||
+          fabsf(samples[i].accel_z - 1.0f) > 1e-3f ||
+          fabsf(samples[i].temperature - 46.53f) > 0.01f) {
+        result->misaligned++;
+        continue;
+      }
+      if (next_index >= 0 && index != next_index) {
+        result->gaps++;
+      } else if (next_index >= 0) {
+        /* Samples are stamped at the FIFO sample period */
+        CHECK(samples[i].timestamp_us - previous_us == (1 + mpu6050_fifo_sample_rate_div) * 1000 ||
+              i == 0);
+      }
+      next_index  = index + 1;
+      previous_us = samples[i].timestamp_us;
+
+      int64_t produced_us = mpu6050_model_sample_time((uint32_t)index);
+      CHECK(produced_us >= 0);
+      int64_t error_us = llabs(samples[i].timestamp_us - produced_us);
+      result->total_error_us += error_us;
+      if (error_us > result->max_error_us) {
+        result->max_error_us = error_us;
+      }
+      result->samples++;
+    }
+  }
+
+  result->drains       = s_mpu6050.fifo_drains - drains_before;
+  result->transactions = priv_bus_transactions() - transactions_before;
+}
+
+static void priv_report(const char *phase, const stream_result_t *result)
+{
+  printf("  %-9s %5u samples %4u drains %5.1f samples/drain %5.3f transactions/sample "
+         "timestamp error mean %5.2f ms max %5.2f ms\n",
+         phase, result->samples, result->drains,
+         result->drains ? (double)result->samples / result->drains : 0.0,
+         result->samples ? (double)result->transactions / result->samples : 0.0,
+         result->samples ? result->total_error_us / 1000.0 / result->samples : 0.0,
+         result->max_error_us / 1000.0);
+}
+
+/* Standing, then 350 ms of free fall, a 4 g impact and lying on the side */
+static void priv_fall_waveform(void *ctx, uint32_t index, int64_t time_us, int16_t raw[7])
+{
+  int64_t t_us = time_us - *(const int64_t *)ctx;
+  memset(raw, 0, 7 * sizeof(int16_t));
+  raw[3] = 3400;
+  if (t_us < 500000) {
+    raw[2] = 2048;
+  } else if (t_us < 850000) {
+    raw[2] = 100;
+  } else if (t_us < 880000) {
+    raw[0] = 5800;
+    raw[2] = 5800;
+    raw[4] = 4000;
+  } else {
+    raw[0] = 2048;
+  }
+}
+
+/* Phases *********************************************************************/
+
+static void priv_check_init(void)
+{
+  CHECK(mpu6050_init(&s_mpu6050) == ESP_OK);
+  CHECK(s_mpu6050.state == k_mpu6050_ready);
+  CHECK(mpu6050_model_register(k_mpu6050_pwr_mgmt_1_cmd) == k_mpu6050_power_on_cmd);
+  CHECK(mpu6050_model_register(k_mpu6050_smplrt_div_cmd) == mpu6050_fifo_sample_rate_div);
+  CHECK(mpu6050_model_register(k_mpu6050_config_cmd) == mpu6050_config_dlpf);
+  CHECK(mpu6050_model_register(k_mpu6050_gyro_config_cmd) == k_mpu6050_gyro_fs_2000dps);
+  CHECK(mpu6050_model_register(k_mpu6050_accel_config_cmd) == k_mpu6050_accel_fs_16g);
+  CHECK(mpu6050_model_register(k_mpu6050_user_ctrl_cmd) == k_mpu6050_user_ctrl_fifo_en);
+  CHECK(mpu6050_model_register(k_mpu6050_fifo_en_cmd) == k_mpu6050_fifo_en_all_sensors);
+  CHECK(mpu6050_model_register(k_mpu6050_int_enable_cmd) == 0);
+
+  mpu6050_model_stats_t stats;
+  mpu6050_model_get_stats(&stats);
+  CHECK(stats.fifo_resets == 1);
+
+  /* The register path reads the same sample layout in one transaction */
+  uint32_t transactions = priv_bus_transactions();
+  CHECK(mpu6050_read(&s_mpu6050) == ESP_OK);
+  CHECK(priv_bus_transactions() - transactions == 1);
+  CHECK(lroundf(s_mpu6050.accel_y * 2048.0f) == -lroundf(s_mpu6050.accel_x * 2048.0f));
+  CHECK(fabsf(s_mpu6050.gyro_x - 10.0f) < 0.01f && fabsf(s_mpu6050.gyro_y + 10.0f) < 0.01f);
+
+  /* Reading the ring takes nothing away from other readers */
+  uint32_t         first  = s_cursor;
+  uint32_t         second = s_cursor;
+  mpu6050_sample_t sample;
+  CHECK(mpu6050_copy_samples(&first, &sample, 1) == 1);
+  CHECK(mpu6050_copy_samples(&second, &sample, 1) == 1);
+  CHECK(sample.accel_x == s_mpu6050.accel_x && first == second);
+  CHECK(mpu6050_copy_samples(&first, &sample, 1) == 0);
+  s_cursor = mpu6050_samples_cursor();
+}
+
+static void priv_check_stream(void)
+{
+  stream_result_t result;
+  priv_stream(2000 * 1000, &result);
+  priv_report("stream", &result);
+
+  CHECK(result.samples >= 350);
+  CHECK(result.gaps == 0);
+  CHECK(result.misaligned == 0);
+  CHECK(s_mpu6050.fifo_overflows == 0);
+  CHECK(result.samples >= result.drains * (mpu6050_fifo_burst_samples - 1));
+  CHECK(result.transactions <= 2 * result.drains);
+  CHECK(result.max_error_us < 20 * 1000);
+
+  mpu6050_model_stats_t stats;
+  mpu6050_model_get_stats(&stats);
+  CHECK(stats.interrupts == 0);
+}
+
+static void priv_check_overflow(void)
+{
+  mpu6050_model_stats_t before;
+  mpu6050_model_get_stats(&before);
+
+  /* 1024 bytes hold 73 samples, 365 ms at 200 Hz */
+  host_sleep_us(500 * 1000);
+  CHECK(mpu6050_fifo_drain(&s_mpu6050) == ESP_OK);
+  CHECK(s_mpu6050.fifo_overflows == 1);
+
+  mpu6050_model_stats_t after;
+  mpu6050_model_get_stats(&after);
+  CHECK(after.fifo_resets == before.fifo_resets + 1);
+  CHECK(after.fifo_dropped > before.fifo_dropped);
+
+  stream_result_t result;
+  priv_stream(1000 * 1000, &result);
+  priv_report("recovered", &result);
+  CHECK(result.samples >= 150);
+  CHECK(result.gaps == 0);
+  CHECK(result.misaligned == 0);
+  CHECK(s_mpu6050.fifo_overflows == 1);
+}
+
+static void priv_check_fall(void)
+{
+  static int64_t start_us;
+  start_us = host_now_us();
+  mpu6050_model_set_waveform(priv_fall_waveform, &start_us);
+
+  /* A second reader copies after every tick, behind the fall detector */
+  int64_t  end_us       = start_us + 3500 * 1000;
+  uint32_t samples_read = s_mpu6050.fifo_samples;
+  uint32_t copied       = 0;
+  s_cursor              = mpu6050_samples_cursor();
+  while (host_now_us() < end_us) {
+    vTaskDelay(mpu6050_tick_period_ticks);
+    mpu6050_tick(&s_mpu6050);
+
+    mpu6050_sample_t samples[MPU6050_SAMPLE_RING_SIZE];
+    copied += mpu6050_copy_samples(&s_cursor, samples, MPU6050_SAMPLE_RING_SIZE);
+  }
+  mpu6050_model_set_waveform(NULL, NULL);
+  CHECK(copied == s_mpu6050.fifo_samples - samples_read);
+
+  printf("  fall      %u alerts sent, %u logged, %u readings published\n",
+         s_alerts_sent, s_alerts_logged, s_frames_queued);
+  CHECK(s_alerts_sent == 2);
+  CHECK(s_alerts_logged == 2);
+  CHECK(s_alert_types[0] == k_fall_detector_event_impact);
+  CHECK(s_alert_types[1] == k_fall_detector_event_fall);
+  CHECK(strstr(s_alert_record, "\"event\":\"fall\"") != NULL);
+  CHECK(s_frames_queued >= 1 && s_frames_logged == s_frames_queued);
+  CHECK(s_mpu6050.fifo_overflows == 1);
+}
+
+static void priv_run_task(void *param)
+{
+  mpu6050_tasks(&s_mpu6050);
+}
+
+static void priv_check_task_mode(void)
+{
+  mpu6050_model_stats_t before;
+  mpu6050_model_get_stats(&before);
+  uint32_t drains_before  = s_mpu6050.fifo_drains;
+  uint32_t samples_before = s_mpu6050.fifo_samples;
+
+  xTaskCreate(priv_run_task, "mpu6050", 4096, NULL, 5, NULL);
+  host_sleep_us(2000 * 1000);
+
+  mpu6050_model_stats_t after;
+  mpu6050_model_get_stats(&after);
+  uint32_t drains  = s_mpu6050.fifo_drains - drains_before;
+  uint32_t samples = s_mpu6050.fifo_samples - samples_before;
+  printf("  task      %u interrupts, %u drains, %.1f samples/drain\n",
+         after.interrupts - before.interrupts, drains, drains ? (double)samples / drains : 0.0);
+  CHECK(mpu6050_model_register(k_mpu6050_int_enable_cmd) == k_mpu6050_int_enable_data_rdy);
+  CHECK(after.interrupts - before.interrupts >= 350);
+  CHECK(drains >= 15 && drains <= 25);
+  CHECK(samples >= drains * (mpu6050_fifo_burst_samples - 1));
+  CHECK(s_mpu6050.fifo_overflows == 1);
+}
+
+/* Bus cost per sample of `samples` acquisitions by `path` */
+typedef struct {
+  uint32_t         samples;
+  host_i2c_stats_t stats;
+} bus_cost_t;
+
+static void priv_cost_begin(bus_cost_t *cost)
+{
+  cost->samples = 0;
+  host_i2c_get_stats(mpu6050_i2c_bus, &cost->stats);
+}
+
+static void priv_cost_end(const char *path, bus_cost_t *cost)
+{
+  host_i2c_stats_t after;
+  host_i2c_get_stats(mpu6050_i2c_bus, &after);
+  cost->stats.commands     = after.commands - cost->stats.commands;
+  cost->stats.links_built  = after.links_built - cost->stats.links_built;
+  cost->stats.wire_bytes   = after.wire_bytes - cost->stats.wire_bytes;
+  cost->stats.wire_time_us = after.wire_time_us - cost->stats.wire_time_us;
+
+  double samples = cost->samples ? cost->samples : 1;
+  printf("  %-16s %5u samples %6.3f commands %6.3f links built %5.1f wire bytes %7.1f us bus time"
+         " per sample\n", path, cost->samples, cost->stats.commands / samples,
+         cost->stats.links_built / samples, cost->stats.wire_bytes / samples,
+         cost->stats.wire_time_us / samples);
+}
+
+static void priv_check_bus_cost(void)
+{
+  const uint32_t samples = 50; /* Short enough for the FIFO not to overflow meanwhile */
+  bus_cost_t     fifo;
+  bus_cost_t     legacy;
+  bus_cost_t     burst;
+
+  /* The old `mpu6050_read`: accel and gyro in two 6-byte reads, no temperature */
+  priv_cost_begin(&legacy);
+  for (uint32_t i = 0; i < samples; i++) {
+    uint8_t accel[6];
+    uint8_t gyro[6];
+    CHECK(priv_i2c_read_reg_bytes(k_mpu6050_accel_xout_h_cmd, accel, sizeof(accel),
+                                  mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag) == ESP_OK);
+    CHECK(priv_i2c_read_reg_bytes(k_mpu6050_gyro_xout_h_cmd, gyro, sizeof(gyro),
+                                  mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_tag) == ESP_OK);
+    legacy.samples++;
+  }
+  priv_cost_end("two 6-byte reads", &legacy);
+  CHECK(mpu6050_fifo_drain(&s_mpu6050) == ESP_OK);
+
+  priv_cost_begin(&burst);
+  for (uint32_t i = 0; i < samples; i++) {
+    CHECK(mpu6050_read(&s_mpu6050) == ESP_OK);
+    burst.samples++;
+  }
+  priv_cost_end("14-byte burst", &burst);
+  CHECK(mpu6050_fifo_drain(&s_mpu6050) == ESP_OK);
+
+  priv_cost_begin(&fifo);
+  uint32_t samples_before = s_mpu6050.fifo_samples;
+  for (int i = 0; i < 10; i++) {
+    vTaskDelay(mpu6050_tick_period_ticks);
+    CHECK(mpu6050_fifo_drain(&s_mpu6050) == ESP_OK);
+  }
+  fifo.samples = s_mpu6050.fifo_samples - samples_before;
+  priv_cost_end("FIFO drain", &fifo);
+
+  CHECK(burst.stats.commands * 2 == legacy.stats.commands);
+  CHECK(burst.stats.links_built == 0);
+  CHECK(legacy.stats.links_built == legacy.stats.commands);
+  CHECK(burst.stats.wire_time_us < legacy.stats.wire_time_us);
+  CHECK(fifo.stats.commands * 10 <= fifo.samples);
+  CHECK(fifo.stats.wire_time_us * legacy.samples < burst.stats.wire_time_us * fifo.samples);
+  CHECK(s_mpu6050.fifo_overflows == 1);
+}
+
+int main(void)
+{
+  i2c_bus_create_locks();
+  mpu6050_model_start(mpu6050_i2c_bus, mpu6050_i2c_address, mpu6050_int_io);
+
+  printf("mpu6050_fifo_test: %u Hz, drain every %u samples\n",
+         1000 / (1 + mpu6050_fifo_sample_rate_div), mpu6050_fifo_burst_samples);
+  priv_check_init();
+  priv_check_stream();
+  priv_check_overflow();
+  priv_check_fall();
+  priv_check_bus_cost();
+  priv_check_task_mode();
+
+  printf("mpu6050_fifo_test: %s (%d failures)\n", s_failures ? "FAILED" : "ok", s_failures);
+  return s_failures ? 1 : 0;
+}
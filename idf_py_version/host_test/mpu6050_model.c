@@ -0,0 +1,270 @@
+/* host_test/mpu6050_model.c */
+
+#include "mpu6050_model.h"
+#include <pthread.h>
+#include <string.h>
+#include "idf_host.h"
+
+#define MODEL_FIFO_SIZE     (1024)
+#define MODEL_TIME_HISTORY  (4096) /* Sample times remembered, ~20 s at 200 Hz */
+
+enum {
+  k_reg_smplrt_div   = 0x19,
+  k_reg_fifo_en      = 0x23,
+  k_reg_int_enable   = 0x38,
+  k_reg_int_status   = 0x3A,
+  k_reg_data         = 0x3B,
+  k_reg_fifo_count_h = 0x72,
+  k_reg_fifo_count_l = 0x73,
+  k_reg_fifo_r_w     = 0x74,
+  k_reg_user_ctrl    = 0x6A,
+  k_reg_pwr_mgmt_1   = 0x6B,
+  k_reg_who_am_i     = 0x75,
+};
+
+typedef struct {
+  pthread_mutex_t          lock;
+  gpio_num_t               int_pin;
+  uint8_t                  regs[128];
+  uint8_t                  pointer;
+  uint8_t                  fifo[MODEL_FIFO_SIZE];
+  size_t                   fifo_head;
+  size_t                   fifo_count;
+  mpu6050_model_waveform_t waveform;
+  void                    *waveform_ctx;
+  int64_t                  times[MODEL_TIME_HISTORY];
+  mpu6050_model_stats_t    stats;
+} mpu6050_model_t;
+
+static mpu6050_model_t s_model = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void priv_default_waveform(void *ctx, uint32_t index, int64_t time_us, int16_t raw[7])
+{
+  raw[0] = (int16_t)index;
+  raw[1] = (int16_t)-(int16_t)index;
+  raw[2] = 2048;  /* 1 g at +-16 g full scale */
+  raw[3] = 3400;  /* 46.53 C */
+  raw[4] = 164;   /* 10 dps at +-2000 dps full scale */
+  raw[5] = -164;
+  raw[6] = 0;
+}
+
+static void priv_reset_registers(void)
+{
+  memset(s_model.regs, 0, sizeof(s_model.regs));
+  s_model.regs[k_reg_pwr_mgmt_1] = 0x40; /* Asleep after power-up and reset */
+  s_model.regs[k_reg_who_am_i]   = 0x68;
+  s_model.fifo_count             = 0;
+}
+
+static void priv_fifo_push(uint8_t byte)
+{
+  if (s_model.fifo_count == MODEL_FIFO_SIZE) {
+    s_model.fifo_head = (s_model.fifo_head + 1) % MODEL_FIFO_SIZE;
+    s_model.fifo_count--;
+    s_model.stats.fifo_dropped++;
+  }
+  s_model.fifo[(s_model.fifo_head + s_model.fifo_count) % MODEL_FIFO_SIZE] = byte;
+  s_model.fifo_count++;
+}
+
+static uint8_t priv_fifo_pop(void)
+{
+  if (s_model.fifo_count == 0) {
+    s_model.stats.fifo_underrun++;
+    return 0xFF;
+  }
+  uint8_t byte      = s_model.fifo[s_model.fifo_head];
+  s_model.fifo_head = (s_model.fifo_head + 1) % MODEL_FIFO_SIZE;
+  s_model.fifo_count--;
+  return byte;
+}
+
+static void priv_write_register(uint8_t reg, uint8_t value)
+{
+  switch (reg) {
+  case k_reg_pwr_mgmt_1:
+    if (value & 0x80) {
+      priv_reset_registers();
+      return;
+    }
+    break;
+  case k_reg_user_ctrl:
+    if (value & 0x04) {
+      s_model.fifo_count = 0;
+      s_model.stats.fifo_resets++;
+    }
+    value &= ~0x04; /* FIFO_RST clears itself */
+    break;
+  case k_reg_fifo_r_w:
+    priv_fifo_push(value);
+    return;
+  case k_reg_who_am_i:
+  case k_reg_int_status:
+  case k_reg_fifo_count_h:
+  case k_reg_fifo_count_l:
+    return; /* Read-only */
+  default:
+    if (reg >= k_reg_data && reg < k_reg_data + 14) {
+      return;
+    }
+    break;
+  }
+  s_model.regs[reg] = value;
+}
+
+static uint8_t priv_read_register(uint8_t reg)
+{
+  switch (reg) {
+  case k_reg_fifo_count_h:
+    return (uint8_t)(s_model.fifo_count >> 8);
+  case k_reg_fifo_count_l:
+    return (uint8_t)s_model.fifo_count;
+  case k_reg_fifo_r_w:
+    return priv_fifo_pop();
+  case k_reg_int_status: {
+    uint8_t status = s_model.regs[reg];
+    s_model.regs[reg] = 0; /* Cleared on read */
+    return status;
+  }
+  default:
+    return s_model.regs[reg & 0x7F];
+  }
+}
+
+static bool priv_i2c_write(void *ctx, const uint8_t *data, size_t len)
+{
+  pthread_mutex_lock(&s_model.lock);
+  s_model.pointer = data[0] & 0x7F;
+  for (size_t i = 1; i < len; i++) {
+    priv_write_register(s_model.pointer, data[i]);
+    if (s_model.pointer != k_reg_fifo_r_w) {
+      s_model.pointer = (s_model.pointer + 1) & 0x7F;
+    }
+  }
+  pthread_mutex_unlock(&s_model.lock);
+  return true;
+}
+
+static bool priv_i2c_read(void *ctx, uint8_t *data, size_t len)
+{
+  pthread_mutex_lock(&s_model.lock);
+  for (size_t i = 0; i < len; i++) {
+    data[i] = priv_read_register(s_model.pointer);
+    if (s_model.pointer != k_reg_fifo_r_w) {
+      s_model.pointer = (s_model.pointer + 1) & 0x7F;
+    }
+  }
+  pthread_mutex_unlock(&s_model.lock);
+  return true;
+}
+
+/* Produces one sample; returns whether the interrupt should fire */
+static bool priv_sample(int64_t now_us)
+{
+  int16_t raw[7];
+  bool    interrupt = false;
+
+  pthread_mutex_lock(&s_model.lock);
+  uint32_t index = s_model.stats.samples++;
+  s_model.times[index % MODEL_TIME_HISTORY] = now_us;
+  s_model.waveform(s_model.waveform_ctx, index, now_us, raw);
+
+  for (int i = 0; i < 7; i++) {
+    s_model.regs[k_reg_data + 2 * i]     = (uint8_t)((uint16_t)raw[i] >> 8);
+    s_model.regs[k_reg_data + 2 * i + 1] = (uint8_t)raw[i];
+  }
+
+  /* FIFO order follows the register map: accel, temperature, gyro X/Y/Z */
+  uint8_t fifo_en = s_model.regs[k_reg_fifo_en];
+  if (s_model.regs[k_reg_user_ctrl] & 0x40) {
+    static const struct { uint8_t bit; uint8_t first; uint8_t channels; } sources[] = {
+      { 0x08, 0, 3 }, { 0x80, 3, 1 }, { 0x40, 4, 1 }, { 0x20, 5, 1 }, { 0x10, 6, 1 },
+    };
+    for (size_t s = 0; s < sizeof(sources) / sizeof(sources[0]); s++) {
+      if (fifo_en & sources[s].bit) {
+        for (int c = sources[s].first; c < sources[s].first + sources[s].channels; c++) {
+          priv_fifo_push((uint8_t)((uint16_t)raw[c] >> 8));
+          priv_fifo_push((uint8_t)raw[c]);
+        }
+      }
+    }
+  }
+
+  if (s_model.regs[k_reg_int_enable] & 0x01) {
+    s_model.regs[k_reg_int_status] |= 0x01;
+    s_model.stats.interrupts++;
+    interrupt = true;
+  }
+  pthread_mutex_unlock(&s_model.lock);
+  return interrupt;
+}
+
+static void *priv_sampling_thread(void *arg)
+{
+  int64_t next_us = host_now_us();
+  while (true) {
+    pthread_mutex_lock(&s_model.lock);
+    bool    awake     = (s_model.regs[k_reg_pwr_mgmt_1] & 0x40) == 0;
+    int64_t period_us = (1 + s_model.regs[k_reg_smplrt_div]) * 1000;
+    pthread_mutex_unlock(&s_model.lock);
+
+    next_us += period_us;
+    int64_t now_us = host_now_us();
+    if (next_us > now_us) {
+      host_sleep_us(next_us - now_us);
+    }
+    if (awake && priv_sample(next_us)) {
+      host_gpio_trigger(s_model.int_pin);
+    }
+  }
+  return NULL;
+}
+
+void mpu6050_model_start(i2c_port_t i2c_bus, uint8_t address, gpio_num_t int_pin)
+{
+  pthread_mutex_lock(&s_model.lock);
+  priv_reset_registers();
+  s_model.int_pin  = int_pin;
+  s_model.waveform = priv_default_waveform;
+  pthread_mutex_unlock(&s_model.lock);
+
+  host_i2c_device_t device = { .write = priv_i2c_write, .read = priv_i2c_read };
+  host_i2c_attach(i2c_bus, address, &device);
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, priv_sampling_thread, NULL);
+  pthread_detach(thread);
+}
+
+void mpu6050_model_set_waveform(mpu6050_model_waveform_t waveform, void *ctx)
+{
+  pthread_mutex_lock(&s_model.lock);
+  s_model.waveform     = (waveform != NULL) ? waveform : priv_default_waveform;
+  s_model.waveform_ctx = ctx;
+  pthread_mutex_unlock(&s_model.lock);
+}
+
+uint8_t mpu6050_model_register(uint8_t reg)
+{
+  pthread_mutex_lock(&s_model.lock);
+  uint8_t value = s_model.regs[reg & 0x7F];
+  pthread_mutex_unlock(&s_model.lock);
+  return value;
+}
+
+int64_t mpu6050_model_sample_time(uint32_t index)
+{
+  pthread_mutex_lock(&s_model.lock);
+  int64_t time_us = (s_model.stats.samples - index <= MODEL_TIME_HISTORY &&
+                     index < s_model.stats.samples) ? s_model.times[index % MODEL_TIME_HISTORY] : -1;
+  pthread_mutex_unlock(&s_model.lock);
+  return time_us;
+}
+
+void mpu6050_model_get_stats(mpu6050_model_stats_t *stats)
+{
+  pthread_mutex_lock(&s_model.lock);
+  *stats = s_model.stats;
+  pthread_mutex_unlock(&s_model.lock);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+/* Register-level model of an MPU6050 on a host I2C bus.
+ *
+ * The model keeps the registers the HAL touches, a 1024-byte FIFO and the
+ * data-ready interrupt. While the device is awake a sampling thread produces
+ * one sample every (1 + SMPLRT_DIV) ms of host time, as with the DLPF
+ * enabled: it updates the data registers, appends the channels enabled in
+ * FIFO_EN to the FIFO and, if INT_ENABLE asks for it, triggers the INT pin.
+ * A full FIFO keeps accepting bytes and drops the oldest ones, as the chip
+ * does, so an overflow leaves the stream misaligned until the FIFO is reset.
+ * Reads auto-increment the register pointer except at FIFO_R_W, which pops
+ * the FIFO. */
+
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+
+/* Fills the seven raw channels (accel X/Y/Z, temperature, gyro X/Y/Z) of
+ * sample `index`, taken at `time_us` on the host clock */
+typedef void (*mpu6050_model_waveform_t)(void *ctx, uint32_t index, int64_t time_us,
+                                         int16_t raw[7]);
+
+typedef struct {
+  uint32_t samples;        /* Samples produced while awake */
+  uint32_t fifo_resets;    /* FIFO resets through USER_CTRL */
+  uint32_t fifo_dropped;   /* Bytes dropped because the FIFO was full */
+  uint32_t fifo_underrun;  /* FIFO_R_W reads of an empty FIFO */
+  uint32_t interrupts;     /* Data-ready interrupts raised */
+} mpu6050_model_stats_t;
+
+/* Attaches the model and starts its sampling thread */
+void mpu6050_model_start(i2c_port_t i2c_bus, uint8_t address, gpio_num_t int_pin);
+
+/* Replaces the signal generator; NULL restores the default, which counts
+ * the sample index in accel X, its negation in accel Y and keeps the other
+ * channels constant */
+void mpu6050_model_set_waveform(mpu6050_model_waveform_t waveform, void *ctx);
+
+/* Current value of a register, without side effects */
+uint8_t mpu6050_model_register(uint8_t reg);
+
+/* Time at which sample `index` was produced, or -1 if it is too old to be
+ * remembered */
+int64_t mpu6050_model_sample_time(uint32_t index);
+
+void mpu6050_model_get_stats(mpu6050_model_stats_t *stats);
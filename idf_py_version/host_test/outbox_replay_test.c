@@ -0,0 +1,395 @@
+/* host_test/outbox_replay_test.c
+ *
+ * Replays the SD card outbox (outbox_manager.c) through the uplink's HTTP
+ * session (webserver_tasks.c) against a server model that goes up and
+ * down, and checks what reaches the server and what the cursor keeps.
+ *
+ * The first boot stores `BATCHES` batches of MQ135 frames numbered from 0
+ * while the station has no IP address; no request may be sent then. The
+ * station comes up and the server accepts part of the outbox, answers 503
+ * for a minute, stops answering for ten minutes, and the station loses its
+ * address for two more. Requests during the outages must stay bounded by
+ * the retry backoff. Then the server accepts again, and the boot ends
+ * inside the request that follows `LOST_ACK_AFTER` accepted ones, after the
+ * server took its frames but before the answer arrived. The second boot
+ * resumes from the cursor on the card and reports its catch-up rate.
+ *
+ * One batch (`POISON`) is refused with 400 whatever request carries it.
+ * In the end every other frame must have been accepted, the poisoned ones
+ * never, and only the frames of the request whose answer was lost may
+ * have been accepted twice. The outbox must be empty.
+ *
+ * A third boot keeps the outbox from ever emptying: every request the
+ * server takes stores a new batch, `SUSTAIN_BATCHES` in all. The outbox
+ * file must be compacted and stay below twice `outbox_compact_bytes`, and
+ * every sustained frame must arrive.
+ *
+ * The boots run in forked children; the server model keeps its counts in
+ * shared memory. The first boot runs on a clock 200 times faster than real
+ * time, the second in real time, so its rate includes the host's file
+ * system cost of storing the cursor after each request.
+ *
+ * Usage: outbox_replay_test [directory]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "esp_http_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+#include "idf_host.h"
+#include "outbox_manager.h"
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+#include "sensor_tasks.h"
+#include "webserver_tasks.h"
+#include "wifi_tasks.h"
+
+#define BATCHES        (120)
+#define BATCH_FRAMES   (16)
+#define FRAMES         (BATCHES * BATCH_FRAMES)
+#define POISON         (100) /* Batch the server refuses */
+#define FIRST_REPLAY   (30 * BATCH_FRAMES) /* Frames accepted before the first outage */
+#define LOST_ACK_AFTER (2)   /* Requests accepted after the outages before the boot ends */
+#define MAX_ATTEMPTS   (10)  /* Replay attempts allowed in the ten-minute outage */
+#define SUSTAIN_BATCHES (3000) /* Batches stored by the third boot, about 800 kB */
+
+typedef enum {
+  k_server_ok,        /**< Answers 200, or 400 to a request carrying the poisoned batch */
+  k_server_error,     /**< Answers 503 */
+  k_server_down,      /**< Does not answer */
+  k_server_lose_ack,  /**< Like `k_server_ok`, but the boot ends inside request `LOST_ACK_AFTER + 1` */
+  k_server_sustain,   /**< Answers 200, counts the frames and stores a new batch for each request */
+} server_phase_t;
+
+/* Shared between the boots and the checks */
+typedef struct {
+  server_phase_t phase;
+  uint32_t       requests;    /* Requests that reached the server model */
+  uint32_t       accepted;    /* Requests answered with 2xx in this phase */
+  uint32_t       lost_frames; /* Frames of the request whose answer was lost */
+  uint8_t        delivered[FRAMES];
+  outbox_stats_t stats[2];
+  int64_t        catch_up_us;
+  uint32_t       catch_up_frames;
+  uint32_t       sustain_stored;    /* Batches stored by the third boot */
+  uint32_t       sustain_delivered; /* Frames of the third boot the server accepted */
+  long long      outbox_peak;       /* Largest outbox file the third boot saw */
+} replay_state_t;
+
+static replay_state_t    *s_state    = NULL;
+static const char        *s_dir      = "build/outbox_replay";
+static EventGroupHandle_t s_link     = NULL;
+const char               *sd_card_mount_path;
+
+/* Stand-ins for the station: the test decides when it has an address */
+
+esp_err_t wifi_check_connection(void)
+{
+  return (xEventGroupGetBits(s_link) & WIFI_CONNECTED_BIT) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t wifi_wait_online(TickType_t timeout_ticks)
+{
+  EventBits_t bits = xEventGroupWaitBits(s_link, WIFI_CONNECTED_BIT, pdFALSE, pdFALSE, timeout_ticks);
+  return (bits & WIFI_CONNECTED_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t sensor_tasks_get_settings(const char *config_key, sensor_settings_t *settings)
+{
+  return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t sensor_tasks_configure(const char *config_key, const sensor_settings_t *settings)
+{
+  return ESP_ERR_NOT_FOUND;
+}
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+/* Reads the frame numbers out of a request body; returns how many it holds */
+static uint32_t priv_frame_ids(const uint8_t *body, size_t length, uint16_t *ids, uint32_t max_ids)
+{
+  uint32_t count  = 0;
+  size_t   offset = 0;
+  while (offset < length && count < max_ids) {
+    sensor_frame_header_t header;
+    if (sensor_frame_parse_header(&body[offset], length - offset, &header) != ESP_OK) {
+      return 0;
+    }
+    memcpy(&ids[count++], header.payload, sizeof(uint16_t));
+    offset = (size_t)(header.payload - body) + header.payload_len;
+  }
+  return count;
+}
+
+static void priv_store_sustained(void);
+
+static int priv_server(const uint8_t *body, size_t length)
+{
+  __atomic_add_fetch(&s_state->requests, 1, __ATOMIC_SEQ_CST);
+  if (s_state->phase == k_server_error) {
+    return 503;
+  }
+  if (s_state->phase == k_server_down) {
+    return -1;
+  }
+
+  uint16_t ids[OUTBOX_BATCH_SIZE / SENSOR_FRAME_HEADER_SIZE];
+  uint32_t count = priv_frame_ids(body, length, ids, sizeof(ids) / sizeof(ids[0]));
+  if (s_state->phase == k_server_sustain) {
+    s_state->sustain_delivered += count;
+    priv_store_sustained();
+    return 200;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    if (ids[i] / BATCH_FRAMES == POISON || ids[i] >= FRAMES) {
+      return 400;
+    }
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    s_state->delivered[ids[i]]++;
+  }
+  if (s_state->phase == k_server_lose_ack && ++s_state->accepted > LOST_ACK_AFTER) {
+    s_state->lost_frames = count;
+    outbox_manager_get_stats(&s_state->stats[0]);
+    _exit(0); /* The power fails before the answer arrives */
+  }
+  return 200;
+}
+
+static void priv_link(bool up)
+{
+  if (up) {
+    xEventGroupSetBits(s_link, WIFI_CONNECTED_BIT);
+  } else {
+    xEventGroupClearBits(s_link, WIFI_CONNECTED_BIT);
+  }
+}
+
+static void priv_init(void)
+{
+  s_link = xEventGroupCreate();
+  host_http_serve(priv_server);
+  if (outbox_manager_init() != ESP_OK || webserver_tasks_init() != ESP_OK) {
+    _exit(2);
+  }
+}
+
+/* Waits until the outbox has replayed `frames` frames; returns false on timeout */
+static bool priv_wait_replayed(uint32_t frames, uint32_t timeout_ms)
+{
+  TickType_t     deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+  outbox_stats_t stats;
+  do {
+    outbox_manager_get_stats(&stats);
+    if (stats.replayed >= frames) {
+      return true;
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+  } while (xTaskGetTickCount() < deadline);
+  return false;
+}
+
+/* Runs `phase` for `ms` and returns the number of requests it saw. A
+ * request sent before the station lost its address may still be retried on
+ * a fresh connection, so those are only counted after the retry is over. */
+static uint32_t priv_outage(server_phase_t phase, bool link, uint32_t ms)
+{
+  uint32_t settle = link ? 0 : 3 * webserver_timeout_ms;
+  s_state->phase  = phase;
+  priv_link(link);
+  vTaskDelay(pdMS_TO_TICKS(settle));
+  uint32_t before = s_state->requests;
+  vTaskDelay(pdMS_TO_TICKS(ms - settle));
+  return s_state->requests - before;
+}
+
+/* Stores batch `batch`, its frames numbered from `batch * BATCH_FRAMES` */
+static esp_err_t priv_store_batch(uint32_t batch)
+{
+  uint8_t frames[BATCH_FRAMES * SENSOR_FRAME_MAX_SIZE];
+  size_t  length = 0;
+  for (uint32_t i = 0; i < BATCH_FRAMES; i++) {
+    uint32_t     id    = batch * BATCH_FRAMES + i;
+    mq135_data_t mq135 = { .raw_adc_value = (uint16_t)id, .gas_concentration = (float)id };
+    size_t       frame_len = 0;
+    sensor_frame_encode(k_sensor_frame_id_mq135, &mq135, &frames[length], sizeof(frames) - length, &frame_len);
+    length += frame_len;
+  }
+  return outbox_store(frames, length, BATCH_FRAMES);
+}
+
+/* Called by the server model in the third boot, so the outbox never empties */
+static void priv_store_sustained(void)
+{
+  char        path[256];
+  struct stat st = { 0 };
+  if (s_state->sustain_stored < SUSTAIN_BATCHES && priv_store_batch(s_state->sustain_stored) == ESP_OK) {
+    s_state->sustain_stored++;
+  }
+  snprintf(path, sizeof(path), "%s/%s/outbox.bin", s_dir, outbox_dir);
+  stat(path, &st);
+  if (st.st_size > s_state->outbox_peak) {
+    s_state->outbox_peak = st.st_size;
+  }
+}
+
+/* First boot; ends with `_exit` inside the server model */
+static void priv_boot_store(void)
+{
+  host_time_scale = 200.0;
+  priv_init();
+
+  for (uint32_t batch = 0; batch < BATCHES; batch++) {
+    if (priv_store_batch(batch) != ESP_OK) {
+      _exit(3);
+    }
+  }
+
+  uint32_t offline = priv_outage(k_server_ok, false, 30 * 1000);
+  priv_link(true);
+  if (!priv_wait_replayed(FIRST_REPLAY, 60 * 1000)) {
+    _exit(4);
+  }
+  uint32_t errors = priv_outage(k_server_error, true, 60 * 1000);
+  uint32_t down   = priv_outage(k_server_down, true, 10 * 60 * 1000);
+  uint32_t no_ip  = priv_outage(k_server_down, false, 2 * 60 * 1000);
+
+  /* Every attempt is a request and its retry on a fresh connection */
+  printf("outbox_replay_test: requests while offline %u, during 503 %u, server down %u, no IP %u\n",
+         offline, errors, down, no_ip);
+  fflush(stdout);
+  if (offline != 0 || no_ip != 0 || down > 2 * MAX_ATTEMPTS) {
+    _exit(5);
+  }
+
+  s_state->phase = k_server_lose_ack;
+  priv_link(true);
+  vTaskDelay(pdMS_TO_TICKS(30 * 60 * 1000));
+  _exit(6); /* The server never saw the request whose answer is lost */
+}
+
+/* Second boot: catches up on what the first one left */
+static void priv_boot_resume(void)
+{
+  priv_init();
+  s_state->phase = k_server_ok;
+
+  outbox_stats_t stats;
+  outbox_manager_get_stats(&stats);
+  uint32_t pending = stats.pending_bytes;
+  int64_t  start   = host_now_us();
+  priv_link(true);
+  do {
+    vTaskDelay(pdMS_TO_TICKS(10));
+    outbox_manager_get_stats(&stats);
+  } while (stats.pending_bytes > 0 && host_now_us() - start < 60 * 1000000);
+
+  s_state->catch_up_us     = host_now_us() - start;
+  s_state->catch_up_frames = stats.replayed;
+  s_state->stats[1]        = stats;
+  printf("outbox_replay_test: %u bytes pending at boot\n", pending);
+  fflush(stdout);
+  _exit(stats.pending_bytes == 0 ? 0 : 7);
+}
+
+/* Third boot: the server takes requests as fast as new batches are stored */
+static void priv_boot_sustain(void)
+{
+  host_time_scale = 200.0;
+  priv_init();
+  s_state->phase = k_server_sustain;
+  priv_store_sustained();
+  priv_link(true);
+
+  outbox_stats_t stats;
+  do {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    outbox_manager_get_stats(&stats);
+  } while (s_state->sustain_stored < SUSTAIN_BATCHES || stats.pending_bytes > 0);
+  s_state->stats[1] = stats;
+  _exit(0);
+}
+
+static bool priv_run_boot(void (*boot)(void))
+{
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    alarm(120);
+    boot();
+  }
+  int status = 0;
+  if (pid <= 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    fprintf(stderr, "outbox_replay_test: boot failed (status 0x%x)\n", status);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1) {
+    s_dir = argv[1];
+  }
+  sd_card_mount_path = s_dir;
+  mkdir(s_dir, 0775);
+  setenv("HOST_LOG", "none", 0);
+
+  s_state = mmap(NULL, sizeof(*s_state), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (s_state == MAP_FAILED) {
+    return 1;
+  }
+  if (!priv_run_boot(priv_boot_store) || !priv_run_boot(priv_boot_resume)) {
+    return 1;
+  }
+
+  uint32_t missing = 0;
+  uint32_t twice   = 0;
+  uint32_t poison  = 0;
+  for (uint32_t id = 0; id < FRAMES; id++) {
+    if (id / BATCH_FRAMES == POISON) {
+      poison += s_state->delivered[id];
+    } else if (s_state->delivered[id] == 0) {
+      missing++;
+    } else {
+      twice += s_state->delivered[id] - 1;
+    }
+  }
+  uint32_t rejected = s_state->stats[0].rejected + s_state->stats[1].rejected;
+
+  char        path[256];
+  struct stat st = { 0 };
+  snprintf(path, sizeof(path), "%s/%s/outbox.bin", s_dir, outbox_dir);
+  stat(path, &st);
+
+  printf("outbox_replay_test: catch-up %u frames in %.2f s (%.0f frames/s)\n", s_state->catch_up_frames,
+         s_state->catch_up_us / 1e6, s_state->catch_up_frames / (s_state->catch_up_us / 1e6));
+  printf("outbox_replay_test: %u missing, %u accepted twice (at most %u), %u poisoned accepted, "
+         "%u rejected, outbox %lld bytes\n",
+         missing, twice, s_state->lost_frames, poison, rejected, (long long)st.st_size);
+
+  bool ok = missing == 0 && twice <= s_state->lost_frames && poison == 0 && rejected == BATCH_FRAMES &&
+            st.st_size == 0;
+
+  if (!priv_run_boot(priv_boot_sustain)) {
+    return 1;
+  }
+  printf("outbox_replay_test: sustained %u of %u frames, %u compactions, outbox at most %lld bytes\n",
+         s_state->sustain_delivered, SUSTAIN_BATCHES * BATCH_FRAMES, s_state->stats[1].compactions,
+         s_state->outbox_peak);
+  ok = ok && s_state->sustain_delivered == SUSTAIN_BATCHES * BATCH_FRAMES &&
+       s_state->stats[1].compactions > 0 && s_state->outbox_peak < 2 * (long long)outbox_compact_bytes;
+  printf("outbox_replay_test: %s\n", ok ? "ok" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,365 @@
+/* host_test/power_cut_test.c
+ *
+ * Cuts the power under file_write_manager.c at random byte offsets and
+ * checks what the recovery scan (sd_card_recover.c and `ts_log_recover`)
+ * leaves for the next boot.
+ *
+ * Every trial boots the writer twice, each time in a forked child that ends
+ * with `_exit`, so nothing is closed or flushed on the way out. The first
+ * boot logs MQ135 frames numbered from 0 and an alert line for every eighth
+ * one. Between the boots the time-series log and the text log are each cut
+ * at a random offset, and the rest of the sector behind the cut is filled
+ * with random bytes or zeros, like a sector that was allocated but never
+ * written; the index is left as it was. The second boot recovers, then logs
+ * frames numbered from `RESUME_BASE`. Afterwards the logs must hold exactly
+ * the frames and lines that ended before the cut, followed by everything of
+ * the second boot, every block but the last sealed, nothing but zeros
+ * behind the last record and one index entry per sealed block.
+ *
+ * Some first boots end without a flush, one flush interval after the last
+ * record; their logs must already be complete before the cut, which bounds
+ * what a power loss can take to `file_write_flush_interval_ticks`.
+ *
+ * Usage: power_cut_test [directory [trials [seed]]]
+ */
+
+#include <glob.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "file_write_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "idf_host.h"
+#include "sd_card_hal.h"
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+#include "ts_log.h"
+
+#define MAX_RECORDS   (2048)
+#define RESUME_BASE   (10000)
+#define ALERT_EVERY   (8)
+#define UNFLUSHED     (25) /* Every 25th first boot ends without a flush */
+#define SECTOR_SIZE   (512)
+#define WINDOW        (48)
+
+/* What one log holds: record values and where each record ends in the file */
+typedef struct {
+  uint32_t count;
+  uint32_t values[MAX_RECORDS];
+  long     ends[MAX_RECORDS];
+  uint32_t sealed;
+  bool     ok;
+} power_cut_log_t;
+
+static const char *s_dir    = "build/power_cut";
+static uint32_t    s_random = 1;
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+static uint32_t priv_random(void)
+{
+  s_random ^= s_random << 13;
+  s_random ^= s_random >> 17;
+  s_random ^= s_random << 5;
+  return s_random;
+}
+
+/* Waits until the write task has taken all but `WINDOW` of `sent` records */
+static void priv_wait_window(uint32_t sent)
+{
+  file_write_stats_t stats;
+  do {
+    file_write_manager_get_stats(&stats);
+    if (sent - stats.records - stats.records_dropped <= WINDOW) {
+      return;
+    }
+    vTaskDelay(1);
+  } while (1);
+}
+
+/* One boot of the writer; runs in a child and never returns */
+static void priv_boot(uint32_t first, uint32_t count, bool flush)
+{
+  if (file_write_manager_init() != ESP_OK) {
+    _exit(2);
+  }
+
+  uint32_t sent = 0;
+  for (uint32_t i = first; i < first + count; i++) {
+    mq135_data_t mq135 = { .raw_adc_value = (uint16_t)i, .gas_concentration = (float)i };
+    uint8_t      frame[SENSOR_FRAME_MAX_SIZE];
+    size_t       frame_len = 0;
+    sensor_frame_encode(k_sensor_frame_id_mq135, &mq135, frame, sizeof(frame), &frame_len);
+    priv_wait_window(sent);
+    file_write_log_frame("mq135.tsl", frame, frame_len);
+    sent++;
+    if (i % ALERT_EVERY == 0) {
+      char alert[32];
+      snprintf(alert, sizeof(alert), "alert %u", i);
+      file_write_enqueue("alerts.txt", alert);
+      sent++;
+    }
+  }
+
+  if (flush) {
+    file_write_manager_flush(portMAX_DELAY);
+  } else {
+    vTaskDelay(file_write_flush_interval_ticks + pdMS_TO_TICKS(200));
+  }
+  _exit(0);
+}
+
+static bool priv_run_boot(uint32_t first, uint32_t count, bool flush)
+{
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    priv_boot(first, count, flush);
+  }
+  int status = 0;
+  return pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/* Finds the one segment of `name` below the log root */
+static bool priv_find(const char *name, char *path, size_t size)
+{
+  char    pattern[512];
+  glob_t  found;
+  snprintf(pattern, sizeof(pattern), "%s/%s/*/*/*_%s", s_dir, file_write_segment_root, name);
+  bool ok = (glob(pattern, 0, NULL, &found) == 0 && found.gl_pathc == 1);
+  if (ok) {
+    snprintf(path, size, "%s", found.gl_pathv[0]);
+  }
+  globfree(&found);
+  return ok;
+}
+
+static long priv_file_size(const char *path)
+{
+  struct stat st;
+  return (stat(path, &st) == 0) ? (long)st.st_size : -1;
+}
+
+/* Reads a time-series log the way a reader of the card would */
+static void priv_read_log(const char *path, power_cut_log_t *log)
+{
+  static ts_log_block_t block;
+  static uint8_t        raw[TS_LOG_BLOCK_SIZE];
+  ts_log_file_header_t  header;
+
+  memset(log, 0, sizeof(*log));
+  FILE *file = fopen(path, "rb");
+  long  size = priv_file_size(path);
+  if (file == NULL || fread(&header, 1, sizeof(header), file) != sizeof(header) ||
+      ts_log_file_header_check(&header) != ESP_OK) {
+    printf("  %s: no valid header\n", path);
+    if (file != NULL) {
+      fclose(file);
+    }
+    return;
+  }
+
+  log->ok = true;
+  for (uint32_t block_no = 0; ts_log_block_offset(block_no) < size && log->ok; block_no++) {
+    long   offset = ts_log_block_offset(block_no);
+    size_t length = (size - offset < TS_LOG_BLOCK_SIZE) ? (size_t)(size - offset) : TS_LOG_BLOCK_SIZE;
+    memset(raw, 0, sizeof(raw));
+    fseek(file, offset, SEEK_SET);
+    fread(raw, 1, length, file);
+    memcpy(&block, raw, sizeof(block));
+
+    uint16_t count;
+    if (length == TS_LOG_BLOCK_SIZE && ts_log_block_verify(&block, block_no)) {
+      count = block.footer.record_count;
+      log->sealed++;
+    } else if (offset + (long)length < size) {
+      printf("  %s: block %u is not sealed but not the last\n", path, block_no);
+      log->ok = false;
+      break;
+    } else {
+      ts_log_block_init(&block, block_no, header.record_size);
+      memcpy(block.records, raw, (length < sizeof(block.records)) ? length : sizeof(block.records));
+      size_t used = ts_log_block_scan(&block, length);
+      count       = block.footer.record_count;
+      for (size_t i = used; i < length; i++) {
+        if (raw[i] != 0) {
+          printf("  %s: stale data behind the last record at offset %ld\n", path, offset + (long)i);
+          log->ok = false;
+          break;
+        }
+      }
+    }
+
+    for (uint16_t i = 0; i < count && log->count < MAX_RECORDS; i++) {
+      const uint8_t *record   = &block.records[(size_t)i * header.record_size];
+      log->values[log->count] = record[TS_LOG_RECORD_HEADER] | (record[TS_LOG_RECORD_HEADER + 1] << 8);
+      log->ends[log->count]   = offset + (long)(i + 1) * header.record_size;
+      log->count++;
+    }
+  }
+  fclose(file);
+}
+
+/* Reads the alert numbers of a text log; an incomplete last line fails it */
+static void priv_read_text(const char *path, power_cut_log_t *log)
+{
+  memset(log, 0, sizeof(*log));
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return;
+  }
+  char line[128];
+  log->ok = true;
+  while (fgets(line, sizeof(line), file) != NULL && log->count < MAX_RECORDS) {
+    const char *alert = strstr(line, "alert ");
+    if (line[strlen(line) - 1] != '\n' || alert == NULL) {
+      printf("  %s: incomplete line '%s'\n", path, line);
+      log->ok = false;
+      break;
+    }
+    log->values[log->count] = (uint32_t)strtoul(&alert[6], NULL, 10);
+    log->ends[log->count]   = ftell(file);
+    log->count++;
+  }
+  fclose(file);
+}
+
+/* Cuts a file at `cut` and fills the rest of that sector with zeros or random bytes */
+static void priv_cut(const char *path, long cut, bool random_fill)
+{
+  long end = ((cut + SECTOR_SIZE - 1) / SECTOR_SIZE) * SECTOR_SIZE;
+  truncate(path, cut);
+  FILE *file = fopen(path, "r+b");
+  if (file == NULL) {
+    return;
+  }
+  fseek(file, cut, SEEK_SET);
+  for (long i = cut; i < end; i++) {
+    fputc(random_fill ? (int)(priv_random() & 0xFF) : 0, file);
+  }
+  fclose(file);
+}
+
+/* Number of entries of `before` that ended at or before `cut` */
+static uint32_t priv_kept(const power_cut_log_t *before, long cut)
+{
+  uint32_t kept = 0;
+  while (kept < before->count && before->ends[kept] <= cut) {
+    kept++;
+  }
+  return kept;
+}
+
+/* Checks that `after` holds `kept` entries of `before`, then `expected` more from `first` on */
+static bool priv_check(const char *what, const power_cut_log_t *before, uint32_t kept,
+                       const power_cut_log_t *after, const uint32_t *expected, uint32_t expected_count)
+{
+  if (!after->ok || after->count != kept + expected_count) {
+    printf("  %s: %u records after the restart, expected %u kept and %u new\n", what, after->count,
+           kept, expected_count);
+    return false;
+  }
+  for (uint32_t i = 0; i < after->count; i++) {
+    uint32_t want = (i < kept) ? before->values[i] : expected[i - kept];
+    if (after->values[i] != want) {
+      printf("  %s: record %u is %u, expected %u\n", what, i, after->values[i], want);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool priv_trial(uint32_t trial)
+{
+  static power_cut_log_t log_before, log_after, text_before, text_after;
+  static uint32_t        frames[MAX_RECORDS], alerts[MAX_RECORDS];
+  char                   log_path[512], text_path[512], command[600];
+
+  snprintf(command, sizeof(command), "rm -rf '%s'", s_dir);
+  system(command);
+
+  bool     flush = (trial % UNFLUSHED) != 0;
+  uint32_t count = 50 + priv_random() % 550;
+  if (!priv_run_boot(0, count, flush) || !priv_find("mq135.tsl", log_path, sizeof(log_path)) ||
+      !priv_find("alerts.txt", text_path, sizeof(text_path))) {
+    printf("trial %u: first boot failed\n", trial);
+    return false;
+  }
+  priv_read_log(log_path, &log_before);
+  priv_read_text(text_path, &text_before);
+  if (log_before.count != count || text_before.count != (count + ALERT_EVERY - 1) / ALERT_EVERY) {
+    printf("trial %u: %u frames and %u alerts of %u frames on the card %s\n", trial, log_before.count,
+           text_before.count, count, flush ? "after a flush" : "one flush interval after the last");
+    return false;
+  }
+
+  long log_cut  = (long)(priv_random() % (uint32_t)(priv_file_size(log_path) + 1));
+  long text_cut = (long)(priv_random() % (uint32_t)(priv_file_size(text_path) + 1));
+  priv_cut(log_path, log_cut, priv_random() & 1);
+  priv_cut(text_path, text_cut, false);
+  uint32_t log_kept  = priv_kept(&log_before, log_cut);
+  uint32_t text_kept = priv_kept(&text_before, text_cut);
+
+  uint32_t resume_count = 50 + priv_random() % 200;
+  uint32_t alert_count  = 0;
+  for (uint32_t i = 0; i < resume_count; i++) {
+    frames[i] = RESUME_BASE + i;
+    if ((RESUME_BASE + i) % ALERT_EVERY == 0) {
+      alerts[alert_count++] = RESUME_BASE + i;
+    }
+  }
+  if (!priv_run_boot(RESUME_BASE, resume_count, true) || !priv_find("mq135.tsl", log_path, sizeof(log_path)) ||
+      !priv_find("alerts.txt", text_path, sizeof(text_path))) {
+    printf("trial %u: second boot failed\n", trial);
+    return false;
+  }
+  priv_read_log(log_path, &log_after);
+  priv_read_text(text_path, &text_after);
+
+  char index_path[520];
+  snprintf(index_path, sizeof(index_path), "%s" TS_LOG_INDEX_SUFFIX, log_path);
+  long index_size = priv_file_size(index_path);
+  bool index_ok   = (index_size < 0 ? 0 : index_size) == (long)(log_after.sealed * sizeof(ts_log_index_entry_t));
+  if (!index_ok) {
+    printf("  index: %ld bytes for %u sealed blocks\n", index_size, log_after.sealed);
+  }
+
+  bool ok = priv_check("mq135.tsl", &log_before, log_kept, &log_after, frames, resume_count) &&
+            priv_check("alerts.txt", &text_before, text_kept, &text_after, alerts, alert_count) && index_ok;
+  if (!ok) {
+    printf("trial %u: log cut at %ld of %ld, text cut at %ld of %ld\n", trial, log_cut,
+           log_before.count ? log_before.ends[log_before.count - 1] : 0L, text_cut,
+           text_before.count ? text_before.ends[text_before.count - 1] : 0L);
+  }
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t trials = 200;
+  s_dir           = (argc > 1) ? argv[1] : s_dir;
+  trials          = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : trials;
+  s_random        = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 10) : 0x2545F491;
+  if (s_random == 0) {
+    s_random = 1;
+  }
+  setenv("HOST_LOG", "error", 0); /* Every trial repairs logs, which the scan reports as warnings */
+  host_time_scale    = 10.0;      /* Only shortens the wait of the unflushed boots */
+  sd_card_mount_path = s_dir;
+
+  printf("power_cut_test: %u trials into %s, seed %u\n", trials, s_dir, s_random);
+  uint32_t failed = 0;
+  for (uint32_t trial = 0; trial < trials; trial++) {
+    failed += priv_trial(trial) ? 0 : 1;
+  }
+  printf("power_cut_test: %u of %u trials recovered every record before the cut and nothing after it\n",
+         trials - failed, trials);
+  return failed ? 1 : 0;
+}
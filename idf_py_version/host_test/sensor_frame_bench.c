@@ -0,0 +1,143 @@
+/* host_test/sensor_frame_bench.c
+ *
+ * Compares the binary frames of sensor_frame.c with the JSON documents the
+ * HALs' `*_data_to_json` functions produced for the same readings: bytes per
+ * reading and host CPU time per encoded reading.
+ *
+ * cJSON is not available on the host, so the JSON side prints the same
+ * documents with snprintf, using cJSON's number format (integers as %d,
+ * everything else as %1.15g, or %1.17g when that does not round-trip). It
+ * leaves out cJSON's tree allocations, so the JSON times are a lower bound.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+
+#define ITERATIONS (200000)
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+static int64_t priv_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Appends `"key":number` the way cJSON_PrintUnformatted prints a number */
+static size_t priv_json_number(char *out, size_t size, const char *key, double value)
+{
+  char number[32];
+  if (value == (double)(int)value) {
+    snprintf(number, sizeof(number), "%d", (int)value);
+  } else {
+    snprintf(number, sizeof(number), "%1.15g", value);
+    if (strtod(number, NULL) != value) {
+      snprintf(number, sizeof(number), "%1.17g", value);
+    }
+  }
+  return snprintf(out, size, ",\"%s\":%s", key, number);
+}
+
+static size_t priv_json_dht22(const dht22_data_t *data, char *out, size_t size)
+{
+  size_t len = snprintf(out, size, "{\"sensor_type\":\"temperature_humidity\"");
+  len += priv_json_number(&out[len], size - len, "temperature_f", data->temperature_f);
+  len += priv_json_number(&out[len], size - len, "temperature_c", data->temperature_c);
+  len += priv_json_number(&out[len], size - len, "humidity", data->humidity);
+  len += snprintf(&out[len], size - len, "}");
+  return len;
+}
+
+static size_t priv_json_mq135(const mq135_data_t *data, char *out, size_t size)
+{
+  size_t len = snprintf(out, size, "{\"sensor_type\":\"gas\"");
+  len += priv_json_number(&out[len], size - len, "raw_adc_value", data->raw_adc_value);
+  len += priv_json_number(&out[len], size - len, "gas_concentration", data->gas_concentration);
+  len += snprintf(&out[len], size - len, "}");
+  return len;
+}
+
+static size_t priv_json_gps(const gy_neo6mv2_data_t *data, char *out, size_t size)
+{
+  size_t len = snprintf(out, size, "{\"sensor_type\":\"gps\"");
+  len += priv_json_number(&out[len], size - len, "latitude", data->latitude);
+  len += priv_json_number(&out[len], size - len, "longitude", data->longitude);
+  len += priv_json_number(&out[len], size - len, "speed", data->speed);
+  len += snprintf(&out[len], size - len, ",\"time\":\"%s\"", data->time);
+  len += priv_json_number(&out[len], size - len, "fix_status", data->fix_status);
+  len += priv_json_number(&out[len], size - len, "satellite_count", data->satellite_count);
+  len += priv_json_number(&out[len], size - len, "hdop", data->hdop);
+  len += snprintf(&out[len], size - len, "}");
+  return len;
+}
+
+static size_t priv_json_mpu6050(const mpu6050_data_t *data, char *out, size_t size)
+{
+  size_t len = snprintf(out, size, "{\"sensor_type\":\"accelerometer_gyroscope\"");
+  len += priv_json_number(&out[len], size - len, "accel_x", data->accel_x);
+  len += priv_json_number(&out[len], size - len, "accel_y", data->accel_y);
+  len += priv_json_number(&out[len], size - len, "accel_z", data->accel_z);
+  len += priv_json_number(&out[len], size - len, "gyro_x", data->gyro_x);
+  len += priv_json_number(&out[len], size - len, "gyro_y", data->gyro_y);
+  len += priv_json_number(&out[len], size - len, "gyro_z", data->gyro_z);
+  len += priv_json_number(&out[len], size - len, "temperature", data->temperature);
+  len += snprintf(&out[len], size - len, "}");
+  return len;
+}
+
+typedef size_t (*json_fn_t)(const void *data, char *out, size_t size);
+
+static void priv_bench(const char *name, sensor_frame_id_t sensor_id, const void *data, json_fn_t json)
+{
+  uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+  char    text[512];
+  size_t  frame_len = 0;
+  size_t  text_len  = 0;
+
+  int64_t start = priv_now_ns();
+  for (int i = 0; i < ITERATIONS; i++) {
+    sensor_frame_encode(sensor_id, data, frame, sizeof(frame), &frame_len);
+    __asm__ volatile("" : : "r"(frame) : "memory");
+  }
+  double frame_ns = (double)(priv_now_ns() - start) / ITERATIONS;
+
+  start = priv_now_ns();
+  for (int i = 0; i < ITERATIONS; i++) {
+    text_len = json(data, text, sizeof(text));
+    __asm__ volatile("" : : "r"(text) : "memory");
+  }
+  double json_ns = (double)(priv_now_ns() - start) / ITERATIONS;
+
+  printf("%-10s %6u %6u %7.1fx %10.0f %10.0f %7.1fx\n", name, (unsigned)frame_len, (unsigned)text_len,
+         (double)text_len / frame_len, frame_ns, json_ns, json_ns / frame_ns);
+}
+
+int main(void)
+{
+  dht22_data_t      dht22 = { .temperature_c = 23.47f, .temperature_f = 74.246f, .humidity = 41.26f };
+  mq135_data_t      mq135 = { .raw_adc_value = 2871, .gas_concentration = 418.375f };
+  gy_neo6mv2_data_t gps   = {
+    .latitude = -33.8568f, .longitude = 151.2153f, .speed = 1.42f, .time = "093015.25",
+    .fix_status = 1, .satellite_count = 7, .hdop = 1.3f,
+  };
+  mpu6050_data_t mpu6050 = {
+    .accel_x = 0.012f, .accel_y = -0.981f, .accel_z = 0.1234f,
+    .gyro_x = 1.25f, .gyro_y = -2.5f, .gyro_z = 0.31f, .temperature = 31.337f,
+  };
+
+  printf("sensor_frame_bench: %d readings per sensor; JSON without cJSON's allocations\n", ITERATIONS);
+  printf("%-10s %6s %6s %8s %10s %10s %8s\n", "sensor", "frame", "json", "size", "frame ns", "json ns", "time");
+  priv_bench("dht22", k_sensor_frame_id_dht22, &dht22, (json_fn_t)priv_json_dht22);
+  priv_bench("mq135", k_sensor_frame_id_mq135, &mq135, (json_fn_t)priv_json_mq135);
+  priv_bench("gps", k_sensor_frame_id_gy_neo6mv2, &gps, (json_fn_t)priv_json_gps);
+  priv_bench("mpu6050", k_sensor_frame_id_mpu6050, &mpu6050, (json_fn_t)priv_json_mpu6050);
+  return 0;
+}
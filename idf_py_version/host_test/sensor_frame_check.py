@@ -0,0 +1,57 @@
+"""Decodes the frames written by sensor_frame_test with the server's decoder.
+
+Every reading the firmware encoded must come back from
+esp_mesh_server/sensor_frame.py with the values it was made from, within
+the resolution of the fixed-point field it travelled in.
+
+Usage: sensor_frame_check.py <sensor_frames.json>
+"""
+import json
+import os
+import sys
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "..", "esp_mesh_server"))
+import sensor_frame  # noqa: E402
+
+
+def main(path):
+    with open(path) as f:
+        data = json.load(f)
+
+    body = bytes.fromhex(data["body"])
+    decoded = sensor_frame.decode_frames(body)
+    expected = data["readings"]
+
+    failures = []
+    if len(decoded) != len(expected):
+        failures.append(f"decoded {len(decoded)} frames, expected {len(expected)}")
+
+    for index, (got, want) in enumerate(zip(decoded, expected)):
+        for key, value in want.items():
+            if key not in got:
+                failures.append(f"frame {index}: missing {key}")
+            elif isinstance(value, list):
+                target, tolerance = value
+                if abs(got[key] - target) > tolerance + 1e-9:
+                    failures.append(f"frame {index}: {key} = {got[key]}, expected {target} +/- {tolerance}")
+            elif got[key] != value:
+                failures.append(f"frame {index}: {key} = {got[key]!r}, expected {value!r}")
+
+    # Truncated bodies must be rejected, not half-decoded
+    for cut in (1, len(body) // 2, len(body) - 1):
+        try:
+            sensor_frame.decode_frames(body[:cut])
+            failures.append(f"body cut at {cut} bytes was accepted")
+        except ValueError:
+            pass
+
+    for failure in failures:
+        print(failure, file=sys.stderr)
+    print(f"sensor_frame_check: {'FAILED' if failures else 'ok'} "
+          f"({len(decoded)} frames, {len(body)} bytes)")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1]))
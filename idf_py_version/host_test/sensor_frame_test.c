@@ -0,0 +1,258 @@
+/* host_test/sensor_frame_test.c
+ *
+ * Encodes one reading of every sensor type with sensor_frame.c, checks the
+ * frame headers and the error paths, and writes the concatenated frames and
+ * the values they were made from to a JSON file. sensor_frame_check.py then
+ * decodes the body with esp_mesh_server/sensor_frame.py and compares, so the
+ * encoder and the server's decoder are checked against each other.
+ *
+ * Usage: sensor_frame_test <output.json>
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+#include "fall_detector.h"
+
+static bool s_synced   = true;
+static int  s_failures = 0;
+
+bool time_manager_is_synced(void)
+{
+  return s_synced;
+}
+
+#define CHECK(cond) do {                                                      \
+    if (!(cond)) {                                                            \
+      fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      s_failures++;                                                           \
+    }                                                                         \
+  } while (0)
+
+/* Frames and expectations collected for the JSON file */
+static uint8_t s_body[1024];
+static size_t  s_body_len = 0;
+static char    s_expect[8192];
+static size_t  s_expect_len = 0;
+
+#define EXPECT(...) (s_expect_len += snprintf(&s_expect[s_expect_len], sizeof(s_expect) - s_expect_len, __VA_ARGS__))
+
+static int64_t priv_now_ms(void)
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000;
+}
+
+/* Encodes a reading, checks its header and appends it to the body. The
+ * caller then appends the expected decoded fields with EXPECT(). */
+static void priv_encode(sensor_frame_id_t sensor_id, const void *data, uint32_t sequence)
+{
+  uint8_t frame[SENSOR_FRAME_MAX_SIZE];
+  size_t  frame_len = 0;
+  int64_t before_ms = priv_now_ms();
+
+  CHECK(sensor_frame_encode(sensor_id, data, frame, sizeof(frame), &frame_len) == ESP_OK);
+  CHECK(frame_len > SENSOR_FRAME_HEADER_SIZE && frame_len <= SENSOR_FRAME_MAX_SIZE);
+
+  sensor_frame_header_t header;
+  CHECK(sensor_frame_parse_header(frame, frame_len, &header) == ESP_OK);
+  CHECK(header.sensor_id == sensor_id);
+  CHECK(header.sequence == sequence);
+  CHECK(header.payload_len == frame_len - SENSOR_FRAME_HEADER_SIZE);
+  CHECK(header.node_id == 0xc4123456);
+  CHECK(header.timestamp_ms >= before_ms && header.timestamp_ms <= priv_now_ms());
+  CHECK(header.payload == &frame[SENSOR_FRAME_HEADER_SIZE]);
+  CHECK(((header.flags & k_sensor_frame_flag_time_unsynced) != 0) == !s_synced);
+
+  memcpy(&s_body[s_body_len], frame, frame_len);
+  s_body_len += frame_len;
+
+  EXPECT("%s{\"node_id\":\"c4123456\",\"seq\":%u,\"timestamp_ms\":%lld,\"time_synced\":%s",
+         s_expect_len > 1 ? "," : "", sequence, (long long)header.timestamp_ms,
+         s_synced ? "true" : "false");
+}
+
+/* Numbers are written as [value, tolerance]; the tolerance is half a step of
+ * the fixed-point field they travel in. */
+#define NUM(key, value, tol) EXPECT(",\"%s\":[%.9g,%g]", key, (double)(value), (double)(tol))
+#define INT(key, value)      EXPECT(",\"%s\":%lld", key, (long long)(value))
+#define STR(key, value)      EXPECT(",\"%s\":\"%s\"", key, value)
+#define END()                EXPECT("}")
+
+static void priv_encode_all_sensors(void)
+{
+  dht22_data_t dht22 = { .temperature_c = 23.47f, .humidity = 41.26f };
+  priv_encode(k_sensor_frame_id_dht22, &dht22, 0);
+  STR("sensor_type", "temperature_humidity");
+  NUM("temperature_c", 23.47, 0.05);
+  NUM("temperature_f", 23.47 * 1.8 + 32.0, 0.1);
+  NUM("humidity", 41.26, 0.05);
+  END();
+
+  ccs811_data_t ccs811 = { .eco2 = 612, .tvoc = 37 };
+  priv_encode(k_sensor_frame_id_ccs811, &ccs811, 0);
+  STR("sensor_type", "air_quality");
+  INT("eCO2", 612);
+  INT("TVOC", 37);
+  END();
+
+  mq135_data_t mq135 = { .raw_adc_value = 2871, .gas_concentration = 418.375f };
+  priv_encode(k_sensor_frame_id_mq135, &mq135, 0);
+  STR("sensor_type", "gas");
+  INT("raw_adc_value", 2871);
+  NUM("gas_concentration", 418.375f, 0);
+  END();
+
+  gy_neo6mv2_data_t gps = {
+    .latitude        = -33.8568f,
+    .longitude       = 151.2153f,
+    .speed           = 1.42f,
+    .time            = "093015.25",
+    .fix_status      = 1,
+    .satellite_count = 7,
+    .hdop            = 1.3f,
+  };
+  priv_encode(k_sensor_frame_id_gy_neo6mv2, &gps, 0);
+  STR("sensor_type", "gps");
+  NUM("latitude", -33.8568f, 1e-5); /* float32 input, 1e-7 degree field */
+  NUM("longitude", 151.2153f, 1e-5);
+  NUM("speed", 1.42, 0.005);
+  NUM("hdop", 1.3, 0.005);
+  INT("fix_status", 1);
+  INT("satellite_count", 7);
+  STR("time", "093015.25");
+  END();
+
+  /* A module without a time yet sends an empty string */
+  gy_neo6mv2_data_t no_time = { .fix_status = 0 };
+  priv_encode(k_sensor_frame_id_gy_neo6mv2, &no_time, 1);
+  STR("sensor_type", "gps");
+  STR("time", "");
+  INT("satellite_count", 0);
+  END();
+
+  bh1750_data_t bh1750 = { .lux = 312.5f };
+  priv_encode(k_sensor_frame_id_bh1750, &bh1750, 0);
+  STR("sensor_type", "light");
+  NUM("lux", 312.5, 0);
+  END();
+
+  mpu6050_data_t mpu6050 = {
+    .accel_x = 0.012f, .accel_y = -0.981f, .accel_z = 0.1234f,
+    .gyro_x  = 1.25f,  .gyro_y  = -250.04f, .gyro_z = 0.0f,
+    .temperature = 31.337f,
+  };
+  priv_encode(k_sensor_frame_id_mpu6050, &mpu6050, 0);
+  STR("sensor_type", "accelerometer_gyroscope");
+  NUM("accel_x", 0.012, 0.0005);
+  NUM("accel_y", -0.981, 0.0005);
+  NUM("accel_z", 0.1234, 0.0005);
+  NUM("gyro_x", 1.25, 0.05);
+  NUM("gyro_y", -250.04, 0.05);
+  NUM("gyro_z", 0.0, 0.05);
+  NUM("temperature", 31.337, 0.005);
+  END();
+
+  /* Out-of-range values saturate instead of wrapping */
+  mpu6050_data_t saturated = {
+    .accel_x = 40.0f, .accel_y = -40.0f, .accel_z = NAN,
+    .gyro_x  = 5000.0f, .gyro_y = -5000.0f,
+  };
+  priv_encode(k_sensor_frame_id_mpu6050, &saturated, 1);
+  NUM("accel_x", 32.767, 0.0005);
+  NUM("accel_y", -32.768, 0.0005);
+  NUM("accel_z", -32.768, 0.0005);
+  NUM("gyro_x", 3276.7, 0.05);
+  NUM("gyro_y", -3276.8, 0.05);
+  END();
+
+  fall_detector_event_t fall = {
+    .type                   = k_fall_detector_event_fall,
+    .peak_g                 = 4.87f,
+    .free_fall_ms           = 412,
+    .orientation_change_deg = 78.3f,
+  };
+  priv_encode(k_sensor_frame_id_fall_alert, &fall, 0);
+  STR("sensor_type", "fall_alert");
+  STR("event", "fall");
+  NUM("peak_g", 4.87, 0.005);
+  INT("free_fall_ms", 412);
+  NUM("orientation_change_deg", 78.3, 0.05);
+  END();
+
+  /* Readings taken before SNTP sync carry the unsynced flag */
+  s_synced = false;
+  priv_encode(k_sensor_frame_id_dht22, &dht22, 1);
+  STR("sensor_type", "temperature_humidity");
+  END();
+  s_synced = true;
+}
+
+static void priv_check_errors(void)
+{
+  dht22_data_t dht22 = { 0 };
+  uint8_t      frame[SENSOR_FRAME_MAX_SIZE];
+  size_t       frame_len = 0;
+
+  CHECK(sensor_frame_encode(k_sensor_frame_id_dht22, &dht22, frame, SENSOR_FRAME_MAX_SIZE - 1,
+                            &frame_len) == ESP_ERR_INVALID_SIZE);
+  CHECK(sensor_frame_encode(0, &dht22, frame, sizeof(frame), &frame_len) == ESP_ERR_INVALID_ARG);
+  CHECK(sensor_frame_encode(k_sensor_frame_id_count, &dht22, frame, sizeof(frame),
+                            &frame_len) == ESP_ERR_INVALID_ARG);
+  CHECK(sensor_frame_encode(k_sensor_frame_id_dht22, NULL, frame, sizeof(frame),
+                            &frame_len) == ESP_ERR_INVALID_ARG);
+
+  /* Failed calls must not consume sequence numbers */
+  sensor_frame_header_t header;
+  CHECK(sensor_frame_encode(k_sensor_frame_id_dht22, &dht22, frame, sizeof(frame),
+                            &frame_len) == ESP_OK);
+  CHECK(sensor_frame_parse_header(frame, frame_len, &header) == ESP_OK);
+  CHECK(header.sequence == 2);
+
+  CHECK(sensor_frame_parse_header(frame, SENSOR_FRAME_HEADER_SIZE - 1, &header) == ESP_ERR_INVALID_ARG);
+  CHECK(sensor_frame_parse_header(frame, frame_len - 1, &header) == ESP_ERR_INVALID_SIZE);
+
+  uint8_t bad[SENSOR_FRAME_MAX_SIZE];
+  memcpy(bad, frame, frame_len);
+  bad[0] ^= 0xff;
+  CHECK(sensor_frame_parse_header(bad, frame_len, &header) == ESP_ERR_INVALID_STATE);
+  memcpy(bad, frame, frame_len);
+  bad[2] = SENSOR_FRAME_VERSION + 1;
+  CHECK(sensor_frame_parse_header(bad, frame_len, &header) == ESP_ERR_INVALID_STATE);
+  memcpy(bad, frame, frame_len);
+  bad[3] = k_sensor_frame_id_count;
+  CHECK(sensor_frame_parse_header(bad, frame_len, &header) == ESP_ERR_INVALID_STATE);
+}
+
+int main(int argc, char **argv)
+{
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <output.json>\n", argv[0]);
+    return 2;
+  }
+
+  EXPECT("[");
+  priv_encode_all_sensors();
+  EXPECT("]");
+  priv_check_errors();
+
+  FILE *out = fopen(argv[1], "w");
+  if (out == NULL) {
+    perror(argv[1]);
+    return 2;
+  }
+  fprintf(out, "{\"body\":\"");
+  for (size_t i = 0; i < s_body_len; i++) {
+    fprintf(out, "%02x", s_body[i]);
+  }
+  fprintf(out, "\",\"readings\":%s}\n", s_expect);
+  fclose(out);
+
+  printf("sensor_frame_test: %s (%u bytes in frames, %d failures)\n",
+         s_failures ? "FAILED" : "ok", (unsigned)s_body_len, s_failures);
+  return s_failures ? 1 : 0;
+}
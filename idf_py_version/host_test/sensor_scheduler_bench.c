@@ -0,0 +1,253 @@
+/* host_test/sensor_scheduler_bench.c
+ *
+ * Runs the firmware's sensor set through sensor_scheduler.c on the FreeRTOS
+ * shims, and through the design it replaced: one task per sensor with a
+ * 4096-byte stack, each looping over a read and vTaskDelay(period). Reports
+ * the RAM each design takes and, per sensor, how late every run starts
+ * against the sensor's period grid and how much the time between runs
+ * varies (the standard deviation of interval minus period).
+ *
+ * Periods, workers and jitter budgets are the ones sensor_tasks.c registers,
+ * with the CCS811 left out as it is there. A read sleeps for the bus time of
+ * that sensor's transfer, since a blocking I2C, UART or one-wire transaction
+ * gives up the CPU on the device too, and encodes a frame into a local
+ * buffer as the HAL ticks do. Stack use comes from the painted task stacks
+ * of freertos_host.c. Host frames are larger than Xtensa ones, so it is an
+ * upper estimate; static RAM is sized on the host as well.
+ *
+ * The scheduler has no stop, so the replaced design runs first.
+ *
+ * Usage: sensor_scheduler_bench [seconds]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "idf_host.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+#include "sensor_scheduler.h"
+
+#define LEGACY_STACK_DEPTH (4096)
+#define LEGACY_PRIORITY    (5)
+#define MAX_RUNS           (4096)
+
+typedef struct {
+  const char  *name;
+  uint32_t     period_ms;
+  uint32_t     budget_ms;
+  uint8_t      worker;
+  uint32_t     bus_us;            /* Bus time of one read */
+  int64_t      starts[MAX_RUNS];  /* Start of every recorded run, esp_timer time */
+  uint32_t     runs;
+  TaskHandle_t task;              /* Task that ran the last read */
+  uint8_t      id;                /* Scheduler job id */
+} bench_job_t;
+
+/* Bus times: MPU6050 drains 20 FIFO samples at 100 kHz (1289 us each, see
+ * mpu6050_fifo_test), DHT22 clocks 40 bits, GPS reads one NMEA sentence at
+ * 9600 baud, MQ135 is one ADC conversion */
+static bench_job_t s_jobs[] = {
+  { "BH1750",     5000, 500,  1, 1000 },
+  { "MPU6050",    100,  50,   0, 25780 },
+  { "DHT22",      5000, 500,  1, 4800 },
+  { "GY-NEO6MV2", 500,  1000, 1, 2000 },
+  { "MQ135",      1000, 500,  1, 100 },
+};
+
+#define JOBS (sizeof(s_jobs) / sizeof(s_jobs[0]))
+
+static volatile bool s_recording = false;
+static volatile bool s_stop      = false;
+static int64_t       s_start_us  = 0;
+static int64_t       s_end_us    = 0;
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+static void priv_tick(void *param)
+{
+  bench_job_t *job = param;
+  int64_t      now = esp_timer_get_time();
+  job->task           = xTaskGetCurrentTaskHandle();
+  if (s_recording && now < s_end_us && job->runs < MAX_RUNS) {
+    job->starts[job->runs++] = now;
+  }
+
+  mq135_data_t mq135 = { .raw_adc_value = 2871, .gas_concentration = 418.375f };
+  uint8_t      frame[SENSOR_FRAME_MAX_SIZE];
+  size_t       frame_len = 0;
+  sensor_frame_encode(k_sensor_frame_id_mq135, &mq135, frame, sizeof(frame), &frame_len);
+  host_sleep_us(job->bus_us);
+}
+
+/* The replaced `*_tasks` loop */
+static void priv_legacy_task(void *param)
+{
+  bench_job_t *job = param;
+  while (!s_stop) {
+    priv_tick(job);
+    vTaskDelay(pdMS_TO_TICKS(job->period_ms));
+  }
+  vTaskDelete(NULL);
+}
+
+/* Grid points inside the recorded window */
+static uint32_t priv_expected_runs(const bench_job_t *job, uint32_t seconds)
+{
+  return (seconds * 1000 + job->period_ms - 1) / job->period_ms;
+}
+
+static int priv_compare(const void *a, const void *b)
+{
+  int64_t x = *(const int64_t *)a;
+  int64_t y = *(const int64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void priv_report_timing(uint32_t seconds, bool scheduled)
+{
+  printf("%-11s %7s %9s %10s %10s %10s %10s", "sensor", "period", "runs", "late mean",
+         "late p99", "late max", "jitter");
+  printf(scheduled ? " %6s %7s\n" : "\n", "late", "skipped");
+
+  for (size_t i = 0; i < JOBS; i++) {
+    bench_job_t *job      = &s_jobs[i];
+    int64_t      period   = (int64_t)job->period_ms * 1000;
+    uint32_t     expected = priv_expected_runs(job, seconds);
+    int64_t      lateness[MAX_RUNS];
+    double       late_sum = 0;
+    double       dev_sum  = 0;
+    double       dev_sq   = 0;
+
+    for (uint32_t k = 0; k < job->runs; k++) {
+      lateness[k]  = job->starts[k] - (s_start_us + (int64_t)k * period);
+      late_sum    += lateness[k];
+      if (k > 0) {
+        double dev  = (double)(job->starts[k] - job->starts[k - 1] - period);
+        dev_sum    += dev;
+        dev_sq     += dev * dev;
+      }
+    }
+    qsort(lateness, job->runs, sizeof(lateness[0]), priv_compare);
+
+    uint32_t intervals = job->runs > 1 ? job->runs - 1 : 1;
+    double   dev_mean  = dev_sum / intervals;
+    double   jitter    = sqrt(fmax(dev_sq / intervals - dev_mean * dev_mean, 0));
+    char     runs[16];
+    snprintf(runs, sizeof(runs), "%u/%u", job->runs, expected);
+    printf("%-11s %5ums %9s %8.2fms %8.2fms %8.2fms %8.2fms", job->name, job->period_ms, runs,
+           job->runs ? late_sum / job->runs / 1000 : 0, lateness[job->runs * 99 / 100] / 1000.0,
+           lateness[job->runs - 1] / 1000.0, jitter / 1000);
+    if (scheduled) {
+      sensor_scheduler_stats_t stats;
+      sensor_scheduler_get_stats(job->id, &stats);
+      printf(" %6u %7u", stats.late_runs, stats.skipped_periods);
+    }
+    printf("\n");
+  }
+}
+
+static void priv_record(uint32_t seconds)
+{
+  for (size_t i = 0; i < JOBS; i++) {
+    s_jobs[i].runs = 0;
+  }
+  s_start_us  = esp_timer_get_time();
+  s_end_us    = s_start_us + (int64_t)seconds * 1000 * 1000;
+  s_recording = true;
+}
+
+/* Peak stack use on the host, summed over the tasks that ran reads */
+static size_t priv_stack_peak(void)
+{
+  size_t peak = 0;
+  for (size_t i = 0; i < JOBS; i++) {
+    bool counted = false;
+    for (size_t j = 0; j < i; j++) {
+      counted |= (s_jobs[j].task == s_jobs[i].task);
+    }
+    peak += counted ? 0 : host_task_stack_peak(s_jobs[i].task);
+  }
+  return peak;
+}
+
+static void priv_run_legacy(uint32_t seconds)
+{
+  priv_record(seconds);
+  for (size_t i = 0; i < JOBS; i++) {
+    xTaskCreate(priv_legacy_task, s_jobs[i].name, LEGACY_STACK_DEPTH, &s_jobs[i], LEGACY_PRIORITY,
+                &s_jobs[i].task);
+  }
+  host_sleep_us((int64_t)seconds * 1000 * 1000);
+  s_recording = false;
+  s_stop      = true;
+
+  printf("task per sensor: %zu tasks, 0 bytes static, %zu stack bytes, %zu used on the host\n",
+         JOBS, JOBS * LEGACY_STACK_DEPTH, priv_stack_peak());
+  priv_report_timing(seconds, false);
+}
+
+static bool priv_run_scheduler(uint32_t seconds)
+{
+  for (size_t i = 0; i < JOBS; i++) {
+    sensor_scheduler_entry_t entry = {
+      .name                = s_jobs[i].name,
+      .tick_function       = priv_tick,
+      .data_ptr            = &s_jobs[i],
+      .period_ticks        = pdMS_TO_TICKS(s_jobs[i].period_ms),
+      .jitter_budget_ticks = pdMS_TO_TICKS(s_jobs[i].budget_ms),
+      .worker              = s_jobs[i].worker,
+      .enabled             = true,
+    };
+    if (sensor_scheduler_add(&entry, &s_jobs[i].id) != ESP_OK) {
+      return false;
+    }
+  }
+
+  priv_record(seconds);
+  if (sensor_scheduler_start() != ESP_OK) {
+    return false;
+  }
+  host_sleep_us((int64_t)seconds * 1000 * 1000);
+  s_recording = false;
+
+  sensor_scheduler_footprint_t footprint;
+  sensor_scheduler_get_footprint(&footprint);
+  printf("scheduler: %d workers, %zu bytes static, %zu stack bytes, %zu used on the host\n",
+         SENSOR_SCHEDULER_WORKERS, footprint.static_bytes, footprint.stack_bytes, priv_stack_peak());
+  priv_report_timing(seconds, true);
+
+  /* Every job ran on its grid, give or take the run in flight at either end */
+  bool ok = true;
+  for (size_t i = 0; i < JOBS; i++) {
+    uint32_t expected = priv_expected_runs(&s_jobs[i], seconds);
+    if (s_jobs[i].runs + 1 < expected || s_jobs[i].runs > expected + 1) {
+      printf("sensor_scheduler_bench: %s ran %u times, expected %u\n", s_jobs[i].name,
+             s_jobs[i].runs, expected);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t seconds = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 10;
+  printf("sensor_scheduler_bench: %zu sensors for %u s per design\n", JOBS, seconds);
+
+  /* Stopped legacy tasks check the flag before their next read, so they
+   * record nothing into the scheduler's run */
+  priv_run_legacy(seconds);
+  if (!priv_run_scheduler(seconds)) {
+    printf("sensor_scheduler_bench: FAILED\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+/* cJSON is not built for the host. Every constructor and the parser return
+ * NULL (see cjson_host.c), so code that builds or parses JSON takes its
+ * error path; the binary uplink and logs do not depend on it. */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct cJSON {
+  struct cJSON *next;
+  struct cJSON *prev;
+  struct cJSON *child;
+  int           type;
+  char         *valuestring;
+  int           valueint;
+  double        valuedouble;
+  char         *string;
+} cJSON;
+
+typedef int cJSON_bool;
+
+cJSON     *cJSON_CreateObject(void);
+cJSON     *cJSON_ParseWithLength(const char *value, size_t buffer_length);
+void       cJSON_Delete(cJSON *item);
+char      *cJSON_PrintUnformatted(const cJSON *item);
+cJSON     *cJSON_AddNumberToObject(cJSON *object, const char *name, double number);
+cJSON     *cJSON_AddStringToObject(cJSON *object, const char *name, const char *string);
+cJSON     *cJSON_GetObjectItemCaseSensitive(const cJSON *object, const char *string);
+cJSON_bool cJSON_IsBool(const cJSON *item);
+cJSON_bool cJSON_IsTrue(const cJSON *item);
+cJSON_bool cJSON_IsNumber(const cJSON *item);
+cJSON_bool cJSON_IsString(const cJSON *item);
+
+#define cJSON_ArrayForEach(element, array) \
+  for (element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
@@ -0,0 +1,57 @@
+/* cJSON stand-ins that always fail; see cJSON.h. */
+
+#include "cJSON.h"
+
+cJSON *cJSON_CreateObject(void)
+{
+  return NULL;
+}
+
+cJSON *cJSON_ParseWithLength(const char *value, size_t buffer_length)
+{
+  return NULL;
+}
+
+void cJSON_Delete(cJSON *item)
+{
+}
+
+char *cJSON_PrintUnformatted(const cJSON *item)
+{
+  return NULL;
+}
+
+cJSON *cJSON_AddNumberToObject(cJSON *object, const char *name, double number)
+{
+  return NULL;
+}
+
+cJSON *cJSON_AddStringToObject(cJSON *object, const char *name, const char *string)
+{
+  return NULL;
+}
+
+cJSON *cJSON_GetObjectItemCaseSensitive(const cJSON *object, const char *string)
+{
+  return NULL;
+}
+
+cJSON_bool cJSON_IsBool(const cJSON *item)
+{
+  return 0;
+}
+
+cJSON_bool cJSON_IsTrue(const cJSON *item)
+{
+  return 0;
+}
+
+cJSON_bool cJSON_IsNumber(const cJSON *item)
+{
+  return 0;
+}
+
+cJSON_bool cJSON_IsString(const cJSON *item)
+{
+  return 0;
+}
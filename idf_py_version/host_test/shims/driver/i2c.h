@@ -0,0 +1,129 @@
+#pragma once
+
+/* Host stand-in for the legacy ESP-IDF I2C controller driver.
+ *
+ * Command links record their operations the way the IDF driver does, and
+ * `i2c_master_cmd_begin` plays them against device models attached with
+ * `host_i2c_attach` (see i2c_host.c). A command to an address with no model
+ * attached fails like a NACK. Each executed command also takes the time its
+ * bytes would need on the wire at the configured clock, and is counted in
+ * `host_i2c_get_stats`. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+typedef int i2c_port_t;
+
+enum {
+  I2C_NUM_0 = 0,
+  I2C_NUM_1,
+  I2C_NUM_MAX,
+};
+
+typedef enum {
+  I2C_MODE_SLAVE = 0,
+  I2C_MODE_MASTER,
+  I2C_MODE_MAX,
+} i2c_mode_t;
+
+typedef enum {
+  I2C_MASTER_WRITE = 0,
+  I2C_MASTER_READ,
+} i2c_rw_t;
+
+typedef enum {
+  I2C_MASTER_ACK = 0,
+  I2C_MASTER_NACK,
+  I2C_MASTER_LAST_NACK,
+  I2C_MASTER_ACK_MAX,
+} i2c_ack_type_t;
+
+typedef struct {
+  i2c_mode_t    mode;
+  int           sda_io_num;
+  int           scl_io_num;
+  bool          sda_pullup_en;
+  bool          scl_pullup_en;
+  union {
+    struct {
+      uint32_t clk_speed;
+    } master;
+    struct {
+      uint8_t  addr_10bit_en;
+      uint16_t slave_addr;
+      uint32_t maximum_speed;
+    } slave;
+  };
+  uint32_t      clk_flags;
+} i2c_config_t;
+
+typedef void *i2c_cmd_handle_t;
+
+/* One recorded command link operation */
+typedef struct {
+  uint8_t  type;
+  uint8_t  byte;
+  uint8_t  ack;
+  uint8_t *read_data;
+  size_t   len;
+  const uint8_t *write_data;
+} host_i2c_op_t;
+
+/* Command link header; the operations follow it in the same buffer */
+typedef struct {
+  size_t capacity;
+  size_t count;
+} host_i2c_link_t;
+
+#define I2C_LINK_RECOMMENDED_SIZE(TRANSACTIONS) \
+  (sizeof(host_i2c_link_t) + sizeof(host_i2c_op_t) * 5 * ((TRANSACTIONS) + 1))
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t *i2c_conf);
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len,
+                             size_t slv_tx_buf_len, int intr_alloc_flags);
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num);
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t *buffer, uint32_t size);
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+void             i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd_handle);
+void             i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle);
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t *data, size_t data_len,
+                           bool ack_en);
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t *data, i2c_ack_type_t ack);
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len,
+                          i2c_ack_type_t ack);
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle,
+                               TickType_t ticks_to_wait);
+
+/* Host only ******************************************************************/
+
+/* A device model on a host I2C bus. `write` receives the bytes of one write
+ * phase (everything after the address byte up to the next start or stop);
+ * `read` fills the bytes of a read phase, possibly in several calls. Either
+ * returns false to NACK. Both run on the thread executing the command. */
+typedef struct {
+  bool (*write)(void *ctx, const uint8_t *data, size_t len);
+  bool (*read)(void *ctx, uint8_t *data, size_t len);
+  void *ctx;
+} host_i2c_device_t;
+
+/* Attaches a device model at a 7-bit address, replacing any previous one */
+void host_i2c_attach(i2c_port_t i2c_num, uint8_t address, const host_i2c_device_t *device);
+
+/* What the commands executed on a bus put on the wire */
+typedef struct {
+  uint32_t commands;     /* Command links executed with i2c_master_cmd_begin */
+  uint32_t links_built;  /* Command links started with i2c_cmd_link_create(_static), on any bus */
+  uint32_t wire_bytes;   /* Bytes clocked, address bytes included */
+  uint64_t wire_time_us; /* Time the bus was busy at its clock: 9 clocks a byte, 1 per start or stop */
+} host_i2c_stats_t;
+
+void host_i2c_get_stats(i2c_port_t i2c_num, host_i2c_stats_t *stats);
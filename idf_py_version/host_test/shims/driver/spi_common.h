@@ -0,0 +1,10 @@
+#pragma once
+
+/* Types only; no SPI driver is available on the host */
+
+typedef enum {
+  SPI1_HOST = 0,
+  SPI2_HOST = 1,
+  SPI3_HOST = 2,
+  SPI_HOST_MAX,
+} spi_host_device_t;
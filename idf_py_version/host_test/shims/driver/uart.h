@@ -0,0 +1,14 @@
+#pragma once
+
+/* Only the types the HAL headers need */
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef int uart_port_t;
+
+enum {
+  UART_NUM_0 = 0,
+  UART_NUM_1,
+  UART_NUM_2,
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+/* Host stand-in for esp_http_client.h. By default no socket is opened:
+ * every request is handed to a server model the test installs with
+ * `host_http_serve` (see http_client_host.c). The client keeps a connection
+ * open across requests like the keep-alive client does, so ON_CONNECTED
+ * only fires after a close or a transport failure. After
+ * `host_http_listen`, requests go over real HTTP/1.1 connections to a
+ * loopback server instead, which answers with the same model. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct host_http_client *esp_http_client_handle_t;
+
+typedef enum {
+  HTTP_METHOD_GET,
+  HTTP_METHOD_POST,
+} esp_http_client_method_t;
+
+typedef enum {
+  HTTP_EVENT_ERROR,
+  HTTP_EVENT_ON_CONNECTED,
+  HTTP_EVENT_HEADERS_SENT,
+  HTTP_EVENT_ON_HEADER,
+  HTTP_EVENT_ON_DATA,
+  HTTP_EVENT_ON_FINISH,
+  HTTP_EVENT_DISCONNECTED,
+  HTTP_EVENT_REDIRECT,
+} esp_http_client_event_id_t;
+
+typedef struct esp_http_client_event {
+  esp_http_client_event_id_t event_id;
+  esp_http_client_handle_t   client;
+  void                      *data;
+  int                        data_len;
+  void                      *user_data;
+  char                      *header_key;
+  char                      *header_value;
+} esp_http_client_event_t;
+
+typedef esp_err_t (*http_event_handle_cb)(esp_http_client_event_t *evt);
+
+typedef struct {
+  const char              *url;
+  esp_http_client_method_t method;
+  int                      timeout_ms;
+  bool                     keep_alive_enable;
+  http_event_handle_cb     event_handler;
+  void                    *user_data;
+} esp_http_client_config_t;
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config);
+esp_err_t                esp_http_client_set_header(esp_http_client_handle_t client, const char *key,
+                                                    const char *value);
+esp_err_t                esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len);
+esp_err_t                esp_http_client_perform(esp_http_client_handle_t client);
+esp_err_t                esp_http_client_close(esp_http_client_handle_t client);
+esp_err_t                esp_http_client_cleanup(esp_http_client_handle_t client);
+int                      esp_http_client_get_status_code(esp_http_client_handle_t client);
+
+/* Server model: gets the body of each request and returns the status code
+ * to answer with, or -1 for a transport failure (no connection, reset or
+ * timeout), which costs the client its `timeout_ms` of scaled time. Without
+ * a model every request fails that way. */
+typedef int (*host_http_server_t)(const uint8_t *body, size_t length);
+
+void host_http_serve(host_http_server_t server);
+
+/* Starts an HTTP/1.1 server on a loopback port that answers each request
+ * with `server` (200 without one) and makes every client connect to it.
+ * With `keep_alive_max` > 0 the server closes a connection after that many
+ * requests, the way web servers limit keep-alive. */
+esp_err_t host_http_listen(host_http_server_t server, uint32_t keep_alive_max);
+
+/* Scaled time added to every TCP connect of the loopback transport, for a
+ * handshake round trip longer than the loopback one */
+extern int64_t host_http_connect_rtt_us;
+
+/* Connections the server accepted and requests it received */
+typedef struct {
+  uint32_t connections;
+  uint32_t requests;
+} host_http_stats_t;
+
+void host_http_get_stats(host_http_stats_t *stats);
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+  ESP_MAC_WIFI_STA,
+} esp_mac_type_t;
+
+/* Every host process reports the same MAC, see idf_host.c */
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include <stdint.h>
+
+/* CRC-32 (IEEE 802.3, reflected), chained like the ROM function: pass 0 to
+ * start and the previous result to continue, see idf_host.c */
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
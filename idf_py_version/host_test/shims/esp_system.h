@@ -0,0 +1,11 @@
+#pragma once
+
+#include "esp_err.h"
+
+typedef void (*shutdown_handler_t)(void);
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle);
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handle);
+
+/* Runs the shutdown handlers, newest first, and exits the process */
+void esp_restart(void) __attribute__((noreturn));
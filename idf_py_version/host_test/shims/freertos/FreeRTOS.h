@@ -0,0 +1,59 @@
+#pragma once
+
+/* Host stand-in for FreeRTOS as shipped with ESP-IDF.
+ *
+ * Tasks are detached pthreads, queues and semaphores are mutex/condvar
+ * pairs (see freertos_host.c), and critical sections are recursive mutexes.
+ * There is no scheduler, so priorities and core affinity are ignored. One
+ * tick is one millisecond of the scaled host clock (see idf_host.h). */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_attr.h"
+#include "esp_bit_defs.h"
+
+typedef uint32_t     TickType_t;
+typedef int          BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t      StackType_t;
+
+#define configTICK_RATE_HZ      (1000)
+#define configMAX_PRIORITIES    (25)
+#define configMAX_TASK_NAME_LEN (16)
+#define portNUM_PROCESSORS      (2)
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define pdTICKS_TO_MS(ticks)    ((uint32_t)(((uint64_t)(ticks) * 1000) / configTICK_RATE_HZ))
+
+#define pdFALSE         ((BaseType_t)0)
+#define pdTRUE          ((BaseType_t)1)
+#define pdFAIL          (pdFALSE)
+#define pdPASS          (pdTRUE)
+#define errQUEUE_EMPTY  ((BaseType_t)0)
+#define errQUEUE_FULL   ((BaseType_t)0)
+
+#define tskIDLE_PRIORITY (0)
+#define tskNO_AFFINITY   (0x7FFFFFFF)
+
+typedef struct {
+  pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+
+#define portENTER_CRITICAL(mux)     pthread_mutex_lock(&(mux)->mutex)
+#define portEXIT_CRITICAL(mux)      pthread_mutex_unlock(&(mux)->mutex)
+#define portENTER_CRITICAL_ISR(mux) pthread_mutex_lock(&(mux)->mutex)
+#define portEXIT_CRITICAL_ISR(mux)  pthread_mutex_unlock(&(mux)->mutex)
+#define taskENTER_CRITICAL(mux)     pthread_mutex_lock(&(mux)->mutex)
+#define taskEXIT_CRITICAL(mux)      pthread_mutex_unlock(&(mux)->mutex)
+#define portYIELD_FROM_ISR(...)     ((void)0)
+
+/* Static allocation buffers; the host always allocates from the heap */
+typedef struct { uint8_t unused; } StaticSemaphore_t;
+typedef struct { uint8_t unused; } StaticQueue_t;
+typedef struct { uint8_t unused; } StaticTask_t;
+typedef struct { uint8_t unused; } StaticRingbuffer_t;
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_queue *QueueHandle_t;
+typedef struct host_queue *QueueSetHandle_t;
+typedef struct host_queue *QueueSetMemberHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void          vQueueDelete(QueueHandle_t queue);
+BaseType_t    xQueueReset(QueueHandle_t queue);
+BaseType_t    xQueueGenericSend(QueueHandle_t queue, const void *item, TickType_t ticks, bool to_front);
+BaseType_t    xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t    xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t    xQueueOverwrite(QueueHandle_t queue, const void *item);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t   uxQueueSpacesAvailable(QueueHandle_t queue);
+
+QueueSetHandle_t       xQueueCreateSet(UBaseType_t length);
+BaseType_t             xQueueAddToSet(QueueSetMemberHandle_t member, QueueSetHandle_t set);
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set, TickType_t ticks);
+
+#define xQueueCreateStatic(length, size, storage, buffer) xQueueCreate((length), (size))
+#define xQueueSend(queue, item, ticks)                    xQueueGenericSend((queue), (item), (ticks), false)
+#define xQueueSendToBack(queue, item, ticks)              xQueueGenericSend((queue), (item), (ticks), false)
+#define xQueueSendToFront(queue, item, ticks)             xQueueGenericSend((queue), (item), (ticks), true)
+#define xQueueSendFromISR(queue, item, woken)             xQueueGenericSend((queue), (item), 0, false)
+#define xQueueSendToBackFromISR(queue, item, woken)       xQueueGenericSend((queue), (item), 0, false)
+#define xQueueReceiveFromISR(queue, item, woken)          xQueueReceive((queue), (item), 0)
+#define xQueueOverwriteFromISR(queue, item, woken)        xQueueOverwrite((queue), (item))
@@ -0,0 +1,35 @@
+#pragma once
+
+/* Host stand-in for the ESP-IDF ring buffer (see ringbuf_host.c).
+ *
+ * Only no-split buffers are modelled. Items keep the IDF layout: an 8-byte
+ * header in front of the data, sizes rounded up to 4 bytes, and an item
+ * that does not fit before the end of the storage wraps to the start and
+ * wastes the tail. Free and maximum item sizes are computed the same way,
+ * so peak usage measured on the host matches the target. */
+
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_ringbuf *RingbufHandle_t;
+
+typedef enum {
+  RINGBUF_TYPE_NOSPLIT = 0,
+  RINGBUF_TYPE_ALLOWSPLIT,
+  RINGBUF_TYPE_BYTEBUF,
+  RINGBUF_TYPE_MAX,
+} RingbufferType_t;
+
+RingbufHandle_t xRingbufferCreate(size_t buffer_size, RingbufferType_t type);
+void            vRingbufferDelete(RingbufHandle_t ring);
+
+BaseType_t xRingbufferSend(RingbufHandle_t ring, const void *item, size_t item_size,
+                           TickType_t ticks_to_wait);
+BaseType_t xRingbufferSendAcquire(RingbufHandle_t ring, void **item, size_t item_size,
+                                  TickType_t ticks_to_wait);
+BaseType_t xRingbufferSendComplete(RingbufHandle_t ring, void *item);
+void      *xRingbufferReceive(RingbufHandle_t ring, size_t *item_size, TickType_t ticks_to_wait);
+void       vRingbufferReturnItem(RingbufHandle_t ring, void *item);
+
+size_t xRingbufferGetMaxItemSize(RingbufHandle_t ring);
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t ring);
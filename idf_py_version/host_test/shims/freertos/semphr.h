@@ -0,0 +1,21 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/* Semaphores are queues of zero-sized items, as in FreeRTOS */
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+
+#define xSemaphoreCreateBinary()                   xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex()                    xSemaphoreCreateCounting(1, 1)
+#define xSemaphoreCreateRecursiveMutex()           xSemaphoreCreateCounting(1, 1)
+#define xSemaphoreCreateBinaryStatic(buffer)       xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutexStatic(buffer)        xSemaphoreCreateCounting(1, 1)
+#define xSemaphoreTake(sem, ticks)                 xQueueReceive((sem), NULL, (ticks))
+#define xSemaphoreGive(sem)                        xQueueGenericSend((sem), NULL, 0, false)
+#define xSemaphoreTakeFromISR(sem, woken)          xQueueReceive((sem), NULL, 0)
+#define xSemaphoreGiveFromISR(sem, woken)          xQueueGenericSend((sem), NULL, 0, false)
+#define uxSemaphoreGetCount(sem)                   uxQueueMessagesWaiting(sem)
+#define vSemaphoreDelete(sem)                      vQueueDelete(sem)
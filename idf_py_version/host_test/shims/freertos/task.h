@@ -0,0 +1,42 @@
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+  eNoAction = 0,
+  eSetBits,
+  eIncrement,
+  eSetValueWithOverwrite,
+  eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth,
+                       void *param, UBaseType_t priority, TaskHandle_t *created_task);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_depth,
+                                   void *param, UBaseType_t priority, TaskHandle_t *created_task,
+                                   BaseType_t core_id);
+void         vTaskDelete(TaskHandle_t task);
+void         vTaskDelay(TickType_t ticks);
+BaseType_t   xTaskDelayUntil(TickType_t *previous_wake, TickType_t increment);
+void         vTaskDelayUntil(TickType_t *previous_wake, TickType_t increment);
+TickType_t   xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t  uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+/* Host only: peak stack use of a task in bytes, including any use past the
+ * depth it asked for, which the high-water mark clamps to 0 */
+size_t host_task_stack_peak(TaskHandle_t task);
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              uint32_t *previous_value);
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t *value, TickType_t ticks);
+uint32_t   ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+
+#define xTaskNotify(task, value, action)                 xTaskGenericNotify((task), (value), (action), NULL)
+#define xTaskNotifyGive(task)                            xTaskGenericNotify((task), 0, eIncrement, NULL)
+#define xTaskNotifyFromISR(task, value, action, woken)   xTaskGenericNotify((task), (value), (action), NULL)
+#define vTaskNotifyGiveFromISR(task, woken)              ((void)xTaskGenericNotify((task), 0, eIncrement, NULL))
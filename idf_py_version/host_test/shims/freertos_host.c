@@ -0,0 +1,534 @@
+/* FreeRTOS tasks, queues, semaphores, queue sets, task notifications and
+ * event groups on top of pthreads. Good enough to run the firmware's
+ * producer/consumer code on the host; no scheduling semantics beyond
+ * blocking and waking are modelled.
+ *
+ * Task stacks are painted the way FreeRTOS does it, so
+ * uxTaskGetStackHighWaterMark reports what a task really used of the depth
+ * it asked for. Host frames are bigger than Xtensa ones and glibc's printf
+ * is deeper than newlib's, so every stack gets STACK_HOST_MARGIN on top of
+ * its depth and the figures err on the high side. */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include "idf_host.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+/* Waiting ********************************************************************/
+
+static void priv_cond_init(pthread_cond_t *cond)
+{
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(cond, &attr);
+  pthread_condattr_destroy(&attr);
+}
+
+/* Waits on `cond` until `deadline` (NULL: forever). Returns false on timeout. */
+static bool priv_wait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *deadline)
+{
+  if (deadline == NULL) {
+    pthread_cond_wait(cond, mutex);
+    return true;
+  }
+  return pthread_cond_timedwait(cond, mutex, deadline) != ETIMEDOUT;
+}
+
+/* Returns the deadline for `ticks`, or NULL for portMAX_DELAY */
+static const struct timespec *priv_deadline(TickType_t ticks, struct timespec *storage)
+{
+  if (ticks == portMAX_DELAY) {
+    return NULL;
+  }
+  host_deadline((int64_t)pdTICKS_TO_MS(ticks) * 1000, storage);
+  return storage;
+}
+
+/* Tasks **********************************************************************/
+
+#define STACK_HOST_MARGIN (1024 * 1024)
+#define STACK_PAINT       (0xa5)
+
+struct host_task {
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  uint32_t        notify_value;
+  bool            notify_pending;
+  TaskFunction_t  function;
+  void           *param;
+  uint8_t        *stack;       /* Lowest usable byte of the painted stack, NULL for main */
+  size_t          stack_size;  /* Painted bytes, margin included */
+  uint32_t        stack_depth; /* Bytes the task asked for */
+};
+
+static __thread struct host_task *s_current_task = NULL;
+
+static struct host_task *priv_task_new(TaskFunction_t function, void *param)
+{
+  struct host_task *task = calloc(1, sizeof(*task));
+  pthread_mutex_init(&task->mutex, NULL);
+  priv_cond_init(&task->cond);
+  task->function = function;
+  task->param    = param;
+  return task;
+}
+
+static void *priv_task_entry(void *arg)
+{
+  s_current_task = arg;
+  s_current_task->function(s_current_task->param);
+  return NULL;
+}
+
+/* Maps a painted stack with a guard page below it; the mapping outlives the
+ * task, like its handle does */
+static bool priv_task_stack(struct host_task *task, uint32_t stack_depth)
+{
+  size_t   page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t   size = ((size_t)stack_depth + STACK_HOST_MARGIN + page - 1) / page * page;
+  uint8_t *map  = mmap(NULL, size + page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  mprotect(map, page, PROT_NONE);
+  task->stack       = map + page;
+  task->stack_size  = size;
+  task->stack_depth = stack_depth;
+  memset(task->stack, STACK_PAINT, size);
+  return true;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack_depth,
+                                   void *param, UBaseType_t priority, TaskHandle_t *created_task,
+                                   BaseType_t core_id)
+{
+  struct host_task *task = priv_task_new(function, param);
+  pthread_attr_t    attr;
+  pthread_t         thread;
+  if (!priv_task_stack(task, stack_depth)) {
+    free(task);
+    return pdFAIL;
+  }
+  pthread_attr_init(&attr);
+  pthread_attr_setstack(&attr, task->stack, task->stack_size);
+  int err = pthread_create(&thread, &attr, priv_task_entry, task);
+  pthread_attr_destroy(&attr);
+  if (err != 0) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    munmap(task->stack - page, task->stack_size + page);
+    free(task);
+    return pdFAIL;
+  }
+  pthread_detach(thread);
+  if (created_task != NULL) {
+    *created_task = task;
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stack_depth,
+                       void *param, UBaseType_t priority, TaskHandle_t *created_task)
+{
+  return xTaskCreatePinnedToCore(function, name, stack_depth, param, priority, created_task,
+                                 tskNO_AFFINITY);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+  /* Threads not started through xTaskCreate (main) get a handle on first use */
+  if (s_current_task == NULL) {
+    s_current_task = priv_task_new(NULL, NULL);
+  }
+  return s_current_task;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  /* Only self-deletion is supported; the handle is leaked on purpose, since
+   * other tasks may still hold it. */
+  if (task == NULL || task == s_current_task) {
+    pthread_exit(NULL);
+  }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  host_sleep_us((int64_t)pdTICKS_TO_MS(ticks) * 1000);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+  return (TickType_t)pdMS_TO_TICKS(host_now_us() / 1000);
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *previous_wake, TickType_t increment)
+{
+  *previous_wake += increment;
+  TickType_t now  = xTaskGetTickCount();
+  int32_t    wait = (int32_t)(*previous_wake - now);
+  if (wait <= 0) {
+    return pdFALSE;
+  }
+  vTaskDelay((TickType_t)wait);
+  return pdTRUE;
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake, TickType_t increment)
+{
+  xTaskDelayUntil(previous_wake, increment);
+}
+
+size_t host_task_stack_peak(TaskHandle_t task)
+{
+  if (task == NULL) {
+    task = xTaskGetCurrentTaskHandle();
+  }
+  if (task->stack == NULL) {
+    return 0;
+  }
+
+  /* The stack grows down, so untouched paint is left at the low end */
+  size_t untouched = 0;
+  while (untouched < task->stack_size && task->stack[untouched] == STACK_PAINT) {
+    untouched++;
+  }
+  return task->stack_size - untouched;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+  if (task == NULL) {
+    task = xTaskGetCurrentTaskHandle();
+  }
+  size_t used = host_task_stack_peak(task);
+  return (task->stack != NULL && used < task->stack_depth) ? (UBaseType_t)(task->stack_depth - used) : 0;
+}
+
+BaseType_t xTaskGenericNotify(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              uint32_t *previous_value)
+{
+  BaseType_t ret = pdPASS;
+  pthread_mutex_lock(&task->mutex);
+  if (previous_value != NULL) {
+    *previous_value = task->notify_value;
+  }
+  switch (action) {
+    case eSetBits:                  task->notify_value |= value; break;
+    case eIncrement:                task->notify_value++; break;
+    case eSetValueWithOverwrite:    task->notify_value = value; break;
+    case eSetValueWithoutOverwrite:
+      if (task->notify_pending) {
+        ret = pdFAIL;
+      } else {
+        task->notify_value = value;
+      }
+      break;
+    case eNoAction:                 break;
+  }
+  task->notify_pending = true;
+  pthread_cond_broadcast(&task->cond);
+  pthread_mutex_unlock(&task->mutex);
+  return ret;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t *value, TickType_t ticks)
+{
+  struct host_task      *task = xTaskGetCurrentTaskHandle();
+  struct timespec        storage;
+  const struct timespec *deadline = priv_deadline(ticks, &storage);
+  BaseType_t             ret      = pdTRUE;
+
+  pthread_mutex_lock(&task->mutex);
+  if (!task->notify_pending) {
+    task->notify_value &= ~clear_on_entry;
+  }
+  while (!task->notify_pending && ticks > 0) {
+    if (!priv_wait(&task->cond, &task->mutex, deadline)) {
+      break;
+    }
+  }
+  if (value != NULL) {
+    *value = task->notify_value;
+  }
+  if (task->notify_pending) {
+    task->notify_value  &= ~clear_on_exit;
+    task->notify_pending = false;
+  } else {
+    ret = pdFALSE;
+  }
+  pthread_mutex_unlock(&task->mutex);
+  return ret;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+  struct host_task      *task = xTaskGetCurrentTaskHandle();
+  struct timespec        storage;
+  const struct timespec *deadline = priv_deadline(ticks, &storage);
+
+  pthread_mutex_lock(&task->mutex);
+  while (task->notify_value == 0 && ticks > 0) {
+    if (!priv_wait(&task->cond, &task->mutex, deadline)) {
+      break;
+    }
+  }
+  uint32_t value = task->notify_value;
+  if (value != 0) {
+    task->notify_value = clear_on_exit ? 0 : value - 1;
+  }
+  task->notify_pending = false;
+  pthread_mutex_unlock(&task->mutex);
+  return value;
+}
+
+/* Queues and semaphores ******************************************************/
+
+struct host_queue {
+  pthread_mutex_t    mutex;
+  pthread_cond_t     cond; /* Broadcast on every change */
+  uint8_t           *items;
+  size_t             item_size;
+  size_t             length;
+  size_t             head;
+  size_t             count;
+  struct host_queue *set;  /* Queue set this queue belongs to */
+};
+
+static struct host_queue *priv_queue_new(size_t length, size_t item_size)
+{
+  struct host_queue *queue = calloc(1, sizeof(*queue));
+  pthread_mutex_init(&queue->mutex, NULL);
+  priv_cond_init(&queue->cond);
+  queue->items     = calloc(length ? length : 1, item_size ? item_size : 1);
+  queue->item_size = item_size;
+  queue->length    = length;
+  return queue;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+  return priv_queue_new(length, item_size);
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+  if (queue == NULL) {
+    return;
+  }
+  pthread_mutex_destroy(&queue->mutex);
+  pthread_cond_destroy(&queue->cond);
+  free(queue->items);
+  free(queue);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+  struct host_queue *queue = priv_queue_new(max_count, 0);
+  queue->count             = initial_count;
+  return queue;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+  pthread_mutex_lock(&queue->mutex);
+  queue->head  = 0;
+  queue->count = 0;
+  pthread_cond_broadcast(&queue->cond);
+  pthread_mutex_unlock(&queue->mutex);
+  return pdPASS;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t queue, const void *item, TickType_t ticks, bool to_front)
+{
+  struct timespec        storage;
+  const struct timespec *deadline = priv_deadline(ticks, &storage);
+
+  pthread_mutex_lock(&queue->mutex);
+  while (queue->count == queue->length) {
+    if (ticks == 0 || !priv_wait(&queue->cond, &queue->mutex, deadline)) {
+      pthread_mutex_unlock(&queue->mutex);
+      return errQUEUE_FULL;
+    }
+  }
+
+  size_t slot;
+  if (to_front) {
+    queue->head = (queue->head + queue->length - 1) % queue->length;
+    slot        = queue->head;
+  } else {
+    slot = (queue->head + queue->count) % queue->length;
+  }
+  if (queue->item_size > 0) {
+    memcpy(&queue->items[slot * queue->item_size], item, queue->item_size);
+  }
+  queue->count++;
+  pthread_cond_broadcast(&queue->cond);
+  struct host_queue *set = queue->set;
+  pthread_mutex_unlock(&queue->mutex);
+
+  if (set != NULL) {
+    xQueueGenericSend(set, &queue, portMAX_DELAY, false);
+  }
+  return pdPASS;
+}
+
+static BaseType_t priv_queue_receive(QueueHandle_t queue, void *item, TickType_t ticks, bool remove)
+{
+  struct timespec        storage;
+  const struct timespec *deadline = priv_deadline(ticks, &storage);
+
+  pthread_mutex_lock(&queue->mutex);
+  while (queue->count == 0) {
+    if (ticks == 0 || !priv_wait(&queue->cond, &queue->mutex, deadline)) {
+      pthread_mutex_unlock(&queue->mutex);
+      return pdFALSE;
+    }
+  }
+
+  if (item != NULL && queue->item_size > 0) {
+    memcpy(item, &queue->items[queue->head * queue->item_size], queue->item_size);
+  }
+  if (remove) {
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_broadcast(&queue->cond);
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+  return priv_queue_receive(queue, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks)
+{
+  return priv_queue_receive(queue, item, ticks, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item)
+{
+  pthread_mutex_lock(&queue->mutex);
+  if (queue->count == queue->length) {
+    queue->count--;
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return xQueueGenericSend(queue, item, 0, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+  pthread_mutex_lock(&queue->mutex);
+  UBaseType_t count = queue->count;
+  pthread_mutex_unlock(&queue->mutex);
+  return count;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+  pthread_mutex_lock(&queue->mutex);
+  UBaseType_t spaces = queue->length - queue->count;
+  pthread_mutex_unlock(&queue->mutex);
+  return spaces;
+}
+
+QueueSetHandle_t xQueueCreateSet(UBaseType_t length)
+{
+  return priv_queue_new(length, sizeof(struct host_queue *));
+}
+
+BaseType_t xQueueAddToSet(QueueSetMemberHandle_t member, QueueSetHandle_t set)
+{
+  pthread_mutex_lock(&member->mutex);
+  member->set = set;
+  pthread_mutex_unlock(&member->mutex);
+  return pdPASS;
+}
+
+QueueSetMemberHandle_t xQueueSelectFromSet(QueueSetHandle_t set, TickType_t ticks)
+{
+  struct host_queue *member = NULL;
+  if (xQueueReceive(set, &member, ticks) != pdTRUE) {
+    return NULL;
+  }
+  return member;
+}
+
+/* Event groups ***************************************************************/
+
+struct host_event_group {
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+  EventBits_t     bits;
+};
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+  struct host_event_group *group = calloc(1, sizeof(*group));
+  pthread_mutex_init(&group->mutex, NULL);
+  priv_cond_init(&group->cond);
+  return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+  pthread_mutex_lock(&group->mutex);
+  group->bits |= bits;
+  EventBits_t now = group->bits;
+  pthread_cond_broadcast(&group->cond);
+  pthread_mutex_unlock(&group->mutex);
+  return now;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+  pthread_mutex_lock(&group->mutex);
+  EventBits_t before = group->bits;
+  group->bits       &= ~bits;
+  pthread_mutex_unlock(&group->mutex);
+  return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+  pthread_mutex_lock(&group->mutex);
+  EventBits_t bits = group->bits;
+  pthread_mutex_unlock(&group->mutex);
+  return bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks)
+{
+  struct timespec        storage;
+  const struct timespec *deadline = priv_deadline(ticks, &storage);
+
+  pthread_mutex_lock(&group->mutex);
+  while (true) {
+    EventBits_t set = group->bits & bits;
+    if (wait_for_all ? (set == bits) : (set != 0)) {
+      break;
+    }
+    if (ticks == 0 || !priv_wait(&group->cond, &group->mutex, deadline)) {
+      break;
+    }
+  }
+  EventBits_t result = group->bits;
+  EventBits_t set    = result & bits;
+  if (clear_on_exit && (wait_for_all ? (set == bits) : (set != 0))) {
+    group->bits &= ~bits;
+  }
+  pthread_mutex_unlock(&group->mutex);
+  return result;
+}
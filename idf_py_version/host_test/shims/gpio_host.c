@@ -0,0 +1,102 @@
+/* GPIO levels and interrupt handlers for the host; see driver/gpio.h. */
+
+#include "driver/gpio.h"
+#include <pthread.h>
+
+static pthread_mutex_t s_gpio_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool            s_isr_service_installed;
+static uint32_t        s_levels[GPIO_NUM_MAX];
+static gpio_isr_t      s_handlers[GPIO_NUM_MAX];
+static void           *s_handler_args[GPIO_NUM_MAX];
+
+static bool priv_valid(gpio_num_t gpio_num)
+{
+  return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX;
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+  if (config == NULL || config->pin_bit_mask == 0 ||
+      (config->pin_bit_mask >> GPIO_NUM_MAX) != 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+  return priv_valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+  if (!priv_valid(gpio_num)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pthread_mutex_lock(&s_gpio_lock);
+  s_levels[gpio_num] = level ? 1 : 0;
+  pthread_mutex_unlock(&s_gpio_lock);
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+  if (!priv_valid(gpio_num)) {
+    return 0;
+  }
+  pthread_mutex_lock(&s_gpio_lock);
+  int level = (int)s_levels[gpio_num];
+  pthread_mutex_unlock(&s_gpio_lock);
+  return level;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags)
+{
+  pthread_mutex_lock(&s_gpio_lock);
+  esp_err_t ret = s_isr_service_installed ? ESP_ERR_INVALID_STATE : ESP_OK;
+  s_isr_service_installed = true;
+  pthread_mutex_unlock(&s_gpio_lock);
+  return ret;
+}
+
+void gpio_uninstall_isr_service(void)
+{
+  pthread_mutex_lock(&s_gpio_lock);
+  s_isr_service_installed = false;
+  pthread_mutex_unlock(&s_gpio_lock);
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args)
+{
+  if (!priv_valid(gpio_num)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pthread_mutex_lock(&s_gpio_lock);
+  esp_err_t ret = ESP_ERR_INVALID_STATE;
+  if (s_isr_service_installed) {
+    s_handlers[gpio_num]     = isr_handler;
+    s_handler_args[gpio_num] = args;
+    ret                      = ESP_OK;
+  }
+  pthread_mutex_unlock(&s_gpio_lock);
+  return ret;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num)
+{
+  return gpio_isr_handler_add(gpio_num, NULL, NULL);
+}
+
+void host_gpio_trigger(gpio_num_t gpio_num)
+{
+  if (!priv_valid(gpio_num)) {
+    return;
+  }
+  pthread_mutex_lock(&s_gpio_lock);
+  gpio_isr_t handler = s_handlers[gpio_num];
+  void      *arg     = s_handler_args[gpio_num];
+  pthread_mutex_unlock(&s_gpio_lock);
+  if (handler != NULL) {
+    handler(arg);
+  }
+}
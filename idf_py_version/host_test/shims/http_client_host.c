@@ -0,0 +1,339 @@
+/* Host stand-in for the ESP-IDF HTTP client; see esp_http_client.h. */
+
+#include "esp_http_client.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "idf_host.h"
+
+#define HEADER_MAX (1024)
+#define BODY_MAX   (64 * 1024)
+
+struct host_http_client {
+  esp_http_client_config_t config;
+  const char              *body;
+  int                      body_len;
+  int                      status;
+  bool                     connected;
+  int                      fd;              /* Socket to the loopback server, -1 if none */
+  char                     content_type[64];
+};
+
+static host_http_server_t s_server   = NULL;
+static uint16_t           s_port     = 0; /* Port of the loopback server, 0 without one */
+static uint32_t           s_keep_max = 0; /* Requests per connection before the server closes it */
+static host_http_stats_t  s_stats    = { 0 };
+
+int64_t host_http_connect_rtt_us = 0;
+
+void host_http_serve(host_http_server_t server)
+{
+  s_server = server;
+}
+
+void host_http_get_stats(host_http_stats_t *stats)
+{
+  stats->connections = __atomic_load_n(&s_stats.connections, __ATOMIC_SEQ_CST);
+  stats->requests    = __atomic_load_n(&s_stats.requests, __ATOMIC_SEQ_CST);
+}
+
+static void priv_event(esp_http_client_handle_t client, esp_http_client_event_id_t event_id,
+                       void *data, int data_len)
+{
+  esp_http_client_event_t evt = { .event_id  = event_id, .client = client, .data = data,
+                                  .data_len  = data_len, .user_data = client->config.user_data };
+  if (client->config.event_handler != NULL) {
+    client->config.event_handler(&evt);
+  }
+}
+
+/* Loopback server ************************************************************/
+
+static bool priv_write_all(int fd, const void *data, size_t length)
+{
+  const uint8_t *bytes = data;
+  while (length > 0) {
+    ssize_t n = send(fd, bytes, length, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    bytes  += n;
+    length -= (size_t)n;
+  }
+  return true;
+}
+
+static bool priv_read_all(int fd, void *data, size_t length)
+{
+  uint8_t *bytes = data;
+  while (length > 0) {
+    ssize_t n = recv(fd, bytes, length, 0);
+    if (n <= 0) {
+      return false;
+    }
+    bytes  += n;
+    length -= (size_t)n;
+  }
+  return true;
+}
+
+/* Reads a header block up to the blank line; returns its length or -1 */
+static int priv_read_header(int fd, char *header, size_t size)
+{
+  size_t length = 0;
+  while (length < size - 1) {
+    if (recv(fd, &header[length], 1, 0) != 1) {
+      return -1;
+    }
+    length++;
+    if (length >= 4 && memcmp(&header[length - 4], "\r\n\r\n", 4) == 0) {
+      header[length] = '\0';
+      return (int)length;
+    }
+  }
+  return -1;
+}
+
+static long priv_content_length(const char *header)
+{
+  const char *field = strcasestr(header, "\r\nContent-Length:");
+  return (field != NULL) ? strtol(field + 17, NULL, 10) : 0;
+}
+
+/* Serves one connection: each request body goes to the server model */
+static void *priv_connection_thread(void *arg)
+{
+  int      fd       = (int)(intptr_t)arg;
+  uint8_t *body     = malloc(BODY_MAX);
+  uint32_t requests = 0;
+  char     header[HEADER_MAX];
+
+  while (body != NULL && priv_read_header(fd, header, sizeof(header)) > 0) {
+    long length = priv_content_length(header);
+    if (length < 0 || length > BODY_MAX || !priv_read_all(fd, body, (size_t)length)) {
+      break;
+    }
+    __atomic_add_fetch(&s_stats.requests, 1, __ATOMIC_SEQ_CST);
+
+    int status = (s_server != NULL) ? s_server(body, (size_t)length) : 200;
+    if (status < 0) {
+      break;
+    }
+
+    bool last = (s_keep_max > 0 && ++requests >= s_keep_max);
+    int  len  = snprintf(header, sizeof(header), "HTTP/1.1 %d Status\r\nContent-Length: 0\r\n"
+                         "Connection: %s\r\n\r\n", status, last ? "close" : "keep-alive");
+    if (!priv_write_all(fd, header, (size_t)len) || last) {
+      break;
+    }
+  }
+
+  free(body);
+  close(fd);
+  return NULL;
+}
+
+static void *priv_accept_thread(void *arg)
+{
+  int listener = (int)(intptr_t)arg;
+  while (1) {
+    int fd = accept(listener, NULL, NULL);
+    if (fd < 0) {
+      continue;
+    }
+    __atomic_add_fetch(&s_stats.connections, 1, __ATOMIC_SEQ_CST);
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, priv_connection_thread, (void *)(intptr_t)fd) == 0) {
+      pthread_detach(thread);
+    } else {
+      close(fd);
+    }
+  }
+  return NULL;
+}
+
+esp_err_t host_http_listen(host_http_server_t server, uint32_t keep_alive_max)
+{
+  int                listener = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr     = { .sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+  socklen_t          addr_len = sizeof(addr);
+  if (listener < 0 || bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(listener, 64) != 0 || getsockname(listener, (struct sockaddr *)&addr, &addr_len) != 0) {
+    return ESP_FAIL;
+  }
+
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, priv_accept_thread, (void *)(intptr_t)listener) != 0) {
+    close(listener);
+    return ESP_FAIL;
+  }
+  pthread_detach(thread);
+
+  s_server   = server;
+  s_keep_max = keep_alive_max;
+  s_port     = ntohs(addr.sin_port);
+  return ESP_OK;
+}
+
+/* Client *********************************************************************/
+
+static void priv_disconnect(esp_http_client_handle_t client)
+{
+  if (client->fd >= 0) {
+    close(client->fd);
+    client->fd = -1;
+  }
+  client->connected = false;
+}
+
+static esp_err_t priv_connect(esp_http_client_handle_t client)
+{
+  client->fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (client->fd < 0) {
+    return ESP_ERR_HTTP_CONNECT;
+  }
+
+  int            one     = 1;
+  struct timeval timeout = { .tv_sec  = client->config.timeout_ms / 1000,
+                             .tv_usec = (client->config.timeout_ms % 1000) * 1000 };
+  setsockopt(client->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  setsockopt(client->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(s_port),
+                              .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+  host_sleep_us(host_http_connect_rtt_us);
+  if (connect(client->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    priv_disconnect(client);
+    return ESP_ERR_HTTP_CONNECT;
+  }
+  client->connected = true;
+  priv_event(client, HTTP_EVENT_ON_CONNECTED, NULL, 0);
+  return ESP_OK;
+}
+
+/* One request on the loopback server, over the open connection if there is one */
+static esp_err_t priv_perform_socket(esp_http_client_handle_t client)
+{
+  if (!client->connected && priv_connect(client) != ESP_OK) {
+    return ESP_ERR_HTTP_CONNECT;
+  }
+
+  char header[HEADER_MAX];
+  int  len = snprintf(header, sizeof(header), "POST /api/frames HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+                      "Content-Type: %s\r\nContent-Length: %d\r\n\r\n",
+                      client->content_type, client->body_len);
+  if (!priv_write_all(client->fd, header, (size_t)len) ||
+      !priv_write_all(client->fd, client->body, (size_t)client->body_len) ||
+      priv_read_header(client->fd, header, sizeof(header)) < 0) {
+    priv_disconnect(client);
+    return ESP_ERR_HTTP_CONNECT;
+  }
+
+  client->status = atoi(&header[9]);
+  long length    = priv_content_length(header);
+  if (length > 0) {
+    char *body = malloc((size_t)length);
+    if (body == NULL || !priv_read_all(client->fd, body, (size_t)length)) {
+      free(body);
+      priv_disconnect(client);
+      return ESP_ERR_HTTP_CONNECT;
+    }
+    priv_event(client, HTTP_EVENT_ON_DATA, body, (int)length);
+    free(body);
+  }
+  if (strcasestr(header, "\r\nConnection: close") != NULL) {
+    priv_disconnect(client);
+  }
+  priv_event(client, HTTP_EVENT_ON_FINISH, NULL, 0);
+  return ESP_OK;
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config)
+{
+  esp_http_client_handle_t client = calloc(1, sizeof(*client));
+  if (client != NULL) {
+    client->config = *config;
+    client->fd     = -1;
+  }
+  return client;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value)
+{
+  if (client == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (strcasecmp(key, "Content-Type") == 0) {
+    snprintf(client->content_type, sizeof(client->content_type), "%s", value);
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len)
+{
+  if (client == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  client->body     = data;
+  client->body_len = len;
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client)
+{
+  if (client == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (s_port != 0) {
+    return priv_perform_socket(client);
+  }
+
+  int status = (s_server != NULL) ? s_server((const uint8_t *)client->body, (size_t)client->body_len) : -1;
+  if (status < 0) {
+    client->connected = false;
+    client->status    = 0;
+    host_sleep_us((int64_t)client->config.timeout_ms * 1000);
+    return ESP_ERR_HTTP_CONNECT;
+  }
+
+  if (!client->connected) {
+    client->connected = true;
+    __atomic_add_fetch(&s_stats.connections, 1, __ATOMIC_SEQ_CST);
+    priv_event(client, HTTP_EVENT_ON_CONNECTED, NULL, 0);
+  }
+  __atomic_add_fetch(&s_stats.requests, 1, __ATOMIC_SEQ_CST);
+  client->status = status;
+  priv_event(client, HTTP_EVENT_ON_FINISH, NULL, 0);
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+  if (client != NULL) {
+    priv_disconnect(client);
+  }
+  return ESP_OK;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client)
+{
+  if (client != NULL) {
+    priv_disconnect(client);
+  }
+  free(client);
+  return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client)
+{
+  return (client != NULL) ? client->status : 0;
+}
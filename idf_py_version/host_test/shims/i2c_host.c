@@ -0,0 +1,290 @@
+/* The legacy I2C controller driver on the host: command links are recorded
+ * as in ESP-IDF and played against the device models attached with
+ * `host_i2c_attach`; see driver/i2c.h. */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "idf_host.h"
+#include "driver/i2c.h"
+
+enum {
+  k_op_start = 0,
+  k_op_stop,
+  k_op_write_byte,
+  k_op_write,
+  k_op_read,
+};
+
+/* Longest write phase a device model can receive */
+#define HOST_I2C_MAX_WRITE (256)
+
+typedef struct {
+  bool              installed;
+  uint32_t          clk_speed;
+  pthread_mutex_t   lock;          /* The driver serializes commands per port */
+  host_i2c_device_t devices[128];
+  host_i2c_stats_t  stats;         /* Guarded by `lock`, except `links_built` */
+} host_i2c_bus_t;
+
+static host_i2c_bus_t s_buses[I2C_NUM_MAX] = {
+  { .lock = PTHREAD_MUTEX_INITIALIZER },
+  { .lock = PTHREAD_MUTEX_INITIALIZER },
+};
+static i2c_config_t   s_configs[I2C_NUM_MAX];
+static uint32_t       s_links_built = 0;
+
+static bool priv_valid(i2c_port_t i2c_num)
+{
+  return i2c_num >= 0 && i2c_num < I2C_NUM_MAX;
+}
+
+static host_i2c_op_t *priv_op_append(i2c_cmd_handle_t cmd_handle, uint8_t type)
+{
+  host_i2c_link_t *link = cmd_handle;
+  if (link == NULL || link->count >= link->capacity) {
+    return NULL;
+  }
+  host_i2c_op_t *op = &((host_i2c_op_t *)(link + 1))[link->count++];
+  memset(op, 0, sizeof(*op));
+  op->type = type;
+  return op;
+}
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t *i2c_conf)
+{
+  if (!priv_valid(i2c_num) || i2c_conf == NULL || i2c_conf->mode != I2C_MODE_MASTER ||
+      i2c_conf->master.clk_speed == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  s_configs[i2c_num] = *i2c_conf;
+  return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len,
+                             size_t slv_tx_buf_len, int intr_alloc_flags)
+{
+  if (!priv_valid(i2c_num) || mode != I2C_MODE_MASTER) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  host_i2c_bus_t *bus = &s_buses[i2c_num];
+  pthread_mutex_lock(&bus->lock);
+  esp_err_t ret = bus->installed ? ESP_FAIL : ESP_OK;
+  bus->installed = true;
+  bus->clk_speed = s_configs[i2c_num].master.clk_speed;
+  pthread_mutex_unlock(&bus->lock);
+  return ret;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num)
+{
+  if (!priv_valid(i2c_num)) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  pthread_mutex_lock(&s_buses[i2c_num].lock);
+  s_buses[i2c_num].installed = false;
+  pthread_mutex_unlock(&s_buses[i2c_num].lock);
+  return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t *buffer, uint32_t size)
+{
+  if (buffer == NULL || size < I2C_LINK_RECOMMENDED_SIZE(0) ||
+      ((uintptr_t)buffer % _Alignof(host_i2c_op_t)) != 0) {
+    return NULL;
+  }
+  host_i2c_link_t *link = (host_i2c_link_t *)buffer;
+  link->capacity = (size - sizeof(host_i2c_link_t)) / sizeof(host_i2c_op_t);
+  link->count    = 0;
+  __atomic_add_fetch(&s_links_built, 1, __ATOMIC_SEQ_CST);
+  return link;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+  size_t size = I2C_LINK_RECOMMENDED_SIZE(8);
+  return i2c_cmd_link_create_static(malloc(size), size);
+}
+
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd_handle)
+{
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle)
+{
+  free(cmd_handle);
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle)
+{
+  return priv_op_append(cmd_handle, k_op_start) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle)
+{
+  return priv_op_append(cmd_handle, k_op_stop) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en)
+{
+  host_i2c_op_t *op = priv_op_append(cmd_handle, k_op_write_byte);
+  if (op == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  op->byte = data;
+  op->len  = 1;
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t *data, size_t data_len,
+                           bool ack_en)
+{
+  if (data == NULL || data_len == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  host_i2c_op_t *op = priv_op_append(cmd_handle, k_op_write);
+  if (op == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  op->write_data = data;
+  op->len        = data_len;
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len,
+                          i2c_ack_type_t ack)
+{
+  if (data == NULL || data_len == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  host_i2c_op_t *op = priv_op_append(cmd_handle, k_op_read);
+  if (op == NULL) {
+    return ESP_ERR_NO_MEM;
+  }
+  op->read_data = data;
+  op->len       = data_len;
+  op->ack       = ack;
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t *data, i2c_ack_type_t ack)
+{
+  return i2c_master_read(cmd_handle, data, 1, ack);
+}
+
+/* Hands the collected write phase to the addressed device */
+static bool priv_flush_write(host_i2c_device_t *device, uint8_t *data, size_t *len)
+{
+  bool ack = true;
+  if (device != NULL && *len > 0) {
+    ack = device->write == NULL || device->write(device->ctx, data, *len);
+  }
+  *len = 0;
+  return ack;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle,
+                               TickType_t ticks_to_wait)
+{
+  host_i2c_link_t *link = cmd_handle;
+  if (!priv_valid(i2c_num) || link == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  host_i2c_bus_t *bus = &s_buses[i2c_num];
+  pthread_mutex_lock(&bus->lock);
+  if (!bus->installed) {
+    pthread_mutex_unlock(&bus->lock);
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  const host_i2c_op_t *ops         = (const host_i2c_op_t *)(link + 1);
+  host_i2c_device_t   *device      = NULL;
+  bool                 expect_addr = false;
+  bool                 ok          = true;
+  size_t               wire_bytes  = 0;
+  size_t               conditions  = 0;
+  uint8_t              pending[HOST_I2C_MAX_WRITE];
+  size_t               pending_len = 0;
+
+  for (size_t i = 0; ok && i < link->count; i++) {
+    const host_i2c_op_t *op = &ops[i];
+    switch (op->type) {
+    case k_op_start:
+    case k_op_stop:
+      conditions++;
+      ok          = priv_flush_write(device, pending, &pending_len);
+      expect_addr = (op->type == k_op_start);
+      break;
+
+    case k_op_write_byte:
+    case k_op_write: {
+      const uint8_t *data = (op->type == k_op_write) ? op->write_data : &op->byte;
+      size_t         len  = op->len;
+      wire_bytes += len;
+      if (expect_addr) {
+        /* The first byte after a start addresses a device; the rest is payload */
+        device      = &bus->devices[data[0] >> 1];
+        expect_addr = false;
+        if (device->write == NULL && device->read == NULL) {
+          ok = false;
+          break;
+        }
+        data++;
+        len--;
+      }
+      if (pending_len + len > sizeof(pending)) {
+        ok = false;
+        break;
+      }
+      memcpy(&pending[pending_len], data, len);
+      pending_len += len;
+      break;
+    }
+
+    case k_op_read:
+      wire_bytes += op->len;
+      ok = device != NULL && !expect_addr && device->read != NULL &&
+           device->read(device->ctx, op->read_data, op->len);
+      break;
+    }
+  }
+  if (ok) {
+    ok = priv_flush_write(device, pending, &pending_len);
+  }
+
+  /* Nine clocks per byte on the wire, plus one per start and stop */
+  uint64_t wire_time_us = (wire_bytes * 9 + conditions) * 1000000ULL / bus->clk_speed;
+  bus->stats.commands++;
+  bus->stats.wire_bytes   += wire_bytes;
+  bus->stats.wire_time_us += wire_time_us;
+  host_sleep_us((int64_t)wire_time_us);
+  pthread_mutex_unlock(&bus->lock);
+
+  return ok ? ESP_OK : ESP_FAIL;
+}
+
+void host_i2c_attach(i2c_port_t i2c_num, uint8_t address, const host_i2c_device_t *device)
+{
+  if (!priv_valid(i2c_num) || address >= 128) {
+    return;
+  }
+  pthread_mutex_lock(&s_buses[i2c_num].lock);
+  if (device != NULL) {
+    s_buses[i2c_num].devices[address] = *device;
+  } else {
+    memset(&s_buses[i2c_num].devices[address], 0, sizeof(host_i2c_device_t));
+  }
+  pthread_mutex_unlock(&s_buses[i2c_num].lock);
+}
+
+void host_i2c_get_stats(i2c_port_t i2c_num, host_i2c_stats_t *stats)
+{
+  memset(stats, 0, sizeof(*stats));
+  if (priv_valid(i2c_num)) {
+    pthread_mutex_lock(&s_buses[i2c_num].lock);
+    *stats = s_buses[i2c_num].stats;
+    pthread_mutex_unlock(&s_buses[i2c_num].lock);
+  }
+  stats->links_built = __atomic_load_n(&s_links_built, __ATOMIC_SEQ_CST);
+}
@@ -0,0 +1,179 @@
+/* Host implementations of the small ESP-IDF services used by the modules
+ * under test: error names, logging, the MAC address, esp_timer, the
+ * shutdown handlers and the ROM CRC. */
+
+#include "idf_host.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "esp_rom_crc.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+double host_time_scale = 1.0;
+
+static int64_t priv_real_us(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t s_start_us = 0;
+
+__attribute__((constructor)) static void priv_host_clock_init(void)
+{
+  s_start_us = priv_real_us();
+}
+
+int64_t host_now_us(void)
+{
+  return (int64_t)((double)(priv_real_us() - s_start_us) * host_time_scale);
+}
+
+void host_sleep_us(int64_t us)
+{
+  if (us <= 0) {
+    return;
+  }
+  int64_t         real = (int64_t)((double)us / host_time_scale);
+  struct timespec ts   = { .tv_sec = real / 1000000, .tv_nsec = (real % 1000000) * 1000 };
+  while (nanosleep(&ts, &ts) != 0) {
+  }
+}
+
+void host_deadline(int64_t timeout_us, struct timespec *deadline)
+{
+  int64_t real = (int64_t)((double)timeout_us / host_time_scale);
+  clock_gettime(CLOCK_MONOTONIC, deadline);
+  deadline->tv_sec  += real / 1000000;
+  deadline->tv_nsec += (real % 1000000) * 1000;
+  if (deadline->tv_nsec >= 1000000000) {
+    deadline->tv_sec++;
+    deadline->tv_nsec -= 1000000000;
+  }
+}
+
+int64_t esp_timer_get_time(void)
+{
+  return host_now_us();
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+  crc = ~crc;
+  for (uint32_t i = 0; i < len; i++) {
+    crc ^= buf[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+    }
+  }
+  return ~crc;
+}
+
+/* Same limit as ESP-IDF */
+#define SHUTDOWN_HANDLERS_NO (5)
+
+static shutdown_handler_t s_shutdown_handlers[SHUTDOWN_HANDLERS_NO];
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle)
+{
+  for (int i = 0; i < SHUTDOWN_HANDLERS_NO; i++) {
+    if (s_shutdown_handlers[i] == handle) {
+      return ESP_ERR_INVALID_STATE;
+    }
+    if (s_shutdown_handlers[i] == NULL) {
+      s_shutdown_handlers[i] = handle;
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_NO_MEM;
+}
+
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handle)
+{
+  for (int i = 0; i < SHUTDOWN_HANDLERS_NO; i++) {
+    if (s_shutdown_handlers[i] == handle) {
+      s_shutdown_handlers[i] = NULL;
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_INVALID_STATE;
+}
+
+void host_run_shutdown_handlers(void)
+{
+  for (int i = SHUTDOWN_HANDLERS_NO - 1; i >= 0; i--) {
+    if (s_shutdown_handlers[i] != NULL) {
+      s_shutdown_handlers[i]();
+    }
+  }
+}
+
+void esp_restart(void)
+{
+  host_run_shutdown_handlers();
+  exit(0);
+}
+
+esp_err_t esp_read_mac(uint8_t *mac, esp_mac_type_t type)
+{
+  static const uint8_t host_mac[6] = { 0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56 };
+  memcpy(mac, host_mac, sizeof(host_mac));
+  return ESP_OK;
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+  switch (code) {
+    case ESP_OK:                   return "ESP_OK";
+    case ESP_FAIL:                 return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:           return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:    return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:     return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:        return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:    return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:          return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_RESPONSE: return "ESP_ERR_INVALID_RESPONSE";
+    case ESP_ERR_INVALID_CRC:      return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_INVALID_VERSION:  return "ESP_ERR_INVALID_VERSION";
+    case ESP_ERR_NOT_FINISHED:     return "ESP_ERR_NOT_FINISHED";
+    case ESP_ERR_HTTP_CONNECT:     return "ESP_ERR_HTTP_CONNECT";
+    default:                       return "ESP_ERR_UNKNOWN";
+  }
+}
+
+void host_log(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+  static int max_level = -1;
+  if (max_level < 0) {
+    const char *env = getenv("HOST_LOG");
+    max_level       = ESP_LOG_WARN;
+    if (env != NULL && strcmp(env, "none") == 0) {
+      max_level = ESP_LOG_NONE;
+    } else if (env != NULL && strcmp(env, "info") == 0) {
+      max_level = ESP_LOG_INFO;
+    } else if (env != NULL && strcmp(env, "debug") == 0) {
+      max_level = ESP_LOG_VERBOSE;
+    } else if (env != NULL && strcmp(env, "error") == 0) {
+      max_level = ESP_LOG_ERROR;
+    }
+  }
+  if (level > max_level) {
+    return;
+  }
+
+  static const char letters[] = "-EWIDV";
+  fprintf(stderr, "%c (%lld) %s: ", letters[level], (long long)(host_now_us() / 1000), tag);
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/* Host-side helpers shared by the shims and the tests.
+ *
+ * All time in the shims (ticks, esp_timer, delays and timeouts) runs on one
+ * clock that advances `host_time_scale` times faster than real time, so tests
+ * that wait on retry intervals or throttles can run in a fraction of the real
+ * duration. The scale is 1 unless a test sets it before starting any task. */
+
+#include <stdint.h>
+
+extern double host_time_scale;
+
+/* Microseconds since the process started, scaled */
+int64_t host_now_us(void);
+
+/* Sleeps for `us` microseconds of scaled time */
+void host_sleep_us(int64_t us);
+
+/* Converts a scaled timeout into an absolute CLOCK_MONOTONIC deadline */
+struct timespec;
+void host_deadline(int64_t timeout_us, struct timespec *deadline);
+
+/* Runs the handlers registered with esp_register_shutdown_handler, newest
+ * first, the way esp_restart does, but keeps the process running */
+void host_run_shutdown_handlers(void);
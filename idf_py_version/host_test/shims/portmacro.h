@@ -0,0 +1,5 @@
+#pragma once
+
+/* ESP-IDF headers include portmacro.h for the FreeRTOS port types */
+
+#include "freertos/FreeRTOS.h"
@@ -0,0 +1,250 @@
+/* No-split ring buffer with the storage layout of the ESP-IDF one: items
+ * are acquired in order at the head, become readable once completed, and
+ * their space is reclaimed in order at the tail once returned. */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "idf_host.h"
+#include "freertos/ringbuf.h"
+
+#define HEADER_SIZE   (8)
+#define FLAG_WRITTEN  (1u << 0)
+#define FLAG_RETURNED (1u << 1)
+#define FLAG_WRAP     (1u << 2) /* Dummy header: the rest of the storage is unused */
+#define ALIGN(size)   (((size) + 3) & ~(size_t)3)
+
+typedef struct {
+  uint32_t len;
+  uint32_t flags;
+} ringbuf_header_t;
+
+struct host_ringbuf {
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;  /* Broadcast on every change */
+  uint8_t        *storage;
+  size_t          size;
+  size_t          head;  /* Where the next item is acquired */
+  size_t          tail;  /* Oldest item not returned yet */
+  size_t          read;  /* Oldest item not received yet */
+  size_t          used;  /* Bytes between tail and head, including wasted ends */
+  size_t          unread;
+};
+
+static ringbuf_header_t *priv_header(struct host_ringbuf *ring, size_t offset)
+{
+  return (ringbuf_header_t *)&ring->storage[offset];
+}
+
+/* Whether the storage from `offset` to its end is a wasted wrap area */
+static bool priv_wraps_at(struct host_ringbuf *ring, size_t offset)
+{
+  return ring->size - offset < HEADER_SIZE || (priv_header(ring, offset)->flags & FLAG_WRAP);
+}
+
+/* Largest contiguous allocation possible right now, header included */
+static size_t priv_contiguous_free(struct host_ringbuf *ring)
+{
+  if (ring->used == 0) {
+    return ring->size;
+  }
+  if (ring->head == ring->tail) {
+    return 0;
+  }
+  if (ring->head > ring->tail) {
+    size_t end = ring->size - ring->head;
+    return (end > ring->tail) ? end : ring->tail;
+  }
+  return ring->tail - ring->head;
+}
+
+static size_t priv_max_item_size(struct host_ringbuf *ring)
+{
+  return ALIGN(ring->size / 2) - HEADER_SIZE;
+}
+
+/* Allocates an item of `need` bytes, header included; NULL if it does not fit */
+static ringbuf_header_t *priv_alloc(struct host_ringbuf *ring, size_t need)
+{
+  if (ring->used == 0) {
+    ring->head = ring->tail = ring->read = 0;
+  } else if (ring->head == ring->tail) {
+    return NULL;
+  }
+
+  if (ring->head >= ring->tail) {
+    if (ring->size - ring->head < need) {
+      if (ring->tail < need) {
+        return NULL;
+      }
+      if (ring->size - ring->head >= HEADER_SIZE) {
+        priv_header(ring, ring->head)->flags = FLAG_WRAP;
+      }
+      ring->used += ring->size - ring->head;
+      ring->head  = 0;
+    }
+  } else if (ring->tail - ring->head < need) {
+    return NULL;
+  }
+
+  ringbuf_header_t *header = priv_header(ring, ring->head);
+  header->flags = 0;
+  ring->head    = (ring->head + need) % ring->size;
+  ring->used   += need;
+  ring->unread++;
+  return header;
+}
+
+RingbufHandle_t xRingbufferCreate(size_t buffer_size, RingbufferType_t type)
+{
+  if (type != RINGBUF_TYPE_NOSPLIT || buffer_size < 2 * HEADER_SIZE) {
+    return NULL;
+  }
+  struct host_ringbuf *ring = calloc(1, sizeof(*ring));
+  pthread_mutex_init(&ring->mutex, NULL);
+  pthread_condattr_t attr;
+  pthread_condattr_init(&attr);
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&ring->cond, &attr);
+  pthread_condattr_destroy(&attr);
+  ring->size    = ALIGN(buffer_size);
+  ring->storage = calloc(1, ring->size);
+  return ring;
+}
+
+void vRingbufferDelete(RingbufHandle_t ring)
+{
+  free(ring->storage);
+  free(ring);
+}
+
+/* Allocates an item of `item_size` data bytes, waiting up to `ticks_to_wait`;
+ * returns with the mutex held, or NULL with it released */
+static ringbuf_header_t *priv_acquire(struct host_ringbuf *ring, size_t item_size, TickType_t ticks_to_wait)
+{
+  if (item_size > priv_max_item_size(ring)) {
+    return NULL;
+  }
+
+  struct timespec deadline;
+  if (ticks_to_wait != portMAX_DELAY) {
+    host_deadline((int64_t)pdTICKS_TO_MS(ticks_to_wait) * 1000, &deadline);
+  }
+
+  pthread_mutex_lock(&ring->mutex);
+  ringbuf_header_t *header;
+  while ((header = priv_alloc(ring, HEADER_SIZE + ALIGN(item_size))) == NULL) {
+    if (ticks_to_wait == 0 ||
+        (ticks_to_wait == portMAX_DELAY ? pthread_cond_wait(&ring->cond, &ring->mutex)
+                                        : pthread_cond_timedwait(&ring->cond, &ring->mutex, &deadline)) != 0) {
+      pthread_mutex_unlock(&ring->mutex);
+      return NULL;
+    }
+  }
+  header->len = (uint32_t)item_size;
+  return header;
+}
+
+BaseType_t xRingbufferSendAcquire(RingbufHandle_t ring, void **item, size_t item_size,
+                                  TickType_t ticks_to_wait)
+{
+  ringbuf_header_t *header = priv_acquire(ring, item_size, ticks_to_wait);
+  if (header == NULL) {
+    return pdFALSE;
+  }
+  *item = header + 1;
+  pthread_mutex_unlock(&ring->mutex);
+  return pdTRUE;
+}
+
+BaseType_t xRingbufferSendComplete(RingbufHandle_t ring, void *item)
+{
+  pthread_mutex_lock(&ring->mutex);
+  ((ringbuf_header_t *)item - 1)->flags |= FLAG_WRITTEN;
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->mutex);
+  return pdTRUE;
+}
+
+/* Copies the item in under the same lock that allocates it, as ESP-IDF does */
+BaseType_t xRingbufferSend(RingbufHandle_t ring, const void *item, size_t item_size,
+                           TickType_t ticks_to_wait)
+{
+  ringbuf_header_t *header = priv_acquire(ring, item_size, ticks_to_wait);
+  if (header == NULL) {
+    return pdFALSE;
+  }
+  memcpy(header + 1, item, item_size);
+  header->flags |= FLAG_WRITTEN;
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->mutex);
+  return pdTRUE;
+}
+
+void *xRingbufferReceive(RingbufHandle_t ring, size_t *item_size, TickType_t ticks_to_wait)
+{
+  struct timespec deadline;
+  if (ticks_to_wait != portMAX_DELAY) {
+    host_deadline((int64_t)pdTICKS_TO_MS(ticks_to_wait) * 1000, &deadline);
+  }
+
+  pthread_mutex_lock(&ring->mutex);
+  while (1) {
+    if (ring->unread > 0) {
+      if (priv_wraps_at(ring, ring->read)) {
+        ring->read = 0;
+      }
+      ringbuf_header_t *header = priv_header(ring, ring->read);
+      if (header->flags & FLAG_WRITTEN) {
+        ring->read = (ring->read + HEADER_SIZE + ALIGN(header->len)) % ring->size;
+        ring->unread--;
+        *item_size = header->len;
+        pthread_mutex_unlock(&ring->mutex);
+        return header + 1;
+      }
+    }
+    if (ticks_to_wait == 0 ||
+        (ticks_to_wait == portMAX_DELAY ? pthread_cond_wait(&ring->cond, &ring->mutex)
+                                        : pthread_cond_timedwait(&ring->cond, &ring->mutex, &deadline)) != 0) {
+      pthread_mutex_unlock(&ring->mutex);
+      return NULL;
+    }
+  }
+}
+
+void vRingbufferReturnItem(RingbufHandle_t ring, void *item)
+{
+  pthread_mutex_lock(&ring->mutex);
+  ((ringbuf_header_t *)item - 1)->flags |= FLAG_RETURNED;
+  while (ring->used > 0) {
+    if (priv_wraps_at(ring, ring->tail)) {
+      ring->used -= ring->size - ring->tail;
+      ring->tail  = 0;
+      continue;
+    }
+    ringbuf_header_t *header = priv_header(ring, ring->tail);
+    if (!(header->flags & FLAG_RETURNED)) {
+      break;
+    }
+    size_t size = HEADER_SIZE + ALIGN(header->len);
+    ring->tail  = (ring->tail + size) % ring->size;
+    ring->used -= size;
+  }
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->mutex);
+}
+
+size_t xRingbufferGetMaxItemSize(RingbufHandle_t ring)
+{
+  return priv_max_item_size(ring);
+}
+
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t ring)
+{
+  pthread_mutex_lock(&ring->mutex);
+  size_t free_size = priv_contiguous_free(ring);
+  pthread_mutex_unlock(&ring->mutex);
+
+  free_size = (free_size > HEADER_SIZE) ? free_size - HEADER_SIZE : 0;
+  return (free_size < priv_max_item_size(ring)) ? free_size : priv_max_item_size(ring);
+}
@@ -0,0 +1,57 @@
+/* Host stand-in for sd_card_hal.c: the "card" is a directory on the host
+ * file system, created on mount. Pointing `sd_card_mount_path` at a
+ * loop-mounted FAT image before `sd_card_init` runs the writer against a
+ * real FAT driver. The power-loss recovery scan is the firmware's
+ * (sd_card_recover.c), run on mount and by `sd_card_recover_dir` as on the
+ * board. */
+
+#include "sd_card_hal.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include "esp_log.h"
+
+const char *sd_card_tag        = "SD_CARD";
+const char *sd_card_mount_path = "build/sdcard";
+
+static bool s_mounted = false;
+
+esp_err_t sd_card_init(void)
+{
+  char path[256];
+  snprintf(path, sizeof(path), "%s", sd_card_mount_path);
+  for (char *slash = strchr(&path[1], '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+    *slash = '\0';
+    mkdir(path, 0775);
+    *slash = '/';
+  }
+  if (mkdir(path, 0775) != 0 && errno != EEXIST) {
+    ESP_LOGE(sd_card_tag, "Cannot create %s: %s", path, strerror(errno));
+    return ESP_FAIL;
+  }
+  s_mounted = true;
+  sd_card_recover_scan(sd_card_mount_path);
+  return ESP_OK;
+}
+
+esp_err_t sd_card_recover_dir(const char *dir_path)
+{
+  if (!s_mounted) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  return sd_card_recover_scan(dir_path);
+}
+
+esp_err_t sd_card_get_usage(uint64_t *total_bytes, uint64_t *free_bytes)
+{
+  struct statvfs fs;
+  if (!s_mounted || statvfs(sd_card_mount_path, &fs) != 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  *total_bytes = (uint64_t)fs.f_blocks * fs.f_frsize;
+  *free_bytes  = (uint64_t)fs.f_bavail * fs.f_frsize;
+  return ESP_OK;
+}
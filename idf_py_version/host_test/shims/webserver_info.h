@@ -0,0 +1,6 @@
+#pragma once
+
+/* Host copy of main/include/webserver_info.txt; requests go to the server
+ * model of esp_http_client.h, not to this URL */
+
+#define webserver_url ("http://host.invalid/api/frames")
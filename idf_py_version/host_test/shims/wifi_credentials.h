@@ -0,0 +1,6 @@
+#pragma once
+
+/* Host copy of main/include/wifi_credentials.txt; there is no radio */
+
+#define wifi_ssid ("")
+#define wifi_pass ("")
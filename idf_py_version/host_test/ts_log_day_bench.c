@@ -0,0 +1,146 @@
+/* host_test/ts_log_day_bench.c
+ *
+ * Writes a day of MPU6050 readings to a host directory the way a helmet
+ * does: every frame goes through file_write_log_frame into the hourly
+ * time-series segments under log/, and the same readings are also written
+ * to mpu6050.txt as the timestamped JSON lines the HALs logged before.
+ * ts_log_day_load.py then times loading the day, and one hour of it, from
+ * both with the readers the dashboard uses.
+ *
+ * The bench stands in for the wall clock (time and gettimeofday below), so
+ * the day passes as fast as the writer takes the frames. Readings are one
+ * per `mpu6050_polling_rate_ticks` (5 s) by default, which is what the HAL
+ * logs; pass a shorter interval to load a denser day. As in
+ * file_write_bench, at most `WINDOW` frames are in flight so the ring buffer
+ * never rejects one, and the bench fails if a reading is missing.
+ *
+ * Usage: ts_log_day_bench [directory] [interval_ms]
+ */
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+#include "file_write_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "sd_card_hal.h"
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+
+#define DAY_START_S (1748822400) /* 2025-06-02 00:00:00 UTC */
+#define DAY_MS      (24 * 60 * 60 * 1000LL)
+#define WINDOW      (48)
+
+static int64_t s_now_ms = (int64_t)DAY_START_S * 1000;
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+/* Wall clock of the simulated day, for the writer and the frame encoder */
+
+time_t time(time_t *t)
+{
+  time_t now = (time_t)(s_now_ms / 1000);
+  if (t != NULL) {
+    *t = now;
+  }
+  return now;
+}
+
+int gettimeofday(struct timeval *tv, void *tz)
+{
+  tv->tv_sec  = (time_t)(s_now_ms / 1000);
+  tv->tv_usec = (suseconds_t)(s_now_ms % 1000) * 1000;
+  return 0;
+}
+
+static void priv_wait_window(uint32_t sent)
+{
+  file_write_stats_t stats;
+  do {
+    file_write_manager_get_stats(&stats);
+    if (sent - stats.records - stats.records_dropped <= WINDOW) {
+      return;
+    }
+    sched_yield();
+  } while (1);
+}
+
+/* A helmet worn through a shift: mostly upright, with slow sway */
+static void priv_reading(uint32_t index, mpu6050_data_t *mpu6050)
+{
+  float phase          = (float)(index % 240) / 240.0f;
+  mpu6050->accel_x     = 0.05f * (phase - 0.5f);
+  mpu6050->accel_y     = -0.98f + 0.02f * phase;
+  mpu6050->accel_z     = 0.12f - 0.04f * phase;
+  mpu6050->gyro_x      = 4.0f * (phase - 0.5f);
+  mpu6050->gyro_y      = -2.5f + phase;
+  mpu6050->gyro_z      = 0.31f;
+  mpu6050->temperature = 30.0f + 3.0f * phase;
+}
+
+/* The line `file_write_enqueue` wrote for a reading before the binary logs */
+static void priv_write_text(FILE *file, const mpu6050_data_t *mpu6050)
+{
+  time_t    now = (time_t)(s_now_ms / 1000);
+  struct tm timeinfo;
+  char      timestamp[32];
+  gmtime_r(&now, &timeinfo);
+  strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &timeinfo);
+  fprintf(file, "%s {\"sensor_type\":\"accelerometer_gyroscope\",\"accel_x\":%.4f,\"accel_y\":%.4f,"
+          "\"accel_z\":%.4f,\"gyro_x\":%.2f,\"gyro_y\":%.2f,\"gyro_z\":%.2f,\"temperature\":%.2f}\n",
+          timestamp, mpu6050->accel_x, mpu6050->accel_y, mpu6050->accel_z, mpu6050->gyro_x,
+          mpu6050->gyro_y, mpu6050->gyro_z, mpu6050->temperature);
+}
+
+int main(int argc, char **argv)
+{
+  sd_card_mount_path   = (argc > 1) ? argv[1] : "build/ts_log_day";
+  uint32_t interval_ms = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 5000;
+  if (interval_ms == 0 || file_write_manager_init() != ESP_OK) {
+    fprintf(stderr, "ts_log_day_bench: setup failed\n");
+    return 1;
+  }
+
+  char text_path[256];
+  snprintf(text_path, sizeof(text_path), "%s/mpu6050.txt", sd_card_mount_path);
+  FILE *text = fopen(text_path, "w");
+  if (text == NULL) {
+    fprintf(stderr, "ts_log_day_bench: cannot create %s: %s\n", text_path, strerror(errno));
+    return 1;
+  }
+
+  uint32_t readings = (uint32_t)(DAY_MS / interval_ms);
+  for (uint32_t i = 0; i < readings; i++) {
+    mpu6050_data_t mpu6050;
+    uint8_t        frame[SENSOR_FRAME_MAX_SIZE];
+    size_t         frame_len = 0;
+    s_now_ms = (int64_t)DAY_START_S * 1000 + (int64_t)i * interval_ms;
+    priv_reading(i, &mpu6050);
+    sensor_frame_encode(k_sensor_frame_id_mpu6050, &mpu6050, frame, sizeof(frame), &frame_len);
+    priv_wait_window(i);
+    file_write_log_frame("mpu6050.tsl", frame, frame_len);
+    priv_write_text(text, &mpu6050);
+  }
+  fclose(text);
+
+  file_write_stats_t stats;
+  if (file_write_manager_flush(portMAX_DELAY) != ESP_OK) {
+    fprintf(stderr, "ts_log_day_bench: flush failed\n");
+    return 1;
+  }
+  file_write_manager_get_stats(&stats);
+  printf("ts_log_day_bench: %u readings every %u ms written to %s\n", readings, interval_ms,
+         sd_card_mount_path);
+  if (stats.records != readings) {
+    printf("ts_log_day_bench: %u records written, %u dropped, expected %u\n", stats.records,
+           stats.records_dropped, readings);
+    return 1;
+  }
+  return 0;
+}
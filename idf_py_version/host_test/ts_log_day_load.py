@@ -0,0 +1,92 @@
+"""Times loading the day of MPU6050 readings written by ts_log_day_bench.
+
+The time-series segments are read with esp_mesh_server/tslog.py, as the
+dashboard does: the whole day, then one hour through the block index. The
+same day logged as text is parsed the way the dashboard's
+parse_log_file_robust does, a regex and json.loads per line. Each load is
+the best of a few runs, and every load must find the readings the bench
+wrote.
+
+Usage: ts_log_day_load.py <directory> [interval_ms]
+"""
+import json
+import os
+import re
+import sys
+import time
+from datetime import datetime, timezone
+
+sys.dont_write_bytecode = True
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "..", "esp_mesh_server"))
+import tslog  # noqa: E402
+
+DAY_START_MS = int(datetime(2025, 6, 2, tzinfo=timezone.utc).timestamp() * 1000)
+HOUR_MS = 60 * 60 * 1000
+RUNS = 5
+
+
+def parse_text(path):
+    """parse_log_file_robust from dashboard2/server.py, without its logging."""
+    entries = []
+    pattern = re.compile(r"^(.*?)(\{.*\})\s*$")
+    with open(path, "r") as file:
+        for line in file:
+            line = line.strip()
+            if not line:
+                continue
+            match = pattern.match(line)
+            if not match:
+                continue
+            try:
+                data = json.loads(match.group(2).strip())
+            except json.JSONDecodeError:
+                continue
+            entry = {"timestamp": match.group(1).strip()}
+            entry.update(data)
+            entries.append(entry)
+    return entries
+
+
+def best_of(load):
+    best = None
+    for _ in range(RUNS):
+        start = time.perf_counter()
+        result = load()
+        elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return best, result
+
+
+def main(root, interval_ms):
+    per_day = 24 * HOUR_MS // interval_ms
+    per_hour = HOUR_MS // interval_ms
+    noon = DAY_START_MS + 12 * HOUR_MS
+    loads = [
+        ("ts_log, day", per_day,
+         lambda: tslog.read_segments(root, "mpu6050.tsl")),
+        ("ts_log, one hour", per_hour,
+         lambda: tslog.read_segments(root, "mpu6050.tsl", noon, noon + HOUR_MS - 1)),
+        ("text, day", per_day,
+         lambda: parse_text(os.path.join(root, "mpu6050.txt"))),
+    ]
+
+    segments = list(tslog.segment_paths(root, "mpu6050.tsl"))
+    print(f"ts_log_day_load: {len(segments)} segments, "
+          f"{sum(os.path.getsize(path) for path in segments)} bytes; text log "
+          f"{os.path.getsize(os.path.join(root, 'mpu6050.txt'))} bytes")
+    print(f"{'load':<18} {'readings':>9} {'ms':>9}")
+
+    failures = []
+    for name, expected, load in loads:
+        seconds, readings = best_of(load)
+        print(f"{name:<18} {len(readings):>9} {seconds * 1000:>9.2f}")
+        if len(readings) != expected:
+            failures.append(f"{name}: {len(readings)} readings, expected {expected}")
+
+    for failure in failures:
+        print(f"ts_log_day_load: {failure}")
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1], int(sys.argv[2]) if len(sys.argv) > 2 else 5000))
@@ -0,0 +1,211 @@
+/* host_test/webserver_session_bench.c
+ *
+ * Sends the same batch of frames to a loopback HTTP/1.1 server (see
+ * host_http_listen in shims/http_client_host.c) over the uplink's
+ * persistent keep-alive session in webserver_tasks.c, and over the client
+ * it replaced, which ran init, perform and cleanup for every request.
+ * Reports requests/s, the TCP connections the server accepted and, for the
+ * session, the connects the uplink counted itself.
+ *
+ * The server closes a connection after 100 requests, like nginx does by
+ * default, so the session has to reconnect on its own. The session is also
+ * shared by four tasks at once. A second round adds 20 ms of scaled time to
+ * every TCP connect, standing in for the handshake round trip over Wi-Fi,
+ * which the loopback one leaves out.
+ *
+ * Usage: webserver_session_bench [requests]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_http_client.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "outbox_manager.h"
+#include "sensor_frame.h"
+#include "sensor_hal.h"
+#include "sensor_tasks.h"
+#include "webserver_info.h"
+#include "webserver_tasks.h"
+#include "wifi_tasks.h"
+
+#define BATCH_FRAMES   (16)
+#define KEEP_ALIVE_MAX (100) /* nginx keepalive_requests default */
+#define TASKS          (4)
+
+static uint8_t           s_body[WEBSERVER_BATCH_BUFFER_SIZE];
+static size_t            s_body_len = 0;
+static uint32_t          s_failures = 0;
+static SemaphoreHandle_t s_done     = NULL;
+
+/* Stand-ins for the modules the uplink calls: the station is always up */
+
+esp_err_t wifi_check_connection(void)
+{
+  return ESP_OK;
+}
+
+esp_err_t outbox_store(const uint8_t *frames, size_t length, uint32_t count)
+{
+  return ESP_FAIL;
+}
+
+esp_err_t sensor_tasks_get_settings(const char *config_key, sensor_settings_t *settings)
+{
+  return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t sensor_tasks_configure(const char *config_key, const sensor_settings_t *settings)
+{
+  return ESP_ERR_NOT_FOUND;
+}
+
+bool time_manager_is_synced(void)
+{
+  return true;
+}
+
+static int64_t priv_now_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void priv_build_body(void)
+{
+  mq135_data_t mq135 = { .raw_adc_value = 2871, .gas_concentration = 418.375f };
+  for (int i = 0; i < BATCH_FRAMES; i++) {
+    size_t frame_len = 0;
+    sensor_frame_encode(k_sensor_frame_id_mq135, &mq135, &s_body[s_body_len],
+                        sizeof(s_body) - s_body_len, &frame_len);
+    s_body_len += frame_len;
+  }
+}
+
+/* The replaced `send_sensor_data_to_webserver`: a new client for every request */
+static esp_err_t priv_legacy_post(void)
+{
+  esp_http_client_config_t config = {
+    .url    = webserver_url,
+    .method = HTTP_METHOD_POST,
+  };
+
+  esp_http_client_handle_t client = esp_http_client_init(&config);
+  if (client == NULL) {
+    return ESP_FAIL;
+  }
+  esp_http_client_set_header(client, "Content-Type", "application/octet-stream");
+  esp_http_client_set_post_field(client, (const char *)s_body, (int)s_body_len);
+  esp_err_t err = esp_http_client_perform(client);
+  if (err == ESP_OK && esp_http_client_get_status_code(client) != 200) {
+    err = ESP_FAIL;
+  }
+  esp_http_client_cleanup(client);
+  return err;
+}
+
+static void priv_session_task(void *param)
+{
+  uint32_t requests = (uint32_t)(uintptr_t)param;
+  for (uint32_t i = 0; i < requests; i++) {
+    if (webserver_post_frames(s_body, s_body_len, BATCH_FRAMES) != ESP_OK) {
+      __atomic_add_fetch(&s_failures, 1, __ATOMIC_SEQ_CST);
+    }
+  }
+  xSemaphoreGive(s_done);
+  vTaskDelete(NULL);
+}
+
+static void priv_report(const char *path, uint32_t requests, int64_t start_ns, uint32_t connects,
+                        const host_http_stats_t *before)
+{
+  double            seconds = (priv_now_ns() - start_ns) / 1e9;
+  host_http_stats_t after;
+  char              counted[16] = "-";
+  host_http_get_stats(&after);
+  if (connects != UINT32_MAX) {
+    snprintf(counted, sizeof(counted), "%u", connects);
+  }
+  printf("%-16s %9u %11.0f %9s %12u %9u\n", path, requests, requests / seconds, counted,
+         after.connections - before->connections, after.requests - before->requests);
+}
+
+static void priv_run_legacy(uint32_t requests)
+{
+  host_http_stats_t before;
+  host_http_get_stats(&before);
+  int64_t start = priv_now_ns();
+  for (uint32_t i = 0; i < requests; i++) {
+    if (priv_legacy_post() != ESP_OK) {
+      s_failures++;
+    }
+  }
+  /* The replaced client counted no connects; the server's count stands */
+  priv_report("per-request", requests, start, UINT32_MAX, &before);
+}
+
+static void priv_run_session(uint32_t requests, uint32_t tasks)
+{
+  webserver_stats_t stats_before;
+  webserver_stats_t stats_after;
+  host_http_stats_t before;
+  webserver_get_stats(&stats_before);
+  host_http_get_stats(&before);
+
+  int64_t start = priv_now_ns();
+  for (uint32_t i = 0; i < tasks; i++) {
+    xTaskCreate(priv_session_task, "session", 4096, (void *)(uintptr_t)(requests / tasks), 4, NULL);
+  }
+  for (uint32_t i = 0; i < tasks; i++) {
+    xSemaphoreTake(s_done, portMAX_DELAY);
+  }
+
+  webserver_get_stats(&stats_after);
+  char path[32];
+  snprintf(path, sizeof(path), tasks > 1 ? "session, %u tasks" : "session", tasks);
+  priv_report(path, requests, start, stats_after.connects - stats_before.connects, &before);
+  if (stats_after.uploaded - stats_before.uploaded != requests * BATCH_FRAMES) {
+    printf("webserver_session_bench: %u frames counted as uploaded, expected %u\n",
+           stats_after.uploaded - stats_before.uploaded, requests * BATCH_FRAMES);
+    s_failures++;
+  }
+}
+
+static void priv_round(uint32_t requests)
+{
+  printf("%-16s %9s %11s %9s %12s %9s\n", "client", "requests", "requests/s", "connects",
+         "server conns", "received");
+  priv_run_legacy(requests);
+  priv_run_session(requests, 1);
+  priv_run_session(requests, TASKS);
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t requests = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 10) : 20000;
+  priv_build_body();
+  s_done = xSemaphoreCreateCounting(TASKS, 0);
+  if (host_http_listen(NULL, KEEP_ALIVE_MAX) != ESP_OK || webserver_tasks_init() != ESP_OK) {
+    fprintf(stderr, "webserver_session_bench: setup failed\n");
+    return 1;
+  }
+
+  printf("webserver_session_bench: %zu-byte batches, server closes connections after %d requests\n",
+         s_body_len, KEEP_ALIVE_MAX);
+  printf("loopback connect:\n");
+  priv_round(requests);
+
+  host_http_connect_rtt_us = 20 * 1000;
+  printf("connect + 20 ms handshake round trip:\n");
+  priv_round(requests / 100 > TASKS ? requests / 100 : TASKS);
+
+  if (s_failures > 0) {
+    printf("webserver_session_bench: %u requests FAILED\n", s_failures);
+    return 1;
+  }
+  return 0;
+}
@@ -3,138 +3,1128 @@
 /* TODO: Test this */
 
 #include "file_write_manager.h"
+#include <dirent.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 #include "sd_card_hal.h"
+#include "sensor_frame.h"
+#include "ts_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
 
 /* Constants ******************************************************************/
 
-const char    *file_manager_tag   = "FILE_MANAGER";
-const uint32_t max_pending_writes = 10; /**< Maximum queued write operations */
+const char    *file_manager_tag                = "FILE_MANAGER";
+const uint32_t file_write_ring_size            = 8 * 1024;
+const uint32_t file_write_flush_interval_ticks = pdMS_TO_TICKS(1 * 1000);
+const uint32_t file_write_stats_interval_ticks = pdMS_TO_TICKS(60 * 1000);
+const uint32_t file_write_shutdown_flush_ticks = pdMS_TO_TICKS(1 * 1000);
+const char    *file_write_segment_root         = "log";
+const uint32_t file_write_segment_seconds      = 60 * 60;
+const uint32_t file_write_segment_max_bytes    = 4 * 1024 * 1024;
+
+/* Enums **********************************************************************/
+
+/**
+ * @brief Kind of data a ring buffer record carries.
+ */
+typedef enum : uint8_t {
+  k_file_write_record_text  = 0, /**< Text line, written with a timestamp prefix. */
+  k_file_write_record_frame = 1, /**< Encoded sensor frame, appended to a time-series log. */
+} file_write_record_type_t;
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Layout of one record in the ring buffer.
+ *
+ * Producers fill the record in place; only the wall-clock second is taken
+ * at enqueue time, the text timestamp is formatted by the write task.
+ */
+typedef struct {
+  time_t   timestamp; /**< Wall-clock time at which the record was reserved. */
+  uint16_t data_len;  /**< Number of committed data bytes; 0 drops the record. */
+  uint8_t  name_len;  /**< Length of the file name; 0 marks a flush request carrying its token. */
+  uint8_t  type;      /**< `file_write_record_type_t` of the data. */
+  char     payload[]; /**< File name (not terminated), then the record data. */
+} file_write_record_t;
+
+/**
+ * @brief One slot of the open-file table.
+ *
+ * Records for a text file are appended to `buffer` and reach the card in
+ * whole sectors, so the FAT driver never has to read-modify-write a partial
+ * sector on the size trigger. A time-series log instead keeps its current
+ * block in `block`; each flush appends the records the card does not have
+ * yet, and the footer follows once the block is full. Bytes already written
+ * are never written again, so a power loss can only tear the newest ones.
+ *
+ * A slot is looked up by the name producers use; the open file is the
+ * segment of that name for the current hour (see `priv_segment_path`).
+ */
+typedef struct {
+  char       name[FILE_WRITE_MAX_NAME_LENGTH + 1]; /**< Name given by the producers, e.g. "mpu6050.tsl". */
+  char       file_path[MAX_FILE_PATH_LENGTH];      /**< Path of the open segment, empty if the slot is free. */
+  time_t     segment_start;                        /**< Start of the hour the open segment covers. */
+  uint8_t    part;                                 /**< Number of the segment within its hour. */
+  long       file_size;                            /**< Bytes of a text segment already on the card. */
+  FILE      *file;                                 /**< Open handle, kept between records. */
+  TickType_t first_pending;                        /**< Tick at which the oldest unflushed record arrived. */
+  TickType_t last_used;                            /**< Tick of the last record, used for eviction. */
+  size_t     used;                                 /**< Number of buffered bytes (text files only). */
+  bool       binary;                               /**< The file is a time-series log. */
+  size_t     flushed;                              /**< Bytes of the log block already on the card. */
+  union {
+    uint8_t        buffer[FILE_WRITE_BUFFER_SIZE]; /**< Records waiting to be written. */
+    ts_log_block_t block;                          /**< Current block of a time-series log. */
+  };
+} file_write_slot_t;
+
+_Static_assert(sizeof(ts_log_block_t) <= FILE_WRITE_BUFFER_SIZE,
+               "A time-series log block must fit in a slot buffer");
 
 /* Globals (Static) ***********************************************************/
 
-static QueueHandle_t s_file_write_queue = NULL; /**< Queue for handling file write requests */
+static RingbufHandle_t    s_file_write_ring  = NULL;                         /**< Records waiting for the write task */
+static TaskHandle_t       s_file_write_task  = NULL;                         /**< The write task */
+static SemaphoreHandle_t  s_flush_lock       = NULL;                         /**< Lets one `file_write_manager_flush` caller wait at a time */
+static SemaphoreHandle_t  s_flush_done       = NULL;                         /**< Given by the task after each flush request; `s_flush_completed` tells whose */
+static uint32_t           s_flush_requested  = 0;                            /**< Token of the newest flush request, guarded by `s_flush_lock` */
+static uint32_t           s_flush_completed  = 0;                            /**< Token of the newest flush request the task has handled */
+static file_write_slot_t  s_slots[FILE_WRITE_MAX_OPEN_FILES];                /**< Open-file table */
+static file_write_stats_t s_stats            = { 0 };                        /**< Throughput counters */
+static portMUX_TYPE       s_stats_lock       = portMUX_INITIALIZER_UNLOCKED; /**< Guards `s_stats` and `s_flush_completed` */
 
 /* Private Functions **********************************************************/
 
 /**
- * @brief Formats the current date and time as a string.
+ * @brief Formats a wall-clock time as `YYYY-MM-DD HH:MM:SS ` (note the trailing space).
  *
- * Retrieves the current system time and formats it as `YYYY-MM-DD HH:MM:SS`.
+ * Consecutive records usually share the same second, so the last result is
+ * cached and reused.
  *
- * @param[out] buffer Buffer to store the formatted timestamp.
- * @param[in]  buffer_len Length of the buffer.
+ * @param[in]  timestamp Time to format.
+ * @param[out] buffer    Receives exactly `FILE_WRITE_TIMESTAMP_LENGTH` characters,
+ *                       not terminated.
  *
  * @note 
- * - The system time must be properly initialized before calling this function.
+ * - The system time must be properly initialized before records are enqueued.
+ */
+static void priv_format_timestamp(time_t timestamp, char *buffer)
+{
+  static time_t cached_time                                 = (time_t)-1;
+  static char   cached_text[FILE_WRITE_TIMESTAMP_LENGTH + 1] = { '\0' };
+
+  if (timestamp != cached_time) {
+    struct tm timeinfo;
+    localtime_r(&timestamp, &timeinfo);
+    strftime(cached_text, sizeof(cached_text), "%Y-%m-%d %H:%M:%S ", &timeinfo);
+    cached_time = timestamp;
+  }
+  memcpy(buffer, cached_text, FILE_WRITE_TIMESTAMP_LENGTH);
+}
+
+/**
+ * @brief Writes the first `len` buffered bytes of a slot to its file.
+ *
+ * Moves whatever remains to the front of the buffer. On a write error the
+ * bytes are dropped and the file is closed, so it is reopened by the next
+ * record.
+ *
+ * @param[in,out] slot Slot to write out.
+ * @param[in]     len  Number of bytes to write, at most `slot->used`.
+ */
+static void priv_slot_write(file_write_slot_t *slot, size_t len)
+{
+  if (len == 0) {
+    return;
+  }
+
+  int64_t start_us = esp_timer_get_time();
+  size_t  written  = fwrite(slot->buffer, 1, len, slot->file);
+  int64_t spent_us = esp_timer_get_time() - start_us;
+
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.write_calls++;
+  s_stats.bytes_written += written;
+  s_stats.write_time_us += spent_us;
+  if (written != len) {
+    s_stats.bytes_dropped += len - written;
+  }
+  portEXIT_CRITICAL(&s_stats_lock);
+
+  slot->file_size += written;
+  slot->used      -= len;
+  memmove(slot->buffer, &slot->buffer[len], slot->used);
+
+  if (written != len) {
+    ESP_LOGE(file_manager_tag, "Failed to write all data to file: %s", slot->file_path);
+    fclose(slot->file);
+    slot->file = NULL;
+  }
+}
+
+/**
+ * @brief Returns the size the open segment of a slot has once everything is written.
+ */
+static inline long priv_slot_size(const file_write_slot_t *slot)
+{
+  return slot->binary ? ts_log_block_offset(slot->block.footer.block_no) + (long)ts_log_block_used(&slot->block)
+                      : slot->file_size + (long)slot->used;
+}
+
+/**
+ * @brief Reports whether a slot holds records that are not on the card yet.
+ */
+static inline bool priv_slot_pending(const file_write_slot_t *slot)
+{
+  return slot->binary ? (ts_log_block_used(&slot->block) > slot->flushed) : (slot->used > 0);
+}
+
+/**
+ * @brief Adds the entry of a completed block to the log's index file.
+ *
+ * The index is opened only for this append; it is small and written once
+ * per block, so it does not need one of the open-file slots.
+ *
+ * @param[in] slot Slot whose current block was just written in full.
+ */
+static void priv_index_append(const file_write_slot_t *slot)
+{
+  char index_path[MAX_FILE_PATH_LENGTH + sizeof(TS_LOG_INDEX_SUFFIX)];
+  snprintf(index_path, sizeof(index_path), "%s" TS_LOG_INDEX_SUFFIX, slot->file_path);
+
+  ts_log_index_entry_t entry;
+  ts_log_index_entry_init(&slot->block, &entry);
+
+  FILE *index = fopen(index_path, "ab");
+  if (index == NULL || fwrite(&entry, 1, sizeof(entry), index) != sizeof(entry)) {
+    /* Readers rebuild a missing or short index from the block headers */
+    ESP_LOGW(file_manager_tag, "Failed to update index: %s", index_path);
+  }
+  if (index != NULL) {
+    fclose(index);
+  }
+}
+
+/**
+ * @brief Appends the records of a log block that are not on the card yet.
+ *
+ * Once the block is full, the footer is sealed and written with its last
+ * records, so the block is complete with a single write; it is then indexed
+ * and the next block is started. On a write error the file is closed;
+ * reopening it resumes after the last intact record.
+ *
+ * @param[in,out] slot Slot of an open log.
+ */
+static void priv_block_write(file_write_slot_t *slot)
+{
+  size_t end = ts_log_block_used(&slot->block);
+  if (ts_log_block_is_full(&slot->block)) {
+    ts_log_block_seal(&slot->block);
+    end = sizeof(slot->block);
+  }
+  size_t len = end - slot->flushed;
+
+  int64_t start_us = esp_timer_get_time();
+  size_t  written  = 0;
+  if (fseek(slot->file, ts_log_block_offset(slot->block.footer.block_no) + (long)slot->flushed,
+            SEEK_SET) == 0) {
+    written = fwrite(&slot->buffer[slot->flushed], 1, len, slot->file);
+  }
+  int64_t spent_us = esp_timer_get_time() - start_us;
+
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.write_calls++;
+  s_stats.bytes_written += written;
+  s_stats.write_time_us += spent_us;
+  if (written != len) {
+    s_stats.bytes_dropped += len - written;
+  }
+  portEXIT_CRITICAL(&s_stats_lock);
+
+  slot->flushed = end;
+  if (written != len) {
+    ESP_LOGE(file_manager_tag, "Failed to write block %" PRIu32 " of %s",
+             slot->block.footer.block_no, slot->file_path);
+    fclose(slot->file);
+    slot->file = NULL;
+    return;
+  }
+
+  if (end == sizeof(slot->block)) {
+    priv_index_append(slot);
+    ts_log_block_init(&slot->block, slot->block.footer.block_no + 1, slot->block.footer.record_size);
+    slot->flushed = 0;
+  }
+}
+
+/**
+ * @brief Writes out everything a slot holds and commits it to the card.
+ *
+ * The `fsync` updates the directory entry, so a power loss after a flush
+ * does not lose data that was already written.
+ *
+ * @param[in,out] slot Slot to flush.
+ */
+static void priv_slot_flush(file_write_slot_t *slot)
+{
+  if (slot->file == NULL || !priv_slot_pending(slot)) {
+    return;
+  }
+
+  if (slot->binary) {
+    priv_block_write(slot);
+  } else {
+    priv_slot_write(slot, slot->used);
+  }
+  if (slot->file != NULL) {
+    fsync(fileno(slot->file));
+  }
+
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.flushes++;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * @brief Flushes and closes a slot, freeing it for another file.
+ *
+ * @param[in,out] slot Slot to release.
  */
-static void priv_get_timestamp(char *buffer, size_t buffer_len)
+static void priv_slot_close(file_write_slot_t *slot)
+{
+  priv_slot_flush(slot);
+  if (slot->file != NULL) {
+    fclose(slot->file);
+  }
+  slot->file         = NULL;
+  slot->used         = 0;
+  slot->flushed      = 0;
+  slot->file_path[0] = '\0';
+  slot->name[0]      = '\0';
+}
+
+/**
+ * @brief Opens a time-series log and loads the block new records go to.
+ *
+ * A missing or empty file gets a header describing the sensor of `frame`.
+ * An existing log is resumed after its last intact record (see
+ * `ts_log_read_tail`); torn or stale bytes behind it are overwritten by the
+ * next flush. A log of another sensor, layout or version is moved aside to
+ * `<file_path>.old` and a new one is started.
+ *
+ * @param[in,out] slot      Free slot to open the log in.
+ * @param[in]     file_path Full path of the log.
+ * @param[in]     frame     First frame to be logged.
+ *
+ * @return
+ * - ESP_OK   if the log is open and `slot->block` is ready.
+ * - ESP_FAIL if the file could not be opened or its header written.
+ */
+static esp_err_t priv_log_open(file_write_slot_t *slot, const char *file_path,
+                               const sensor_frame_header_t *frame)
+{
+  uint16_t record_size = (uint16_t)ts_log_record_size(frame->payload_len);
+
+  slot->file = fopen(file_path, "r+b");
+  if (slot->file != NULL) {
+    /* Blocks are appended in sector-sized pieces; skip the stdio copy */
+    setvbuf(slot->file, NULL, _IONBF, 0);
+
+    ts_log_file_header_t header;
+    size_t               header_read = fread(&header, 1, sizeof(header), slot->file);
+    if (header_read == sizeof(header) && ts_log_file_header_check(&header) == ESP_OK &&
+        header.sensor_id == frame->sensor_id && header.record_size == record_size) {
+      fseek(slot->file, 0, SEEK_END);
+      long size     = ftell(slot->file);
+      long end      = ts_log_read_tail(slot->file, size, record_size, &slot->block);
+      slot->flushed = ts_log_block_used(&slot->block);
+      if (end < size) {
+        ESP_LOGW(file_manager_tag, "%s: overwriting %ld bytes after the last intact record",
+                 file_path, size - end);
+      }
+      ESP_LOGI(file_manager_tag, "Resuming %s at block %" PRIu32 " (%u records)", file_path,
+               slot->block.footer.block_no, slot->block.footer.record_count);
+
+      /* A full block whose footer was lost is sealed now */
+      if (ts_log_block_is_full(&slot->block)) {
+        priv_block_write(slot);
+        if (slot->file == NULL) {
+          return ESP_FAIL;
+        }
+      }
+      return ESP_OK;
+    }
+
+    fclose(slot->file);
+    slot->file = NULL;
+    if (header_read > 0) {
+      char old_path[MAX_FILE_PATH_LENGTH + sizeof(".old")];
+      snprintf(old_path, sizeof(old_path), "%s.old", file_path);
+      ESP_LOGW(file_manager_tag, "%s is not a log of this sensor, moving it to %s", file_path, old_path);
+      remove(old_path);
+      rename(file_path, old_path);
+    }
+  }
+
+  slot->file = fopen(file_path, "w+b");
+  if (slot->file == NULL) {
+    ESP_LOGE(file_manager_tag, "Failed to open file: %s", file_path);
+    return ESP_FAIL;
+  }
+  setvbuf(slot->file, NULL, _IONBF, 0);
+
+  ts_log_file_header_t header;
+  ts_log_file_header_init(&header, frame->sensor_id, frame->node_id, frame->payload_len);
+  memset(slot->buffer, 0, TS_LOG_FILE_HEADER_SIZE);
+  memcpy(slot->buffer, &header, sizeof(header));
+  if (fwrite(slot->buffer, 1, TS_LOG_FILE_HEADER_SIZE, slot->file) != TS_LOG_FILE_HEADER_SIZE) {
+    ESP_LOGE(file_manager_tag, "Failed to write log header: %s", file_path);
+    fclose(slot->file);
+    slot->file = NULL;
+    return ESP_FAIL;
+  }
+  ts_log_block_init(&slot->block, 0, record_size);
+  slot->flushed = 0;
+
+  /* A stale index of a log that was moved aside or lost would mislead readers */
+  char index_path[MAX_FILE_PATH_LENGTH + sizeof(TS_LOG_INDEX_SUFFIX)];
+  snprintf(index_path, sizeof(index_path), "%s" TS_LOG_INDEX_SUFFIX, file_path);
+  remove(index_path);
+  return ESP_OK;
+}
+
+/**
+ * @brief Builds the path of a segment.
+ *
+ * Segments are stored as `<mount>/log/YYYYMMDD/HH/PP_<name>` (UTC), so no
+ * directory ever holds more than one day of hours or one hour of files and
+ * lookups stay fast however long the helmet has been logging.
+ *
+ * @param[out] file_path     Receives the path.
+ * @param[in]  size          Size of `file_path`.
+ * @param[in]  name          Name given by the producers.
+ * @param[in]  segment_start Start of the segment's hour.
+ * @param[in]  part          Number of the segment within its hour.
+ */
+static void priv_segment_path(char *file_path, size_t size, const char *name,
+                              time_t segment_start, uint8_t part)
 {
-  time_t    now = time(NULL);
   struct tm timeinfo;
+  gmtime_r(&segment_start, &timeinfo);
+  snprintf(file_path, size, "%s/%s/%04d%02d%02d/%02d/%02u_%s", sd_card_mount_path,
+           file_write_segment_root, timeinfo.tm_year + 1900, timeinfo.tm_mon + 1,
+           timeinfo.tm_mday, timeinfo.tm_hour, part, name);
+}
+
+/**
+ * @brief Creates the directories leading to a file below the mount point.
+ *
+ * @param[in] file_path Full path of the file; left unchanged.
+ */
+static void priv_make_dirs(const char *file_path)
+{
+  char   dir_path[MAX_FILE_PATH_LENGTH];
+  size_t mount_len = strlen(sd_card_mount_path);
+  strncpy(dir_path, file_path, sizeof(dir_path) - 1);
+  dir_path[sizeof(dir_path) - 1] = '\0';
+
+  for (char *slash = strchr(&dir_path[mount_len + 1], '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+    *slash = '\0';
+    mkdir(dir_path, 0775); /* Fails harmlessly if the directory exists */
+    *slash = '/';
+  }
+}
+
+/**
+ * @brief Finds the entry of a directory whose name sorts first or last.
+ *
+ * Segment directories are named by date and hour, so names sort by age.
+ *
+ * @param[in,out] dir_path Directory to search; the entry is appended to it.
+ * @param[in]     size     Size of `dir_path`.
+ * @param[in]     newest   `true` for the last name, `false` for the first.
+ *
+ * @return `true` if an entry was found.
+ */
+static bool priv_segment_pick(char *dir_path, size_t size, bool newest)
+{
+  DIR *dir = opendir(dir_path);
+  if (dir == NULL) {
+    return false;
+  }
+  char           picked[16] = "";
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.' || strlen(entry->d_name) >= sizeof(picked)) {
+      continue;
+    }
+    int order = strcmp(entry->d_name, picked);
+    if (picked[0] == '\0' || (newest ? order > 0 : order < 0)) {
+      strcpy(picked, entry->d_name);
+    }
+  }
+  closedir(dir);
+
+  size_t len = strlen(dir_path);
+  return picked[0] != '\0' && snprintf(&dir_path[len], size - len, "/%s", picked) < (int)(size - len);
+}
 
-  localtime_r(&now, &timeinfo);
-  strftime(buffer, buffer_len, "%Y-%m-%d %H:%M:%S", &timeinfo);
+/**
+ * @brief Repairs the segments that may have been open at an unclean shutdown.
+ *
+ * `sd_card_init` only scans the mount point. The segments of the last hour
+ * are the ones open when power was lost, so their directory is scanned. So
+ * is the first hour on the card: when SNTP fails, `time_manager` falls back
+ * to a fixed date and every such boot appends to the same, oldest, hour.
+ */
+static void priv_segment_recover(void)
+{
+  for (uint8_t i = 0; i < 2; i++) {
+    char dir_path[MAX_FILE_PATH_LENGTH];
+    snprintf(dir_path, sizeof(dir_path), "%s/%s", sd_card_mount_path, file_write_segment_root);
+    if (priv_segment_pick(dir_path, sizeof(dir_path), i == 0) &&
+        priv_segment_pick(dir_path, sizeof(dir_path), i == 0)) {
+      sd_card_recover_dir(dir_path);
+    }
+  }
+}
+
+/**
+ * @brief Opens a segment in a free slot.
+ *
+ * After a restart, the first part of the hour that still has room is used,
+ * so a part that already reached `file_write_segment_max_bytes` is not
+ * appended to.
+ *
+ * @param[in,out] slot          Free slot.
+ * @param[in]     name          Name given by the producers.
+ * @param[in]     segment_start Start of the segment's hour.
+ * @param[in]     part          First part number to try.
+ * @param[in]     frame         First frame for a time-series log, NULL for a text file.
+ *
+ * @return Slot holding the open segment, or NULL if it could not be opened.
+ */
+static file_write_slot_t *priv_slot_open(file_write_slot_t *slot, const char *name,
+                                         time_t segment_start, uint8_t part,
+                                         const sensor_frame_header_t *frame)
+{
+  char        file_path[MAX_FILE_PATH_LENGTH];
+  struct stat file_stat;
+  bool        exists;
+  for (;; part++) {
+    priv_segment_path(file_path, sizeof(file_path), name, segment_start, part);
+    exists = (stat(file_path, &file_stat) == 0);
+    if (!exists || file_stat.st_size < (off_t)file_write_segment_max_bytes || part == UINT8_MAX) {
+      break;
+    }
+  }
+  if (!exists) {
+    priv_make_dirs(file_path);
+  }
+
+  strncpy(slot->file_path, file_path, sizeof(slot->file_path) - 1);
+  slot->file_path[sizeof(slot->file_path) - 1] = '\0';
+  strncpy(slot->name, name, sizeof(slot->name) - 1);
+  slot->name[sizeof(slot->name) - 1] = '\0';
+  slot->segment_start                = segment_start;
+  slot->part                         = part;
+  slot->used                         = 0;
+  slot->file_size                    = exists ? (long)file_stat.st_size : 0;
+  slot->binary                       = (frame != NULL);
+
+  if (frame != NULL) {
+    if (priv_log_open(slot, file_path, frame) != ESP_OK) {
+      slot->file_path[0] = '\0';
+      slot->name[0]      = '\0';
+      return NULL;
+    }
+  } else {
+    slot->file = fopen(file_path, "a");
+    if (slot->file == NULL) {
+      ESP_LOGE(file_manager_tag, "Failed to open file: %s", file_path);
+      slot->file_path[0] = '\0';
+      slot->name[0]      = '\0';
+      return NULL;
+    }
+    /* Records are already gathered in whole sectors; skip the stdio copy */
+    setvbuf(slot->file, NULL, _IONBF, 0);
+  }
+
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.opens++;
+  portEXIT_CRITICAL(&s_stats_lock);
+  return slot;
+}
+
+/**
+ * @brief Returns the slot for a name, opening or rotating its segment if necessary.
+ *
+ * A new segment is started when the record belongs to another hour than the
+ * open segment, or when the open segment reached
+ * `file_write_segment_max_bytes`. When every slot is taken, the least
+ * recently used file is flushed and closed to make room.
+ *
+ * @param[in] name          Name given by the producers.
+ * @param[in] segment_start Start of the hour the record belongs to.
+ * @param[in] now           Current tick count.
+ * @param[in] frame         First frame for a time-series log, NULL for a text file.
+ *
+ * @return Slot holding the open segment, or NULL if it could not be opened
+ *         or the name is already open as the other kind of file.
+ */
+static file_write_slot_t *priv_slot_get(const char *name, time_t segment_start, TickType_t now,
+                                        const sensor_frame_header_t *frame)
+{
+  file_write_slot_t *victim = &s_slots[0];
+  for (uint8_t i = 0; i < FILE_WRITE_MAX_OPEN_FILES; i++) {
+    file_write_slot_t *slot = &s_slots[i];
+    if (slot->file != NULL && strcmp(slot->name, name) == 0) {
+      if (slot->binary != (frame != NULL)) {
+        ESP_LOGE(file_manager_tag, "%s is open as another kind of file", name);
+        return NULL;
+      }
+      if (slot->segment_start == segment_start && priv_slot_size(slot) < (long)file_write_segment_max_bytes) {
+        return slot;
+      }
+
+      uint8_t part = (slot->segment_start == segment_start) ? slot->part + 1 : 0;
+      ESP_LOGI(file_manager_tag, "Closing segment %s", slot->file_path);
+      priv_slot_close(slot);
+      return priv_slot_open(slot, name, segment_start, part, frame);
+    }
+    if (victim->file != NULL && (slot->file == NULL || (now - slot->last_used) > (now - victim->last_used))) {
+      victim = slot;
+    }
+  }
+
+  if (victim->file != NULL) {
+    ESP_LOGD(file_manager_tag, "Closing %s to open %s", victim->file_path, name);
+    priv_slot_close(victim);
+  }
+  return priv_slot_open(victim, name, segment_start, 0, frame);
+}
+
+/**
+ * @brief Appends one record, as a timestamped line, to its file's buffer.
+ *
+ * When the buffer cannot take the line, the whole sectors it holds are
+ * written out first, keeping only the unaligned tail in memory.
+ *
+ * @param[in] record        Record taken from the ring buffer.
+ * @param[in] name          Name given by the producer.
+ * @param[in] segment_start Start of the hour the record belongs to.
+ * @param[in] now           Current tick count.
+ */
+static void priv_append_text(const file_write_record_t *record, const char *name,
+                             time_t segment_start, TickType_t now)
+{
+  size_t len = FILE_WRITE_TIMESTAMP_LENGTH + record->data_len + 1;
+
+  file_write_slot_t *slot = priv_slot_get(name, segment_start, now, NULL);
+  if (slot == NULL) {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.bytes_dropped += len;
+    portEXIT_CRITICAL(&s_stats_lock);
+    return;
+  }
+
+  if (slot->used + len > sizeof(slot->buffer)) {
+    priv_slot_write(slot, slot->used - (slot->used % FILE_WRITE_SECTOR_SIZE));
+    if (slot->file == NULL) {
+      portENTER_CRITICAL(&s_stats_lock);
+      s_stats.bytes_dropped += len;
+      portEXIT_CRITICAL(&s_stats_lock);
+      return;
+    }
+  }
+
+  if (slot->used == 0) {
+    slot->first_pending = now;
+  }
+  uint8_t *line = &slot->buffer[slot->used];
+  priv_format_timestamp(record->timestamp, (char *)line);
+  memcpy(&line[FILE_WRITE_TIMESTAMP_LENGTH], &record->payload[record->name_len], record->data_len);
+  line[len - 1]   = '\n';
+  slot->used     += len;
+  slot->last_used = now;
+
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.records++;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * @brief Appends one sensor frame, as a fixed-size record, to its log's block.
+ *
+ * Only the payload, the time and the flags are kept; the rest of the frame
+ * header is the same for every record and lives in the file header. A block
+ * that fills up is written out at once.
+ *
+ * @param[in] record        Record taken from the ring buffer.
+ * @param[in] name          Name given by the producer.
+ * @param[in] segment_start Start of the hour the record belongs to.
+ * @param[in] now           Current tick count.
+ */
+static void priv_append_frame(const file_write_record_t *record, const char *name,
+                              time_t segment_start, TickType_t now)
+{
+  sensor_frame_header_t frame;
+  file_write_slot_t    *slot = NULL;
+  if (sensor_frame_parse_header((const uint8_t *)&record->payload[record->name_len],
+                                record->data_len, &frame) != ESP_OK ||
+      ts_log_record_size(frame.payload_len) > TS_LOG_MAX_RECORD_SIZE) {
+    ESP_LOGE(file_manager_tag, "Dropping malformed frame for %s", name);
+  } else {
+    slot = priv_slot_get(name, segment_start, now, &frame);
+  }
+
+  if (slot == NULL || ts_log_block_append(&slot->block, frame.timestamp_ms, frame.flags,
+                                          frame.payload, frame.payload_len) != ESP_OK) {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.bytes_dropped += record->data_len;
+    portEXIT_CRITICAL(&s_stats_lock);
+    return;
+  }
+
+  if (ts_log_block_used(&slot->block) == slot->flushed + slot->block.footer.record_size) {
+    slot->first_pending = now;
+  }
+  slot->last_used = now;
+
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.records++;
+  portEXIT_CRITICAL(&s_stats_lock);
+
+  if (ts_log_block_is_full(&slot->block)) {
+    priv_block_write(slot);
+  }
+}
+
+/**
+ * @brief Hands a record to the appender for its kind of file.
+ *
+ * The record goes to the segment of the hour it was enqueued in, so a
+ * record that waited in the ring buffer across the hour still lands in the
+ * right segment.
+ *
+ * @param[in] record Record taken from the ring buffer.
+ * @param[in] now    Current tick count.
+ */
+static void priv_append(const file_write_record_t *record, TickType_t now)
+{
+  char name[FILE_WRITE_MAX_NAME_LENGTH + 1];
+  memcpy(name, record->payload, record->name_len);
+  name[record->name_len] = '\0';
+
+  time_t segment_start = record->timestamp - (record->timestamp % file_write_segment_seconds);
+  if (record->type == k_file_write_record_frame) {
+    priv_append_frame(record, name, segment_start, now);
+  } else {
+    priv_append_text(record, name, segment_start, now);
+  }
+}
+
+/**
+ * @brief Flushes every slot whose oldest record has waited long enough.
+ *
+ * @param[in] now Current tick count.
+ *
+ * @return Ticks until the next slot is due, or `portMAX_DELAY` if nothing is buffered.
+ */
+static TickType_t priv_flush_expired(TickType_t now)
+{
+  TickType_t next = portMAX_DELAY;
+  for (uint8_t i = 0; i < FILE_WRITE_MAX_OPEN_FILES; i++) {
+    file_write_slot_t *slot = &s_slots[i];
+    if (slot->file == NULL || !priv_slot_pending(slot)) {
+      continue;
+    }
+
+    TickType_t age = now - slot->first_pending;
+    if (age >= file_write_flush_interval_ticks) {
+      priv_slot_flush(slot);
+    } else if (file_write_flush_interval_ticks - age < next) {
+      next = file_write_flush_interval_ticks - age;
+    }
+  }
+  return next;
+}
+
+/**
+ * @brief Writes every buffered record to the card and syncs the files.
+ */
+static void priv_flush_all(void)
+{
+  for (uint8_t i = 0; i < FILE_WRITE_MAX_OPEN_FILES; i++) {
+    priv_slot_flush(&s_slots[i]);
+  }
+}
+
+/**
+ * @brief Returns how much of a timeout is left.
+ *
+ * @param[in] start         Tick at which the wait started.
+ * @param[in] timeout_ticks Whole timeout.
+ *
+ * @return Remaining ticks, 0 once the timeout has passed.
+ */
+static TickType_t priv_ticks_left(TickType_t start, TickType_t timeout_ticks)
+{
+  TickType_t spent = xTaskGetTickCount() - start;
+  return (spent < timeout_ticks) ? (timeout_ticks - spent) : 0;
+}
+
+/**
+ * @brief Shutdown handler writing out the buffered records before a restart.
+ */
+static void priv_shutdown_flush(void)
+{
+  esp_err_t ret = file_write_manager_flush(file_write_shutdown_flush_ticks);
+  if (ret != ESP_OK) {
+    ESP_LOGW(file_manager_tag, "Buffered records not written before restart: %s",
+             esp_err_to_name(ret));
+  }
+}
+
+/**
+ * @brief Logs the throughput since the previous report.
+ *
+ * @param[in] elapsed_ticks Time since the previous report.
+ */
+static void priv_log_throughput(TickType_t elapsed_ticks)
+{
+  static file_write_stats_t last = { 0 };
+
+  file_write_stats_t now;
+  file_write_manager_get_stats(&now);
+
+  uint32_t elapsed_ms = pdTICKS_TO_MS(elapsed_ticks);
+  if (elapsed_ms == 0) {
+    return;
+  }
+  ESP_LOGI(file_manager_tag,
+           "%" PRIu32 " records/s, %" PRIu32 " bytes/s, %" PRIu32 " writes/s "
+           "(%" PRIu32 " flushes, %" PRIu32 " opens, %" PRIu32 " bytes dropped in total)",
+           (uint32_t)((now.records - last.records) * 1000 / elapsed_ms),
+           (uint32_t)((now.bytes_written - last.bytes_written) * 1000 / elapsed_ms),
+           (uint32_t)((now.write_calls - last.write_calls) * 1000 / elapsed_ms),
+           now.flushes, now.opens, now.bytes_dropped);
+  last = now;
 }
 
 /**
  * @brief Task to handle queued file write requests.
  *
- * Processes file write requests from a queue and writes data to the specified 
- * files. The task runs continuously, handling requests asynchronously.
+ * Appends queued records to per-file buffers and writes them to the card on
+ * one of three triggers: a buffer is full (whole sectors only), the oldest
+ * record of a file has waited `file_write_flush_interval_ticks`, or
+ * `file_write_manager_flush` asked for everything to be written.
  *
  * @param[in] param Pointer to task-specific parameters (unused)
  *
  * @note 
  * - This function is intended to run as a FreeRTOS task.
- * - Each write request includes a timestamp and data to be written.
+ * - Records are read in place from the ring buffer and returned once copied
+ *   into their file's buffer.
  */
 static void priv_file_write_task(void *param)
 {
-  file_write_request_t request;
+  TickType_t wait_ticks = portMAX_DELAY;
+  TickType_t last_log   = xTaskGetTickCount();
 
   while (1) {
-    if (xQueueReceive(s_file_write_queue, &request, portMAX_DELAY) == pdTRUE) {
-      FILE *file = fopen(request.file_path, "a");
-      if (file == NULL) {
-        ESP_LOGE(file_manager_tag, "Failed to open file: %s", request.file_path);
-        continue;
-      }
+    if (wait_ticks > file_write_stats_interval_ticks) {
+      wait_ticks = file_write_stats_interval_ticks;
+    }
+    size_t               item_size = 0;
+    file_write_record_t *record    = xRingbufferReceive(s_file_write_ring, &item_size, wait_ticks);
+    TickType_t           now       = xTaskGetTickCount();
 
-      size_t bytes_written = fwrite(request.data, 1, strlen(request.data), file);
-      fclose(file);
+    if (record != NULL) {
+      if (record->name_len == 0) {
+        /* Flush marker from file_write_manager_flush */
+        uint32_t token;
+        memcpy(&token, record->payload, sizeof(token));
+        priv_flush_all();
+        portENTER_CRITICAL(&s_stats_lock);
+        s_flush_completed = token;
+        portEXIT_CRITICAL(&s_stats_lock);
+        xSemaphoreGive(s_flush_done);
+      } else if (record->data_len > 0) {
+        priv_append(record, now);
+      }
 
-      if (bytes_written != strlen(request.data)) {
-        ESP_LOGE(file_manager_tag, "Failed to write all data to file: %s", request.file_path);
-      } else {
-        ESP_LOGI(file_manager_tag, "Data written to file: %s", request.file_path);
+      /* Occupancy only drops when an item is returned, so the peak is seen
+       * here and producers do not pay for tracking it */
+      size_t in_use = file_write_ring_size - xRingbufferGetCurFreeSize(s_file_write_ring);
+      portENTER_CRITICAL(&s_stats_lock);
+      if (in_use > s_stats.ring_peak_bytes) {
+        s_stats.ring_peak_bytes = in_use;
       }
+      portEXIT_CRITICAL(&s_stats_lock);
+      vRingbufferReturnItem(s_file_write_ring, record);
+    }
+
+    wait_ticks = priv_flush_expired(now);
+
+    if ((now - last_log) >= file_write_stats_interval_ticks) {
+      priv_log_throughput(now - last_log);
+      last_log = now;
     }
   }
 }
 
+/**
+ * @brief Checks the file name and size of a record before it enters the ring.
+ *
+ * @param[in]  file_name File name given by the producer.
+ * @param[in]  capacity  Data bytes the record may hold.
+ * @param[out] name_len  Receives the length of `file_name`.
+ *
+ * @return
+ * - ESP_OK                if the record may be queued.
+ * - ESP_ERR_INVALID_ARG   if the name or size is invalid.
+ * - ESP_ERR_INVALID_STATE if the manager is not initialized.
+ */
+static esp_err_t priv_check_record(const char *file_name, size_t capacity, size_t *name_len)
+{
+  if (file_name == NULL || capacity > FILE_WRITE_MAX_RECORD_LENGTH) {
+    ESP_LOGE(file_manager_tag, "Invalid file name or record size");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  *name_len = strlen(file_name);
+  if (*name_len == 0 || *name_len > FILE_WRITE_MAX_NAME_LENGTH) {
+    ESP_LOGE(file_manager_tag, "Invalid file name length: %s", file_name);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (s_file_write_ring == NULL) {
+    ESP_LOGE(file_manager_tag, "File write ring buffer is not initialized");
+    return ESP_ERR_INVALID_STATE;
+  }
+  return ESP_OK;
+}
+
+/**
+ * @brief Counts and logs a record that found the ring buffer full.
+ *
+ * @return ESP_ERR_NO_MEM, for the producer to return.
+ */
+static esp_err_t priv_ring_full(void)
+{
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.records_dropped++;
+  portEXIT_CRITICAL(&s_stats_lock);
+  ESP_LOGE(file_manager_tag, "File write ring buffer is full");
+  return ESP_ERR_NO_MEM;
+}
+
 /* Public Functions ***********************************************************/
 
 esp_err_t file_write_manager_init(void)
 {
-  s_file_write_queue = xQueueCreate(max_pending_writes, sizeof(file_write_request_t));
-  if (s_file_write_queue == NULL) {
-    ESP_LOGE(file_manager_tag, "Failed to create file write queue");
+  s_file_write_ring = xRingbufferCreate(file_write_ring_size, RINGBUF_TYPE_NOSPLIT);
+  s_flush_lock      = xSemaphoreCreateMutex();
+  s_flush_done      = xSemaphoreCreateBinary();
+  if (s_file_write_ring == NULL || s_flush_lock == NULL || s_flush_done == NULL) {
+    ESP_LOGE(file_manager_tag, "Failed to create file write ring buffer");
     return ESP_FAIL;
   }
-  ESP_LOGI(file_manager_tag, "Created file write queue");
+  ESP_LOGI(file_manager_tag, "Created file write ring buffer (%" PRIu32 " bytes, records up to %u bytes)",
+           file_write_ring_size, (unsigned)xRingbufferGetMaxItemSize(s_file_write_ring));
+
+  /* Mount first: the recovery scan must finish before the task appends to a log */
+  if (sd_card_init() != ESP_OK) {
+    ESP_LOGE(file_manager_tag, "Failed to initialize sd card");
+    return ESP_FAIL;
+  }
+  priv_segment_recover();
 
   BaseType_t task_created = xTaskCreate(priv_file_write_task,
                                         "priv_file_write_task",
                                         4096,
                                         NULL,
                                         3,
-                                        NULL);
+                                        &s_file_write_task);
   if (task_created != pdPASS) {
     ESP_LOGE(file_manager_tag, "Failed to create file write task");
     return ESP_FAIL;
   }
-
-  if (sd_card_init() != ESP_OK) {
-    ESP_LOGE(file_manager_tag, "Failed to initialize sd card");
-    return ESP_FAIL;
+  if (esp_register_shutdown_handler(priv_shutdown_flush) != ESP_OK) {
+    ESP_LOGW(file_manager_tag, "Failed to register shutdown flush; a restart may lose up to %" PRIu32 " ms of records",
+             pdTICKS_TO_MS(file_write_flush_interval_ticks));
   }
   ESP_LOGI(file_manager_tag, "File write manager initialized successfully");
 
   return ESP_OK;
 }
 
-esp_err_t file_write_enqueue(const char *file_path, const char *data)
+esp_err_t file_write_reserve(const char *file_name, size_t capacity,
+                             file_write_reservation_t *reservation)
 {
-  if (file_path == NULL || data == NULL) {
-    ESP_LOGE(file_manager_tag, "Invalid file path or data");
+  size_t    name_len = 0;
+  esp_err_t ret      = priv_check_record(file_name, capacity, &name_len);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+  if (reservation == NULL) {
+    ESP_LOGE(file_manager_tag, "Invalid reservation");
     return ESP_ERR_INVALID_ARG;
   }
 
-  if (s_file_write_queue == NULL) {
-    ESP_LOGE(file_manager_tag, "File write queue is not initialized");
-    return ESP_FAIL;
+  file_write_record_t *record = NULL;
+  if (xRingbufferSendAcquire(s_file_write_ring, (void **)&record,
+                             sizeof(*record) + name_len + capacity, 0) != pdTRUE) {
+    return priv_ring_full();
   }
 
-  file_write_request_t request;
-  char                 timestamp[32] = { '\0' };
-  
-  priv_get_timestamp(timestamp, sizeof(timestamp));
-  snprintf(request.file_path, MAX_FILE_PATH_LENGTH, "%s/%s", sd_card_mount_path, file_path);
-  snprintf(request.data, MAX_DATA_LENGTH, "%s %s\n", timestamp, data);
+  record->timestamp = time(NULL);
+  record->data_len  = 0;
+  record->name_len  = (uint8_t)name_len;
+  record->type      = k_file_write_record_text;
+  memcpy(record->payload, file_name, name_len);
 
-  if (xQueueSend(s_file_write_queue, &request, 0) != pdTRUE) {
-    ESP_LOGE(file_manager_tag, "File write queue is full");
+  reservation->record   = record;
+  reservation->data     = &record->payload[name_len];
+  reservation->capacity = capacity;
+  return ESP_OK;
+}
+
+esp_err_t file_write_commit(file_write_reservation_t *reservation, size_t length)
+{
+  if (reservation == NULL || reservation->record == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  file_write_record_t *record = reservation->record;
+  record->data_len            = (uint16_t)((length <= reservation->capacity) ? length : reservation->capacity);
+  reservation->record         = NULL;
+
+  if (xRingbufferSendComplete(s_file_write_ring, record) != pdTRUE) {
+    ESP_LOGE(file_manager_tag, "Failed to commit record");
     return ESP_FAIL;
   }
+  return ESP_OK;
+}
+
+esp_err_t file_write_enqueue(const char *file_name, const char *data)
+{
+  if (file_name == NULL || data == NULL) {
+    ESP_LOGE(file_manager_tag, "Invalid file path or data");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  size_t                   len = strlen(data);
+  file_write_reservation_t reservation;
+  esp_err_t                ret = file_write_reserve(file_name, len, &reservation);
+  if (ret != ESP_OK) {
+    return ret;
+  }
+
+  memcpy(reservation.data, data, len);
+  return file_write_commit(&reservation, len);
+}
+
+esp_err_t file_write_log_frame(const char *file_name, const uint8_t *frame, size_t frame_len)
+{
+  if (frame == NULL || frame_len == 0 || frame_len > SENSOR_FRAME_MAX_SIZE) {
+    ESP_LOGE(file_manager_tag, "Invalid frame");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  size_t    name_len = 0;
+  esp_err_t ret      = priv_check_record(file_name, frame_len, &name_len);
+  if (ret != ESP_OK) {
+    return ret;
+  }
 
-  ESP_LOGI(file_manager_tag, "Write request queued for file: %s", file_path);
+  /* A frame is small enough to build the whole record here and copy it in
+   * with one send, which takes the ring's lock once instead of twice */
+  union {
+    file_write_record_t record;
+    uint8_t             bytes[sizeof(file_write_record_t) + FILE_WRITE_MAX_NAME_LENGTH + SENSOR_FRAME_MAX_SIZE];
+  } item;
+  item.record.timestamp = time(NULL);
+  item.record.data_len  = (uint16_t)frame_len;
+  item.record.name_len  = (uint8_t)name_len;
+  item.record.type      = k_file_write_record_frame;
+  memcpy(item.record.payload, file_name, name_len);
+  memcpy(&item.record.payload[name_len], frame, frame_len);
+
+  if (xRingbufferSend(s_file_write_ring, &item, sizeof(item.record) + name_len + frame_len, 0) != pdTRUE) {
+    return priv_ring_full();
+  }
   return ESP_OK;
 }
 
+esp_err_t file_write_manager_flush(TickType_t timeout_ticks)
+{
+  if (s_file_write_ring == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  /* A restart requested from the write task itself cannot wait for it */
+  if (xTaskGetCurrentTaskHandle() == s_file_write_task) {
+    priv_flush_all();
+    return ESP_OK;
+  }
+
+  TickType_t start = xTaskGetTickCount();
+  if (xSemaphoreTake(s_flush_lock, timeout_ticks) != pdTRUE) {
+    return ESP_ERR_TIMEOUT;
+  }
+
+  esp_err_t            ret    = ESP_ERR_TIMEOUT;
+  uint32_t             token  = ++s_flush_requested;
+  file_write_record_t *marker = NULL;
+  if (xRingbufferSendAcquire(s_file_write_ring, (void **)&marker, sizeof(*marker) + sizeof(token),
+                             priv_ticks_left(start, timeout_ticks)) == pdTRUE) {
+    marker->timestamp = 0;
+    marker->data_len  = sizeof(token);
+    marker->name_len  = 0;
+    marker->type      = k_file_write_record_text;
+    memcpy(marker->payload, &token, sizeof(token));
+    xRingbufferSendComplete(s_file_write_ring, marker);
+
+    /* A request that timed out earlier may still give the semaphore; only
+     * the task reaching our own token ends the wait */
+    while (1) {
+      portENTER_CRITICAL(&s_stats_lock);
+      bool done = (int32_t)(s_flush_completed - token) >= 0;
+      portEXIT_CRITICAL(&s_stats_lock);
+      if (done) {
+        ret = ESP_OK;
+        break;
+      }
+      if (xSemaphoreTake(s_flush_done, priv_ticks_left(start, timeout_ticks)) != pdTRUE) {
+        break;
+      }
+    }
+  }
+
+  xSemaphoreGive(s_flush_lock);
+  return ret;
+}
+
+void file_write_manager_get_stats(file_write_stats_t *stats)
+{
+  if (stats == NULL) {
+    return;
+  }
+
+  portENTER_CRITICAL(&s_stats_lock);
+  *stats = s_stats;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
@@ -7,82 +7,223 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
 
 /* Constants ******************************************************************/
 
-extern const char    *file_manager_tag;   /**< Logging tag for ESP_LOG messages related to the file write manager. */
-extern const uint32_t max_pending_writes; /**< Maximum number of queued file write requests to prevent overflow. */
+extern const char    *file_manager_tag;                /**< Logging tag for ESP_LOG messages related to the file write manager. */
+extern const uint32_t file_write_ring_size;            /**< Size of the ring buffer holding records waiting to be written, in bytes. */
+extern const uint32_t file_write_flush_interval_ticks; /**< Longest time a record stays buffered before it is written and synced; bounds what a power cut loses. */
+extern const uint32_t file_write_stats_interval_ticks; /**< Interval between two throughput log lines. */
+extern const uint32_t file_write_shutdown_flush_ticks; /**< Longest time a restart waits for the buffered records to be written. */
+extern const char    *file_write_segment_root;         /**< Directory below the mount point that holds the log segments. */
+extern const uint32_t file_write_segment_seconds;      /**< Time covered by one segment directory, in seconds. */
+extern const uint32_t file_write_segment_max_bytes;    /**< Size at which a segment is closed and the next part of the hour is started. */
 
 /* Macros *********************************************************************/
 
 #define MAX_FILE_PATH_LENGTH (64)  /**< Maximum file path length, including the null terminator. */
-#define MAX_DATA_LENGTH      (256) /**< Maximum data length per write request, including the null terminator. */
+
+#define FILE_WRITE_MAX_OPEN_FILES    (7)                          /**< Number of files kept open at the same time (one log per sensor and the alerts). */
+#define FILE_WRITE_SECTOR_SIZE       (512)                        /**< SD card sector size; buffered data is written in multiples of it. */
+#define FILE_WRITE_BUFFER_SIZE       (4 * FILE_WRITE_SECTOR_SIZE) /**< Size of the write buffer of each open file. */
+#define FILE_WRITE_MAX_RECORD_LENGTH (1024)                       /**< Largest record, in bytes; must leave room for a sector and a timestamp in the buffer. */
+#define FILE_WRITE_MAX_NAME_LENGTH   (32)                         /**< Longest file name given by the producers. */
+#define FILE_WRITE_TIMESTAMP_LENGTH  (20)                         /**< Length of the `YYYY-MM-DD HH:MM:SS ` prefix of each line. */
 
 /* Structs ********************************************************************/
 
 /**
- * @brief Represents a request to write data to a file.
+ * @brief Space reserved for one record in the file write ring buffer.
+ *
+ * Returned by `file_write_reserve`. The producer writes up to `capacity`
+ * bytes to `data` and hands the record over with `file_write_commit`.
  *
- * Contains the file path and data required for a file write operation.
- * 
  * @note
- * - The `file_path` must be null-terminated and have a length defined by 
- *   the `max_file_path_length` macro to prevent memory overflow.
- * - The `data` field must also be null-terminated if it contains a string and
- *   has a length defined by the `max_data_length` macro.
+ * - The record stays invisible to the write task until it is committed, and
+ *   every reservation must be committed, even if nothing was written.
+ * - `data` is not null-terminated and should not contain a trailing newline;
+ *   the write task adds the timestamp and the newline.
  */
 typedef struct {
-  char file_path[MAX_FILE_PATH_LENGTH]; /**< Path to the target file. Must be null-terminated and within the length limit. */
-  char data[MAX_DATA_LENGTH];           /**< Data to write to the file. Must be null-terminated if it is a string. */
-} file_write_request_t;
+  void  *record;   /**< Ring buffer item; owned by the manager. */
+  char  *data;     /**< Where the producer writes the record text. */
+  size_t capacity; /**< Number of bytes available at `data`. */
+} file_write_reservation_t;
+
+/**
+ * @brief Cumulative counters of the file write manager.
+ *
+ * Dividing the differences of two snapshots by the time between them gives
+ * records/s, bytes/s and write calls/s; the manager logs exactly that every
+ * `file_write_stats_interval_ticks`.
+ */
+typedef struct {
+  uint32_t records;         /**< Records accepted into a file buffer. */
+  uint32_t records_dropped; /**< Records rejected because the ring buffer was full. */
+  uint64_t bytes_written;   /**< Bytes handed to the file system. */
+  uint32_t bytes_dropped;   /**< Bytes lost to open or write errors. */
+  uint32_t write_calls;     /**< Number of `fwrite` calls issued. */
+  uint32_t flushes;         /**< Number of time- or request-triggered flushes (each ends with an `fsync`). */
+  uint32_t opens;           /**< Number of times a file was opened. */
+  uint64_t write_time_us;   /**< Total time spent in `fwrite`. */
+  uint32_t ring_peak_bytes; /**< Highest ring buffer occupancy seen, in bytes. */
+} file_write_stats_t;
 
 /* Public Functions ***********************************************************/
 
 /**
  * @brief Initializes the file write manager.
  *
- * Sets up a FreeRTOS queue for managing asynchronous file write requests 
- * and starts a background task to process them. Files are always opened 
+ * Sets up a FreeRTOS no-split ring buffer for asynchronous file write
+ * requests and starts a background task to process them. Files are always opened 
  * in append mode, creating them if they do not exist. Each line of data 
  * written to a file will include a timestamp at the start in the format 
  * `YYYY-MM-DD HH:MM:SS`.
  *
+ * Up to `FILE_WRITE_MAX_OPEN_FILES` files stay open between records; the
+ * least recently used one is closed when another file is needed. Records
+ * are gathered in a per-file buffer and written when the buffer fills up
+ * (whole sectors only), when the oldest record has waited
+ * `file_write_flush_interval_ticks`, or on `file_write_manager_flush`.
+ *
+ * Files are not written under the name the producers give but as segments
+ * `<file_write_segment_root>/YYYYMMDD/HH/PP_<name>` (UTC), one per hour and
+ * name, with a new part `PP` once a segment reaches
+ * `file_write_segment_max_bytes`. Old segments are removed or compacted by
+ * the log maintenance manager.
+ *
+ * The SD card is mounted (`sd_card_init`, which also repairs logs torn by a
+ * power loss) before the task starts, and the newest segments are repaired
+ * too, so the task never appends behind a torn record.
+ *
  * @return
  * - ESP_OK   if the initialization is successful.
- * - ESP_FAIL if the queue creation fails.
+ * - ESP_FAIL if the ring buffer, the SD card or the task cannot be set up.
  *
  * @note This function must be called before attempting to enqueue file 
  *       write requests.
  */
 esp_err_t file_write_manager_init(void);
 
+/**
+ * @brief Reserves space for one record in the file write ring buffer.
+ *
+ * Lets a producer format its record directly into the ring buffer instead
+ * of into a stack buffer that is then copied. Only the current wall-clock
+ * second is captured here; the text timestamp is formatted by the write
+ * task.
+ *
+ * @param[in]  file_name   File name (e.g., "sensor1.txt"); the record goes to
+ *                         the current segment of that name.
+ * @param[in]  capacity    Maximum record length, at most `FILE_WRITE_MAX_RECORD_LENGTH`.
+ * @param[out] reservation Receives the reserved space.
+ *
+ * @return
+ * - ESP_OK                if the space was reserved.
+ * - ESP_ERR_INVALID_ARG   if an argument is invalid or too long.
+ * - ESP_ERR_NO_MEM        if the ring buffer is full; the record is counted as dropped.
+ * - ESP_ERR_INVALID_STATE if the manager is not initialized.
+ *
+ * @note Does not block. Commit the reservation promptly: records behind it
+ *       are not written until it is committed.
+ */
+esp_err_t file_write_reserve(const char *file_name, size_t capacity,
+                             file_write_reservation_t *reservation);
+
+/**
+ * @brief Hands a reserved record over to the write task.
+ *
+ * @param[in,out] reservation Reservation from `file_write_reserve`; invalid afterwards.
+ * @param[in]     length      Number of bytes written to `reservation->data`,
+ *                            clamped to its capacity. 0 discards the record.
+ *
+ * @return
+ * - ESP_OK              if the record was committed.
+ * - ESP_ERR_INVALID_ARG if the reservation is NULL or was already committed.
+ * - ESP_FAIL            if the ring buffer rejected the item.
+ */
+esp_err_t file_write_commit(file_write_reservation_t *reservation, size_t length);
+
 /**
  * @brief Enqueues a file write request.
  *
- * Adds a file write request to the queue for asynchronous processing. 
+ * Copies a string into the ring buffer for asynchronous processing. 
  * The data will be written to the specified file in the background by 
  * the file write task. If the file does not exist, it will be created 
  * automatically. All writes append data to the file. Each line written 
  * includes a timestamp at the beginning in the format `YYYY-MM-DD HH:MM:SS`.
  *
- * @param[in] file_path Path to the file (e.g., "/sdcard/sensor1.txt"). 
- *                      This must be a valid file path accessible by 
- *                      the system.
- * @param[in] data      Null-terminated string to write to the file. The 
- *                      string should not exceed the maximum size allowed 
- *                      by the queue.
+ * @param[in] file_name File name (e.g., "sensor1.txt"); the data goes to
+ *                      the current segment of that name.
+ * @param[in] data      Null-terminated string to write to the file, at
+ *                      most `FILE_WRITE_MAX_RECORD_LENGTH` characters.
+ *                      Longer strings are rejected, not truncated.
  *
  * @return
  * - ESP_OK              if the request was successfully enqueued.
  * - ESP_ERR_INVALID_ARG if any argument is invalid (e.g., NULL pointers).
- * - ESP_FAIL            if the queue is full.
+ * - ESP_ERR_NO_MEM      if the ring buffer is full.
  *
  * @note Ensure `file_write_manager_init` has been called before invoking 
  *       this function. The function does not block but returns immediately 
  *       after enqueueing the request.
  */
-esp_err_t file_write_enqueue(const char *file_path, const char *data);
+esp_err_t file_write_enqueue(const char *file_name, const char *data);
+
+/**
+ * @brief Enqueues a sensor frame for the binary time-series log of its sensor.
+ *
+ * The write task stores the frame's time, flags and payload as one
+ * fixed-size record of a `ts_log` file (see `ts_log.h`). The file is
+ * created with a header naming the sensor on first use, and an existing
+ * log is resumed after its last intact record. Each completed block gets an
+ * entry in the segment's `.idx` file, so readers can seek by time. The
+ * record is built on the caller's stack and copied into the ring buffer in
+ * one send.
+ *
+ * @param[in] file_name File name (e.g., "mpu6050.tsl"), one per sensor; the
+ *                      frame goes to the current segment of that name.
+ * @param[in] frame     Frame produced by `sensor_frame_encode`.
+ * @param[in] frame_len Length of `frame`, at most `SENSOR_FRAME_MAX_SIZE`.
+ *
+ * @return
+ * - ESP_OK                if the frame was enqueued.
+ * - ESP_ERR_INVALID_ARG   if an argument is invalid.
+ * - ESP_ERR_NO_MEM        if the ring buffer is full.
+ * - ESP_ERR_INVALID_STATE if the manager is not initialized.
+ *
+ * @note The frame is only parsed by the write task; malformed frames are
+ *       counted as dropped bytes there.
+ */
+esp_err_t file_write_log_frame(const char *file_name, const uint8_t *frame, size_t frame_len);
+
+/**
+ * @brief Writes every buffered record to the card and syncs the files.
+ *
+ * Queues a flush request behind the records already queued and waits until
+ * the write task has handled it. Call this before a planned power-down so no
+ * buffered readings are lost; `esp_restart` already calls it from a shutdown
+ * handler. Concurrent callers wait one after the other, and each request
+ * carries a token, so a request that timed out cannot end a later one early.
+ *
+ * @param[in] timeout_ticks Maximum time to wait for the flush.
+ *
+ * @return
+ * - ESP_OK                if every record queued before the call is on the card.
+ * - ESP_ERR_TIMEOUT       if the flush did not complete in time.
+ * - ESP_ERR_INVALID_STATE if the manager is not initialized.
+ */
+esp_err_t file_write_manager_flush(TickType_t timeout_ticks);
+
+/**
+ * @brief Returns a snapshot of the write counters.
+ *
+ * @param[out] stats Receives the counters.
+ */
+void file_write_manager_get_stats(file_write_stats_t *stats);
 
 #ifdef __cplusplus
 }
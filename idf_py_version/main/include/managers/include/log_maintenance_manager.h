@@ -0,0 +1,54 @@
+/* main/include/managers/include/log_maintenance_manager.h */
+
+#ifndef SAFEHAT_WORKNET_LOG_MAINTENANCE_MANAGER_H
+#define SAFEHAT_WORKNET_LOG_MAINTENANCE_MANAGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/* Constants ******************************************************************/
+
+extern const char    *log_maintenance_tag;                /**< Logging tag for ESP_LOG messages related to log maintenance. */
+extern const uint32_t log_maintenance_interval_ticks;     /**< Time between two maintenance passes. */
+extern const uint8_t  log_maintenance_min_free_percent;   /**< Oldest segments are deleted while less of the card than this is free. */
+extern const bool     log_maintenance_compaction_enabled; /**< Whether old IMU segments are replaced by summaries. */
+extern const uint32_t log_maintenance_compaction_age_s;   /**< Age after which an IMU segment is compacted, in seconds. */
+extern const uint16_t log_maintenance_summary_readings;   /**< MPU6050 log readings one summary record covers at the logging rate. */
+
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Starts the background task that keeps the SD card logs in bounds.
+ *
+ * Every `log_maintenance_interval_ticks`, the task:
+ * - deletes the oldest hour of segments (see `file_write_manager.h`) while
+ *   less than `log_maintenance_min_free_percent` of the card is free. The
+ *   newest hour, which the file write manager is appending to, is kept.
+ * - if `log_maintenance_compaction_enabled`, replaces each MPU6050 segment
+ *   older than `log_maintenance_compaction_age_s` by a time-series log of
+ *   per-window summaries (`<part>_mpu6050_sum.tsl`): for every window of
+ *   `log_maintenance_summary_readings` times `mpu6050_polling_rate_ticks`,
+ *   the number of readings and the minimum, maximum and mean of each
+ *   field. The header's `sensor_id` carries `TS_LOG_SUMMARY_FLAG`.
+ *
+ * A segment is only deleted once its summary is synced, and a summary left
+ * incomplete by a power loss is rewritten on the next pass.
+ *
+ * @return
+ * - ESP_OK   if the task was started.
+ * - ESP_FAIL if the task could not be created.
+ *
+ * @note Call after `file_write_manager_init`, which mounts the card.
+ */
+esp_err_t log_maintenance_manager_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFEHAT_WORKNET_LOG_MAINTENANCE_MANAGER_H */
@@ -0,0 +1,130 @@
+/* main/include/managers/include/outbox_manager.h */
+
+#ifndef SAFEHAT_WORKNET_OUTBOX_MANAGER_H
+#define SAFEHAT_WORKNET_OUTBOX_MANAGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/* Constants ******************************************************************/
+
+extern const char    *outbox_tag;                  /**< Logging tag for ESP_LOG messages related to the outbox. */
+extern const char    *outbox_dir;                  /**< Directory below the SD card mount point holding the outbox. */
+extern const uint32_t outbox_max_bytes;            /**< Largest outbox file; batches that do not fit are dropped. */
+extern const uint32_t outbox_compact_bytes;        /**< Acknowledged bytes at the start of the outbox file that trigger a compaction. */
+extern const uint32_t outbox_drain_interval_ticks; /**< Pause between two replayed batches, leaving the session to live traffic. */
+extern const uint32_t outbox_retry_ticks;          /**< Pause after a failed replay; doubled after each further failure. */
+extern const uint32_t outbox_retry_max_ticks;      /**< Longest pause between failed replays. */
+
+/* Macros *********************************************************************/
+
+#define OUTBOX_BATCH_SIZE   (4096)       /**< Largest body replayed in one request, in bytes. */
+#define OUTBOX_RECORD_MAGIC (0x584F424F) /**< "OBOX" in little-endian byte order, starts every stored batch. */
+#define OUTBOX_CURSOR_MAGIC (0x5253434F) /**< "OCSR" in little-endian byte order, starts every cursor copy. */
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Header in front of every batch stored in the outbox file.
+ *
+ * The batch itself follows: `length` bytes of concatenated sensor frames,
+ * exactly as they would have been POSTed. A batch only counts if its CRC
+ * matches, so one torn by a power loss is cut off at the next boot.
+ */
+typedef struct __attribute__((packed)) {
+  uint32_t magic;  /**< `OUTBOX_RECORD_MAGIC`. */
+  uint16_t length; /**< Number of frame bytes that follow. */
+  uint16_t count;  /**< Number of frames in the batch. */
+  uint32_t crc32;  /**< CRC-32 (IEEE 802.3) of the frame bytes. */
+} outbox_record_t;
+
+/**
+ * @brief Cumulative counters of the outbox.
+ */
+typedef struct {
+  uint32_t stored;         /**< Frames written to the outbox. */
+  uint32_t replayed;       /**< Frames the server accepted from the outbox. */
+  uint32_t dropped;        /**< Frames that did not fit in the outbox, could not be written or were rejected. */
+  uint32_t rejected;       /**< Frames the server refused with a 4xx status, included in `dropped`. */
+  uint32_t replay_batches; /**< Requests sent by the drain task. */
+  uint32_t replay_errors;  /**< Replay requests that failed and will be retried. */
+  uint32_t compactions;    /**< Times the acknowledged start of the outbox file was cut off. */
+  uint32_t pending_bytes;  /**< Bytes between the cursor and the end of the outbox. */
+} outbox_stats_t;
+
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Opens the outbox on the SD card and starts the drain task.
+ *
+ * Readings the uplink cannot deliver are appended to
+ * `<mount>/<outbox_dir>/outbox.bin`. A cursor, kept in `cursor.bin`, marks
+ * how far the server has acknowledged the file. The cursor is stored twice
+ * and the copies are updated in turn, so a power loss during an update
+ * leaves the previous cursor intact.
+ *
+ * Once the network is back, a low-priority task replays the outbox in
+ * batches of up to `OUTBOX_BATCH_SIZE` bytes, oldest first. It pauses
+ * `outbox_drain_interval_ticks` between batches and only sends while the
+ * live uplink queues are empty, so new readings keep priority. The cursor
+ * passes a batch once the server answered it with 2xx; a batch the server
+ * rejects with 4xx is dropped and counted. After a transport error or a
+ * 5xx, the batch is kept and retried with a growing pause, from
+ * `outbox_retry_ticks` up to `outbox_retry_max_ticks`. While the station
+ * has no IP address, or nothing is stored, the task sleeps. When
+ * everything is acknowledged, the file is emptied. If new batches keep it
+ * from ever emptying, the unacknowledged batches are copied to a new file
+ * once `outbox_compact_bytes` have been acknowledged and make up more than
+ * half of it, so the file stays within `outbox_max_bytes`.
+ *
+ * At startup, a batch torn by a power loss at the end of the outbox is cut
+ * off, a compaction interrupted by one is finished or discarded, and a
+ * cursor past the end of the file is reset.
+ *
+ * @return
+ * - ESP_OK   if the outbox is ready.
+ * - ESP_FAIL if the files could not be opened or the task not started.
+ *
+ * @note Delivery is at least once: a batch whose acknowledgement was lost
+ *       is sent again. Frames carry their node and sequence number, so the
+ *       server can recognize the duplicate.
+ * @note Call after `file_write_manager_init`, which mounts the card.
+ */
+esp_err_t outbox_manager_init(void);
+
+/**
+ * @brief Stores a batch of frames that could not be uploaded.
+ *
+ * The batch is synced to the card before the function returns.
+ *
+ * @param[in] frames Concatenated sensor frames.
+ * @param[in] length Number of bytes in `frames`, at most `OUTBOX_BATCH_SIZE`.
+ * @param[in] count  Number of frames in the batch.
+ *
+ * @return
+ * - ESP_OK                if the batch is on the card.
+ * - ESP_ERR_INVALID_ARG   if the batch is empty or too large.
+ * - ESP_ERR_INVALID_STATE if the outbox is not open.
+ * - ESP_ERR_NO_MEM        if the outbox file would grow past `outbox_max_bytes`; the batch
+ *                         is counted as dropped.
+ * - ESP_FAIL              if the batch could not be written.
+ */
+esp_err_t outbox_store(const uint8_t *frames, size_t length, uint32_t count);
+
+/**
+ * @brief Returns a snapshot of the outbox counters.
+ *
+ * @param[out] stats Receives the counters.
+ */
+void outbox_manager_get_stats(outbox_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFEHAT_WORKNET_OUTBOX_MANAGER_H */
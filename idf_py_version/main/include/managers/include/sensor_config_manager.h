@@ -0,0 +1,72 @@
+/* main/include/managers/include/sensor_config_manager.h */
+
+#ifndef SAFEHAT_WORKNET_SENSOR_CONFIG_MANAGER_H
+#define SAFEHAT_WORKNET_SENSOR_CONFIG_MANAGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+/* Constants ******************************************************************/
+
+extern const char    *sensor_config_tag;           /**< Tag for logging */
+extern const char    *sensor_config_namespace;     /**< NVS namespace holding the per-sensor settings */
+extern const uint32_t sensor_config_min_period_ms; /**< Shortest sampling period accepted, in milliseconds */
+extern const uint32_t sensor_config_max_period_ms; /**< Longest sampling period accepted, in milliseconds */
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Runtime-adjustable sampling settings of one sensor.
+ */
+typedef struct {
+  uint32_t period_ms; /**< Time between two acquisition cycles, in milliseconds. */
+  uint8_t  worker;    /**< Scheduler worker running the sensor (0 is the latency-critical one). */
+  bool     enabled;   /**< Whether the sensor is sampled at all. */
+} sensor_settings_t;
+
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Overrides a sensor's settings with the values stored in NVS.
+ *
+ * Every setting is stored under its own NVS key, prefixed with `key`, so
+ * fields that were never stored keep the value already in `settings`. This
+ * lets the caller pass in the compile-time defaults.
+ *
+ * @param[in]     key      Short sensor key (at most 12 characters), e.g. "mpu6050".
+ * @param[in,out] settings Defaults on input, effective settings on output.
+ *
+ * @return
+ * - ESP_OK              if at least one setting was found in NVS.
+ * - ESP_ERR_NOT_FOUND   if nothing is stored for this sensor.
+ * - ESP_ERR_INVALID_ARG if an argument is NULL or the key is too long.
+ * - Error code from the NVS API otherwise.
+ *
+ * @note NVS must be initialized (`nvs_flash_init`) before calling this.
+ */
+esp_err_t sensor_config_load(const char *key, sensor_settings_t *settings);
+
+/**
+ * @brief Persists a sensor's settings so they survive a reboot.
+ *
+ * @param[in] key      Short sensor key, as passed to `sensor_config_load`.
+ * @param[in] settings Settings to store.
+ *
+ * @return
+ * - ESP_OK              if the settings were written and committed.
+ * - ESP_ERR_INVALID_ARG if an argument is NULL, the key is too long or the
+ *                       period lies outside the accepted range.
+ * - Error code from the NVS API otherwise.
+ */
+esp_err_t sensor_config_store(const char *key, const sensor_settings_t *settings);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFEHAT_WORKNET_SENSOR_CONFIG_MANAGER_H */
@@ -0,0 +1,148 @@
+/* main/include/managers/include/sensor_scheduler.h */
+
+#ifndef SAFEHAT_WORKNET_SENSOR_SCHEDULER_H
+#define SAFEHAT_WORKNET_SENSOR_SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+/* Constants ******************************************************************/
+
+extern const char       *sensor_scheduler_tag;            /**< Tag for logging */
+extern const uint32_t    sensor_scheduler_stack_depth;    /**< Stack depth of each worker task, in bytes. */
+extern const UBaseType_t sensor_scheduler_priorities[];   /**< Task priority of each worker, indexed by worker number. */
+extern const uint32_t    sensor_scheduler_stats_interval; /**< Interval between statistics log lines, in ticks. */
+
+/* Macros *********************************************************************/
+
+#define SENSOR_SCHEDULER_MAX_ENTRIES (8) /**< Maximum number of scheduled sensors across all workers. */
+#define SENSOR_SCHEDULER_WORKERS     (2) /**< Number of worker tasks (0: latency-critical, 1: slow sensors). */
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief A periodic job run by the sensor scheduler.
+ */
+typedef struct {
+  const char *name;                  /**< Name used in logs and statistics. */
+  void      (*tick_function)(void *); /**< Performs one non-blocking acquisition cycle. */
+  void       *data_ptr;              /**< Argument passed to `tick_function`. */
+  TickType_t  period_ticks;          /**< Time between two consecutive runs. */
+  TickType_t  jitter_budget_ticks;   /**< Lateness tolerated before a run counts as late. */
+  uint8_t     worker;                /**< Worker task that runs the job (< `SENSOR_SCHEDULER_WORKERS`). */
+  bool        enabled;               /**< Disabled jobs stay registered but are not run. */
+} sensor_scheduler_entry_t;
+
+/**
+ * @brief Timing statistics of one scheduled job.
+ */
+typedef struct {
+  uint32_t   runs;                /**< Number of completed runs. */
+  uint32_t   late_runs;           /**< Runs that started later than the jitter budget allows. */
+  uint32_t   skipped_periods;     /**< Periods dropped because the job fell a full period behind. */
+  TickType_t max_lateness_ticks;  /**< Largest observed start lateness. */
+  uint32_t   max_runtime_us;      /**< Longest single run. */
+  uint64_t   total_runtime_us;    /**< Sum of all run times. */
+} sensor_scheduler_stats_t;
+
+/**
+ * @brief RAM taken by the scheduler.
+ */
+typedef struct {
+  size_t static_bytes;     /**< Statically allocated job and worker state. */
+  size_t stack_bytes;      /**< Stack allocated to the running workers. */
+  size_t stack_used_bytes; /**< Peak stack use, summed over the running workers. */
+} sensor_scheduler_footprint_t;
+
+/* Public Functions ***********************************************************/
+
+/**
+ * @brief Registers a periodic job with the scheduler.
+ *
+ * Jobs must be registered before `sensor_scheduler_start`. Disabled jobs
+ * are registered too, so they can be enabled at runtime. The first run is
+ * due immediately; later runs follow on a fixed grid of `period_ticks`, so
+ * a late start does not shift the phase of the following runs.
+ *
+ * @param[in]  entry Job description; copied by the scheduler.
+ * @param[out] id    Optional; receives the id used by the other functions.
+ *
+ * @return
+ * - ESP_OK                if the job was registered.
+ * - ESP_ERR_INVALID_ARG   if `entry` is incomplete or names an invalid worker.
+ * - ESP_ERR_NO_MEM        if `SENSOR_SCHEDULER_MAX_ENTRIES` jobs are registered.
+ * - ESP_ERR_INVALID_STATE if the scheduler is already running.
+ */
+esp_err_t sensor_scheduler_add(const sensor_scheduler_entry_t *entry, uint8_t *id);
+
+/**
+ * @brief Creates one task per worker that has jobs and starts scheduling.
+ *
+ * Each worker keeps its jobs in a min-heap ordered by next due time, sleeps
+ * until the earliest one is due, runs it and re-inserts it. Jobs on the same
+ * worker never run concurrently, so tick functions must not block for long.
+ *
+ * @return
+ * - ESP_OK   if every needed worker task was created.
+ * - ESP_FAIL if a worker task could not be created.
+ */
+esp_err_t sensor_scheduler_start(void);
+
+/**
+ * @brief Changes the period of a job or enables/disables it.
+ *
+ * Before `sensor_scheduler_start` the entry is updated directly. Afterwards
+ * the change is handed to the job's worker, which is woken up and applies it
+ * before its next run; the reconfigured job then runs right away and
+ * continues on the new period grid. The worker of a job cannot be changed.
+ *
+ * @param[in] id           Job id returned by `sensor_scheduler_add`.
+ * @param[in] period_ticks New time between two consecutive runs.
+ * @param[in] enabled      Whether the job should run at all.
+ *
+ * @return
+ * - ESP_OK              if the change was applied or queued.
+ * - ESP_ERR_INVALID_ARG if `id` is unknown or `period_ticks` is 0.
+ */
+esp_err_t sensor_scheduler_reconfigure(uint8_t id, TickType_t period_ticks, bool enabled);
+
+/**
+ * @brief Returns a snapshot of the timing statistics of a job.
+ *
+ * @param[in]  id    Job id returned by `sensor_scheduler_add`.
+ * @param[out] stats Receives the statistics.
+ *
+ * @return
+ * - ESP_OK              on success.
+ * - ESP_ERR_INVALID_ARG if `id` is unknown or `stats` is NULL.
+ */
+esp_err_t sensor_scheduler_get_stats(uint8_t id, sensor_scheduler_stats_t *stats);
+
+/**
+ * @brief Returns the RAM the scheduler takes, peak stack use included.
+ *
+ * Stack use comes from each worker's high-water mark, so it only grows
+ * while the scheduler runs.
+ *
+ * @param[out] footprint Receives the figures.
+ */
+void sensor_scheduler_get_footprint(sensor_scheduler_footprint_t *footprint);
+
+/**
+ * @brief Logs the statistics of every job, the stack headroom of every worker
+ * and the scheduler's RAM footprint.
+ */
+void sensor_scheduler_log_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAFEHAT_WORKNET_SENSOR_SCHEDULER_H */
@@ -7,35 +7,60 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
 
 /* Globals (Constants) ********************************************************/
 
-extern const char *time_manager_tag; /**< For Logging */
+extern const char    *time_manager_tag;                /**< For Logging */
+extern const uint32_t time_manager_sync_timeout_ticks; /**< Suggested longest wait for the first SNTP sync */
 
 /* Public Functions ***********************************************************/
 
 /**
- * @brief Initializes the SNTP service and synchronizes the ESP32's system time.
+ * @brief Sets the fallback time and arranges for SNTP to start with the network.
  *
- * Sets up the Simple Network Time Protocol (SNTP) service to retrieve the 
- * current date and time from an NTP server. If synchronization with the NTP 
- * server fails (e.g., due to lack of Wi-Fi connectivity), the system falls 
- * back to manually setting the time to a predefined default value ("beginning 
- * of time"). The synchronized system time is critical for logging and 
- * timestamping operations across the application.
+ * Sets the system clock to a default date ("beginning of time") unless it
+ * is already later, so readings taken before the first SNTP sync carry a
+ * plausible timestamp; they are flagged as unsynced. SNTP is started from
+ * `IP_EVENT_STA_GOT_IP`, whenever the station first gets an address, and
+ * restarted on every later one, so a helmet that boots offline still
+ * synchronizes once Wi-Fi comes up. Does not block.
  *
  * @return
- * - ESP_OK   if the system time is successfully synchronized with an NTP server.
- * - ESP_FAIL if synchronization fails and the default fallback time is set.
+ * - ESP_OK         if the IP event handler is registered.
+ * - ESP_ERR_NO_MEM if the sync event group could not be created.
+ * - Error code from the event loop otherwise; the clock then keeps the default time.
  *
- * @note
- * - Call this function once during the system initialization phase.
- * - Ensure Wi-Fi connectivity is established before invoking this function 
- *   for successful NTP synchronization.
+ * @note Call once during system initialization, before the sensors start.
  */
 esp_err_t time_manager_init(void);
 
+/**
+ * @brief Waits until SNTP has set the system clock.
+ *
+ * A sync that completes after the wait gave up is still picked up by
+ * `time_manager_is_synced`.
+ *
+ * @param[in] timeout_ticks Longest time to wait, e.g. `time_manager_sync_timeout_ticks`.
+ *
+ * @return
+ * - ESP_OK                if the time is synchronized with an NTP server.
+ * - ESP_ERR_TIMEOUT       if it was not synchronized within `timeout_ticks`.
+ * - ESP_ERR_INVALID_STATE if `time_manager_init` has not succeeded.
+ */
+esp_err_t time_manager_wait_synced(TickType_t timeout_ticks);
+
+/**
+ * @brief Reports whether the system time was synchronized with an NTP server.
+ *
+ * @return
+ * - `true`  if the time was obtained from an NTP server.
+ * - `false` if the clock still runs from boot or from the default fallback time.
+ */
+bool time_manager_is_synced(void);
+
 #ifdef __cplusplus
 }
 #endif
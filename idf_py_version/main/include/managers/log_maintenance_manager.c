@@ -0,0 +1,571 @@
+/* main/include/managers/log_maintenance_manager.c */
+
+#include "log_maintenance_manager.h"
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "file_write_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "mpu6050_hal.h"
+#include "sd_card_hal.h"
+#include "sensor_frame.h"
+#include "ts_log.h"
+
+/* Constants ******************************************************************/
+
+const char    *log_maintenance_tag                = "LOG_MAINTENANCE";
+const uint32_t log_maintenance_interval_ticks     = pdMS_TO_TICKS(60 * 1000);
+const uint8_t  log_maintenance_min_free_percent   = 10;
+const bool     log_maintenance_compaction_enabled = true;
+const uint32_t log_maintenance_compaction_age_s   = 24 * 60 * 60;
+const uint16_t log_maintenance_summary_readings   = 12;
+
+/* Macros *********************************************************************/
+
+#define LOG_MAINTENANCE_IMU_FIELDS     (7)                                /**< Fields of an MPU6050 payload (acceleration, rotation, temperature), each an int16. */
+#define LOG_MAINTENANCE_IMU_SIZE       (2 * LOG_MAINTENANCE_IMU_FIELDS)   /**< Size of an MPU6050 payload. */
+#define LOG_MAINTENANCE_SUMMARY_SIZE   (2 + 3 * LOG_MAINTENANCE_IMU_SIZE) /**< Summary payload: reading count, then min, max and mean of each field. */
+#define LOG_MAINTENANCE_NAME_LENGTH    (16)                               /**< Room for the name of a day or hour directory. */
+#define LOG_MAINTENANCE_BATCH          (8)                                /**< Segments compacted per hour directory and pass. */
+#define LOG_MAINTENANCE_RAW_SUFFIX     "_mpu6050.tsl"                     /**< Ends the name of an MPU6050 segment. */
+#define LOG_MAINTENANCE_SUMMARY_SUFFIX "_mpu6050_sum.tsl"                 /**< Ends the name of its summary. */
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Readings of the summary window being accumulated.
+ */
+typedef struct {
+  int64_t  window_ms;                       /**< Start of the window, milliseconds since epoch. */
+  uint16_t count;                           /**< Readings in the window so far. */
+  uint8_t  flags;                           /**< Frame flags of all readings, OR-ed together. */
+  int16_t  min[LOG_MAINTENANCE_IMU_FIELDS]; /**< Smallest value of each field. */
+  int16_t  max[LOG_MAINTENANCE_IMU_FIELDS]; /**< Largest value of each field. */
+  int32_t  sum[LOG_MAINTENANCE_IMU_FIELDS]; /**< Sum of each field, for the mean. */
+} log_maintenance_window_t;
+
+/**
+ * @brief Summary log being written.
+ */
+typedef struct {
+  FILE           *file;      /**< Summary log. */
+  FILE           *index;     /**< Its index file. */
+  ts_log_block_t *block;     /**< Block being filled. */
+  uint32_t        summaries; /**< Summary records written. */
+} log_maintenance_summary_t;
+
+/* Globals (Static) ***********************************************************/
+
+static char s_compacted_day[LOG_MAINTENANCE_NAME_LENGTH] = ""; /**< Days sorting before this one have no segment left to compact */
+
+/* Private Functions **********************************************************/
+
+/**
+ * @brief Finds the entry of a directory whose name sorts first or last.
+ *
+ * Day and hour directories are named `YYYYMMDD` and `HH`, so names sort by age.
+ *
+ * @param[in]  dir_path Directory to search.
+ * @param[out] name     Receives the name, `LOG_MAINTENANCE_NAME_LENGTH` bytes.
+ * @param[in]  newest   `true` for the last name, `false` for the first.
+ *
+ * @return `true` if an entry was found.
+ */
+static bool priv_pick_entry(const char *dir_path, char *name, bool newest)
+{
+  DIR *dir = opendir(dir_path);
+  if (dir == NULL) {
+    return false;
+  }
+  name[0] = '\0';
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.' || strlen(entry->d_name) >= LOG_MAINTENANCE_NAME_LENGTH) {
+      continue;
+    }
+    int order = strcmp(entry->d_name, name);
+    if (name[0] == '\0' || (newest ? order > 0 : order < 0)) {
+      strcpy(name, entry->d_name);
+    }
+  }
+  closedir(dir);
+  return name[0] != '\0';
+}
+
+/**
+ * @brief Deletes a directory and the files in it.
+ *
+ * @param[in] dir_path Directory to delete; it must not hold subdirectories.
+ *
+ * @return
+ * - ESP_OK   if the directory is gone.
+ * - ESP_FAIL if a file or the directory could not be deleted, e.g.
+ *            because it is still open.
+ */
+static esp_err_t priv_remove_dir(const char *dir_path)
+{
+  DIR *dir = opendir(dir_path);
+  if (dir == NULL) {
+    return ESP_FAIL;
+  }
+  esp_err_t      ret = ESP_OK;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    char file_path[MAX_FILE_PATH_LENGTH];
+    if (entry->d_name[0] == '.' ||
+        snprintf(file_path, sizeof(file_path), "%s/%s", dir_path, entry->d_name) >= (int)sizeof(file_path)) {
+      continue;
+    }
+    if (unlink(file_path) != 0) {
+      ESP_LOGW(log_maintenance_tag, "Failed to delete %s", file_path);
+      ret = ESP_FAIL;
+    }
+  }
+  closedir(dir);
+
+  if (ret == ESP_OK && rmdir(dir_path) != 0) {
+    ret = ESP_FAIL;
+  }
+  return ret;
+}
+
+/**
+ * @brief Deletes the oldest hours of segments until enough of the card is free.
+ *
+ * The newest hour is never deleted: the file write manager appends to it.
+ */
+static void priv_enforce_retention(void)
+{
+  uint64_t total_bytes = 0;
+  uint64_t free_bytes  = 0;
+  if (sd_card_get_usage(&total_bytes, &free_bytes) != ESP_OK ||
+      free_bytes * 100 >= total_bytes * log_maintenance_min_free_percent) {
+    return;
+  }
+
+  char root_path[MAX_FILE_PATH_LENGTH];
+  char dir_path[MAX_FILE_PATH_LENGTH];
+  char newest_day[LOG_MAINTENANCE_NAME_LENGTH];
+  char newest_hour[LOG_MAINTENANCE_NAME_LENGTH];
+  snprintf(root_path, sizeof(root_path), "%s/%s", sd_card_mount_path, file_write_segment_root);
+  if (!priv_pick_entry(root_path, newest_day, true)) {
+    return;
+  }
+  snprintf(dir_path, sizeof(dir_path), "%s/%s", root_path, newest_day);
+  if (!priv_pick_entry(dir_path, newest_hour, true)) {
+    newest_hour[0] = '\0';
+  }
+
+  while (free_bytes * 100 < total_bytes * log_maintenance_min_free_percent) {
+    char day[LOG_MAINTENANCE_NAME_LENGTH];
+    char hour[LOG_MAINTENANCE_NAME_LENGTH];
+    char day_path[MAX_FILE_PATH_LENGTH];
+    if (!priv_pick_entry(root_path, day, false)) {
+      break;
+    }
+    snprintf(day_path, sizeof(day_path), "%s/%s", root_path, day);
+    if (!priv_pick_entry(day_path, hour, false)) {
+      /* Day left empty by an earlier pass */
+      if (rmdir(day_path) != 0) {
+        break;
+      }
+      continue;
+    }
+    if (strcmp(day, newest_day) == 0 && strcmp(hour, newest_hour) == 0) {
+      ESP_LOGW(log_maintenance_tag, "SD card nearly full, only the current hour is left");
+      break;
+    }
+
+    snprintf(dir_path, sizeof(dir_path), "%s/%s", day_path, hour);
+    if (priv_remove_dir(dir_path) != ESP_OK) {
+      ESP_LOGW(log_maintenance_tag, "Could not delete %s, retrying on the next pass", dir_path);
+      break;
+    }
+    rmdir(day_path); /* Fails harmlessly while other hours remain */
+    ESP_LOGW(log_maintenance_tag, "Deleted segments of %s/%s to free space", day, hour);
+
+    if (sd_card_get_usage(&total_bytes, &free_bytes) != ESP_OK) {
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Reads the records of one block of a log.
+ *
+ * @param[in]  file        Log opened for reading.
+ * @param[in]  block_no    Block to read.
+ * @param[in]  record_size Record size from the file header.
+ * @param[out] block       Receives the block.
+ * @param[out] sealed      Set to `true` if the block is complete.
+ *
+ * @return Number of record bytes in the block; 0 past the end of the log.
+ */
+static size_t priv_read_block(FILE *file, uint32_t block_no, uint16_t record_size,
+                              ts_log_block_t *block, bool *sealed)
+{
+  long offset = ts_log_block_offset(block_no);
+  *sealed     = false;
+  if (fseek(file, offset, SEEK_SET) != 0) {
+    return 0;
+  }
+  if (fread(block, 1, sizeof(*block), file) == sizeof(*block) &&
+      ts_log_block_verify(block, block_no) && block->footer.record_size == record_size) {
+    *sealed = true;
+    return ts_log_block_used(block);
+  }
+
+  /* The unsealed tail block: keep the records up to the first torn one */
+  ts_log_block_init(block, block_no, record_size);
+  if (fseek(file, offset, SEEK_SET) != 0) {
+    return 0;
+  }
+  return ts_log_block_scan(block, fread(block->records, 1, sizeof(block->records), file));
+}
+
+/**
+ * @brief Time covered by one summary record.
+ *
+ * The MPU6050 logs one reading every `mpu6050_polling_rate_ticks`, so the
+ * window spans `log_maintenance_summary_readings` of them. A summary record
+ * is about twice the size of a reading; a window holding only one or two
+ * readings would make the log larger instead of smaller.
+ *
+ * @return Window length in milliseconds, at least one second.
+ */
+static int64_t priv_summary_window_ms(void)
+{
+  int64_t window_ms = (int64_t)log_maintenance_summary_readings * pdTICKS_TO_MS(mpu6050_polling_rate_ticks);
+  return (window_ms > 1000) ? window_ms : 1000;
+}
+
+/**
+ * @brief Adds one MPU6050 reading to the current window.
+ */
+static void priv_window_add(log_maintenance_window_t *window, int64_t window_ms, uint8_t flags,
+                            const uint8_t *payload)
+{
+  if (window->count == 0) {
+    window->window_ms = window_ms;
+    window->flags     = 0;
+  }
+  for (uint8_t i = 0; i < LOG_MAINTENANCE_IMU_FIELDS; i++) {
+    int16_t value;
+    memcpy(&value, &payload[i * sizeof(value)], sizeof(value));
+    if (window->count == 0 || value < window->min[i]) {
+      window->min[i] = value;
+    }
+    if (window->count == 0 || value > window->max[i]) {
+      window->max[i] = value;
+    }
+    window->sum[i] = (window->count == 0) ? value : window->sum[i] + value;
+  }
+  window->flags |= flags;
+  window->count++;
+}
+
+/**
+ * @brief Appends the summary of a window to the summary log and empties the window.
+ *
+ * Full blocks are sealed, written and indexed right away.
+ *
+ * @return
+ * - ESP_OK   if the summary was added.
+ * - ESP_FAIL if a block could not be written.
+ */
+static esp_err_t priv_window_emit(log_maintenance_window_t *window, log_maintenance_summary_t *summary)
+{
+  if (window->count == 0) {
+    return ESP_OK;
+  }
+
+  uint8_t payload[LOG_MAINTENANCE_SUMMARY_SIZE];
+  size_t  offset = 0;
+  memcpy(&payload[offset], &window->count, sizeof(window->count));
+  offset += sizeof(window->count);
+  for (uint8_t i = 0; i < LOG_MAINTENANCE_IMU_FIELDS; i++) {
+    int32_t sum  = window->sum[i];
+    int16_t mean = (int16_t)((sum + (sum >= 0 ? window->count / 2 : -(window->count / 2))) / window->count);
+    memcpy(&payload[offset], &window->min[i], sizeof(int16_t));
+    memcpy(&payload[offset + 2], &window->max[i], sizeof(int16_t));
+    memcpy(&payload[offset + 4], &mean, sizeof(int16_t));
+    offset += 3 * sizeof(int16_t);
+  }
+
+  ts_log_block_t *block = summary->block;
+  ts_log_block_append(block, window->window_ms, window->flags, payload, sizeof(payload));
+  window->count = 0;
+  summary->summaries++;
+  if (!ts_log_block_is_full(block)) {
+    return ESP_OK;
+  }
+
+  ts_log_index_entry_t entry;
+  ts_log_block_seal(block);
+  ts_log_index_entry_init(block, &entry);
+  if (fwrite(block, 1, sizeof(*block), summary->file) != sizeof(*block) ||
+      fwrite(&entry, 1, sizeof(entry), summary->index) != sizeof(entry)) {
+    return ESP_FAIL;
+  }
+  ts_log_block_init(block, block->footer.block_no + 1, block->footer.record_size);
+  return ESP_OK;
+}
+
+/**
+ * @brief Replaces one MPU6050 segment by its summary.
+ *
+ * The summary is written from scratch, so one left incomplete by a power
+ * loss is simply written again. The segment is deleted only after the
+ * summary is synced.
+ *
+ * @param[in] dir_path Hour directory holding the segment.
+ * @param[in] raw_name File name of the segment.
+ * @param[in] raw      Scratch block for reading the segment.
+ * @param[in] out      Scratch block for writing the summary.
+ *
+ * @return
+ * - ESP_OK                if the segment was replaced.
+ * - ESP_ERR_INVALID_STATE if the file is not an MPU6050 log; it is left alone.
+ * - ESP_FAIL              if a file could not be read or written.
+ */
+static esp_err_t priv_compact_segment(const char *dir_path, const char *raw_name,
+                                      ts_log_block_t *raw, ts_log_block_t *out)
+{
+  char raw_path[MAX_FILE_PATH_LENGTH];
+  char summary_path[MAX_FILE_PATH_LENGTH];
+  char index_path[MAX_FILE_PATH_LENGTH];
+  int  prefix_len = (int)(strlen(raw_name) - strlen(LOG_MAINTENANCE_RAW_SUFFIX));
+  snprintf(raw_path, sizeof(raw_path), "%s/%s", dir_path, raw_name);
+  snprintf(summary_path, sizeof(summary_path), "%s/%.*s" LOG_MAINTENANCE_SUMMARY_SUFFIX,
+           dir_path, prefix_len, raw_name);
+  snprintf(index_path, sizeof(index_path), "%s" TS_LOG_INDEX_SUFFIX, summary_path);
+
+  FILE *file = fopen(raw_path, "rb");
+  if (file == NULL) {
+    return ESP_FAIL;
+  }
+  ts_log_file_header_t header;
+  if (fread(&header, 1, sizeof(header), file) != sizeof(header) ||
+      ts_log_file_header_check(&header) != ESP_OK || header.sensor_id != k_sensor_frame_id_mpu6050 ||
+      header.record_size != ts_log_record_size(LOG_MAINTENANCE_IMU_SIZE)) {
+    fclose(file);
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  log_maintenance_summary_t summary = {
+    .file  = fopen(summary_path, "wb"),
+    .index = fopen(index_path, "wb"),
+    .block = out,
+  };
+  esp_err_t ret = (summary.file != NULL && summary.index != NULL) ? ESP_OK : ESP_FAIL;
+
+  ts_log_file_header_t summary_header;
+  ts_log_file_header_init(&summary_header, header.sensor_id | TS_LOG_SUMMARY_FLAG, header.node_id,
+                          LOG_MAINTENANCE_SUMMARY_SIZE);
+  memset(out, 0, TS_LOG_FILE_HEADER_SIZE);
+  memcpy(out, &summary_header, sizeof(summary_header));
+  if (ret == ESP_OK && fwrite(out, 1, TS_LOG_FILE_HEADER_SIZE, summary.file) != TS_LOG_FILE_HEADER_SIZE) {
+    ret = ESP_FAIL;
+  }
+  ts_log_block_init(out, 0, summary_header.record_size);
+
+  log_maintenance_window_t window    = { 0 };
+  int64_t                  window_ms = priv_summary_window_ms();
+  uint32_t                 readings  = 0;
+  bool                     sealed    = true;
+  for (uint32_t block_no = 0; ret == ESP_OK && sealed; block_no++) {
+    size_t used = priv_read_block(file, block_no, header.record_size, raw, &sealed);
+    for (size_t at = 0; ret == ESP_OK && at < used; at += header.record_size) {
+      int64_t time_ms;
+      memcpy(&time_ms, &raw->records[at + sizeof(uint32_t)], sizeof(time_ms));
+      int64_t start_ms = time_ms - (time_ms % window_ms);
+      if (window.count > 0 && (start_ms != window.window_ms || window.count == UINT16_MAX)) {
+        ret = priv_window_emit(&window, &summary);
+      }
+      priv_window_add(&window, start_ms, raw->records[at + sizeof(uint32_t) + sizeof(time_ms)],
+                      &raw->records[at + TS_LOG_RECORD_HEADER]);
+      readings++;
+    }
+  }
+  fclose(file);
+
+  if (ret == ESP_OK) {
+    ret = priv_window_emit(&window, &summary);
+  }
+  /* The last block stays unsealed, like the tail of a live log */
+  size_t tail = ts_log_block_used(out);
+  if (ret == ESP_OK && tail > 0 && fwrite(out->records, 1, tail, summary.file) != tail) {
+    ret = ESP_FAIL;
+  }
+  if (ret == ESP_OK && (fflush(summary.file) != 0 || fsync(fileno(summary.file)) != 0 ||
+                        fflush(summary.index) != 0 || fsync(fileno(summary.index)) != 0)) {
+    ret = ESP_FAIL;
+  }
+  if (summary.file != NULL) {
+    fclose(summary.file);
+  }
+  if (summary.index != NULL) {
+    fclose(summary.index);
+  }
+  if (ret != ESP_OK) {
+    ESP_LOGE(log_maintenance_tag, "Failed to compact %s", raw_path);
+    return ret;
+  }
+
+  /* The index of the segment is rebuilt by readers if it is left behind */
+  unlink(raw_path);
+  snprintf(index_path, sizeof(index_path), "%s" TS_LOG_INDEX_SUFFIX, raw_path);
+  unlink(index_path);
+  ESP_LOGI(log_maintenance_tag, "Compacted %s: %" PRIu32 " readings into %" PRIu32 " summaries",
+           raw_path, readings, summary.summaries);
+  return ESP_OK;
+}
+
+/**
+ * @brief Compacts the MPU6050 segments of one hour directory.
+ *
+ * @return
+ * - ESP_OK   if no segment is left to compact.
+ * - ESP_FAIL if a segment could not be compacted or more remain for the next pass.
+ */
+static esp_err_t priv_compact_hour(const char *dir_path, ts_log_block_t *raw, ts_log_block_t *out)
+{
+  /* Names are gathered first: the directory is not read while files are deleted from it */
+  char    names[LOG_MAINTENANCE_BATCH][FILE_WRITE_MAX_NAME_LENGTH + 4];
+  uint8_t count = 0;
+  bool    more  = false;
+
+  DIR *dir = opendir(dir_path);
+  if (dir == NULL) {
+    return ESP_FAIL;
+  }
+  struct dirent *entry;
+  size_t         suffix_len = strlen(LOG_MAINTENANCE_RAW_SUFFIX);
+  while ((entry = readdir(dir)) != NULL) {
+    size_t len = strlen(entry->d_name);
+    if (len <= suffix_len || len >= sizeof(names[0]) ||
+        strcmp(&entry->d_name[len - suffix_len], LOG_MAINTENANCE_RAW_SUFFIX) != 0) {
+      continue;
+    }
+    if (count == LOG_MAINTENANCE_BATCH) {
+      more = true;
+      break;
+    }
+    strcpy(names[count++], entry->d_name);
+  }
+  closedir(dir);
+
+  esp_err_t ret = more ? ESP_FAIL : ESP_OK;
+  for (uint8_t i = 0; i < count; i++) {
+    esp_err_t compacted = priv_compact_segment(dir_path, names[i], raw, out);
+    if (compacted == ESP_FAIL) {
+      ret = ESP_FAIL;
+    }
+  }
+  return ret;
+}
+
+/**
+ * @brief Compacts every MPU6050 segment older than `log_maintenance_compaction_age_s`.
+ *
+ * Days already fully compacted are skipped without being listed, so a pass
+ * over weeks of logs only reads the directories of the last day or two.
+ */
+static void priv_compact_old_segments(ts_log_block_t *raw, ts_log_block_t *out)
+{
+  time_t    cutoff = time(NULL) - (time_t)log_maintenance_compaction_age_s;
+  struct tm cutoff_time;
+  char      cutoff_day[LOG_MAINTENANCE_NAME_LENGTH];
+  char      cutoff_hour[LOG_MAINTENANCE_NAME_LENGTH];
+  gmtime_r(&cutoff, &cutoff_time);
+  strftime(cutoff_day, sizeof(cutoff_day), "%Y%m%d", &cutoff_time);
+  strftime(cutoff_hour, sizeof(cutoff_hour), "%H", &cutoff_time);
+
+  char root_path[MAX_FILE_PATH_LENGTH];
+  snprintf(root_path, sizeof(root_path), "%s/%s", sd_card_mount_path, file_write_segment_root);
+  DIR *root = opendir(root_path);
+  if (root == NULL) {
+    return;
+  }
+
+  esp_err_t      ret = ESP_OK;
+  struct dirent *day;
+  while ((day = readdir(root)) != NULL) {
+    if (day->d_name[0] == '.' || strlen(day->d_name) >= LOG_MAINTENANCE_NAME_LENGTH ||
+        strcmp(day->d_name, s_compacted_day) < 0 || strcmp(day->d_name, cutoff_day) > 0) {
+      continue;
+    }
+
+    char day_path[MAX_FILE_PATH_LENGTH];
+    snprintf(day_path, sizeof(day_path), "%s/%s", root_path, day->d_name);
+    DIR *hours = opendir(day_path);
+    if (hours == NULL) {
+      continue;
+    }
+    struct dirent *hour;
+    while ((hour = readdir(hours)) != NULL) {
+      /* Hours of the cutoff day are old enough only if they ended before the cutoff */
+      if (hour->d_name[0] == '.' || strlen(hour->d_name) >= LOG_MAINTENANCE_NAME_LENGTH ||
+          (strcmp(day->d_name, cutoff_day) == 0 && strcmp(hour->d_name, cutoff_hour) >= 0)) {
+        continue;
+      }
+      char dir_path[MAX_FILE_PATH_LENGTH];
+      snprintf(dir_path, sizeof(dir_path), "%s/%s", day_path, hour->d_name);
+      if (priv_compact_hour(dir_path, raw, out) != ESP_OK) {
+        ret = ESP_FAIL;
+      }
+    }
+    closedir(hours);
+  }
+  closedir(root);
+
+  if (ret == ESP_OK) {
+    strcpy(s_compacted_day, cutoff_day);
+  }
+}
+
+/**
+ * @brief Task running the retention and compaction passes.
+ */
+static void priv_log_maintenance_task(void *param)
+{
+  /* Two blocks are too large for the stack; they are kept for the task's lifetime */
+  ts_log_block_t *blocks = malloc(2 * sizeof(ts_log_block_t));
+  if (blocks == NULL && log_maintenance_compaction_enabled) {
+    ESP_LOGE(log_maintenance_tag, "No memory for compaction, only retention runs");
+  }
+
+  while (1) {
+    vTaskDelay(log_maintenance_interval_ticks);
+
+    priv_enforce_retention();
+    if (log_maintenance_compaction_enabled && blocks != NULL) {
+      priv_compact_old_segments(&blocks[0], &blocks[1]);
+    }
+  }
+}
+
+/* Public Functions ***********************************************************/
+
+esp_err_t log_maintenance_manager_init(void)
+{
+  BaseType_t task_created = xTaskCreate(priv_log_maintenance_task,
+                                        "log_maintenance_task",
+                                        4096,
+                                        NULL,
+                                        1,
+                                        NULL);
+  if (task_created != pdPASS) {
+    ESP_LOGE(log_maintenance_tag, "Failed to create log maintenance task");
+    return ESP_FAIL;
+  }
+  ESP_LOGI(log_maintenance_tag, "Log maintenance started (keep %u%% free, compaction %s)",
+           log_maintenance_min_free_percent, log_maintenance_compaction_enabled ? "on" : "off");
+  return ESP_OK;
+}
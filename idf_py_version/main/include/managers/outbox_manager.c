@@ -0,0 +1,520 @@
+/* main/include/managers/outbox_manager.c */
+
+#include "outbox_manager.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "file_write_manager.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sd_card_hal.h"
+#include "webserver_tasks.h"
+#include "wifi_tasks.h"
+
+/* Constants ******************************************************************/
+
+const char    *outbox_tag                  = "OUTBOX";
+const char    *outbox_dir                  = "outbox";
+const uint32_t outbox_max_bytes            = 8 * 1024 * 1024;
+const uint32_t outbox_compact_bytes        = 256 * 1024;
+const uint32_t outbox_drain_interval_ticks = pdMS_TO_TICKS(200);
+const uint32_t outbox_retry_ticks          = pdMS_TO_TICKS(5 * 1000);
+const uint32_t outbox_retry_max_ticks      = pdMS_TO_TICKS(5 * 60 * 1000);
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief One of the two copies of the cursor in `cursor.bin`.
+ *
+ * The copy with the higher sequence number and a matching CRC wins; the
+ * next update overwrites the other one.
+ */
+typedef struct __attribute__((packed)) {
+  uint32_t magic;    /**< `OUTBOX_CURSOR_MAGIC`. */
+  uint32_t sequence; /**< Incremented on every update. */
+  uint32_t offset;   /**< Outbox offset up to which the server acknowledged. */
+  uint32_t crc32;    /**< CRC-32 of the fields above. */
+} outbox_cursor_t;
+
+/* Globals (Static) ***********************************************************/
+
+static SemaphoreHandle_t s_outbox_lock = NULL;  /**< Guards the files, offsets and `s_stats` */
+static TaskHandle_t      s_drain_task  = NULL;  /**< Woken when a batch is stored */
+static FILE             *s_outbox_file = NULL;  /**< Stored batches */
+static FILE             *s_cursor_file = NULL;  /**< Both cursor copies */
+static long              s_cursor      = 0;     /**< Offset of the first unacknowledged batch */
+static long              s_end         = 0;     /**< Offset just past the last intact batch */
+static long              s_single_end  = 0;     /**< Batches before this offset are replayed one at a time */
+static uint32_t          s_cursor_seq  = 0;     /**< Sequence number of the newest cursor copy */
+static outbox_stats_t    s_stats       = { 0 }; /**< Counters */
+static uint8_t           s_drain_buffer[OUTBOX_BATCH_SIZE]; /**< Body of the batch being replayed */
+
+/* Private Functions **********************************************************/
+
+/**
+ * @brief Builds the path of a file in the outbox directory.
+ */
+static void priv_path(char *path, size_t size, const char *file_name)
+{
+  snprintf(path, size, "%s/%s/%s", sd_card_mount_path, outbox_dir, file_name);
+}
+
+/**
+ * @brief Opens a file for reading and writing, creating it if needed.
+ */
+static FILE *priv_open(const char *file_path)
+{
+  FILE *file = fopen(file_path, "r+b");
+  if (file == NULL) {
+    file = fopen(file_path, "w+b");
+  }
+  return file;
+}
+
+/**
+ * @brief Computes the CRC of a cursor copy.
+ */
+static uint32_t priv_cursor_crc(const outbox_cursor_t *cursor)
+{
+  return esp_rom_crc32_le(0, (const uint8_t *)cursor, offsetof(outbox_cursor_t, crc32));
+}
+
+/**
+ * @brief Loads the newest intact cursor copy into `s_cursor`.
+ *
+ * Missing or damaged copies count as a cursor at offset 0.
+ */
+static void priv_cursor_load(void)
+{
+  outbox_cursor_t copies[2] = { 0 };
+  fseek(s_cursor_file, 0, SEEK_SET);
+  fread(copies, 1, sizeof(copies), s_cursor_file);
+
+  s_cursor     = 0;
+  s_cursor_seq = 0;
+  for (uint8_t i = 0; i < 2; i++) {
+    if (copies[i].magic == OUTBOX_CURSOR_MAGIC && copies[i].crc32 == priv_cursor_crc(&copies[i]) &&
+        copies[i].sequence >= s_cursor_seq) {
+      s_cursor     = copies[i].offset;
+      s_cursor_seq = copies[i].sequence;
+    }
+  }
+}
+
+/**
+ * @brief Makes the cursor durable.
+ *
+ * Writes the older of the two copies, so the newer one survives if power
+ * fails during the write. Must be called with `s_outbox_lock` held.
+ *
+ * @return
+ * - ESP_OK   if the cursor is on the card.
+ * - ESP_FAIL if it could not be written; the previous cursor stays valid.
+ */
+static esp_err_t priv_cursor_save(void)
+{
+  outbox_cursor_t copy = {
+    .magic    = OUTBOX_CURSOR_MAGIC,
+    .sequence = s_cursor_seq + 1,
+    .offset   = (uint32_t)s_cursor,
+  };
+  copy.crc32 = priv_cursor_crc(&copy);
+
+  long slot = (long)(copy.sequence % 2) * (long)sizeof(copy);
+  if (fseek(s_cursor_file, slot, SEEK_SET) != 0 ||
+      fwrite(&copy, 1, sizeof(copy), s_cursor_file) != sizeof(copy) ||
+      fflush(s_cursor_file) != 0 || fsync(fileno(s_cursor_file)) != 0) {
+    ESP_LOGE(outbox_tag, "Failed to save cursor");
+    return ESP_FAIL;
+  }
+  s_cursor_seq = copy.sequence;
+  return ESP_OK;
+}
+
+/**
+ * @brief Reads and checks the batch header at an offset.
+ *
+ * Leaves the file positioned at the frames of the batch.
+ *
+ * @param[in]  offset Offset of the header.
+ * @param[in]  limit  Offset the batch must end before.
+ * @param[out] record Receives the header.
+ *
+ * @return `true` if the header is plausible and the batch ends before `limit`.
+ */
+static bool priv_record_read(long offset, long limit, outbox_record_t *record)
+{
+  return offset + (long)sizeof(*record) <= limit && fseek(s_outbox_file, offset, SEEK_SET) == 0 &&
+         fread(record, 1, sizeof(*record), s_outbox_file) == sizeof(*record) &&
+         record->magic == OUTBOX_RECORD_MAGIC && record->length > 0 &&
+         record->length <= OUTBOX_BATCH_SIZE &&
+         offset + (long)sizeof(*record) + record->length <= limit;
+}
+
+/**
+ * @brief Finds the end of the intact batches and cuts off anything after it.
+ *
+ * Every batch is synced before the next one is written, so only the last
+ * one can be torn. The headers are walked from the cursor without reading
+ * the frames; only the CRC of the last batch is checked.
+ */
+static void priv_outbox_recover(void)
+{
+  fseek(s_outbox_file, 0, SEEK_END);
+  long size = ftell(s_outbox_file);
+  if (s_cursor > size) {
+    ESP_LOGW(outbox_tag, "Cursor %ld past the end of the outbox (%ld bytes), starting over",
+             s_cursor, size);
+    s_cursor = 0;
+  }
+
+  outbox_record_t record;
+  long            offset = s_cursor;
+  long            last   = -1;
+  while (priv_record_read(offset, size, &record)) {
+    last    = offset;
+    offset += (long)sizeof(record) + record.length;
+  }
+  if (last >= 0) {
+    priv_record_read(last, size, &record);
+    if (fread(s_drain_buffer, 1, record.length, s_outbox_file) != record.length ||
+        esp_rom_crc32_le(0, s_drain_buffer, record.length) != record.crc32) {
+      offset = last;
+    }
+  }
+
+  s_end = offset;
+  if (s_end < size) {
+    ESP_LOGW(outbox_tag, "Cut %ld bytes of a torn batch", size - s_end);
+    ftruncate(fileno(s_outbox_file), s_end);
+  }
+}
+
+/**
+ * @brief Gathers the oldest stored batches into `s_drain_buffer`.
+ *
+ * Batches whose CRC does not match are skipped and counted as dropped.
+ * Must be called with `s_outbox_lock` held.
+ *
+ * @param[in]  single Gather only one batch.
+ * @param[out] length Receives the number of bytes gathered.
+ * @param[out] count  Receives the number of frames gathered.
+ *
+ * @return Offset just past the last batch gathered.
+ */
+static long priv_drain_collect(bool single, size_t *length, uint32_t *count)
+{
+  outbox_record_t record;
+  long            offset = s_cursor;
+  *length                = 0;
+  *count                 = 0;
+  while (!(single && *count > 0) && priv_record_read(offset, s_end, &record) &&
+         *length + record.length <= sizeof(s_drain_buffer)) {
+    uint8_t *data = &s_drain_buffer[*length];
+    offset       += (long)sizeof(record) + record.length;
+    if (fread(data, 1, record.length, s_outbox_file) != record.length ||
+        esp_rom_crc32_le(0, data, record.length) != record.crc32) {
+      s_stats.dropped += record.count;
+      continue;
+    }
+    *length += record.length;
+    *count  += record.count;
+  }
+
+  /* A damaged header: nothing behind it can be found, so give the rest up */
+  if (offset < s_end && *count == 0 && !priv_record_read(offset, s_end, &record)) {
+    ESP_LOGE(outbox_tag, "Damaged batch header at %ld, discarding %ld bytes", offset, s_end - offset);
+    offset = s_end;
+  }
+  return offset;
+}
+
+/**
+ * @brief Resets both cursor copies to the start of the outbox.
+ *
+ * Both copies are written, so a later torn update cannot fall back to an
+ * offset from before the outbox was emptied or compacted.
+ */
+static void priv_cursor_reset(void)
+{
+  s_cursor = 0;
+  priv_cursor_save();
+  priv_cursor_save();
+}
+
+/**
+ * @brief Moves the unacknowledged batches to the start of a new outbox file.
+ *
+ * The batches are copied to `outbox.new`, synced, and renamed over
+ * `outbox.bin`; then the cursor is reset. The copy is smaller than the
+ * cursor offset, so after a power loss before the reset the old cursor
+ * lies past the end of the new file and `priv_outbox_recover` resets it
+ * too. A power loss between removing `outbox.bin` and the rename is
+ * finished by `outbox_manager_init`. Must be called with `s_outbox_lock`
+ * held, and only by the drain task, whose buffer it copies through.
+ */
+static void priv_outbox_compact(void)
+{
+  char path[MAX_FILE_PATH_LENGTH];
+  char new_path[MAX_FILE_PATH_LENGTH];
+  priv_path(path, sizeof(path), "outbox.bin");
+  priv_path(new_path, sizeof(new_path), "outbox.new");
+
+  long  length = s_end - s_cursor;
+  FILE *file   = fopen(new_path, "w+b");
+  bool  copied = file != NULL && fseek(s_outbox_file, s_cursor, SEEK_SET) == 0;
+  for (long done = 0; copied && done < length;) {
+    size_t chunk = (size_t)(length - done);
+    chunk        = (chunk < sizeof(s_drain_buffer)) ? chunk : sizeof(s_drain_buffer);
+    copied       = fread(s_drain_buffer, 1, chunk, s_outbox_file) == chunk &&
+                   fwrite(s_drain_buffer, 1, chunk, file) == chunk;
+    done        += (long)chunk;
+  }
+  copied = copied && fflush(file) == 0 && fsync(fileno(file)) == 0;
+  if (file != NULL) {
+    fclose(file);
+  }
+  if (!copied) {
+    ESP_LOGW(outbox_tag, "Failed to compact the outbox, keeping %ld bytes", s_end);
+    remove(new_path);
+    return;
+  }
+
+  /* FAT cannot rename onto an existing file, so the old outbox goes first */
+  fclose(s_outbox_file);
+  if (remove(path) != 0) {
+    s_outbox_file = priv_open(path);
+    remove(new_path);
+    ESP_LOGW(outbox_tag, "Failed to replace the outbox, keeping %ld bytes", s_end);
+    return;
+  }
+  s_outbox_file = priv_open(rename(new_path, path) == 0 ? path : new_path);
+
+  ESP_LOGI(outbox_tag, "Compacted the outbox from %ld to %ld bytes", s_end, length);
+  s_end        = length;
+  s_single_end = (s_single_end > s_cursor) ? s_single_end - s_cursor : 0;
+  s_stats.compactions++;
+  priv_cursor_reset();
+}
+
+/**
+ * @brief Moves the cursor past acknowledged batches.
+ *
+ * Once everything is acknowledged, the outbox is emptied. It is truncated
+ * before the cursor is reset, so a power loss in between leaves a cursor
+ * past the end, which `priv_outbox_recover` resets. If batches keep
+ * arriving so that it never empties, it is compacted once the cursor
+ * passes `outbox_compact_bytes` and the acknowledged part is the larger
+ * one. Must be called with `s_outbox_lock` held.
+ */
+static void priv_cursor_advance(long offset)
+{
+  s_cursor = offset;
+  if (s_cursor >= s_end && ftruncate(fileno(s_outbox_file), 0) == 0) {
+    s_end        = 0;
+    s_single_end = 0;
+    priv_cursor_reset();
+  } else if (s_cursor >= (long)outbox_compact_bytes && s_cursor > s_end - s_cursor) {
+    priv_outbox_compact();
+  } else {
+    priv_cursor_save();
+  }
+}
+
+/**
+ * @brief Task replaying the outbox once the uplink is back.
+ *
+ * Sleeps while the outbox is empty and while the station has no IP
+ * address. The cursor only moves past batches the server answered with
+ * 2xx, or rejected with 4xx. A request the server rejected may hold
+ * several stored batches, so they are sent again one at a time and only
+ * the batch rejected on its own is dropped. After any other failure the
+ * pause before the next attempt doubles, from `outbox_retry_ticks` up to
+ * `outbox_retry_max_ticks`.
+ *
+ * @param[in] param Unused.
+ */
+static void priv_outbox_drain_task(void *param)
+{
+  TickType_t retry_ticks = outbox_retry_ticks;
+  while (1) {
+    xSemaphoreTake(s_outbox_lock, portMAX_DELAY);
+    bool empty = (s_cursor == s_end);
+    xSemaphoreGive(s_outbox_lock);
+    if (empty) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    vTaskDelay(outbox_drain_interval_ticks);
+
+    /* Live readings go first; replay only while the uplink has nothing queued */
+    if (wifi_wait_online(portMAX_DELAY) != ESP_OK) {
+      vTaskDelay(outbox_retry_ticks);
+      continue;
+    }
+    if (webserver_uplink_pending() > 0) {
+      continue;
+    }
+
+    size_t   length;
+    uint32_t count;
+    xSemaphoreTake(s_outbox_lock, portMAX_DELAY);
+    bool single = (s_cursor < s_single_end);
+    long next   = priv_drain_collect(single, &length, &count);
+    if (count == 0 && next != s_cursor) {
+      priv_cursor_advance(next);
+    }
+    xSemaphoreGive(s_outbox_lock);
+    if (count == 0) {
+      continue;
+    }
+
+    /* The buffer is only written by this task, so it is posted without the lock */
+    esp_err_t err = webserver_post_frames(s_drain_buffer, length, count);
+
+    xSemaphoreTake(s_outbox_lock, portMAX_DELAY);
+    s_stats.replay_batches++;
+    if (err == ESP_OK) {
+      s_stats.replayed += count;
+      priv_cursor_advance(next);
+    } else if (err == ESP_ERR_NOT_SUPPORTED && single) {
+      s_stats.rejected += count;
+      s_stats.dropped  += count;
+      priv_cursor_advance(next);
+    } else if (err == ESP_ERR_NOT_SUPPORTED) {
+      s_single_end = next;
+    } else {
+      s_stats.replay_errors++;
+    }
+    long pending = s_end - s_cursor;
+    xSemaphoreGive(s_outbox_lock);
+
+    if (err == ESP_OK) {
+      ESP_LOGI(outbox_tag, "Replayed %" PRIu32 " frames, %ld bytes left", count, pending);
+    } else if (err == ESP_ERR_NOT_SUPPORTED && single) {
+      ESP_LOGE(outbox_tag, "Server rejected %" PRIu32 " frames, dropping them", count);
+    } else if (err == ESP_ERR_NOT_SUPPORTED) {
+      ESP_LOGW(outbox_tag, "Server rejected a replay, resending its batches one at a time");
+    } else {
+      ESP_LOGW(outbox_tag, "Replay failed (%s), retrying in %" PRIu32 " ms", esp_err_to_name(err),
+               (uint32_t)pdTICKS_TO_MS(retry_ticks));
+      vTaskDelay(retry_ticks);
+      retry_ticks = (retry_ticks < outbox_retry_max_ticks / 2) ? 2 * retry_ticks : outbox_retry_max_ticks;
+      continue;
+    }
+    retry_ticks = outbox_retry_ticks;
+  }
+}
+
+/* Public Functions ***********************************************************/
+
+esp_err_t outbox_manager_init(void)
+{
+  char path[MAX_FILE_PATH_LENGTH];
+  char new_path[MAX_FILE_PATH_LENGTH];
+  snprintf(path, sizeof(path), "%s/%s", sd_card_mount_path, outbox_dir);
+  mkdir(path, 0775); /* Fails harmlessly if the directory exists */
+
+  /* Finish a compaction cut short between removing the outbox and the rename,
+   * or throw away the copy of one cut short before that */
+  struct stat st;
+  priv_path(path, sizeof(path), "outbox.bin");
+  priv_path(new_path, sizeof(new_path), "outbox.new");
+  if (stat(path, &st) != 0 && stat(new_path, &st) == 0) {
+    rename(new_path, path);
+  } else {
+    remove(new_path);
+  }
+
+  s_outbox_file = priv_open(path);
+  priv_path(path, sizeof(path), "cursor.bin");
+  s_cursor_file = priv_open(path);
+  s_outbox_lock = xSemaphoreCreateMutex();
+  if (s_outbox_file == NULL || s_cursor_file == NULL || s_outbox_lock == NULL) {
+    ESP_LOGE(outbox_tag, "Failed to open the outbox");
+    return ESP_FAIL;
+  }
+
+  priv_cursor_load();
+  priv_outbox_recover();
+  ESP_LOGI(outbox_tag, "Outbox ready, %ld bytes waiting for replay", s_end - s_cursor);
+
+  BaseType_t task_created = xTaskCreate(priv_outbox_drain_task,
+                                        "outbox_drain_task",
+                                        4096,
+                                        NULL,
+                                        1,
+                                        &s_drain_task);
+  if (task_created != pdPASS) {
+    ESP_LOGE(outbox_tag, "Failed to create outbox drain task");
+    return ESP_FAIL;
+  }
+  if (s_end > s_cursor) {
+    xTaskNotifyGive(s_drain_task);
+  }
+  return ESP_OK;
+}
+
+esp_err_t outbox_store(const uint8_t *frames, size_t length, uint32_t count)
+{
+  if (frames == NULL || length == 0 || length > OUTBOX_BATCH_SIZE || count == 0 || count > UINT16_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (s_outbox_lock == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  outbox_record_t record = {
+    .magic  = OUTBOX_RECORD_MAGIC,
+    .length = (uint16_t)length,
+    .count  = (uint16_t)count,
+    .crc32  = esp_rom_crc32_le(0, frames, (uint32_t)length),
+  };
+
+  esp_err_t ret = ESP_OK;
+  xSemaphoreTake(s_outbox_lock, portMAX_DELAY);
+  if (s_end + (long)(sizeof(record) + length) > (long)outbox_max_bytes) {
+    ret = ESP_ERR_NO_MEM;
+  } else if (fseek(s_outbox_file, s_end, SEEK_SET) != 0 ||
+             fwrite(&record, 1, sizeof(record), s_outbox_file) != sizeof(record) ||
+             fwrite(frames, 1, length, s_outbox_file) != length ||
+             fflush(s_outbox_file) != 0 || fsync(fileno(s_outbox_file)) != 0) {
+    /* Leave no partial batch behind for the next one to follow */
+    ftruncate(fileno(s_outbox_file), s_end);
+    ret = ESP_FAIL;
+  } else {
+    s_end += (long)(sizeof(record) + length);
+  }
+
+  if (ret == ESP_OK) {
+    s_stats.stored += count;
+  } else {
+    s_stats.dropped += count;
+  }
+  xSemaphoreGive(s_outbox_lock);
+
+  if (ret == ESP_OK) {
+    xTaskNotifyGive(s_drain_task);
+  } else {
+    ESP_LOGE(outbox_tag, "Could not store %" PRIu32 " frames: %s", count, esp_err_to_name(ret));
+  }
+  return ret;
+}
+
+void outbox_manager_get_stats(outbox_stats_t *stats)
+{
+  if (s_outbox_lock == NULL) {
+    *stats = s_stats;
+    return;
+  }
+  xSemaphoreTake(s_outbox_lock, portMAX_DELAY);
+  s_stats.pending_bytes = (uint32_t)(s_end - s_cursor);
+  *stats                = s_stats;
+  xSemaphoreGive(s_outbox_lock);
+}
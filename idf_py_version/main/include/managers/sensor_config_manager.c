@@ -0,0 +1,136 @@
+/* main/include/managers/sensor_config_manager.c */
+
+#include "sensor_config_manager.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+
+/* Constants ******************************************************************/
+
+const char    *sensor_config_tag           = "SENSOR_CONFIG";
+const char    *sensor_config_namespace     = "sensors";
+const uint32_t sensor_config_min_period_ms = 5;
+const uint32_t sensor_config_max_period_ms = 60 * 60 * 1000;
+
+/* Macros *********************************************************************/
+
+#define SENSOR_CONFIG_MAX_KEY_LEN (12) /**< Longest sensor key; leaves room for a 3-character suffix in an NVS key. */
+
+/* Private (Static) Functions *************************************************/
+
+/**
+ * @brief Builds the NVS key of one setting, e.g. "mpu6050_ms".
+ *
+ * NVS keys are limited to 15 characters, hence the short suffixes.
+ *
+ * @param[out] out     Receives the NVS key.
+ * @param[in]  out_len Size of `out`; 16 bytes fit any valid key.
+ * @param[in]  key     Sensor key.
+ * @param[in]  suffix  Setting suffix ("_ms", "_en" or "_wk").
+ */
+static void priv_setting_key(char *out, size_t out_len, const char *key, const char *suffix)
+{
+  snprintf(out, out_len, "%s%s", key, suffix);
+}
+
+/**
+ * @brief Checks that a sensor key fits the NVS key length limit.
+ */
+static bool priv_key_valid(const char *key)
+{
+  return key != NULL && key[0] != '\0' && strlen(key) <= SENSOR_CONFIG_MAX_KEY_LEN;
+}
+
+/* Public Functions ***********************************************************/
+
+esp_err_t sensor_config_load(const char *key, sensor_settings_t *settings)
+{
+  if (!priv_key_valid(key) || settings == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  nvs_handle_t handle;
+  esp_err_t    ret = nvs_open(sensor_config_namespace, NVS_READONLY, &handle);
+  if (ret == ESP_ERR_NVS_NOT_FOUND) {
+    return ESP_ERR_NOT_FOUND; /* Namespace is created by the first store */
+  }
+  if (ret != ESP_OK) {
+    ESP_LOGE(sensor_config_tag, "Failed to open NVS: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  char     nvs_key[16];
+  bool     found = false;
+  uint32_t period_ms;
+  uint8_t  value;
+
+  priv_setting_key(nvs_key, sizeof(nvs_key), key, "_ms");
+  if (nvs_get_u32(handle, nvs_key, &period_ms) == ESP_OK) {
+    if (period_ms >= sensor_config_min_period_ms && period_ms <= sensor_config_max_period_ms) {
+      settings->period_ms = period_ms;
+      found               = true;
+    } else {
+      ESP_LOGW(sensor_config_tag, "Ignoring stored period of %" PRIu32 " ms for %s",
+               period_ms, key);
+    }
+  }
+
+  priv_setting_key(nvs_key, sizeof(nvs_key), key, "_en");
+  if (nvs_get_u8(handle, nvs_key, &value) == ESP_OK) {
+    settings->enabled = (value != 0);
+    found             = true;
+  }
+
+  priv_setting_key(nvs_key, sizeof(nvs_key), key, "_wk");
+  if (nvs_get_u8(handle, nvs_key, &value) == ESP_OK) {
+    settings->worker = value;
+    found            = true;
+  }
+
+  nvs_close(handle);
+
+  if (found) {
+    ESP_LOGI(sensor_config_tag, "%s: period=%" PRIu32 "ms enabled=%d worker=%u (from NVS)",
+             key, settings->period_ms, settings->enabled, settings->worker);
+  }
+  return found ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t sensor_config_store(const char *key, const sensor_settings_t *settings)
+{
+  if (!priv_key_valid(key) || settings == NULL ||
+      settings->period_ms < sensor_config_min_period_ms ||
+      settings->period_ms > sensor_config_max_period_ms) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  nvs_handle_t handle;
+  esp_err_t    ret = nvs_open(sensor_config_namespace, NVS_READWRITE, &handle);
+  if (ret != ESP_OK) {
+    ESP_LOGE(sensor_config_tag, "Failed to open NVS: %s", esp_err_to_name(ret));
+    return ret;
+  }
+
+  char nvs_key[16];
+  priv_setting_key(nvs_key, sizeof(nvs_key), key, "_ms");
+  ret = nvs_set_u32(handle, nvs_key, settings->period_ms);
+  if (ret == ESP_OK) {
+    priv_setting_key(nvs_key, sizeof(nvs_key), key, "_en");
+    ret = nvs_set_u8(handle, nvs_key, settings->enabled ? 1 : 0);
+  }
+  if (ret == ESP_OK) {
+    priv_setting_key(nvs_key, sizeof(nvs_key), key, "_wk");
+    ret = nvs_set_u8(handle, nvs_key, settings->worker);
+  }
+  if (ret == ESP_OK) {
+    ret = nvs_commit(handle);
+  }
+  nvs_close(handle);
+
+  if (ret != ESP_OK) {
+    ESP_LOGE(sensor_config_tag, "Failed to store settings for %s: %s", key, esp_err_to_name(ret));
+  }
+  return ret;
+}
@@ -0,0 +1,408 @@
+/* main/include/managers/sensor_scheduler.c */
+
+#include "sensor_scheduler.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Constants ******************************************************************/
+
+const char       *sensor_scheduler_tag                                   = "SENSOR_SCHEDULER";
+const uint32_t    sensor_scheduler_stack_depth                           = 4096;
+const UBaseType_t sensor_scheduler_priorities[SENSOR_SCHEDULER_WORKERS] = { 6, 5 };
+const uint32_t    sensor_scheduler_stats_interval                        = pdMS_TO_TICKS(60 * 1000);
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Scheduler-side state of one registered job.
+ */
+typedef struct {
+  sensor_scheduler_entry_t entry;                /**< Job description. */
+  TickType_t               next_due;             /**< Tick at which the next run is due. */
+  sensor_scheduler_stats_t stats;                /**< Timing statistics. */
+  TickType_t               pending_period_ticks; /**< Period requested by `sensor_scheduler_reconfigure`. */
+  bool                     pending_enabled;      /**< Enable flag requested by `sensor_scheduler_reconfigure`. */
+  bool                     pending;              /**< Set while a requested change waits for the worker. */
+} sensor_scheduler_job_t;
+
+/**
+ * @brief State of one worker task.
+ */
+typedef struct {
+  uint8_t      heap[SENSOR_SCHEDULER_MAX_ENTRIES]; /**< Ids of the enabled jobs, min-heap on `next_due`. */
+  uint8_t      count;                             /**< Number of jobs in `heap`. */
+  TaskHandle_t task;                              /**< Worker task, NULL if not started. */
+  bool         dirty;                             /**< Set when one of the worker's jobs has a pending change. */
+} sensor_scheduler_worker_t;
+
+/* Globals (Static) ***********************************************************/
+
+static sensor_scheduler_job_t    s_jobs[SENSOR_SCHEDULER_MAX_ENTRIES];          /**< Registered jobs */
+static sensor_scheduler_worker_t s_workers[SENSOR_SCHEDULER_WORKERS];           /**< Worker state */
+static uint8_t                   s_job_count    = 0;                            /**< Number of registered jobs */
+static bool                      s_running      = false;                        /**< Set once the workers are started */
+static portMUX_TYPE              s_stats_lock   = portMUX_INITIALIZER_UNLOCKED; /**< Guards job statistics, pending changes and `s_first_run_us` */
+static int64_t                   s_first_run_us = 0;                            /**< Start of the first run of any job, 0 until then */
+
+/* Private (Static) Functions *************************************************/
+
+/**
+ * @brief Wrap-safe "a is due before b" comparison of two tick counts.
+ */
+static inline bool priv_due_before(TickType_t a, TickType_t b)
+{
+  return (int32_t)(a - b) < 0;
+}
+
+/**
+ * @brief Compares two heap slots by the due time of their jobs.
+ */
+static inline bool priv_heap_less(const sensor_scheduler_worker_t *worker, uint8_t i, uint8_t j)
+{
+  return priv_due_before(s_jobs[worker->heap[i]].next_due, s_jobs[worker->heap[j]].next_due);
+}
+
+/**
+ * @brief Swaps two heap slots.
+ */
+static inline void priv_heap_swap(sensor_scheduler_worker_t *worker, uint8_t i, uint8_t j)
+{
+  uint8_t tmp     = worker->heap[i];
+  worker->heap[i] = worker->heap[j];
+  worker->heap[j] = tmp;
+}
+
+/**
+ * @brief Inserts a job into a worker's heap.
+ *
+ * @param[in,out] worker Worker state.
+ * @param[in]     id     Job id to insert.
+ */
+static void priv_heap_push(sensor_scheduler_worker_t *worker, uint8_t id)
+{
+  uint8_t i       = worker->count++;
+  worker->heap[i] = id;
+  while (i > 0) {
+    uint8_t parent = (i - 1) / 2;
+    if (!priv_heap_less(worker, i, parent)) {
+      break;
+    }
+    priv_heap_swap(worker, i, parent);
+    i = parent;
+  }
+}
+
+/**
+ * @brief Removes and returns the job that is due first.
+ *
+ * @param[in,out] worker Worker state; must not be empty.
+ *
+ * @return Id of the removed job.
+ */
+static uint8_t priv_heap_pop(sensor_scheduler_worker_t *worker)
+{
+  uint8_t top     = worker->heap[0];
+  worker->heap[0] = worker->heap[--worker->count];
+
+  uint8_t i = 0;
+  while (true) {
+    uint8_t left     = 2 * i + 1;
+    uint8_t right    = left + 1;
+    uint8_t smallest = i;
+    if (left < worker->count && priv_heap_less(worker, left, smallest)) {
+      smallest = left;
+    }
+    if (right < worker->count && priv_heap_less(worker, right, smallest)) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      break;
+    }
+    priv_heap_swap(worker, i, smallest);
+    i = smallest;
+  }
+  return top;
+}
+
+/**
+ * @brief Runs one job and records its timing.
+ *
+ * @param[in] id  Job id.
+ * @param[in] now Tick count at which the run starts.
+ */
+static void priv_run_job(uint8_t id, TickType_t now)
+{
+  sensor_scheduler_job_t *job      = &s_jobs[id];
+  TickType_t              lateness = now - job->next_due;
+
+  int64_t start_us = esp_timer_get_time();
+  job->entry.tick_function(job->entry.data_ptr);
+  uint32_t runtime_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+  /* Stay on the period grid; drop whole periods the job fell behind on */
+  uint32_t   skipped  = 0;
+  TickType_t finished = xTaskGetTickCount();
+  job->next_due      += job->entry.period_ticks;
+  while (priv_due_before(job->next_due, finished)) {
+    job->next_due += job->entry.period_ticks;
+    skipped++;
+  }
+
+  bool first = false;
+  portENTER_CRITICAL(&s_stats_lock);
+  if (s_first_run_us == 0) {
+    s_first_run_us = start_us;
+    first          = true;
+  }
+  job->stats.runs++;
+  job->stats.skipped_periods  += skipped;
+  job->stats.total_runtime_us += runtime_us;
+  if (lateness > job->entry.jitter_budget_ticks) {
+    job->stats.late_runs++;
+  }
+  if (lateness > job->stats.max_lateness_ticks) {
+    job->stats.max_lateness_ticks = lateness;
+  }
+  if (runtime_us > job->stats.max_runtime_us) {
+    job->stats.max_runtime_us = runtime_us;
+  }
+  portEXIT_CRITICAL(&s_stats_lock);
+
+  /* Time to first sample, for the boot log */
+  if (first) {
+    ESP_LOGI(sensor_scheduler_tag, "First sample (%s) taken %" PRId64 " ms after boot",
+             job->entry.name, start_us / 1000);
+  }
+}
+
+/**
+ * @brief Applies the changes requested for a worker's jobs and rebuilds its heap.
+ *
+ * Reconfigured jobs are due immediately, so a new period takes effect without
+ * waiting out the old one. Disabled jobs are left out of the heap.
+ *
+ * @param[in,out] worker Worker state.
+ * @param[in]     now    Current tick count.
+ */
+static void priv_apply_changes(sensor_scheduler_worker_t *worker, TickType_t now)
+{
+  uint8_t w = (uint8_t)(worker - s_workers);
+
+  portENTER_CRITICAL(&s_stats_lock);
+  bool dirty    = worker->dirty;
+  worker->dirty = false;
+  if (dirty) {
+    for (uint8_t id = 0; id < s_job_count; id++) {
+      sensor_scheduler_job_t *job = &s_jobs[id];
+      if (job->entry.worker == w && job->pending) {
+        job->entry.period_ticks = job->pending_period_ticks;
+        job->entry.enabled      = job->pending_enabled;
+        job->next_due           = now;
+        job->pending            = false;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&s_stats_lock);
+
+  if (!dirty) {
+    return;
+  }
+
+  worker->count = 0;
+  for (uint8_t id = 0; id < s_job_count; id++) {
+    if (s_jobs[id].entry.worker == w && s_jobs[id].entry.enabled) {
+      priv_heap_push(worker, id);
+    }
+  }
+}
+
+/**
+ * @brief Worker task: sleeps until the earliest job is due, then runs it.
+ *
+ * The sleep is a task-notification wait, so `sensor_scheduler_reconfigure`
+ * can wake the worker early to apply a change.
+ *
+ * @param[in] arg Pointer to the worker's `sensor_scheduler_worker_t`.
+ */
+static void priv_worker_task(void *arg)
+{
+  sensor_scheduler_worker_t *worker   = (sensor_scheduler_worker_t *)arg;
+  TickType_t                 last_log = xTaskGetTickCount();
+
+  while (1) {
+    TickType_t now = xTaskGetTickCount();
+    priv_apply_changes(worker, now);
+
+    /* Worker 0 also reports statistics for everyone */
+    if (worker == &s_workers[0] && (now - last_log) >= sensor_scheduler_stats_interval) {
+      sensor_scheduler_log_stats();
+      last_log = now;
+    }
+
+    /* With every job disabled, only wake up for changes and statistics */
+    if (worker->count == 0) {
+      ulTaskNotifyTake(pdTRUE, sensor_scheduler_stats_interval);
+      continue;
+    }
+
+    TickType_t due = s_jobs[worker->heap[0]].next_due;
+    if (priv_due_before(now, due)) {
+      ulTaskNotifyTake(pdTRUE, due - now);
+      continue;
+    }
+
+    uint8_t id = priv_heap_pop(worker);
+    priv_run_job(id, now);
+    priv_heap_push(worker, id);
+  }
+}
+
+/* Public Functions ***********************************************************/
+
+esp_err_t sensor_scheduler_add(const sensor_scheduler_entry_t *entry, uint8_t *id)
+{
+  if (s_running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (entry == NULL || entry->tick_function == NULL || entry->period_ticks == 0 ||
+      entry->worker >= SENSOR_SCHEDULER_WORKERS) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (s_job_count >= SENSOR_SCHEDULER_MAX_ENTRIES) {
+    ESP_LOGE(sensor_scheduler_tag, "No room to schedule %s", entry->name);
+    return ESP_ERR_NO_MEM;
+  }
+
+  uint8_t new_id = s_job_count++;
+  memset(&s_jobs[new_id], 0, sizeof(s_jobs[new_id]));
+  s_jobs[new_id].entry = *entry;
+  if (id != NULL) {
+    *id = new_id;
+  }
+  return ESP_OK;
+}
+
+esp_err_t sensor_scheduler_start(void)
+{
+  if (s_running) {
+    return ESP_OK;
+  }
+
+  /* Everything is due now; the heaps order the first round by registration */
+  uint8_t    registered[SENSOR_SCHEDULER_WORKERS] = { 0 };
+  TickType_t now                                  = xTaskGetTickCount();
+  for (uint8_t id = 0; id < s_job_count; id++) {
+    registered[s_jobs[id].entry.worker]++;
+    s_jobs[id].next_due = now;
+    if (s_jobs[id].entry.enabled) {
+      priv_heap_push(&s_workers[s_jobs[id].entry.worker], id);
+    }
+  }
+  s_running = true;
+
+  /* Workers whose jobs are all disabled still start, so the jobs can be enabled later */
+  esp_err_t ret = ESP_OK;
+  for (uint8_t w = 0; w < SENSOR_SCHEDULER_WORKERS; w++) {
+    if (registered[w] == 0) {
+      continue;
+    }
+
+    char name[configMAX_TASK_NAME_LEN];
+    snprintf(name, sizeof(name), "sensor_sched_%u", w);
+    if (xTaskCreate(priv_worker_task, name, sensor_scheduler_stack_depth, &s_workers[w],
+                    sensor_scheduler_priorities[w], &s_workers[w].task) != pdPASS) {
+      ESP_LOGE(sensor_scheduler_tag, "Failed to create worker %u", w);
+      ret = ESP_FAIL;
+    } else {
+      ESP_LOGI(sensor_scheduler_tag, "Worker %u started with %u sensors", w, s_workers[w].count);
+    }
+  }
+  return ret;
+}
+
+esp_err_t sensor_scheduler_reconfigure(uint8_t id, TickType_t period_ticks, bool enabled)
+{
+  if (id >= s_job_count || period_ticks == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  sensor_scheduler_job_t    *job    = &s_jobs[id];
+  sensor_scheduler_worker_t *worker = &s_workers[job->entry.worker];
+
+  portENTER_CRITICAL(&s_stats_lock);
+  if (s_running) {
+    job->pending_period_ticks = period_ticks;
+    job->pending_enabled      = enabled;
+    job->pending              = true;
+    worker->dirty             = true;
+  } else {
+    job->entry.period_ticks = period_ticks;
+    job->entry.enabled      = enabled;
+  }
+  portEXIT_CRITICAL(&s_stats_lock);
+
+  if (s_running && worker->task != NULL) {
+    xTaskNotifyGive(worker->task);
+  }
+  return ESP_OK;
+}
+
+esp_err_t sensor_scheduler_get_stats(uint8_t id, sensor_scheduler_stats_t *stats)
+{
+  if (id >= s_job_count || stats == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  portENTER_CRITICAL(&s_stats_lock);
+  *stats = s_jobs[id].stats;
+  portEXIT_CRITICAL(&s_stats_lock);
+  return ESP_OK;
+}
+
+void sensor_scheduler_get_footprint(sensor_scheduler_footprint_t *footprint)
+{
+  footprint->static_bytes     = sizeof(s_jobs) + sizeof(s_workers) + sizeof(s_job_count) +
+                                sizeof(s_running) + sizeof(s_stats_lock) + sizeof(s_first_run_us);
+  footprint->stack_bytes      = 0;
+  footprint->stack_used_bytes = 0;
+  for (uint8_t w = 0; w < SENSOR_SCHEDULER_WORKERS; w++) {
+    if (s_workers[w].task != NULL) {
+      footprint->stack_bytes      += sensor_scheduler_stack_depth;
+      footprint->stack_used_bytes += sensor_scheduler_stack_depth -
+                                     uxTaskGetStackHighWaterMark(s_workers[w].task);
+    }
+  }
+}
+
+void sensor_scheduler_log_stats(void)
+{
+  for (uint8_t id = 0; id < s_job_count; id++) {
+    sensor_scheduler_stats_t stats;
+    sensor_scheduler_get_stats(id, &stats);
+    ESP_LOGI(sensor_scheduler_tag,
+             "%s: runs=%" PRIu32 " late=%" PRIu32 " skipped=%" PRIu32
+             " max_late=%" PRIu32 "ms max_run=%" PRIu32 "us avg_run=%" PRIu32 "us",
+             s_jobs[id].entry.name, stats.runs, stats.late_runs, stats.skipped_periods,
+             (uint32_t)pdTICKS_TO_MS(stats.max_lateness_ticks), stats.max_runtime_us,
+             stats.runs ? (uint32_t)(stats.total_runtime_us / stats.runs) : 0);
+  }
+
+  for (uint8_t w = 0; w < SENSOR_SCHEDULER_WORKERS; w++) {
+    if (s_workers[w].task != NULL) {
+      ESP_LOGI(sensor_scheduler_tag, "Worker %u stack headroom: %u bytes", w,
+               (unsigned)uxTaskGetStackHighWaterMark(s_workers[w].task));
+    }
+  }
+
+  sensor_scheduler_footprint_t footprint;
+  sensor_scheduler_get_footprint(&footprint);
+  ESP_LOGI(sensor_scheduler_tag, "RAM: %u bytes static, %u of %u stack bytes used",
+           (unsigned)footprint.static_bytes, (unsigned)footprint.stack_used_bytes,
+           (unsigned)footprint.stack_bytes);
+}
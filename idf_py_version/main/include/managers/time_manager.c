@@ -1,27 +1,57 @@
 /* main/include/managers/time_manager.c */
 
 #include "time_manager.h"
+#include <string.h>
 #include <time.h>
 #include <sys/time.h>
-#include "wifi_tasks.h"
+#include "esp_event.h"
+#include "esp_netif.h"
 #include "esp_sntp.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 
 /* Globals (Constants) ********************************************************/
 
-const char *time_manager_tag = "TIME_MANAGER";
+#define TIME_SYNCED_BIT (BIT0) /**< SNTP has set the system clock */
+
+const char    *time_manager_tag                = "TIME_MANAGER";
+const uint32_t time_manager_sync_timeout_ticks = pdMS_TO_TICKS(20 * 1000);
+
+/* Globals (Static) ***********************************************************/
+
+static volatile bool      s_time_synced = false; /**< Set once SNTP has provided the wall-clock time */
+static EventGroupHandle_t s_time_events = NULL;  /**< Holds `TIME_SYNCED_BIT` once SNTP has set the clock */
+static bool               s_sntp_started = false; /**< SNTP was initialized on the first IP address */
 
 /* Private Functions **********************************************************/
 
+/**
+ * @brief SNTP callback, run each time the system clock was set from the server.
+ *
+ * Marks the time as synced and wakes `time_manager_wait_synced`. It also
+ * runs for syncs that complete after a wait gave up, so a helmet that
+ * booted offline starts stamping synced readings as soon as NTP answers.
+ *
+ * @param[in] tv Time that was set.
+ */
+static void priv_time_sync_cb(struct timeval *tv)
+{
+  if (!s_time_synced) {
+    ESP_LOGI(time_manager_tag, "System time synchronized by SNTP.");
+  }
+  s_time_synced = true;
+  xEventGroupSetBits(s_time_events, TIME_SYNCED_BIT);
+}
+
 /**
  * @brief Initializes the SNTP service for time synchronization.
  *
  * Configures SNTP to synchronize the system clock with an NTP server. By default, 
  * it uses "pool.ntp.org" and operates in polling mode to periodically refresh the time.
  *
- * @note 
- * - Ensure network connectivity before calling this function.
- * - The system time will remain unsynchronized if SNTP initialization fails.
+ * @note Called from `priv_got_ip_handler`, once the TCP/IP stack is up and
+ *       the station has an address.
  */
 static void priv_initialize_sntp(void)
 {
@@ -33,6 +63,9 @@ static void priv_initialize_sntp(void)
   /* Set the NTP server */
   esp_sntp_setservername(0, "pool.ntp.org");
 
+  /* Report every sync, including the ones after a timeout */
+  sntp_set_time_sync_notification_cb(priv_time_sync_cb);
+
   /* Initialize SNTP */
   esp_sntp_init();
 
@@ -42,16 +75,12 @@ static void priv_initialize_sntp(void)
 /**
  * @brief Sets the system time to a default value as a fallback.
  *
- * Sets the system clock to January 1st, 2023, 00:00:00 in cases where Wi-Fi 
- * is unavailable or NTP synchronization fails.
- *
- * @note 
- * - Use this function only as a fallback when time synchronization cannot complete.
+ * Sets the system clock to January 1st, 2025, 00:00:00, so readings taken
+ * before the first SNTP sync carry a plausible date. A clock that is already
+ * past it, e.g. kept across a software restart, is left alone.
  */
 static void priv_set_default_time(void)
 {
-  ESP_LOGW(time_manager_tag, "Setting time to default values.");
-
   struct timeval tv;
   struct tm      tm;
 
@@ -65,6 +94,9 @@ static void priv_set_default_time(void)
 
   tv.tv_sec  = mktime(&tm); /* Convert to seconds since epoch */
   tv.tv_usec = 0;
+  if (time(NULL) >= tv.tv_sec) {
+    return;
+  }
 
   settimeofday(&tv, NULL);
   char *time_str = asctime(&tm);
@@ -73,41 +105,81 @@ static void priv_set_default_time(void)
   ESP_LOGI(time_manager_tag, "Time set to default: %s", time_str);
 }
 
+/**
+ * @brief Starts SNTP when the station gets an IP address.
+ *
+ * The first address initializes SNTP. Later ones, after the station
+ * reconnected, restart it so the clock is checked at once instead of at
+ * the next poll.
+ *
+ * @param[in] arg        Unused.
+ * @param[in] event_base `IP_EVENT`.
+ * @param[in] event_id   `IP_EVENT_STA_GOT_IP`.
+ * @param[in] event_data Unused.
+ */
+static void priv_got_ip_handler(void *arg, esp_event_base_t event_base,
+                                int32_t event_id, void *event_data)
+{
+  if (!s_sntp_started) {
+    s_sntp_started = true;
+    priv_initialize_sntp();
+  } else {
+    esp_sntp_restart();
+  }
+}
+
 /* Public Functions ***********************************************************/
 
 esp_err_t time_manager_init(void)
 {
-  /* First, check the Wi-Fi connection. If it's unavailable, fallback to default time. */
-  if (wifi_check_connection() != ESP_OK) {
-    ESP_LOGE(time_manager_tag, "Network not available. Using default time.");
-    priv_set_default_time();
-    return ESP_FAIL; 
+  /* Readings taken before the first sync get the default date */
+  priv_set_default_time();
+
+  s_time_events = xEventGroupCreate();
+  if (!s_time_events) {
+    ESP_LOGE(time_manager_tag, "Failed to create event group.");
+    return ESP_ERR_NO_MEM;
   }
 
-  /* If we have Wi-Fi, proceed with SNTP initialization. */
-  priv_initialize_sntp();
+  /* Wi-Fi creates the same loop; whichever runs first creates it */
+  esp_err_t ret = esp_event_loop_create_default();
+  if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+    ESP_LOGE(time_manager_tag, "Failed to create the event loop: %s", esp_err_to_name(ret));
+    return ret;
+  }
 
-  /* Wait for NTP synchronization */
-  time_t    now         = 0;
-  struct tm timeinfo    = { 0 };
-  int       retry       = 0;
-  const int max_retries = 10;
+  ret = esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &priv_got_ip_handler, NULL, NULL);
+  if (ret != ESP_OK) {
+    ESP_LOGE(time_manager_tag, "Failed to register for IP events: %s", esp_err_to_name(ret));
+  }
+  return ret;
+}
 
-  while (timeinfo.tm_year < (2023 - 1900) && ++retry < max_retries) {
-    ESP_LOGI(time_manager_tag, "Waiting for system time to be set... (%d/%d)", retry, max_retries);
-    vTaskDelay(pdMS_TO_TICKS(2000));
-    time(&now);
-    localtime_r(&now, &timeinfo);
+esp_err_t time_manager_wait_synced(TickType_t timeout_ticks)
+{
+  if (!s_time_events) {
+    return ESP_ERR_INVALID_STATE;
   }
 
-  /* If time is still not set after retries, fallback to default. */
-  if (timeinfo.tm_year < (2023 - 1900)) {
-    ESP_LOGW(time_manager_tag, "NTP sync failed after multiple attempts. Setting default time.");
-    priv_set_default_time();
-    return ESP_FAIL;
+  /* Wait for the sync callback rather than polling the clock */
+  ESP_LOGI(time_manager_tag, "Waiting for system time to be set...");
+  EventBits_t bits = xEventGroupWaitBits(s_time_events, TIME_SYNCED_BIT, pdFALSE, pdFALSE, timeout_ticks);
+
+  /* The clock keeps running from the default time; SNTP keeps polling */
+  if (!(bits & TIME_SYNCED_BIT)) {
+    ESP_LOGW(time_manager_tag, "NTP sync timed out. Time stays unsynced.");
+    return ESP_ERR_TIMEOUT;
   }
 
+  time_t    now      = 0;
+  struct tm timeinfo = { 0 };
+  time(&now);
+  localtime_r(&now, &timeinfo);
   ESP_LOGI(time_manager_tag, "Time synchronized: %s", asctime(&timeinfo));
   return ESP_OK;
 }
 
+bool time_manager_is_synced(void)
+{
+  return s_time_synced;
+}
@@ -8,6 +8,7 @@ extern "C" {
 #endif
 
 #include "sensor_hal.h"
+#include "sensor_config_manager.h"
 #include "esp_err.h"
 #include "portmacro.h"
 
@@ -17,16 +18,27 @@ extern "C" {
  * @brief Structure to hold configuration for each sensor.
  *
  * Represents a sensor's configuration, including its metadata, initialization 
- * and task functions, data pointer, and an enablement flag.
+ * and tick functions, data pointer, scheduling parameters, and an enablement flag.
+ * The period, worker and enable flag are compile-time defaults; the values
+ * in effect live in `settings`, which may be overridden from NVS at boot and
+ * from the server at runtime.
  */
 typedef struct {
-  const char *sensor_name;            /**< Sensor name used for identification in logs and debugging. */
-  esp_err_t (*init_function)(void *); /**< Pointer to the function that initializes the sensor. */
-  void      (*task_function)(void *); /**< Pointer to the function that handles the sensor's tasks. */
-  void       *data_ptr;               /**< Pointer to the structure holding sensor-specific data. */
-  UBaseType_t priority;               /**< Priority of the sensor's task for scheduling purposes. */
-  uint32_t    stack_depth;            /**< Stack depth allocated for the sensor task, in words. */
-  bool        enabled;                /**< Flag indicating if the sensor is enabled (true) or disabled (false). */
+  const char       *sensor_name;            /**< Sensor name used for identification in logs and debugging. */
+  const char       *config_key;             /**< Short key naming the sensor in NVS and in server commands. */
+  esp_err_t       (*init_function)(void *); /**< Pointer to the function that initializes the sensor. */
+  void            (*tick_function)(void *); /**< Pointer to the function that runs one acquisition cycle. */
+  void             *data_ptr;               /**< Pointer to the structure holding sensor-specific data. */
+  const uint32_t   *period_ticks;           /**< Points at the HAL constant holding the sensor's default period, in ticks. */
+  const uint32_t   *max_period_ticks;       /**< Points at the HAL constant bounding the period, in ticks; NULL if unbounded. */
+  TickType_t        jitter_budget_ticks;    /**< Start lateness tolerated before a run counts as late. */
+  uint8_t           worker;                 /**< Default scheduler worker (0 is reserved for latency-critical sensors). */
+  bool              enabled;                /**< Flag indicating if the sensor is enabled by default. */
+  sensor_settings_t settings;               /**< Settings in effect, filled in by `sensors_init`. */
+  sensor_settings_t pending_settings;       /**< Settings posted by `sensor_tasks_configure`, not applied yet. */
+  bool              pending;                /**< Set while `pending_settings` waits to be applied. */
+  uint8_t           scheduler_id;           /**< Job id assigned by the sensor scheduler. */
+  bool              initialized;            /**< Set once `init_function` has been called. */
 } sensor_config_t;
 
 /* Public Functions ***********************************************************/
@@ -55,11 +67,12 @@ esp_err_t sensors_init(sensor_data_t *sensor_data);
 /**
  * @brief Records sensor data and stores it in a given variable.
  *
- * Continuously records data from all configured sensors and updates the provided
- * `sensor_data_t` structure with the latest readings. This function processes the
- * raw data from sensors and ensures it is ready for further use, such as uploading
- * to a server or storing in a database. The function relies on previously 
- * established sensor communication initialized by `sensors_init`.
+ * Registers every enabled sensor with the sensor scheduler and starts it. The
+ * scheduler runs all sensors from two worker tasks instead of one task per
+ * sensor: the IMU on its own worker, everything else on a shared one. Each
+ * sensor's tick updates the provided `sensor_data_t` structure with the latest
+ * readings. The function relies on previously established sensor communication
+ * initialized by `sensors_init`.
  *
  * Pre-condition:
  * - The `sensors_init` function must have been successfully called and completed 
@@ -73,14 +86,52 @@ esp_err_t sensors_init(sensor_data_t *sensor_data);
  *                            readings will be stored and updated.
  *
  * @return 
- * - ESP_OK   if all sensor tasks are successfully started and run.
- * - ESP_FAIL if any sensor task fails during execution.
+ * - ESP_OK   if every enabled sensor is scheduled and the workers are running.
+ * - ESP_FAIL if a sensor could not be scheduled or a worker could not start.
  *
  * @note This function should run continuously as part of the main sensor task loop 
  *       or be called periodically in a task for data acquisition.
  */
 esp_err_t sensor_tasks(sensor_data_t *sensor_data);
 
+/**
+ * @brief Returns a sensor's settings, including any not applied yet.
+ *
+ * @param[in]  config_key Sensor key, e.g. "mpu6050".
+ * @param[out] settings   Receives the settings.
+ *
+ * @return
+ * - ESP_OK              on success.
+ * - ESP_ERR_NOT_FOUND   if no sensor uses `config_key`.
+ * - ESP_ERR_INVALID_ARG if an argument is NULL.
+ */
+esp_err_t sensor_tasks_get_settings(const char *config_key, sensor_settings_t *settings);
+
+/**
+ * @brief Posts new sampling settings for a sensor.
+ *
+ * The settings are validated here and applied shortly afterwards by a job on
+ * the sensor scheduler's shared worker, so the caller never waits for a
+ * sensor init or an NVS write. Posting again before they are applied
+ * replaces them. A period above the sensor's own limit is clamped to it. A
+ * sensor enabled for the first time since boot is initialized first. A
+ * changed worker is only stored; it takes effect after the next restart. The
+ * settings are written to NVS, so they are also used on the next boot.
+ *
+ * @param[in] config_key Sensor key, e.g. "mpu6050".
+ * @param[in] settings   New settings.
+ *
+ * @return
+ * - ESP_OK              if the settings were posted.
+ * - ESP_ERR_NOT_FOUND   if no sensor uses `config_key`.
+ * - ESP_ERR_INVALID_ARG if the period or the worker is out of range.
+ *
+ * @note For the MPU6050 the period sets how often the FIFO is drained; the
+ *       sensor keeps sampling at its FIFO output rate, so the period is capped
+ *       at `mpu6050_max_tick_period_ticks` to drain before the FIFO overflows.
+ */
+esp_err_t sensor_tasks_configure(const char *config_key, const sensor_settings_t *settings);
+
 #ifdef __cplusplus
 }
 #endif
@@ -14,7 +14,11 @@ extern "C" {
 
 /* Constants ******************************************************************/
 
-extern const char *system_tag; /**< Logging tag */
+extern const char    *system_tag;                /**< Logging tag */
+extern const uint32_t system_boot_stack_depth;   /**< Stack of each background boot stage */
+extern const uint32_t system_boot_priority;      /**< Priority of the background boot stages */
+extern const uint32_t system_storage_wait_ticks; /**< Longest wait for storage before the sensors start */
+extern const uint32_t system_wifi_wait_ticks;    /**< Longest wait for Wi-Fi; a little over its own timeout */
 
 /* Globals ********************************************************************/
 
@@ -27,13 +31,20 @@ extern ov7670_data_t    g_camera_data;    /**< Global variable that holds the ca
  * @brief Initializes system-level tasks for handling devices and communication.
  *
  * Prepares system tasks required for managing hardware devices and communication 
- * subsystems. This includes setting up resources for sensor data collection, 
- * video streaming to the web server, and Wi-Fi operations. Initialization ensures 
- * that each task has the necessary prerequisites to start.
+ * subsystems. Only what the sensors depend on is on the critical path:
+ * - NVS and the uplink queues are initialized first, in order.
+ * - Storage, the camera and the network (Wi-Fi, then SNTP) each start in a
+ *   background task, while the sensors are initialized on the calling task.
+ * - The call returns once the sensors and storage are ready. Storage gets
+ *   at most `system_storage_wait_ticks`.
+ *
+ * Network and time keep coming up after the call returns. Each stage logs
+ * how long after boot it finished, so the boot log shows the time line.
  *
  * @return 
- * - ESP_OK   if all system-level tasks are initialized successfully.
- * - ESP_FAIL if any initialization step fails.
+ * - ESP_OK         if NVS, the uplink, the sensors and storage are initialized successfully.
+ * - ESP_FAIL       if any of them failed. Network and camera failures are only logged.
+ * - ESP_ERR_NO_MEM if the boot event group could not be created.
  *
  * @note This function should be called once during system setup, prior to starting 
  *       the tasks with `system_tasks_start`.
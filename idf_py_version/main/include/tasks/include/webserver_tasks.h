@@ -7,36 +7,171 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+#include <stddef.h>
 #include "esp_err.h"
 
+/* Constants ******************************************************************/
+
+extern const char    *webserver_tag;                  /**< Tag for logging */
+extern const uint32_t webserver_timeout_ms;           /**< Network timeout for a single HTTP request in milliseconds */
+extern const uint32_t webserver_session_lock_ticks;   /**< Maximum time a caller waits for the shared HTTP session */
+extern const uint32_t webserver_queue_length;         /**< Maximum number of frames waiting in the uplink queue */
+extern const uint32_t webserver_batch_max_readings;   /**< Number of queued frames that triggers a batch flush */
+extern const uint32_t webserver_flush_interval_ticks; /**< Maximum time a frame waits in a batch before it is flushed */
+extern const uint32_t webserver_alert_queue_length;   /**< Maximum number of alerts waiting to be sent */
+extern const uint8_t  webserver_alert_attempts;       /**< Number of times an alert upload is attempted before it is dropped */
+
+/* Macros *********************************************************************/
+
+#define WEBSERVER_MAX_FRAME_LENGTH     (64)   /**< Maximum length of one queued binary sensor frame. */
+#define WEBSERVER_BATCH_BUFFER_SIZE    (1024) /**< Size of the buffer holding one batch of concatenated frames. */
+#define WEBSERVER_RESPONSE_BUFFER_SIZE (512)  /**< Size of the buffer holding a response body (sensor settings). */
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief Counters describing the usage of the persistent uplink session.
+ *
+ * Lets callers compare the number of requests against the number of TCP
+ * connections actually opened. With keep-alive working, `connects` should
+ * stay close to `sessions` while `requests` keeps growing.
+ */
+typedef struct {
+  uint32_t requests; /**< Number of POST requests that completed successfully. */
+  uint32_t uploaded; /**< Number of frames the server accepted, alerts and outbox replays included. */
+  uint32_t failures; /**< Number of POST requests that failed after the reconnect attempt or got no 2xx status. */
+  uint32_t connects; /**< Number of TCP connections opened to the web server. */
+  uint32_t sessions; /**< Number of HTTP client sessions created (handle (re)initializations). */
+  uint32_t queued;   /**< Number of frames accepted into the uplink queue. */
+  uint32_t dropped;  /**< Number of frames dropped (queue full, rejected by the server, or upload failed and the outbox was full). */
+  uint32_t deferred; /**< Number of frames handed to the SD card outbox after a failed upload. */
+  uint32_t batches;  /**< Number of batched payloads uploaded successfully. */
+  uint32_t alerts;   /**< Number of alerts uploaded successfully. */
+  uint32_t rejected; /**< Number of frames the server refused with a 4xx status, included in `dropped`. */
+} webserver_stats_t;
+
+/**
+ * @brief A single frame waiting in the uplink queue.
+ *
+ * Holds a copy of the binary frame encoded by a sensor task (see
+ * `sensor_frame.h`), so the task can reuse its own buffer right away.
+ */
+typedef struct {
+  uint8_t length;                           /**< Number of valid bytes in `data`. */
+  uint8_t data[WEBSERVER_MAX_FRAME_LENGTH]; /**< Encoded sensor frame. */
+} webserver_frame_t;
+
 /* Public Functions ***********************************************************/
 
 /**
- * @brief Sends a JSON string containing sensor data to the web server.
+ * @brief Initializes the shared HTTP uplink session and the batching uplink task.
+ *
+ * Creates the mutex guarding the persistent HTTP client, the bounded uplink
+ * and alert queues, and the task that drains them. The HTTP client itself is created
+ * lazily on the first send and kept open afterwards, so that consecutive
+ * requests reuse the same TCP connection (HTTP keep-alive) and the same
+ * client buffers.
+ *
+ * @return
+ * - ESP_OK         on success.
+ * - ESP_ERR_NO_MEM if the mutex or the queues could not be created.
+ * - ESP_FAIL       if the uplink task could not be started.
+ *
+ * @note Call this once during system initialization, before any sensor task
+ *       calls `webserver_enqueue_frame`.
+ */
+esp_err_t webserver_tasks_init(void);
+
+/**
+ * @brief Queues a binary sensor frame for batched upload to the web server.
+ *
+ * Copies the frame into the bounded uplink queue and returns immediately.
+ * The uplink task concatenates queued frames from all sensor tasks and POSTs
+ * them as one `application/octet-stream` body when
+ * `webserver_batch_max_readings` frames are pending, when the batch buffer is
+ * full, or when the oldest frame has waited `webserver_flush_interval_ticks`.
+ * A batch that cannot be uploaded is stored in the SD card outbox and
+ * replayed later (see `outbox_manager.h`).
+ *
+ * @param[in] frame     Frame produced by `sensor_frame_encode`.
+ * @param[in] frame_len Length of the frame in bytes. Must not exceed
+ *                      `WEBSERVER_MAX_FRAME_LENGTH`.
+ *
+ * @return
+ * - ESP_OK                if the frame was queued.
+ * - ESP_ERR_INVALID_ARG   if `frame` is NULL.
+ * - ESP_ERR_INVALID_SIZE  if the frame is empty or does not fit in a queue item.
+ * - ESP_ERR_INVALID_STATE if `webserver_tasks_init` has not been called.
+ * - ESP_FAIL              if the queue is full; the frame is dropped.
+ *
+ * @note Never blocks on the network, so it is safe to call from sensor loops.
+ */
+esp_err_t webserver_enqueue_frame(const uint8_t *frame, size_t frame_len);
+
+/**
+ * @brief Queues an alert frame for immediate upload.
+ *
+ * Alerts bypass batching: the uplink task wakes as soon as an alert is
+ * queued and sends it on its own, ahead of any readings waiting in the
+ * current batch. A failed upload is retried up to `webserver_alert_attempts`
+ * times.
+ *
+ * @param[in] frame     Alert frame produced by `sensor_frame_encode`.
+ * @param[in] frame_len Length of the frame in bytes. Must not exceed
+ *                      `WEBSERVER_MAX_FRAME_LENGTH`.
+ *
+ * @return
+ * - ESP_OK                if the alert was queued.
+ * - ESP_ERR_INVALID_ARG   if `frame` is NULL.
+ * - ESP_ERR_INVALID_SIZE  if the frame is empty or does not fit in a queue item.
+ * - ESP_ERR_INVALID_STATE if `webserver_tasks_init` has not been called.
+ * - ESP_FAIL              if the alert queue is full.
+ */
+esp_err_t webserver_enqueue_alert(const uint8_t *frame, size_t frame_len);
+
+/**
+ * @brief Uploads concatenated frames right away on the shared session.
+ *
+ * Used by the outbox to replay stored batches. Unlike
+ * `webserver_enqueue_frame`, the call blocks for the whole request, and a
+ * failed upload is only reported, not stored. Only a 2xx response counts
+ * as accepted.
  *
- * Transmits a JSON-formatted string to a pre-configured web server endpoint
- * using HTTP POST. This function handles the underlying network communication
- * and ensures that the data is successfully sent. In case of a failure, the
- * error code provides details about the issue.
+ * @param[in] frames Concatenated frames produced by `sensor_frame_encode`.
+ * @param[in] length Number of bytes in `frames`.
+ * @param[in] count  Number of frames in `frames`, added to `uploaded` on success.
+ *
+ * @return
+ * - ESP_OK                   if the server accepted the frames.
+ * - ESP_ERR_INVALID_ARG      if `frames` is NULL or empty.
+ * - ESP_ERR_INVALID_STATE    if `webserver_tasks_init` has not been called.
+ * - ESP_ERR_TIMEOUT          if another task held the session for too long.
+ * - ESP_ERR_NOT_SUPPORTED    if the server rejected the frames (4xx other
+ *                            than 408 and 429); sending them again will not help.
+ * - ESP_ERR_INVALID_RESPONSE if the server failed to take them (5xx, 408, 429).
+ * - Error code from the HTTP client otherwise.
+ */
+esp_err_t webserver_post_frames(const uint8_t *frames, size_t length, uint32_t count);
+
+/**
+ * @brief Returns the number of frames and alerts waiting in the uplink queues.
  *
- * @param[in] json_string Pointer to the null-terminated JSON string to be sent. 
- *                        The string must be properly formatted and must not 
- *                        exceed the maximum payload size supported by the 
- *                        network library.
+ * Lets background senders such as the outbox hold back while live readings
+ * are waiting.
+ */
+uint32_t webserver_uplink_pending(void);
+
+/**
+ * @brief Retrieves a snapshot of the uplink session counters.
  *
- * @return 
- * - ESP_OK              if the data is sent successfully.
- * - ESP_ERR_INVALID_ARG if `json_string` is NULL or improperly formatted.
- * - ESP_FAIL            if a network or transmission error occurs.
- * - Other error codes as defined by the network stack.
+ * @param[out] stats Pointer to the structure that receives the counters.
  *
- * @note 
- * - Ensure that the device is connected to the network before calling this function.
- * - The function does not perform retries; consider implementing retry logic if needed.
- * - The server endpoint and configuration (e.g., URL, port) must be predefined 
- *   in the application.
+ * @return
+ * - ESP_OK              on success.
+ * - ESP_ERR_INVALID_ARG if `stats` is NULL.
  */
-esp_err_t send_sensor_data_to_webserver(const char *json_string);
+esp_err_t webserver_get_stats(webserver_stats_t *stats);
 
 #ifdef __cplusplus
 }
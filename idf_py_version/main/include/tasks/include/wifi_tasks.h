@@ -12,13 +12,15 @@ extern "C" {
 #include <stdbool.h>
 #include "wifi_credentials.h"
 #include "esp_err.h"
+#include "freertos/FreeRTOS.h"
 
 /* Constants ******************************************************************/
 
 /* The event group allows multiple bits for each event, but we only care about
  * two events:
  * - we are connected to the AP with an IP
- * - we failed to connect after the maximum amount of retries */
+ * - we failed to connect after the maximum amount of retries; the station
+ *   keeps reconnecting in the background and clears it once it has an IP */
 #define WIFI_CONNECTED_BIT (BIT0) /**< Wifi is Connected */
 #define WIFI_FAIL_BIT      (BIT1) /**< Wifi failed to connect */
 
@@ -27,6 +29,8 @@ extern const uint8_t  wifi_max_retry;          /**< The max number of times to t
 extern const uint8_t  wifi_ssid_max_len;       /**< The max length for wifi's SSID defined by esp */
 extern const uint8_t  wifi_pass_max_len;       /**< The max length for wifi's password defined by esp */
 extern const uint32_t wifi_connect_timeout_ms; /**< Timeout for WiFi connection in milliseconds */
+extern const uint32_t wifi_reconnect_min_ms;   /**< First pause between background reconnect attempts */
+extern const uint32_t wifi_reconnect_max_ms;   /**< Longest pause between background reconnect attempts */
 
 /* Public Functions ***********************************************************/
 
@@ -68,20 +72,57 @@ esp_err_t wifi_check_connection(void);
  *   7. Configures the WiFi settings with the specified SSID, password, 
  *      authentication mode, and SAE settings if applicable.
  *   8. Sets the WiFi mode to station (STA) mode.
- *   9. Starts the WiFi driver.
- *   10. Waits for the WiFi connection to be established or logs an error on failure.
+ *   9. Starts the connection timeout timer and the WiFi driver.
+ *
+ * The connection itself completes in the background; use
+ * `wifi_wait_connected` to wait for its outcome. The station never gives
+ * up: once the first attempts fail, and after any later disconnection, it
+ * keeps reconnecting with a pause that doubles from `wifi_reconnect_min_ms`
+ * up to `wifi_reconnect_max_ms`.
  *
  * @return 
- * - ESP_OK   if the WiFi is initialized and connected successfully.
- * - ESP_FAIL if any step in the initialization or connection process fails.
+ * - ESP_OK         if the WiFi driver was started.
+ * - ESP_ERR_NO_MEM if the event group or a timer could not be created.
  *
  * @note 
  * - Ensure the SSID and password are correctly configured before calling this function.
- * - This function blocks until a connection is established or a failure occurs.
  * - Check the logs for detailed information about the connection status and errors.
  */
 esp_err_t wifi_init_sta(void);
 
+/**
+ * @brief Waits for the connection started by `wifi_init_sta` to succeed or fail.
+ *
+ * The connection fails once `wifi_max_retry` attempts or
+ * `wifi_connect_timeout_ms` have run out, so a wait slightly longer than the
+ * timeout always sees the outcome. Attempts continue in the background after
+ * a failure; use `wifi_wait_online` to wait for them.
+ *
+ * @param[in] timeout_ticks Longest time to wait.
+ *
+ * @return 
+ * - ESP_OK                if the station is connected and has an IP address.
+ * - ESP_FAIL              if the connection attempts were given up.
+ * - ESP_ERR_TIMEOUT       if neither happened within `timeout_ticks`.
+ * - ESP_ERR_INVALID_STATE if `wifi_init_sta` has not been called.
+ */
+esp_err_t wifi_wait_connected(TickType_t timeout_ticks);
+
+/**
+ * @brief Waits until the station is connected and has an IP address.
+ *
+ * Unlike `wifi_wait_connected`, a failed first connection does not end the
+ * wait, so tasks needing the network can block here instead of polling.
+ *
+ * @param[in] timeout_ticks Longest time to wait.
+ *
+ * @return 
+ * - ESP_OK                if the station is connected and has an IP address.
+ * - ESP_ERR_TIMEOUT       if it did not connect within `timeout_ticks`.
+ * - ESP_ERR_INVALID_STATE if `wifi_init_sta` has not been called.
+ */
+esp_err_t wifi_wait_online(TickType_t timeout_ticks);
+
 #ifdef __cplusplus
 }
 #endif
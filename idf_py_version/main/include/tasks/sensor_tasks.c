@@ -1,38 +1,180 @@
 /* main/include/tasks/sensor_tasks.c */
 
 #include "sensor_tasks.h"
+#include <inttypes.h>
+#include <string.h>
 #include "system_tasks.h"
+#include "sensor_scheduler.h"
 #include "esp_log.h"
 
 /* Globals (Static) ***********************************************************/
 
 static sensor_config_t s_sensors[] = {
-  { "BH1750",     bh1750_init,     bh1750_tasks,     &(g_sensor_data.bh1750_data),     5, 4096, false }, /* works bh1750 */
-  { "MPU6050",    mpu6050_init,    mpu6050_tasks,    &(g_sensor_data.mpu6050_data),    5, 4096, false }, /* works mpu6050, but needs to be configured */
-  { "DHT22",      dht22_init,      dht22_tasks,      &(g_sensor_data.dht22_data),      5, 4096, false }, /* works dht22 */
-  { "GY-NEO6MV2", gy_neo6mv2_init, gy_neo6mv2_tasks, &(g_sensor_data.gy_neo6mv2_data), 5, 4096, false }, /* doesn't work gy-neo6mv2 */
-  { "CCS811",     ccs811_init,     ccs811_tasks,     &(g_sensor_data.ccs811_data),     5, 4096, true }, /* doesn't work ccs811 */
-  { "MQ135",      mq135_init,      mq135_tasks,      &(g_sensor_data.mq135_data),      5, 4096, false }, /* works mq135 */
+  { "BH1750",     "bh1750",     bh1750_init,     bh1750_tick,     &(g_sensor_data.bh1750_data),     &bh1750_polling_rate_ticks,     NULL,                           pdMS_TO_TICKS(500),  1, false }, /* works bh1750 */
+  { "MPU6050",    "mpu6050",    mpu6050_init,    mpu6050_tick,    &(g_sensor_data.mpu6050_data),    &mpu6050_tick_period_ticks,     &mpu6050_max_tick_period_ticks, pdMS_TO_TICKS(50),   0, false }, /* works mpu6050, but needs to be configured */
+  { "DHT22",      "dht22",      dht22_init,      dht22_tick,      &(g_sensor_data.dht22_data),      &dht22_polling_rate_ticks,      NULL,                           pdMS_TO_TICKS(500),  1, false }, /* works dht22 */
+  { "GY-NEO6MV2", "gy_neo6mv2", gy_neo6mv2_init, gy_neo6mv2_tick, &(g_sensor_data.gy_neo6mv2_data), &gy_neo6mv2_polling_rate_ticks, NULL,                           pdMS_TO_TICKS(1000), 1, false }, /* doesn't work gy-neo6mv2 */
+  { "CCS811",     "ccs811",     ccs811_init,     ccs811_tick,     &(g_sensor_data.ccs811_data),     &ccs811_polling_rate_ticks,     NULL,                           pdMS_TO_TICKS(500),  1, true }, /* doesn't work ccs811 */
+  { "MQ135",      "mq135",      mq135_init,      mq135_tick,      &(g_sensor_data.mq135_data),      &mq135_polling_rate_ticks,      NULL,                           pdMS_TO_TICKS(500),  1, false }, /* works mq135 */
 };
 
+static bool         s_scheduled     = false;                        /**< Set once every sensor is registered with the scheduler */
+static uint8_t      s_config_job_id = 0;                            /**< Scheduler job that applies posted settings */
+static portMUX_TYPE s_settings_lock = portMUX_INITIALIZER_UNLOCKED; /**< Guards `settings`, `pending_settings` and `pending` */
+
+/* Private (Static) Functions *************************************************/
+
+/**
+ * @brief Looks up a sensor by its configuration key.
+ *
+ * @param[in] config_key Sensor key, e.g. "mpu6050".
+ *
+ * @return Pointer to the sensor's entry in `s_sensors`, or NULL if unknown.
+ */
+static sensor_config_t *priv_find_sensor(const char *config_key)
+{
+  for (int i = 0; i < sizeof(s_sensors) / sizeof(sensor_config_t); i++) {
+    if (strcmp(s_sensors[i].config_key, config_key) == 0) {
+      return &s_sensors[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * @brief Runs a sensor's init function and logs the outcome.
+ *
+ * @param[in,out] sensor Sensor to initialize.
+ *
+ * @return Status returned by the sensor's init function.
+ */
+static esp_err_t priv_init_sensor(sensor_config_t *sensor)
+{
+  ESP_LOGI(system_tag, "Initializing sensor: %s", sensor->sensor_name);
+  esp_err_t status    = sensor->init_function(sensor->data_ptr);
+  sensor->initialized = true;
+
+  if (status == ESP_OK) {
+    ESP_LOGI(system_tag, "Sensor %s initialized successfully", sensor->sensor_name);
+  } else {
+    ESP_LOGE(system_tag, "Sensor %s initialization failed with error: %d",
+             sensor->sensor_name, status);
+  }
+  return status;
+}
+
+/**
+ * @brief Lowers a period that exceeds the sensor's own upper bound.
+ *
+ * @param[in]     sensor   Sensor the settings belong to.
+ * @param[in,out] settings Settings whose period is clamped.
+ */
+static void priv_clamp_period(const sensor_config_t *sensor, sensor_settings_t *settings)
+{
+  if (sensor->max_period_ticks == NULL) {
+    return;
+  }
+
+  uint32_t max_period_ms = pdTICKS_TO_MS(*sensor->max_period_ticks);
+  if (settings->period_ms > max_period_ms) {
+    ESP_LOGW(system_tag, "%s period %" PRIu32 " ms exceeds its %" PRIu32 " ms limit, clamped",
+             sensor->sensor_name, settings->period_ms, max_period_ms);
+    settings->period_ms = max_period_ms;
+  }
+}
+
+/**
+ * @brief Applies validated settings to a sensor and persists them.
+ *
+ * Runs on the scheduler's shared worker, so initializing a sensor or writing
+ * NVS never blocks the task that received the settings.
+ *
+ * @param[in,out] sensor   Sensor to reconfigure.
+ * @param[in]     settings New settings, already validated and clamped.
+ */
+static void priv_apply_settings(sensor_config_t *sensor, const sensor_settings_t *settings)
+{
+  if (settings->enabled && !sensor->initialized) {
+    /* A failed init is retried by the sensor's error handler on its next tick */
+    priv_init_sensor(sensor);
+  }
+
+  TickType_t period_ticks = pdMS_TO_TICKS(settings->period_ms);
+  if (period_ticks == 0) {
+    period_ticks = 1;
+  }
+
+  esp_err_t ret = sensor_scheduler_reconfigure(sensor->scheduler_id, period_ticks, settings->enabled);
+  if (ret != ESP_OK) {
+    ESP_LOGE(system_tag, "Failed to reschedule %s: %s", sensor->sensor_name,
+             esp_err_to_name(ret));
+    return;
+  }
+
+  if (settings->worker != sensor->settings.worker) {
+    ESP_LOGI(system_tag, "%s moves to worker %u after the next restart",
+             sensor->sensor_name, settings->worker);
+  }
+  portENTER_CRITICAL(&s_settings_lock);
+  sensor->settings = *settings;
+  portEXIT_CRITICAL(&s_settings_lock);
+
+  ESP_LOGI(system_tag, "Sensor %s reconfigured: period=%" PRIu32 "ms enabled=%d",
+           sensor->sensor_name, settings->period_ms, settings->enabled);
+  ret = sensor_config_store(sensor->config_key, settings);
+  if (ret != ESP_OK) {
+    ESP_LOGW(system_tag, "Failed to store settings for %s: %s", sensor->sensor_name,
+             esp_err_to_name(ret));
+  }
+}
+
+/**
+ * @brief Scheduler job applying the settings posted by `sensor_tasks_configure`.
+ *
+ * The job is enabled by every post and disables itself before it drains the
+ * pending settings, so a post that arrives while it runs schedules it again.
+ *
+ * @param[in] arg Unused.
+ */
+static void priv_config_tick(void *arg)
+{
+  sensor_scheduler_reconfigure(s_config_job_id, 1, false);
+
+  for (int i = 0; i < sizeof(s_sensors) / sizeof(sensor_config_t); i++) {
+    sensor_settings_t settings;
+    bool              pending;
+
+    portENTER_CRITICAL(&s_settings_lock);
+    pending               = s_sensors[i].pending;
+    settings              = s_sensors[i].pending_settings;
+    s_sensors[i].pending  = false;
+    portEXIT_CRITICAL(&s_settings_lock);
+
+    if (pending) {
+      priv_apply_settings(&s_sensors[i], &settings);
+    }
+  }
+}
+
 /* Public Functions ***********************************************************/
 
 esp_err_t sensors_init(sensor_data_t *sensor_data)
 {
-  esp_err_t status         = ESP_OK;
   esp_err_t overall_status = ESP_OK;
 
   for (int i = 0; i < sizeof(s_sensors) / sizeof(sensor_config_t); i++) {
-    if (s_sensors[i].enabled) {
-      ESP_LOGI(system_tag, "Initializing sensor: %s", s_sensors[i].sensor_name);
-      status = s_sensors[i].init_function(s_sensors[i].data_ptr);
-
-      if (status == ESP_OK) {
-        ESP_LOGI(system_tag, "Sensor %s initialized successfully",
-            s_sensors[i].sensor_name);
-      } else {
-        ESP_LOGE(system_tag, "Sensor %s initialization failed with error: %d",
-                 s_sensors[i].sensor_name, status);
+    /* Start from the compile-time defaults and apply what NVS holds */
+    s_sensors[i].settings.period_ms = pdTICKS_TO_MS(*s_sensors[i].period_ticks);
+    s_sensors[i].settings.worker    = s_sensors[i].worker;
+    s_sensors[i].settings.enabled   = s_sensors[i].enabled;
+    sensor_config_load(s_sensors[i].config_key, &s_sensors[i].settings);
+    if (s_sensors[i].settings.worker >= SENSOR_SCHEDULER_WORKERS) {
+      s_sensors[i].settings.worker = s_sensors[i].worker;
+    }
+    priv_clamp_period(&s_sensors[i], &s_sensors[i].settings);
+
+    if (s_sensors[i].settings.enabled) {
+      if (priv_init_sensor(&s_sensors[i]) != ESP_OK) {
         overall_status = ESP_FAIL;
       }
     } else {
@@ -47,22 +189,102 @@ esp_err_t sensor_tasks(sensor_data_t *sensor_data)
 {
   esp_err_t overall_status = ESP_OK;
 
+  /* Disabled sensors are registered too, so the server can enable them later */
   for (int i = 0; i < sizeof(s_sensors) / sizeof(sensor_config_t); i++) {
-    if (s_sensors[i].enabled) {
-      ESP_LOGI(system_tag, "Creating task for sensor: %s", s_sensors[i].sensor_name);
-      BaseType_t ret = xTaskCreate(s_sensors[i].task_function, s_sensors[i].sensor_name,
-                                   s_sensors[i].stack_depth, s_sensors[i].data_ptr, 
-                                   s_sensors[i].priority, NULL);
-      if (ret != pdPASS) {
-        ESP_LOGE(system_tag, "Task creation failed for sensor: %s",
-                 s_sensors[i].sensor_name);
-        overall_status = ESP_FAIL;
-      }
-    } else {
-      ESP_LOGI(system_tag, "Task for sensor %s is disabled", s_sensors[i].sensor_name);
+    ESP_LOGI(system_tag, "Scheduling sensor: %s every %" PRIu32 " ms%s",
+             s_sensors[i].sensor_name, s_sensors[i].settings.period_ms,
+             s_sensors[i].settings.enabled ? "" : " (disabled)");
+    sensor_scheduler_entry_t entry = {
+      .name                = s_sensors[i].sensor_name,
+      .tick_function       = s_sensors[i].tick_function,
+      .data_ptr            = s_sensors[i].data_ptr,
+      .period_ticks        = pdMS_TO_TICKS(s_sensors[i].settings.period_ms),
+      .jitter_budget_ticks = s_sensors[i].jitter_budget_ticks,
+      .worker              = s_sensors[i].settings.worker,
+      .enabled             = s_sensors[i].settings.enabled,
+    };
+    if (entry.period_ticks == 0) {
+      entry.period_ticks = 1;
     }
+    if (sensor_scheduler_add(&entry, &s_sensors[i].scheduler_id) != ESP_OK) {
+      ESP_LOGE(system_tag, "Scheduling failed for sensor: %s",
+               s_sensors[i].sensor_name);
+      overall_status = ESP_FAIL;
+    }
+  }
+
+  /* Enabled from the start so settings posted before the scheduler ran apply */
+  sensor_scheduler_entry_t config_entry = {
+    .name                = "SensorConfig",
+    .tick_function       = priv_config_tick,
+    .data_ptr            = NULL,
+    .period_ticks        = 1,
+    .jitter_budget_ticks = pdMS_TO_TICKS(1000),
+    .worker              = 1,
+    .enabled             = true,
+  };
+  if (sensor_scheduler_add(&config_entry, &s_config_job_id) != ESP_OK) {
+    ESP_LOGE(system_tag, "Scheduling failed for the sensor configuration job");
+    overall_status = ESP_FAIL;
+  }
+  s_scheduled = (overall_status == ESP_OK);
+
+  if (sensor_scheduler_start() != ESP_OK) {
+    overall_status = ESP_FAIL;
+  }
+
+  return overall_status; /* Return ESP_OK only if every sensor is scheduled */
+}
+
+esp_err_t sensor_tasks_get_settings(const char *config_key, sensor_settings_t *settings)
+{
+  if (config_key == NULL || settings == NULL) {
+    return ESP_ERR_INVALID_ARG;
   }
 
-  return overall_status; /* Return ESP_OK only if all tasks start successfully */
+  sensor_config_t *sensor = priv_find_sensor(config_key);
+  if (sensor == NULL) {
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  portENTER_CRITICAL(&s_settings_lock);
+  *settings = sensor->pending ? sensor->pending_settings : sensor->settings;
+  portEXIT_CRITICAL(&s_settings_lock);
+  return ESP_OK;
 }
 
+esp_err_t sensor_tasks_configure(const char *config_key, const sensor_settings_t *settings)
+{
+  if (config_key == NULL || settings == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  sensor_config_t *sensor = priv_find_sensor(config_key);
+  if (sensor == NULL) {
+    ESP_LOGW(system_tag, "Unknown sensor in configuration: %s", config_key);
+    return ESP_ERR_NOT_FOUND;
+  }
+
+  if (settings->period_ms < sensor_config_min_period_ms ||
+      settings->period_ms > sensor_config_max_period_ms ||
+      settings->worker >= SENSOR_SCHEDULER_WORKERS) {
+    ESP_LOGW(system_tag, "Rejected configuration for %s: period=%" PRIu32 "ms worker=%u",
+             sensor->sensor_name, settings->period_ms, settings->worker);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  sensor_settings_t clamped = *settings;
+  priv_clamp_period(sensor, &clamped);
+
+  portENTER_CRITICAL(&s_settings_lock);
+  sensor->pending_settings = clamped;
+  sensor->pending          = true;
+  portEXIT_CRITICAL(&s_settings_lock);
+
+  /* Before `sensor_tasks` the configuration job is not registered yet; it
+   * starts enabled and picks the settings up on its first run */
+  if (s_scheduled) {
+    return sensor_scheduler_reconfigure(s_config_job_id, 1, true);
+  }
+  return ESP_OK;
+}
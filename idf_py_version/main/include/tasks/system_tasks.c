@@ -1,24 +1,55 @@
 /* main/include/tasks/system_tasks.c */
 
 #include "system_tasks.h"
+#include <inttypes.h>
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "common/i2c_bus.h"
 #include "file_write_manager.h"
+#include "log_maintenance_manager.h"
+#include "outbox_manager.h"
 #include "ov7670_hal.h"
 #include "time_manager.h"
+#include "webserver_tasks.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 #include "freertos/task.h"
 #include "nvs_flash.h"
 
 /* Constants ******************************************************************/
 
-const char *system_tag = "SafeHatWorkNet";
+#define SYSTEM_BOOT_STORAGE_BIT (BIT0) /**< The storage stage has finished */
+#define SYSTEM_BOOT_CAMERA_BIT  (BIT1) /**< The camera stage has finished */
+#define SYSTEM_BOOT_NETWORK_BIT (BIT2) /**< The network and time stage has finished */
+
+const char    *system_tag                = "SafeHatWorkNet";
+const uint32_t system_boot_stack_depth   = 4096;
+const uint32_t system_boot_priority      = 3;
+const uint32_t system_storage_wait_ticks = pdMS_TO_TICKS(5 * 1000);
+const uint32_t system_wifi_wait_ticks    = pdMS_TO_TICKS(35 * 1000);
+
+/* Structs ********************************************************************/
+
+/**
+ * @brief A part of the boot that runs in its own task.
+ */
+typedef struct {
+  const char  *name;       /**< Used in the boot log and as the task name. */
+  esp_err_t  (*run)(void);  /**< Brings the part up; may block. */
+  EventBits_t  done_bit;   /**< Set in `s_boot_events` once `run` returns. */
+  esp_err_t    status;     /**< Result of `run`, valid once `done_bit` is set. */
+} system_boot_stage_t;
 
 /* Globals ********************************************************************/
 
 sensor_data_t    g_sensor_data    = {};
 ov7670_data_t    g_camera_data    = {};
 
+/* Globals (Static) ***********************************************************/
+
+static EventGroupHandle_t s_boot_events = NULL; /**< Done bits of the background boot stages */
+
 /* Private (Static) Functions *************************************************/
 
 /**
@@ -44,49 +75,190 @@ static esp_err_t priv_clear_nvs_flash(void)
   return ret;
 }
 
+/**
+ * @brief Boot stage: mounts the SD card and starts the services that use it.
+ *
+ * Sensor logging and the outbox both write to the card, so the sensors wait
+ * for this stage (up to `system_storage_wait_ticks`) before they start.
+ *
+ * @return
+ * - `ESP_OK`   if storage, log maintenance and the outbox are up.
+ * - `ESP_FAIL` if any of them failed.
+ */
+static esp_err_t priv_storage_init(void)
+{
+  esp_err_t ret = ESP_OK;
+  if (file_write_manager_init() != ESP_OK) {
+    ESP_LOGE(system_tag, "Storage initialization failed.");
+    return ESP_FAIL;
+  }
+
+  if (log_maintenance_manager_init() != ESP_OK) {
+    /* Logging still works, but old segments are no longer evicted */
+    ESP_LOGE(system_tag, "Log maintenance initialization failed.");
+    ret = ESP_FAIL;
+  }
+  if (outbox_manager_init() != ESP_OK) {
+    /* Readings the uplink cannot deliver are dropped */
+    ESP_LOGE(system_tag, "Outbox initialization failed.");
+    ret = ESP_FAIL;
+  }
+  return ret;
+}
+
+/**
+ * @brief Boot stage: configures the camera. Nothing else waits for it.
+ *
+ * @return Status of `ov7670_init`.
+ */
+static esp_err_t priv_camera_init(void)
+{
+  esp_err_t ret = ov7670_init(&g_camera_data);
+  if (ret != ESP_OK) {
+    ESP_LOGE(system_tag, "Camera communication initialization failed.");
+  }
+  return ret;
+}
+
+/**
+ * @brief Boot stage: connects to Wi-Fi, then waits for the SNTP sync.
+ *
+ * Can take the whole Wi-Fi timeout plus the SNTP timeout. Readings taken in
+ * the meantime are stamped as unsynced, and the uplink stores what it cannot
+ * send in the outbox, which replays it once the server is reachable. If
+ * Wi-Fi connects later, SNTP starts then and the clock is synchronized in
+ * the background.
+ *
+ * @return
+ * - `ESP_OK`   if Wi-Fi is connected and the time is synchronized.
+ * - `ESP_FAIL` otherwise; the clock runs from the default time until a sync.
+ */
+static esp_err_t priv_network_init(void)
+{
+  esp_err_t ret = wifi_init_sta();
+  if (ret == ESP_OK) {
+    ret = wifi_wait_connected(system_wifi_wait_ticks);
+  }
+  if (ret != ESP_OK) {
+    ESP_LOGE(system_tag, "Wifi failed to connect / initialize.");
+    return ESP_FAIL;
+  }
+
+  if (time_manager_wait_synced(time_manager_sync_timeout_ticks) != ESP_OK) {
+    ESP_LOGE(system_tag, "Time synchronization failed.");
+    ret = ESP_FAIL;
+  }
+  return ret;
+}
+
+/**
+ * @brief Runs a boot stage, logs how long after boot it finished and sets its done bit.
+ *
+ * @param[in,out] stage Stage to run.
+ */
+static void priv_boot_stage_run(system_boot_stage_t *stage)
+{
+  stage->status = stage->run();
+  ESP_LOGI(system_tag, "Boot: %s %s %" PRId64 " ms after boot", stage->name,
+           (stage->status == ESP_OK) ? "ready" : "failed", esp_timer_get_time() / 1000);
+  xEventGroupSetBits(s_boot_events, stage->done_bit);
+}
+
+/**
+ * @brief Task that runs one boot stage and exits.
+ *
+ * @param[in] param Pointer to the `system_boot_stage_t` to run.
+ */
+static void priv_boot_stage_task(void *param)
+{
+  priv_boot_stage_run((system_boot_stage_t *)param);
+  vTaskDelete(NULL);
+}
+
+/**
+ * @brief Starts a boot stage in the background.
+ *
+ * If the task cannot be created, the stage runs on the calling task instead.
+ *
+ * @param[in,out] stage Stage to start.
+ */
+static void priv_boot_stage_start(system_boot_stage_t *stage)
+{
+  if (xTaskCreate(priv_boot_stage_task, stage->name, system_boot_stack_depth, stage,
+                  system_boot_priority, NULL) != pdPASS) {
+    ESP_LOGW(system_tag, "No task for boot stage %s, running it inline.", stage->name);
+    priv_boot_stage_run(stage);
+  }
+}
+
 /* Public Functions ***********************************************************/
 
 esp_err_t system_tasks_init(void)
 {
+  /* Stages that run in the background; static, as their tasks outlive this call */
+  static system_boot_stage_t s_storage_stage = { "boot_storage", priv_storage_init, SYSTEM_BOOT_STORAGE_BIT, ESP_OK };
+  static system_boot_stage_t s_camera_stage  = { "boot_camera",  priv_camera_init,  SYSTEM_BOOT_CAMERA_BIT,  ESP_OK };
+  static system_boot_stage_t s_network_stage = { "boot_network", priv_network_init, SYSTEM_BOOT_NETWORK_BIT, ESP_OK };
+
   esp_err_t ret = ESP_OK;
-  /* Initialize NVS storage */
+  /* Initialize NVS storage; sensor settings and Wi-Fi both read it */
   if (priv_clear_nvs_flash() != ESP_OK) {
-    ESP_LOGE(system_tag, "Failed to initialize NVS: %s", esp_err_to_name(ret));
+    ESP_LOGE(system_tag, "Failed to initialize NVS.");
     ret = ESP_FAIL;
   }
 
-  /* Initialize sensor communication */
-  if (sensors_init(&g_sensor_data) != ESP_OK) {
-    ESP_LOGE(system_tag, "Sensor communication initialization failed.");
+  /* Initialize the shared webserver uplink session. It needs no network
+   * yet, only its queues, which the sensors feed from their first sample */
+  if (webserver_tasks_init() != ESP_OK) {
+    ESP_LOGE(system_tag, "Webserver uplink initialization failed.");
     ret = ESP_FAIL;
   }
 
-  /* Initialize cameras */
-  if (ov7670_init(&g_camera_data) != ESP_OK) {
-    ESP_LOGE(system_tag, "Camera communication initialization failed.");
-    ret = ESP_FAIL;
+  /* The camera and the sensors share I2C bus 0 and initialize concurrently,
+   * so the bus locks have to exist before either starts */
+  if (i2c_bus_create_locks() != ESP_OK) {
+    ESP_LOGE(system_tag, "Failed to create the I2C bus locks.");
+    return ESP_FAIL;
   }
-  
-  /* Initialize WiFi */
-  if (wifi_init_sta() != ESP_OK) {
-    ESP_LOGE(system_tag, "Wifi failed to connect / initialize.");
+
+  /* Sets the fallback time before the first sample, and starts SNTP once
+   * the network stage gets an address */
+  if (time_manager_init() != ESP_OK) {
+    ESP_LOGE(system_tag, "Time initialization failed.");
     ret = ESP_FAIL;
   }
-  
-  /* Initialize time (SNTP) */
-  if (time_manager_init() != ESP_OK) {
-		ESP_LOGE(system_tag ,"Time initialization failed.");
+
+  s_boot_events = xEventGroupCreate();
+  if (s_boot_events == NULL) {
+    ESP_LOGE(system_tag, "Failed to create boot event group.");
+    return ESP_ERR_NO_MEM;
+  }
+
+  /* Storage, camera and network come up alongside the sensors */
+  priv_boot_stage_start(&s_storage_stage);
+  priv_boot_stage_start(&s_network_stage);
+  priv_boot_stage_start(&s_camera_stage);
+
+  /* Initialize sensor communication */
+  if (sensors_init(&g_sensor_data) != ESP_OK) {
+    ESP_LOGE(system_tag, "Sensor communication initialization failed.");
     ret = ESP_FAIL;
   }
-  
-  /* Initialize storage (e.g., SD card or SPIFFS) */
-  if (file_write_manager_init() != ESP_OK) {
-    ESP_LOGE(system_tag, "Storage initialization failed.");
+
+  /* Local logging has to be up before the first sample */
+  EventBits_t bits = xEventGroupWaitBits(s_boot_events, SYSTEM_BOOT_STORAGE_BIT, pdFALSE, pdTRUE,
+                                         system_storage_wait_ticks);
+  if (!(bits & SYSTEM_BOOT_STORAGE_BIT)) {
+    ESP_LOGW(system_tag, "Storage still not ready, starting sensors without it.");
+    ret = ESP_FAIL;
+  } else if (s_storage_stage.status != ESP_OK) {
     ret = ESP_FAIL;
   }
 
+  ESP_LOGI(system_tag, "Boot: sensors ready %" PRId64 " ms after boot, network and time continue "
+           "in the background.", esp_timer_get_time() / 1000);
   if (ret == ESP_OK) {
-    ESP_LOGI(system_tag, "All system components initialized successfully.");
+    ESP_LOGI(system_tag, "All local components initialized successfully.");
   }
   return ret;
 }
@@ -1,57 +1,606 @@
 /* main/include/tasks/webserver_tasks.c */
 
 #include "webserver_tasks.h"
+#include <string.h>
+#include "outbox_manager.h"
 #include "webserver_info.h"
-#include "system_tasks.h"
+#include "sensor_tasks.h"
+#include "wifi_tasks.h"
+#include "cJSON.h"
 #include "esp_http_client.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 
-/* Public Functions ***********************************************************/
+/* Constants ******************************************************************/
+
+const char    *webserver_tag                  = "WEBSERVER";
+const uint32_t webserver_timeout_ms           = 5000;
+const uint32_t webserver_session_lock_ticks   = pdMS_TO_TICKS(10 * 1000);
+const uint32_t webserver_queue_length         = 32;
+const uint32_t webserver_batch_max_readings   = 16;
+const uint32_t webserver_flush_interval_ticks = pdMS_TO_TICKS(2 * 1000);
+const uint32_t webserver_alert_queue_length   = 4;
+const uint8_t  webserver_alert_attempts       = 3;
+
+/* Globals (Static) ***********************************************************/
+
+static esp_http_client_handle_t s_client       = NULL; /**< Persistent HTTP client, kept open between requests */
+static SemaphoreHandle_t        s_client_mutex = NULL; /**< Serializes access to `s_client` */
+static webserver_stats_t        s_stats        = { 0 };
+static portMUX_TYPE             s_stats_lock   = portMUX_INITIALIZER_UNLOCKED; /**< Guards `s_stats`, which sensor tasks update too */
+static QueueHandle_t            s_uplink_queue = NULL; /**< Readings waiting to be batched by the uplink task */
+static QueueHandle_t            s_alert_queue  = NULL; /**< Alerts waiting to be sent ahead of any batch */
+static QueueSetHandle_t         s_uplink_set   = NULL; /**< Wakes the uplink task on either queue */
+static uint8_t                  s_batch_buffer[WEBSERVER_BATCH_BUFFER_SIZE]; /**< Concatenated frames being assembled */
+static char                     s_response_buffer[WEBSERVER_RESPONSE_BUFFER_SIZE]; /**< Body of the last response, used for server commands */
+static size_t                   s_response_len = 0; /**< Number of bytes in `s_response_buffer` */
+
+/* Private (Static) Functions *************************************************/
 
-esp_err_t send_sensor_data_to_webserver(const char *json_string)
+/**
+ * @brief Event handler for the persistent HTTP client.
+ *
+ * Counts the TCP connections opened by the client so that keep-alive reuse
+ * can be verified from `webserver_get_stats`, and collects the response body
+ * into `s_response_buffer`. Bodies longer than the buffer are truncated.
+ *
+ * @param[in] evt HTTP client event.
+ *
+ * @return Always `ESP_OK`.
+ */
+static esp_err_t priv_webserver_event_handler(esp_http_client_event_t *evt)
 {
-  if (json_string == NULL) {
-    ESP_LOGE(system_tag, "JSON string is NULL.");
-    return ESP_ERR_INVALID_ARG;
+  if (evt->event_id == HTTP_EVENT_ON_CONNECTED) {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.connects++;
+    portEXIT_CRITICAL(&s_stats_lock);
+  } else if (evt->event_id == HTTP_EVENT_ON_DATA) {
+    size_t room = sizeof(s_response_buffer) - 1 - s_response_len;
+    size_t len  = ((size_t)evt->data_len < room) ? (size_t)evt->data_len : room;
+    memcpy(&s_response_buffer[s_response_len], evt->data, len);
+    s_response_len += len;
   }
+  return ESP_OK;
+}
 
-  /* Check if the network is ready */
-  if (wifi_check_connection() != ESP_OK) {
-    ESP_LOGE(system_tag, "Network not available. Aborting data send.");
-    return ESP_FAIL;
+/**
+ * @brief Posts the sensor settings the server attached to its response.
+ *
+ * The server answers uploads with a JSON object that may carry a `config`
+ * array, e.g. `{"config": [{"sensor": "mpu6050", "period_ms": 20}]}`. Each
+ * element names a sensor by its configuration key; fields that are left out
+ * keep their current value. Responses without commands are ignored. The
+ * sensor scheduler applies the posted settings, so the client lock is never
+ * held across a sensor init or an NVS write.
+ */
+static void priv_webserver_handle_response(void)
+{
+  if (s_response_len == 0) {
+    return;
+  }
+
+  cJSON *root = cJSON_ParseWithLength(s_response_buffer, s_response_len);
+  if (root == NULL) {
+    return;
+  }
+
+  const cJSON *commands = cJSON_GetObjectItemCaseSensitive(root, "config");
+  const cJSON *command  = NULL;
+  cJSON_ArrayForEach(command, commands) {
+    const cJSON *sensor = cJSON_GetObjectItemCaseSensitive(command, "sensor");
+    if (!cJSON_IsString(sensor)) {
+      continue;
+    }
+
+    sensor_settings_t settings;
+    if (sensor_tasks_get_settings(sensor->valuestring, &settings) != ESP_OK) {
+      ESP_LOGW(webserver_tag, "Server sent settings for unknown sensor %s.", sensor->valuestring);
+      continue;
+    }
+
+    const cJSON *period_ms = cJSON_GetObjectItemCaseSensitive(command, "period_ms");
+    const cJSON *enabled   = cJSON_GetObjectItemCaseSensitive(command, "enabled");
+    const cJSON *worker    = cJSON_GetObjectItemCaseSensitive(command, "worker");
+    if (cJSON_IsNumber(period_ms) && period_ms->valuedouble > 0) {
+      settings.period_ms = (uint32_t)period_ms->valuedouble;
+    }
+    if (cJSON_IsBool(enabled)) {
+      settings.enabled = cJSON_IsTrue(enabled);
+    }
+    if (cJSON_IsNumber(worker) && worker->valueint >= 0) {
+      settings.worker = (uint8_t)worker->valueint;
+    }
+
+    esp_err_t err = sensor_tasks_configure(sensor->valuestring, &settings);
+    if (err != ESP_OK) {
+      ESP_LOGW(webserver_tag, "Could not post settings for %s: %s", sensor->valuestring,
+               esp_err_to_name(err));
+    }
+  }
+
+  cJSON_Delete(root);
+}
+
+/**
+ * @brief Releases the persistent HTTP client.
+ *
+ * Closes the connection and frees the client buffers. The next send creates
+ * a new session. Must be called with `s_client_mutex` held.
+ */
+static void priv_webserver_session_close(void)
+{
+  if (s_client != NULL) {
+    esp_http_client_cleanup(s_client);
+    s_client = NULL;
+  }
+}
+
+/**
+ * @brief Creates the persistent HTTP client if it does not exist yet.
+ *
+ * Configures the client for POST requests with TCP keep-alive. The content
+ * type is set per request by `priv_webserver_post`. Must be called with
+ * `s_client_mutex` held.
+ *
+ * @return
+ * - `ESP_OK`   if the session is ready.
+ * - `ESP_FAIL` if the client could not be created or configured.
+ */
+static esp_err_t priv_webserver_session_open(void)
+{
+  if (s_client != NULL) {
+    return ESP_OK;
   }
 
   esp_http_client_config_t config = {
-    .url    = webserver_url,
-    .method = HTTP_METHOD_POST,
+    .url               = webserver_url,
+    .method            = HTTP_METHOD_POST,
+    .timeout_ms        = webserver_timeout_ms,
+    .keep_alive_enable = true,
+    .event_handler     = priv_webserver_event_handler,
   };
 
-  esp_http_client_handle_t client = esp_http_client_init(&config);
-  if (client == NULL) {
-    ESP_LOGE(system_tag, "Failed to initialize HTTP client.");
+  s_client = esp_http_client_init(&config);
+  if (s_client == NULL) {
+    ESP_LOGE(webserver_tag, "Failed to initialize HTTP client.");
     return ESP_FAIL;
   }
 
-  if (esp_http_client_set_header(client, "Content-Type", "application/json") != ESP_OK) {
-    ESP_LOGE(system_tag, "Failed to set HTTP header.");
-    esp_http_client_cleanup(client);
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.sessions++;
+  portEXIT_CRITICAL(&s_stats_lock);
+  return ESP_OK;
+}
+
+/**
+ * @brief Maps a response status other than 2xx to the error reported to callers.
+ *
+ * A 4xx status means the server will refuse the same body again, except
+ * 408 (Request Timeout) and 429 (Too Many Requests), which pass like any
+ * 5xx.
+ *
+ * @param[in] status HTTP status code of the response.
+ *
+ * @return
+ * - `ESP_ERR_NOT_SUPPORTED`    if the server rejected the body.
+ * - `ESP_ERR_INVALID_RESPONSE` if the request may succeed later.
+ */
+static esp_err_t priv_webserver_status_error(int status)
+{
+  if (status >= 400 && status < 500 && status != 408 && status != 429) {
+    return ESP_ERR_NOT_SUPPORTED;
+  }
+  return ESP_ERR_INVALID_RESPONSE;
+}
+
+/**
+ * @brief Performs a single POST on the persistent session.
+ *
+ * If the request fails (typically because the server dropped the idle
+ * keep-alive connection), the connection is closed and the request is
+ * retried once on a fresh connection. If the retry also fails, the whole
+ * session is released so it is rebuilt on the next call. Only a 2xx
+ * response counts as delivered; sensor settings it carries are applied
+ * before returning. Must be called with `s_client_mutex` held.
+ *
+ * @param[in] body         Request body.
+ * @param[in] body_len     Length of the request body in bytes.
+ * @param[in] content_type Value of the `Content-Type` header.
+ *
+ * @return
+ * - `ESP_OK`                   if the server accepted the body.
+ * - `ESP_ERR_NOT_SUPPORTED`    if the server rejected it (4xx); sending it again will not help.
+ * - `ESP_ERR_INVALID_RESPONSE` if the server failed (5xx, 408, 429 or another status).
+ * - Error code from the HTTP client otherwise.
+ */
+static esp_err_t priv_webserver_post(const char *body, size_t body_len, const char *content_type)
+{
+  esp_err_t err = priv_webserver_session_open();
+  if (err != ESP_OK) {
+    return err;
+  }
+
+  if (esp_http_client_set_header(s_client, "Content-Type", content_type) != ESP_OK) {
+    ESP_LOGE(webserver_tag, "Failed to set HTTP header.");
     return ESP_FAIL;
   }
 
-  if (esp_http_client_set_post_field(client, json_string, strlen(json_string)) != ESP_OK) {
-    ESP_LOGE(system_tag, "Failed to set HTTP POST field.");
-    esp_http_client_cleanup(client);
+  if (esp_http_client_set_post_field(s_client, body, body_len) != ESP_OK) {
+    ESP_LOGE(webserver_tag, "Failed to set HTTP POST field.");
     return ESP_FAIL;
   }
 
-  esp_err_t err = esp_http_client_perform(client);
+  s_response_len = 0;
+  err            = esp_http_client_perform(s_client);
+  if (err != ESP_OK) {
+    ESP_LOGW(webserver_tag, "Request failed (%s), reconnecting.", esp_err_to_name(err));
+    esp_http_client_close(s_client);
+    s_response_len = 0;
+    err            = esp_http_client_perform(s_client);
+  }
+
+  if (err != ESP_OK) {
+    priv_webserver_session_close();
+    return err;
+  }
+
+  int status = esp_http_client_get_status_code(s_client);
+  if (status < 200 || status >= 300) {
+    ESP_LOGW(webserver_tag, "Server answered with status %d.", status);
+    return priv_webserver_status_error(status);
+  }
+
+  priv_webserver_handle_response();
+  return ESP_OK;
+}
+
+/**
+ * @brief Hands frames that could not be uploaded to the SD card outbox.
+ *
+ * The outbox replays them once the server is reachable again. Frames the
+ * outbox cannot take are dropped and counted.
+ *
+ * @param[in] frames Concatenated frames.
+ * @param[in] length Number of bytes in `frames`.
+ * @param[in] count  Number of frames.
+ */
+static void priv_webserver_defer(const uint8_t *frames, size_t length, uint32_t count)
+{
+  if (outbox_store(frames, length, count) == ESP_OK) {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.deferred += count;
+    portEXIT_CRITICAL(&s_stats_lock);
+  } else {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.dropped += count;
+    portEXIT_CRITICAL(&s_stats_lock);
+  }
+}
+
+/**
+ * @brief Counts frames the server rejected as dropped.
+ *
+ * @param[in] count Number of frames.
+ */
+static void priv_webserver_reject(uint32_t count)
+{
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.rejected += count;
+  s_stats.dropped  += count;
+  portEXIT_CRITICAL(&s_stats_lock);
+}
+
+/**
+ * @brief Uploads the batch assembled in `s_batch_buffer`.
+ *
+ * POSTs the concatenated frames over the shared session. A batch that
+ * cannot be delivered goes to the outbox; one the server rejected is
+ * dropped.
+ *
+ * @param[in] batch_len Number of bytes used in `s_batch_buffer`.
+ * @param[in] count     Number of frames in the batch.
+ */
+static void priv_webserver_flush_batch(size_t batch_len, uint32_t count)
+{
+  if (wifi_check_connection() != ESP_OK) {
+    ESP_LOGW(webserver_tag, "Network not available. Storing batch of %lu frames.", count);
+    priv_webserver_defer(s_batch_buffer, batch_len, count);
+    return;
+  }
+
+  if (xSemaphoreTake(s_client_mutex, webserver_session_lock_ticks) != pdTRUE) {
+    ESP_LOGE(webserver_tag, "Timed out waiting for HTTP session. Storing batch.");
+    priv_webserver_defer(s_batch_buffer, batch_len, count);
+    return;
+  }
+
+  esp_err_t err = priv_webserver_post((const char *)s_batch_buffer, batch_len,
+                                      "application/octet-stream");
   if (err == ESP_OK) {
-    ESP_LOGI(system_tag, "Data sent successfully.");
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.requests++;
+    s_stats.batches++;
+    s_stats.uploaded += count;
+    portEXIT_CRITICAL(&s_stats_lock);
+    ESP_LOGI(webserver_tag, "Uploaded batch of %lu frames (%u bytes).", count, batch_len);
   } else {
-    ESP_LOGE(system_tag, "Failed to send data: %s", esp_err_to_name(err));
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.failures++;
+    portEXIT_CRITICAL(&s_stats_lock);
+    ESP_LOGE(webserver_tag, "Failed to upload batch: %s", esp_err_to_name(err));
   }
 
-  esp_http_client_cleanup(client);
+  xSemaphoreGive(s_client_mutex);
+  if (err == ESP_ERR_NOT_SUPPORTED) {
+    priv_webserver_reject(count);
+  } else if (err != ESP_OK) {
+    priv_webserver_defer(s_batch_buffer, batch_len, count);
+  }
+}
+
+/**
+ * @brief Uploads a single alert frame, retrying on failure.
+ *
+ * An alert the server rejected is dropped without further attempts.
+ *
+ * @param[in] frame Alert frame taken from the alert queue.
+ */
+static void priv_webserver_send_alert(const webserver_frame_t *frame)
+{
+  esp_err_t err = ESP_FAIL;
+  for (uint8_t attempt = 0; attempt < webserver_alert_attempts && err != ESP_OK &&
+                            err != ESP_ERR_NOT_SUPPORTED; attempt++) {
+    if (wifi_check_connection() != ESP_OK) {
+      ESP_LOGW(webserver_tag, "Network not available for alert upload.");
+      vTaskDelay(pdMS_TO_TICKS(100));
+      continue;
+    }
+
+    if (xSemaphoreTake(s_client_mutex, webserver_session_lock_ticks) != pdTRUE) {
+      continue;
+    }
+    err = priv_webserver_post((const char *)frame->data, frame->length,
+                              "application/octet-stream");
+    if (err == ESP_OK) {
+      portENTER_CRITICAL(&s_stats_lock);
+      s_stats.requests++;
+      s_stats.alerts++;
+      s_stats.uploaded++;
+      portEXIT_CRITICAL(&s_stats_lock);
+    } else {
+      portENTER_CRITICAL(&s_stats_lock);
+      s_stats.failures++;
+      portEXIT_CRITICAL(&s_stats_lock);
+    }
+    xSemaphoreGive(s_client_mutex);
+  }
+
+  if (err == ESP_ERR_NOT_SUPPORTED) {
+    ESP_LOGE(webserver_tag, "Server rejected alert. Dropping it.");
+    priv_webserver_reject(1);
+  } else if (err != ESP_OK) {
+    ESP_LOGE(webserver_tag, "Failed to upload alert after %u attempts.", webserver_alert_attempts);
+    priv_webserver_defer(frame->data, frame->length, 1);
+  }
+}
+
+/**
+ * @brief Task that coalesces queued frames into batched uploads.
+ *
+ * Appends frames from the uplink queue to `s_batch_buffer` and flushes it
+ * when `webserver_batch_max_readings` frames are pending, when the next frame
+ * would not fit in the buffer, or when the first frame of the batch has
+ * waited `webserver_flush_interval_ticks`. Alerts are sent as soon as they
+ * arrive, without waiting for or disturbing the current batch.
+ *
+ * @param[in] param Pointer to task-specific parameters (unused)
+ *
+ * @note This function is intended to run as a FreeRTOS task.
+ */
+static void priv_webserver_uplink_task(void *param)
+{
+  webserver_frame_t frame;
+  size_t            batch_len      = 0;
+  uint32_t          count          = 0;
+  TickType_t        batch_deadline = 0;
+
+  while (1) {
+    TickType_t wait_ticks = portMAX_DELAY;
+    if (count > 0) {
+      TickType_t now = xTaskGetTickCount();
+      wait_ticks     = (batch_deadline > now) ? (batch_deadline - now) : 0;
+    }
+
+    QueueSetMemberHandle_t ready = xQueueSelectFromSet(s_uplink_set, wait_ticks);
+
+    if (ready == s_alert_queue) {
+      if (xQueueReceive(s_alert_queue, &frame, 0) == pdTRUE) {
+        priv_webserver_send_alert(&frame);
+      }
+      continue;
+    }
+
+    if (ready == s_uplink_queue && xQueueReceive(s_uplink_queue, &frame, 0) == pdTRUE) {
+      /* Flush first if this frame won't fit */
+      if (count > 0 && batch_len + frame.length > sizeof(s_batch_buffer)) {
+        priv_webserver_flush_batch(batch_len, count);
+        count = 0;
+      }
+
+      if (count == 0) {
+        batch_len      = 0;
+        batch_deadline = xTaskGetTickCount() + webserver_flush_interval_ticks;
+      }
+
+      memcpy(&s_batch_buffer[batch_len], frame.data, frame.length);
+      batch_len += frame.length;
+      count++;
+
+      if (count < webserver_batch_max_readings) {
+        continue;
+      }
+    }
+
+    if (count > 0) {
+      priv_webserver_flush_batch(batch_len, count);
+      count = 0;
+    }
+  }
+}
+
+/* Public Functions ***********************************************************/
+
+esp_err_t webserver_tasks_init(void)
+{
+  if (s_client_mutex != NULL) {
+    return ESP_OK;
+  }
+
+  s_client_mutex = xSemaphoreCreateMutex();
+  if (s_client_mutex == NULL) {
+    ESP_LOGE(webserver_tag, "Failed to create HTTP session mutex.");
+    return ESP_ERR_NO_MEM;
+  }
+
+  s_uplink_queue = xQueueCreate(webserver_queue_length, sizeof(webserver_frame_t));
+  s_alert_queue  = xQueueCreate(webserver_alert_queue_length, sizeof(webserver_frame_t));
+  s_uplink_set   = xQueueCreateSet(webserver_queue_length + webserver_alert_queue_length);
+  if (s_uplink_queue == NULL || s_alert_queue == NULL || s_uplink_set == NULL) {
+    ESP_LOGE(webserver_tag, "Failed to create uplink queues.");
+    return ESP_ERR_NO_MEM;
+  }
+  xQueueAddToSet(s_uplink_queue, s_uplink_set);
+  xQueueAddToSet(s_alert_queue, s_uplink_set);
+
+  BaseType_t task_created = xTaskCreate(priv_webserver_uplink_task,
+                                        "priv_webserver_uplink_task",
+                                        4096,
+                                        NULL,
+                                        4,
+                                        NULL);
+  if (task_created != pdPASS) {
+    ESP_LOGE(webserver_tag, "Failed to create uplink task.");
+    return ESP_FAIL;
+  }
+
+  ESP_LOGI(webserver_tag, "Webserver uplink initialized.");
+  return ESP_OK;
+}
+
+esp_err_t webserver_enqueue_frame(const uint8_t *frame, size_t frame_len)
+{
+  if (frame == NULL) {
+    ESP_LOGE(webserver_tag, "Frame is NULL.");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (s_uplink_queue == NULL) {
+    ESP_LOGE(webserver_tag, "Uplink queue is not initialized.");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  webserver_frame_t item;
+  if (frame_len == 0 || frame_len > sizeof(item.data)) {
+    ESP_LOGE(webserver_tag, "Invalid frame length for uplink queue (%u bytes).", frame_len);
+    return ESP_ERR_INVALID_SIZE;
+  }
+  item.length = (uint8_t)frame_len;
+  memcpy(item.data, frame, frame_len);
+
+  if (xQueueSend(s_uplink_queue, &item, 0) != pdTRUE) {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.dropped++;
+    portEXIT_CRITICAL(&s_stats_lock);
+    ESP_LOGW(webserver_tag, "Uplink queue is full. Dropping frame.");
+    return ESP_FAIL;
+  }
+
+  portENTER_CRITICAL(&s_stats_lock);
+  s_stats.queued++;
+  portEXIT_CRITICAL(&s_stats_lock);
+  return ESP_OK;
+}
+
+esp_err_t webserver_enqueue_alert(const uint8_t *frame, size_t frame_len)
+{
+  if (frame == NULL) {
+    ESP_LOGE(webserver_tag, "Alert frame is NULL.");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (s_alert_queue == NULL) {
+    ESP_LOGE(webserver_tag, "Alert queue is not initialized.");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  webserver_frame_t item;
+  if (frame_len == 0 || frame_len > sizeof(item.data)) {
+    ESP_LOGE(webserver_tag, "Invalid alert length (%u bytes).", frame_len);
+    return ESP_ERR_INVALID_SIZE;
+  }
+  item.length = (uint8_t)frame_len;
+  memcpy(item.data, frame, frame_len);
+
+  if (xQueueSend(s_alert_queue, &item, 0) != pdTRUE) {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.dropped++;
+    portEXIT_CRITICAL(&s_stats_lock);
+    ESP_LOGE(webserver_tag, "Alert queue is full. Dropping alert.");
+    return ESP_FAIL;
+  }
+  return ESP_OK;
+}
+
+esp_err_t webserver_post_frames(const uint8_t *frames, size_t length, uint32_t count)
+{
+  if (frames == NULL || length == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (s_client_mutex == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  if (xSemaphoreTake(s_client_mutex, webserver_session_lock_ticks) != pdTRUE) {
+    return ESP_ERR_TIMEOUT;
+  }
+
+  esp_err_t err = priv_webserver_post((const char *)frames, length, "application/octet-stream");
+  if (err == ESP_OK) {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.requests++;
+    s_stats.batches++;
+    s_stats.uploaded += count;
+    portEXIT_CRITICAL(&s_stats_lock);
+  } else {
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.failures++;
+    portEXIT_CRITICAL(&s_stats_lock);
+  }
+
+  xSemaphoreGive(s_client_mutex);
   return err;
 }
 
+uint32_t webserver_uplink_pending(void)
+{
+  if (s_uplink_queue == NULL) {
+    return 0;
+  }
+  return uxQueueMessagesWaiting(s_uplink_queue) + uxQueueMessagesWaiting(s_alert_queue);
+}
+
+esp_err_t webserver_get_stats(webserver_stats_t *stats)
+{
+  if (stats == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  portENTER_CRITICAL(&s_stats_lock);
+  *stats = s_stats;
+  portEXIT_CRITICAL(&s_stats_lock);
+  return ESP_OK;
+}
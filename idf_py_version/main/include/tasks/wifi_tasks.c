@@ -1,6 +1,7 @@
 /* main/include/tasks/wifi_tasks.c */
 
 #include "wifi_tasks.h"
+#include <inttypes.h>
 #include <string.h>
 #include <stdbool.h>
 #include "esp_wifi.h"
@@ -16,38 +17,75 @@ const char    *wifi_tag                = "WiFi";
 const uint8_t  wifi_max_retry          = 10;
 const uint8_t  wifi_ssid_max_len       = 32;
 const uint8_t  wifi_pass_max_len       = 32;
-const uint32_t wifi_connect_timeout_ms = 30;
+const uint32_t wifi_connect_timeout_ms = 30 * 1000;
+const uint32_t wifi_reconnect_min_ms   = 1 * 1000;
+const uint32_t wifi_reconnect_max_ms   = 60 * 1000;
 
 /* Globals (Static) ***********************************************************/
 
 /* This is a global event handler used for event event management and
  * synchronization between tasks. An event group is a collection of event bits
  * (flags) that tasks can set, clear, or wait on */
-static EventGroupHandle_t s_wifi_event_group   = NULL;
-static TimerHandle_t      s_wifi_connect_timer = NULL;
+static EventGroupHandle_t s_wifi_event_group     = NULL;
+static TimerHandle_t      s_wifi_connect_timer   = NULL;
+static TimerHandle_t      s_wifi_reconnect_timer = NULL;
+static uint32_t           s_reconnect_delay_ms   = 0; /**< Pause before the next background attempt */
 
 /* Private (Static) Functions *************************************************/
 
 /**
  * @brief Timer callback for handling WiFi connection timeout.
  *
- * Stops the WiFi connection process if the timer expires.
+ * Reports the failure to `wifi_wait_connected`. The driver keeps running,
+ * so the attempts started by the event handler carry on in the background.
  *
  * @param[in] xTimer Timer handle (unused in this implementation).
  */
 static void priv_wifi_connect_timeout_cb(TimerHandle_t xTimer)
 {
-  ESP_LOGW(wifi_tag, "WiFi connection timeout reached. Stopping connection attempts.");
-  esp_wifi_stop();
+  ESP_LOGW(wifi_tag, "WiFi connection timeout reached. Retrying in the background.");
   xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT); /* Signal connection failure */
 }
 
+/**
+ * @brief Schedules the next background connection attempt.
+ *
+ * The pause starts at `wifi_reconnect_min_ms` and doubles with every
+ * attempt up to `wifi_reconnect_max_ms`, so an absent AP costs little.
+ */
+static void priv_wifi_schedule_reconnect(void)
+{
+  if (s_reconnect_delay_ms < wifi_reconnect_min_ms) {
+    s_reconnect_delay_ms = wifi_reconnect_min_ms;
+  }
+  ESP_LOGI(wifi_tag, "Reconnecting in %" PRIu32 " ms.", s_reconnect_delay_ms);
+  xTimerChangePeriod(s_wifi_reconnect_timer, pdMS_TO_TICKS(s_reconnect_delay_ms), 0);
+  s_reconnect_delay_ms = (s_reconnect_delay_ms < wifi_reconnect_max_ms / 2) ? 2 * s_reconnect_delay_ms
+                                                                             : wifi_reconnect_max_ms;
+}
+
+/**
+ * @brief Timer callback starting a background connection attempt.
+ *
+ * A failed attempt ends in another `WIFI_EVENT_STA_DISCONNECTED`, which
+ * schedules the next one.
+ *
+ * @param[in] xTimer Timer handle (unused in this implementation).
+ */
+static void priv_wifi_reconnect_cb(TimerHandle_t xTimer)
+{
+  if (esp_wifi_connect() != ESP_OK) {
+    priv_wifi_schedule_reconnect();
+  }
+}
+
 /**
  * @brief Handles Wi-Fi and IP events for connection management.
  *
  * Responds to Wi-Fi and IP-related events, managing actions such as connecting 
  * to an access point, retrying on disconnection, and handling IP acquisition. 
- * Ensures connection retries are limited and logs status updates.
+ * After `wifi_max_retry` immediate retries, the failure is signalled and the
+ * station keeps reconnecting in the background with a growing pause.
  *
  * @param[in] arg         Pointer to user-defined data passed during event registration.
  * @param[in] event_base  Event base (e.g., `WIFI_EVENT`, `IP_EVENT`) that triggered the handler.
@@ -68,13 +106,18 @@ static void priv_event_handler(void *arg, esp_event_base_t event_base,
       esp_wifi_connect();
       ESP_LOGI(wifi_tag, "Trying to connect to the AP");
     } else if (event_id == WIFI_EVENT_STA_DISCONNECTED) {
+      xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
       if (s_retry_num < wifi_max_retry) {
         esp_wifi_connect();
         s_retry_num++;
         ESP_LOGI(wifi_tag, "Retry to connect to the AP");
       } else {
-        ESP_LOGI(wifi_tag, "Maximum retries reached. Giving up.");
+        if (s_retry_num == wifi_max_retry) {
+          ESP_LOGI(wifi_tag, "Maximum retries reached. Retrying in the background.");
+          s_retry_num++;
+        }
         xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
+        priv_wifi_schedule_reconnect();
       }
     }
   }
@@ -82,8 +125,11 @@ static void priv_event_handler(void *arg, esp_event_base_t event_base,
   if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
     ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
     ESP_LOGI(wifi_tag, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
-    s_retry_num = 0;
+    s_retry_num          = 0;
+    s_reconnect_delay_ms = wifi_reconnect_min_ms;
     xTimerStop(s_wifi_connect_timer, 0); /* Stop the timer as connection succeeded */
+    xTimerStop(s_wifi_reconnect_timer, 0);
+    xEventGroupClearBits(s_wifi_event_group, WIFI_FAIL_BIT);
     xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
   }
 }
@@ -127,14 +173,7 @@ esp_err_t wifi_init_sta(void)
   esp_event_handler_instance_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &priv_event_handler, NULL, NULL);
   esp_event_handler_instance_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &priv_event_handler, NULL, NULL);
 
-  wifi_config_t wifi_config = {};
-  strncpy((char *)wifi_config.sta.ssid, wifi_ssid, wifi_ssid_max_len - 1);
-  strncpy((char *)wifi_config.sta.password, wifi_pass, wifi_pass_max_len - 1);
-  esp_wifi_set_mode(WIFI_MODE_STA);
-  esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
-  esp_wifi_start();
-
-  ESP_LOGI(wifi_tag, "Starting connection timeout timer.");
+  /* Created before the driver starts, so the IP event always finds it */
   s_wifi_connect_timer = xTimerCreate("WiFiConnectTimer",
                                       pdMS_TO_TICKS(wifi_connect_timeout_ms),
                                       pdFALSE,
@@ -144,11 +183,38 @@ esp_err_t wifi_init_sta(void)
     ESP_LOGE(wifi_tag, "Failed to create connection timeout timer.");
     return ESP_ERR_NO_MEM;
   }
+  s_wifi_reconnect_timer = xTimerCreate("WiFiReconnectTimer",
+                                        pdMS_TO_TICKS(wifi_reconnect_min_ms),
+                                        pdFALSE,
+                                        NULL,
+                                        priv_wifi_reconnect_cb);
+  if (!s_wifi_reconnect_timer) {
+    ESP_LOGE(wifi_tag, "Failed to create reconnect timer.");
+    return ESP_ERR_NO_MEM;
+  }
+
+  wifi_config_t wifi_config = {};
+  strncpy((char *)wifi_config.sta.ssid, wifi_ssid, wifi_ssid_max_len - 1);
+  strncpy((char *)wifi_config.sta.password, wifi_pass, wifi_pass_max_len - 1);
+  esp_wifi_set_mode(WIFI_MODE_STA);
+  esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+
+  ESP_LOGI(wifi_tag, "Starting connection timeout timer.");
   xTimerStart(s_wifi_connect_timer, 0);
+  esp_wifi_start();
+  return ESP_OK;
+}
+
+esp_err_t wifi_wait_connected(TickType_t timeout_ticks)
+{
+  if (!s_wifi_event_group) {
+    ESP_LOGE(wifi_tag, "WiFi is not initialized.");
+    return ESP_ERR_INVALID_STATE;
+  }
 
   EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
                                          WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
-                                         pdFALSE, pdFALSE, portMAX_DELAY);
+                                         pdFALSE, pdFALSE, timeout_ticks);
 
   if (bits & WIFI_CONNECTED_BIT) {
     ESP_LOGI(wifi_tag, "Successfully connected to AP.");
@@ -157,7 +223,19 @@ esp_err_t wifi_init_sta(void)
     ESP_LOGW(wifi_tag, "Failed to connect to AP within timeout.");
     return ESP_FAIL;
   } else {
-    ESP_LOGE(wifi_tag, "Unexpected event occurred.");
-    return ESP_FAIL;
+    ESP_LOGW(wifi_tag, "Still not connected after waiting %" PRIu32 " ms.",
+             (uint32_t)pdTICKS_TO_MS(timeout_ticks));
+    return ESP_ERR_TIMEOUT;
   }
 }
+
+esp_err_t wifi_wait_online(TickType_t timeout_ticks)
+{
+  if (!s_wifi_event_group) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT,
+                                         pdFALSE, pdFALSE, timeout_ticks);
+  return (bits & WIFI_CONNECTED_BIT) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
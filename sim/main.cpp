@@ -0,0 +1,143 @@
+// Scenario runner for the mesh simulator.
+//
+//   meshsim [key=value ...]
+//
+// Every Config field can be set by name, e.g. nodes=100 loss=0.02.
+// A comma-separated nodes list runs one scenario per count, each in its own
+// process, and prints one row per scenario.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "sim.h"
+
+namespace {
+
+bool parse(sim::Config &config, std::vector<int> &counts, bool &csv, const char *arg) {
+    const char *eq = strchr(arg, '=');
+    if (eq == nullptr) {
+        return false;
+    }
+    std::string key(arg, eq - arg);
+    const char *value = eq + 1;
+    if (key == "nodes") {
+        for (const char *p = value; *p != '\0'; p = strchr(p, ',') ? strchr(p, ',') + 1 : p + strlen(p)) {
+            counts.push_back(atoi(p));
+        }
+        return true;
+    }
+    struct {
+        const char *name;
+        double *field;
+    } doubles[] = {
+        {"duration", &config.durationS},       {"warmup", &config.warmupS},
+        {"area", &config.areaM},               {"range", &config.meshRangeM},
+        {"hop_latency", &config.hopLatencyMs}, {"hop_jitter", &config.hopJitterMs},
+        {"loss", &config.loss},                {"rssi_noise", &config.rssiNoiseDb},
+        {"pi_x", &config.piX},                 {"pi_y", &config.piY},
+        {"pi_range", &config.piRangeDbm},      {"server_ms", &config.serverMsPerRequest},
+        {"server_ms_per_reading", &config.serverMsPerReading},
+        {"alert_every", &config.alertIntervalS},
+        {"clock_skew", &config.clockSkewS},    {"sync_error", &config.timeSyncErrorMs},
+    };
+    for (auto &entry : doubles) {
+        if (key == entry.name) {
+            *entry.field = atof(value);
+            return true;
+        }
+    }
+    if (key == "seed") {
+        config.seed = strtoull(value, nullptr, 0);
+    } else if (key == "verbose") {
+        config.verbose = atoi(value) != 0;
+    } else if (key == "csv") {
+        csv = atoi(value) != 0;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void print(const sim::Report &r, bool csv) {
+    uint64_t busiest = 0;
+    for (auto &entry : r.bridgeReadings) {
+        busiest = std::max(busiest, entry.second);
+    }
+    double rate = r.sent ? 100.0 * r.delivered / r.sent : 0;
+    double airtime = r.scoredS > 0 ? r.hopTransmissions / r.scoredS : 0;
+    double nodeSeconds = std::max(r.scoredS * r.nodes, 1.0);
+    if (csv) {
+        printf("%d,%d,%.1f,%d,%d,%llu,%llu,%.2f,%llu,%.1f,%.1f,%.1f,%llu,%llu,%.1f,%.1f,%.1f,%llu,%.1f,%.1f,%.1f,%.1f,%.1f,%zu,%.2f,%.1f,%.0f,%.1f\n",
+               r.nodes, r.meshNodes,
+               r.convergenceS, r.bridgeChanges, r.finalBridges, (unsigned long long)r.sent,
+               (unsigned long long)r.delivered, rate, (unsigned long long)r.duplicates, r.latencyMeanMs,
+               r.latencyP50Ms, r.latencyP99Ms, (unsigned long long)r.alertsSent,
+               (unsigned long long)r.alertsDelivered, r.alertLatencyMeanMs, r.alertLatencyP99Ms,
+               r.alertLatencyMaxMs, (unsigned long long)r.stamped, r.stampErrorMeanMs, r.stampErrorP99Ms,
+               r.stampErrorMaxMs, airtime, r.hopBytes / std::max(r.scoredS, 1.0),
+               r.bridgeReadings.size(), busiest / std::max(r.scoredS, 1.0), r.allocations / nodeSeconds,
+               r.allocatedBytes / nodeSeconds, r.loopMaxMs);
+        return;
+    }
+    printf("%5d %5d %9.1f %7d %7d %8llu %7.2f%% %6llu %8.1f %8.1f %8.1f %6llu %9.1f %9.1f %9.1f %7zu %9.2f %8.1f %8.1f\n",
+           r.nodes, r.meshNodes, r.convergenceS, r.bridgeChanges, r.finalBridges, (unsigned long long)r.sent, rate,
+           (unsigned long long)r.duplicates, r.latencyMeanMs, r.latencyP50Ms, r.latencyP99Ms,
+           (unsigned long long)r.alertsSent, r.alertLatencyP99Ms, r.stampErrorP99Ms, airtime,
+           r.bridgeReadings.size(), busiest / std::max(r.scoredS, 1.0), r.allocations / nodeSeconds,
+           r.loopMaxMs);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    sim::Config config;
+    std::vector<int> counts;
+    bool csv = false;
+    std::string library = std::string(argv[0]);
+    library = library.substr(0, library.find_last_of('/') + 1) + "libmeshnode.so";
+
+    for (int i = 1; i < argc; i++) {
+        if (!parse(config, counts, csv, argv[i])) {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (counts.empty()) {
+        counts.push_back(config.nodes);
+    }
+
+    if (csv) {
+        printf("nodes,mesh_nodes,convergence_s,bridge_changes,bridges,sent,delivered,delivery_pct,duplicates,"
+               "latency_mean_ms,latency_p50_ms,latency_p99_ms,alerts_sent,alerts_delivered,alert_latency_mean_ms,"
+               "alert_latency_p99_ms,alert_latency_max_ms,stamped,stamp_error_mean_ms,stamp_error_p99_ms,"
+               "stamp_error_max_ms,hop_tx_per_s,hop_bytes_per_s,active_bridges,"
+               "busiest_bridge_per_s,allocs_per_node_s,alloc_bytes_per_node_s,loop_max_ms\n");
+    } else {
+        printf("nodes  mesh converged changes bridges     sent delivered   dups  lat avg  lat p50  lat p99 "
+               "alerts alert p99 stamp p99  hop tx/s bridges busiest/s allocs/s loop max\n");
+    }
+    fflush(stdout);
+
+    // One process per scenario: the simulator's state and the node
+    // libraries are loaded once and never torn down
+    for (int count : counts) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            config.nodes = count;
+            print(sim::run(config, library), csv);
+            fflush(stdout);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "Scenario with %d nodes failed\n", count);
+            return 1;
+        }
+    }
+    return 0;
+}
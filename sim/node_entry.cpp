@@ -0,0 +1,21 @@
+// Entry points of one simulated node. Built into the node library together
+// with the firmware's main.cpp, so setup() and loop() are the real ones.
+
+#include "MeshNode.h"
+
+void setup();
+void loop();
+extern MeshNode meshNode;
+
+extern "C" void sim_setup() {
+    setup();
+}
+
+extern "C" void sim_loop() {
+    loop();
+}
+
+// Stands in for the helmet's fall detection
+extern "C" void sim_alert() {
+    meshNode.sendAlert("fall detected");
+}
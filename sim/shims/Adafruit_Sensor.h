@@ -0,0 +1,3 @@
+#pragma once
+
+// Not needed by the mesh logic; present so the firmware headers compile.
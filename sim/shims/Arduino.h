@@ -0,0 +1,156 @@
+#pragma once
+
+// Host stand-in for the parts of the ESP32 Arduino core the mesh firmware
+// uses. Time, tasks and queues are provided by the simulator (see sim.h);
+// String is a small std::string-backed copy of Arduino's.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+
+#define HEX 16
+#define DEC 10
+#define LOW 0x0
+#define HIGH 0x1
+#define OUTPUT 0x03
+
+#ifndef UINT8_MAX
+#define UINT8_MAX 255
+#endif
+
+class String {
+public:
+    String() {}
+    String(const char *s) : s_(s ? s : "") {}
+    String(const std::string &s) : s_(s) {}
+    String(char c) : s_(1, c) {}
+    template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+    explicit String(T value, unsigned char base = DEC) {
+        char buf[72];
+        if (std::is_signed<T>::value && base == DEC) {
+            snprintf(buf, sizeof(buf), "%lld", (long long)value);
+        } else if (base == HEX) {
+            snprintf(buf, sizeof(buf), "%llx", (unsigned long long)value);
+        } else {
+            snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
+        }
+        s_ = buf;
+    }
+    explicit String(double value, unsigned char decimals = 2) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        s_ = buf;
+    }
+
+    const char *c_str() const { return s_.c_str(); }
+    unsigned int length() const { return (unsigned int)s_.length(); }
+    bool reserve(unsigned int size) { s_.reserve(size); return true; }
+    char operator[](unsigned int index) const { return index < s_.length() ? s_[index] : 0; }
+
+    String &operator+=(const String &rhs) { s_ += rhs.s_; return *this; }
+    String &operator+=(const char *rhs) { s_ += rhs; return *this; }
+    String &operator+=(char rhs) { s_ += rhs; return *this; }
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value, int>::type = 0>
+    String &operator+=(T rhs) { return *this += String(rhs); }
+    bool concat(const String &rhs) { s_ += rhs.s_; return true; }
+
+    bool operator==(const String &rhs) const { return s_ == rhs.s_; }
+    bool operator==(const char *rhs) const { return s_ == rhs; }
+    bool operator!=(const String &rhs) const { return s_ != rhs.s_; }
+    bool operator<(const String &rhs) const { return s_ < rhs.s_; }
+
+    bool startsWith(const String &prefix) const { return s_.compare(0, prefix.s_.length(), prefix.s_) == 0; }
+    bool endsWith(const String &suffix) const {
+        return s_.length() >= suffix.s_.length() &&
+               s_.compare(s_.length() - suffix.s_.length(), suffix.s_.length(), suffix.s_) == 0;
+    }
+    int indexOf(char c, unsigned int from = 0) const { return pos(s_.find(c, from)); }
+    int indexOf(const String &str, unsigned int from = 0) const { return pos(s_.find(str.s_, from)); }
+    int lastIndexOf(char c) const { return pos(s_.rfind(c)); }
+    int lastIndexOf(const String &str) const { return pos(s_.rfind(str.s_)); }
+    String substring(unsigned int from) const { return from < s_.length() ? String(s_.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from > to) {
+            unsigned int t = from;
+            from = to;
+            to = t;
+        }
+        if (from >= s_.length()) {
+            return String();
+        }
+        return String(s_.substr(from, to - from));
+    }
+    long toInt() const { return atol(s_.c_str()); }
+
+    const std::string &str() const { return s_; }
+
+private:
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    std::string s_;
+};
+
+inline String operator+(const String &lhs, const String &rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String &lhs, const char *rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const char *lhs, const String &rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String &lhs, char rhs) { String r(lhs); r += rhs; return r; }
+template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value, int>::type = 0>
+inline String operator+(const String &lhs, T rhs) { String r(lhs); r += String(rhs); return r; }
+
+/* Time, provided by the simulator's virtual clock */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void yield();
+
+/* GPIO: the LED is the only pin the mesh firmware drives */
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) {}
+    int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    void println(const String &line) { printf("%s\n", line.c_str()); }
+    size_t write(const uint8_t *buffer, size_t size);
+};
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+    uint64_t getEfuseMac();
+};
+extern EspClass ESP;
+
+/* FreeRTOS, run as coroutines on the virtual clock */
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef struct SimQueue *QueueHandle_t;
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+// Nodes run one coroutine at a time, so critical sections have nothing to lock
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+TickType_t xTaskGetTickCount();
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
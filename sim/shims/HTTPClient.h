@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define HTTP_CODE_OK 200
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+// Requests go to the simulated Pi server. They block the calling task for
+// the simulated round trip, like the real client.
+class HTTPClient {
+public:
+    ~HTTPClient() { end(); }
+    bool begin(const String &url);
+    bool begin(WiFiClient &client, const String &url);
+    void setReuse(bool reuse) { this->reuse = reuse; }
+    void addHeader(const String &name, const String &value) {}
+    int GET();
+    int POST(const String &body);
+    int POST(uint8_t *payload, size_t size);
+    String getString() { return response; }
+    void end();
+    static String errorToString(int error);
+
+private:
+    int request(const char *method, const char *body, size_t size);
+
+    WiFiClient ownClient;
+    WiFiClient *client = nullptr;
+    bool reuse = false;
+    String response;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Arduino.h"
+
+typedef enum {
+    WIFI_OFF,
+    WIFI_STA,
+    WIFI_AP,
+    WIFI_AP_STA,
+} wifi_mode_t;
+
+typedef enum {
+    WIFI_AUTH_OPEN,
+    WIFI_AUTH_WPA2_PSK,
+} wifi_auth_mode_t;
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_CONNECTED = 3,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+class IPAddress {
+public:
+    IPAddress(uint32_t address = 0) : address(address) {}
+    uint8_t operator[](int index) const { return (address >> (8 * index)) & 0xff; }
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", address & 0xff, (address >> 8) & 0xff,
+                 (address >> 16) & 0xff, address >> 24);
+        return String(buf);
+    }
+
+private:
+    uint32_t address;
+};
+
+// Station link of the current node to the Pi's access point. Whether it
+// associates, and the RSSI it reports, follow the node's distance to the Pi.
+class WiFiClass {
+public:
+    bool mode(wifi_mode_t mode);
+    bool disconnect();
+    wl_status_t begin(const char *ssid, const char *password);
+    wl_status_t status();
+    int8_t RSSI();
+    int32_t channel();
+    IPAddress localIP();
+};
+extern WiFiClass WiFi;
+
+// TCP connection to the server; kept open between requests when reused
+class WiFiClient {
+public:
+    bool connected() const { return open; }
+    void stop() { open = false; }
+
+private:
+    friend class HTTPClient;
+    bool open = false;
+};
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef enum {
+    ESP_MAC_WIFI_STA,
+} esp_mac_type_t;
+
+// Each simulated node gets its own MAC, which also gives it its mesh node id
+int esp_read_mac(uint8_t *mac, esp_mac_type_t type);
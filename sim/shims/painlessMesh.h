@@ -0,0 +1,87 @@
+#pragma once
+
+#include <functional>
+#include <list>
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define TASK_MILLISECOND 1UL
+#define TASK_SECOND 1000UL
+#define TASK_MINUTE 60000UL
+#define TASK_FOREVER (-1)
+#define TASK_ONCE 1
+
+class Scheduler;
+
+// Cooperative task in the style of TaskScheduler, run by Scheduler::execute
+class Task {
+public:
+    Task(unsigned long interval = 0, long iterations = 0, std::function<void()> callback = nullptr)
+        : interval(interval), iterations(iterations), callback(callback) {}
+    void enable();
+    void disable() { enabled = false; }
+    bool isEnabled() const { return enabled; }
+    void setInterval(unsigned long interval) { this->interval = interval; }
+
+private:
+    friend class Scheduler;
+    unsigned long interval;
+    long iterations;
+    std::function<void()> callback;
+    bool enabled = false;
+    unsigned long nextRunMs = 0;
+    Task *next = nullptr;
+};
+
+class Scheduler {
+public:
+    void addTask(Task &task);
+    bool execute();
+
+private:
+    Task *first = nullptr;
+};
+
+namespace painlessmesh {
+namespace protocol {
+
+struct NodeTree {
+    uint32_t nodeId = 0;
+    bool root = false;
+    std::list<NodeTree> subs;
+};
+
+}  // namespace protocol
+}  // namespace painlessmesh
+
+typedef std::function<void(uint32_t from, String &msg)> receivedCallback_t;
+
+// Mesh membership and message delivery go through the simulator's radio
+// model; the callbacks run from update(), as in painlessMesh.
+class painlessMesh {
+public:
+    void init(String prefix, String password, Scheduler *scheduler, uint16_t port = 5555,
+              wifi_mode_t connectMode = WIFI_AP_STA, wifi_auth_mode_t authMode = WIFI_AUTH_WPA2_PSK,
+              uint8_t channel = 1);
+    void update();
+    void stop();
+
+    void onReceive(receivedCallback_t callback) { receivedCallback = callback; }
+    void onNewConnection(std::function<void(uint32_t)> callback) { newConnectionCallback = callback; }
+    void onChangedConnections(std::function<void()> callback) { changedConnectionsCallback = callback; }
+    void onNodeTimeAdjusted(std::function<void(int32_t)> callback) { nodeTimeAdjustedCallback = callback; }
+
+    bool sendSingle(uint32_t destId, String msg);
+    bool sendBroadcast(String msg, bool includeSelf = false);
+
+    uint32_t getNodeId();
+    std::list<uint32_t> getNodeList(bool includeSelf = false);
+    painlessmesh::protocol::NodeTree asNodeTree();
+    uint32_t getNodeTime();
+
+private:
+    receivedCallback_t receivedCallback;
+    std::function<void(uint32_t)> newConnectionCallback;
+    std::function<void()> changedConnectionsCallback;
+    std::function<void(int32_t)> nodeTimeAdjustedCallback;
+};
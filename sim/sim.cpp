@@ -0,0 +1,1027 @@
+#include "sim.h"
+
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <queue>
+#include <set>
+#include "HTTPClient.h"
+#include "WiFi.h"
+#include "esp_wifi.h"
+#include "painlessMesh.h"
+
+namespace sim {
+
+/* Virtual clock and events ***************************************************/
+
+namespace {
+
+struct Event {
+    uint64_t at;
+    uint64_t seq;
+    std::function<void()> fn;
+    bool operator>(const Event &other) const { return at != other.at ? at > other.at : seq > other.seq; }
+};
+
+std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+uint64_t clockUs = 0;
+uint64_t eventSeq = 0;
+
+void schedule(uint64_t at, std::function<void()> fn) {
+    events.push(Event{std::max(at, clockUs), eventSeq++, std::move(fn)});
+}
+
+/* Coroutines *****************************************************************/
+
+const size_t STACK_SIZE = 128 * 1024;
+const uint64_t FOREVER = UINT64_MAX;
+
+struct Coroutine {
+    ucontext_t context;
+    std::unique_ptr<char[]> stack;
+    Node *node;
+    std::function<void()> body;
+    uint64_t waitToken = 0;
+    bool waiting = false;
+    bool woken = false;
+    int simDepth = 0;  // Nesting of SimScope; kept per coroutine as shims may block
+    uint32_t notifications = 0;
+};
+
+ucontext_t mainContext;
+Coroutine *running = nullptr;
+Node *runningNode = nullptr;
+
+// Marks simulator code running on behalf of a node, so that the heap
+// counter only sees what the firmware itself allocates
+struct SimScope {
+    Coroutine *co = running;
+    SimScope() { co->simDepth++; }
+    ~SimScope() { co->simDepth--; }
+};
+Coroutine *starting = nullptr;
+
+void trampoline() {
+    Coroutine *co = starting;
+    co->body();
+    // Firmware tasks never return; park a finished one for good
+    for (;;) {
+        swapcontext(&co->context, &mainContext);
+    }
+}
+
+void resume(Coroutine *co);
+
+Coroutine *spawn(Node *node, std::function<void()> body, uint64_t at) {
+    Coroutine *co = new Coroutine();
+    co->node = node;
+    co->body = std::move(body);
+    co->stack.reset(new char[STACK_SIZE]);
+    getcontext(&co->context);
+    co->context.uc_stack.ss_sp = co->stack.get();
+    co->context.uc_stack.ss_size = STACK_SIZE;
+    co->context.uc_link = nullptr;
+    makecontext(&co->context, trampoline, 0);
+    schedule(at, [co]() {
+        starting = co;
+        resume(co);
+    });
+    return co;
+}
+
+void resume(Coroutine *co) {
+    running = co;
+    runningNode = co->node;
+    swapcontext(&mainContext, &co->context);
+    running = nullptr;
+    runningNode = nullptr;
+}
+
+void suspend() {
+    swapcontext(&running->context, &mainContext);
+}
+
+// Blocks the running coroutine for a fixed time; wake() does not cut it short
+void sleepUs(uint64_t us) {
+    Coroutine *co = running;
+    schedule(clockUs + us, [co]() { resume(co); });
+    suspend();
+}
+
+// Blocks the running coroutine until wake() or the timeout; true if woken
+bool waitUs(uint64_t timeoutUs) {
+    Coroutine *co = running;
+    uint64_t token = ++co->waitToken;
+    co->waiting = true;
+    co->woken = false;
+    if (timeoutUs != FOREVER) {
+        schedule(clockUs + timeoutUs, [co, token]() {
+            if (co->waiting && co->waitToken == token) {
+                co->waiting = false;
+                resume(co);
+            }
+        });
+    }
+    suspend();
+    return co->woken;
+}
+
+void wake(Coroutine *co) {
+    if (co != nullptr && co->waiting) {
+        co->waiting = false;
+        co->woken = true;
+        schedule(clockUs, [co]() { resume(co); });
+    }
+}
+
+}  // namespace
+
+/* Nodes **********************************************************************/
+
+struct Message {
+    uint32_t from;
+    String payload;
+};
+
+struct Node {
+    int index;
+    uint32_t meshId;
+    uint8_t mac[6];
+    double x, y;
+    void *library = nullptr;
+    void (*setupFn)() = nullptr;
+    void (*loopFn)() = nullptr;
+    void (*alertFn)() = nullptr;
+    Coroutine *loop = nullptr;
+
+    bool wifiConnected = false;
+    bool wifiConnecting = false;
+    bool meshJoined = false;
+    bool connectionsChanged = false;
+    std::deque<Message> inbox;
+    int alertsDue = 0;
+    int64_t clockOffsetUs = 0;  // Node time minus simulated time
+    uint64_t nextTaskMs = 0;
+};
+
+namespace {
+
+Config cfg;
+std::mt19937_64 rng;
+std::vector<Node *> nodes;
+std::map<uint32_t, Node *> nodesById;
+uint64_t endUs = 0;
+
+double uniform(double lo, double hi) {
+    return std::uniform_real_distribution<double>(lo, hi)(rng);
+}
+
+bool chance(double p) {
+    return p > 0 && uniform(0, 1) < p;
+}
+
+bool scoring(uint64_t at) {
+    return at >= (uint64_t)(cfg.warmupS * 1e6) && at < endUs;
+}
+
+/* Mesh radio *****************************************************************/
+
+// Shortest-path tree over the joined nodes, rebuilt when membership changes
+struct Tree {
+    std::vector<int> parent;   // -1 for the root and unreachable nodes
+    std::vector<int> depth;    // -1 if unreachable
+    std::vector<int> order;    // Reachable nodes, root first, by depth
+};
+
+uint64_t topologyVersion = 0;
+std::map<int, std::pair<uint64_t, Tree>> treeCache;
+
+bool linked(const Node *a, const Node *b) {
+    return a->meshJoined && b->meshJoined && hypot(a->x - b->x, a->y - b->y) <= cfg.meshRangeM;
+}
+
+const Tree &treeFrom(const Node *root) {
+    auto &cached = treeCache[root->index];
+    if (cached.first == topologyVersion && !cached.second.order.empty()) {
+        return cached.second;
+    }
+    Tree &tree = cached.second;
+    cached.first = topologyVersion;
+    tree.parent.assign(nodes.size(), -1);
+    tree.depth.assign(nodes.size(), -1);
+    tree.order.clear();
+    tree.depth[root->index] = 0;
+    tree.order.push_back(root->index);
+    for (size_t i = 0; i < tree.order.size(); i++) {
+        Node *node = nodes[tree.order[i]];
+        for (Node *other : nodes) {
+            if (tree.depth[other->index] < 0 && linked(node, other)) {
+                tree.depth[other->index] = tree.depth[node->index] + 1;
+                tree.parent[other->index] = node->index;
+                tree.order.push_back(other->index);
+            }
+        }
+    }
+    return tree;
+}
+
+void topologyChanged() {
+    topologyVersion++;
+    for (Node *node : nodes) {
+        if (node->meshJoined) {
+            node->connectionsChanged = true;
+        }
+    }
+}
+
+uint64_t hopDelayUs(size_t bytes) {
+    // ~1 Mbit/s effective per hop once TCP and contention are accounted for
+    return (uint64_t)((cfg.hopLatencyMs + uniform(0, cfg.hopJitterMs)) * 1000 + bytes * 8);
+}
+
+void deliver(Node *to, uint32_t from, const String &payload, uint64_t at) {
+    schedule(at, [to, from, payload]() {
+        to->inbox.push_back(Message{from, payload});
+        wake(to->loop);
+    });
+}
+
+/* Pi access point and server *************************************************/
+
+uint64_t serverFreeUs = 0;
+
+double rssiMean(const Node *node) {
+    double d = std::max(1.0, hypot(node->x - cfg.piX, node->y - cfg.piY));
+    return -40 - 22 * log10(d);
+}
+
+double rssiSample(const Node *node) {
+    return rssiMean(node) + std::normal_distribution<double>(0, cfg.rssiNoiseDb)(rng);
+}
+
+}  // namespace
+
+/* Measurements ***************************************************************/
+
+namespace {
+
+struct Sent {
+    uint64_t atUs;
+    bool delivered;
+    bool alert;
+    bool stamped;   // The delivered copy carried a wall clock time
+};
+
+std::map<std::string, Sent> sentMessages;
+std::vector<double> latenciesMs;
+std::vector<double> alertLatenciesMs;
+std::vector<double> stampErrorsMs;
+std::map<Node *, uint64_t> lastHeartbeatUs;
+std::set<Node *> bridgeSet;
+Report report;
+
+// Readings and alerts are told apart by their text, wherever it starts
+// (mesh payloads carry a traffic class header in front)
+void recordSend(const char *msg) {
+    if (const char *reading = strstr(msg, "Hello from ")) {
+        sentMessages.emplace(reading, Sent{clockUs, false, false, false});
+    } else if (const char *alert = strstr(msg, "Alert from ")) {
+        sentMessages.emplace(alert, Sent{clockUs, false, true, false});
+    }
+}
+
+// The Pi's wall clock, as Unix time
+const uint64_t SERVER_EPOCH_MS = 1767225600000ULL;
+
+uint64_t serverTimeMs() {
+    return SERVER_EPOCH_MS + clockUs / 1000;
+}
+
+// stampMs is the wall clock time the bridge put on the message, 0 if none
+void recordReading(Node *bridge, const std::string &message, uint64_t stampMs) {
+    auto it = sentMessages.find(message);
+    if (it == sentMessages.end() || !scoring(it->second.atUs)) {
+        return;
+    }
+    if (!it->second.alert) {
+        report.bridgeReadings[bridge->meshId]++;
+    }
+    if (it->second.delivered) {
+        report.duplicates++;
+        return;
+    }
+    it->second.delivered = true;
+    if (stampMs != 0) {
+        it->second.stamped = true;
+        stampErrorsMs.push_back(fabs((double)stampMs - (SERVER_EPOCH_MS + it->second.atUs / 1e3)));
+    }
+    (it->second.alert ? alertLatenciesMs : latenciesMs).push_back((clockUs - it->second.atUs) / 1000.0);
+}
+
+// The uplink payloads are the firmware's JSON; only the fields the report
+// needs are picked out
+void serverHandle(Node *node, std::string_view text) {
+    if (text.find("\"status\": \"heartbeat\"") != std::string::npos ||
+        text.find("\"status\": \"online\"") != std::string::npos) {
+        lastHeartbeatUs[node] = clockUs;
+    }
+    const std::string key = "\"message\": \"";
+    const std::string stampKey = "\"timestamp_ms\": ";
+    for (size_t pos = text.find(key); pos != std::string::npos; pos = text.find(key, pos)) {
+        // The entry's other fields come before the message
+        size_t entry = text.rfind('{', pos);
+        size_t stamp = text.find(stampKey, entry);
+        uint64_t stampMs = 0;
+        if (entry != std::string::npos && stamp < pos) {
+            stampMs = strtoull(std::string(text.substr(stamp + stampKey.size(), 20)).c_str(), nullptr, 10);
+        }
+        pos += key.size();
+        size_t end = text.find('"', pos);
+        if (end == std::string::npos) {
+            break;
+        }
+        recordReading(node, std::string(text.substr(pos, end - pos)), stampMs);
+        pos = end;
+    }
+}
+
+// Alerts come at random, independently per node
+void scheduleAlert(Node *node) {
+    double gapS = std::exponential_distribution<double>(1.0 / cfg.alertIntervalS)(rng);
+    schedule(clockUs + (uint64_t)(gapS * 1e6), [node]() {
+        node->alertsDue++;
+        wake(node->loop);
+        scheduleAlert(node);
+    });
+}
+
+void sampleBridges() {
+    std::set<Node *> now;
+    for (auto &entry : lastHeartbeatUs) {
+        if (clockUs - entry.second <= 2500000) {
+            now.insert(entry.first);
+        }
+    }
+    if (now != bridgeSet) {
+        bridgeSet = now;
+        report.bridgeChanges++;
+        report.convergenceS = clockUs / 1e6;
+    }
+    if (clockUs + 500000 < endUs) {
+        schedule(clockUs + 500000, sampleBridges);
+    }
+}
+
+}  // namespace
+
+Node *current() {
+    return runningNode;
+}
+
+uint64_t nowUs() {
+    return clockUs;
+}
+
+/* Scenario *******************************************************************/
+
+Report run(const Config &config, const std::string &nodeLibrary) {
+    cfg = config;
+    rng.seed(cfg.seed);
+    endUs = (uint64_t)(cfg.durationS * 1e6);
+    report = Report();
+    report.nodes = cfg.nodes;
+
+    char dir[] = "/tmp/meshsim-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        perror("mkdtemp");
+        exit(1);
+    }
+
+    for (int i = 0; i < cfg.nodes; i++) {
+        Node *node = new Node();
+        node->index = i;
+        uint8_t mac[6] = {0x24, 0x6f, 0x28, (uint8_t)(i >> 16), (uint8_t)(i >> 8), (uint8_t)i};
+        memcpy(node->mac, mac, sizeof(mac));
+        node->meshId = (uint32_t)mac[2] << 24 | (uint32_t)mac[3] << 16 | (uint32_t)mac[4] << 8 | mac[5];
+        node->x = uniform(0, cfg.areaM);
+        node->y = uniform(0, cfg.areaM);
+        node->clockOffsetUs = (int64_t)(uniform(-cfg.clockSkewS, cfg.clockSkewS) * 1e6);
+
+        // A private copy of the firmware per node keeps its statics apart
+        std::string path = std::string(dir) + "/node" + std::to_string(i) + ".so";
+        std::string copy = "cp '" + nodeLibrary + "' '" + path + "'";
+        if (system(copy.c_str()) != 0) {
+            fprintf(stderr, "Cannot copy %s\n", nodeLibrary.c_str());
+            exit(1);
+        }
+        node->library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (node->library == nullptr) {
+            fprintf(stderr, "dlopen: %s\n", dlerror());
+            exit(1);
+        }
+        node->setupFn = (void (*)())dlsym(node->library, "sim_setup");
+        node->loopFn = (void (*)())dlsym(node->library, "sim_loop");
+        node->alertFn = (void (*)())dlsym(node->library, "sim_alert");
+        unlink(path.c_str());
+
+        nodes.push_back(node);
+        nodesById[node->meshId] = node;
+    }
+    rmdir(dir);
+
+    // Arduino's main loop, idling until a task is due, a message arrives or
+    // the node raises an alert
+    for (Node *node : nodes) {
+        node->loop = spawn(node, [node]() {
+            node->setupFn();
+            for (;;) {
+                for (; node->alertsDue > 0; node->alertsDue--) {
+                    node->alertFn();
+                }
+                uint64_t passUs = clockUs;
+                node->loopFn();
+                report.loopMaxMs = std::max(report.loopMaxMs, (clockUs - passUs) / 1000.0);
+                if ((node->inbox.empty() && node->alertsDue == 0) || !node->meshJoined) {
+                    uint64_t dueUs = node->nextTaskMs * 1000;
+                    waitUs(dueUs > clockUs ? dueUs - clockUs : 1000);
+                }
+            }
+        }, (uint64_t)uniform(0, 3e6));
+    }
+    schedule(500000, sampleBridges);
+    if (cfg.alertIntervalS > 0) {
+        for (Node *node : nodes) {
+            scheduleAlert(node);
+        }
+    }
+
+    while (!events.empty() && events.top().at < endUs) {
+        Event event = events.top();
+        events.pop();
+        clockUs = event.at;
+        event.fn();
+    }
+    clockUs = endUs;
+
+    // Score what was sent in the window, leaving time for the tail to arrive
+    uint64_t drainUs = 10000000;
+    for (auto &entry : sentMessages) {
+        if (!scoring(entry.second.atUs) || entry.second.atUs + drainUs >= endUs) {
+            continue;
+        }
+        if (entry.second.alert) {
+            report.alertsSent++;
+            report.alertsDelivered += entry.second.delivered;
+        } else {
+            report.sent++;
+            report.delivered += entry.second.delivered;
+        }
+        report.stamped += entry.second.stamped;
+    }
+    for (Node *node : nodes) {
+        report.meshNodes += node->meshJoined;
+    }
+    report.finalBridges = (int)bridgeSet.size();
+    report.scoredS = (endUs - cfg.warmupS * 1e6) / 1e6;
+    if (!latenciesMs.empty()) {
+        std::sort(latenciesMs.begin(), latenciesMs.end());
+        double sum = 0;
+        for (double l : latenciesMs) {
+            sum += l;
+        }
+        report.latencyMeanMs = sum / latenciesMs.size();
+        report.latencyP50Ms = latenciesMs[latenciesMs.size() / 2];
+        report.latencyP99Ms = latenciesMs[std::min(latenciesMs.size() - 1, latenciesMs.size() * 99 / 100)];
+    }
+    if (!alertLatenciesMs.empty()) {
+        std::sort(alertLatenciesMs.begin(), alertLatenciesMs.end());
+        double sum = 0;
+        for (double l : alertLatenciesMs) {
+            sum += l;
+        }
+        report.alertLatencyMeanMs = sum / alertLatenciesMs.size();
+        report.alertLatencyP99Ms =
+            alertLatenciesMs[std::min(alertLatenciesMs.size() - 1, alertLatenciesMs.size() * 99 / 100)];
+        report.alertLatencyMaxMs = alertLatenciesMs.back();
+    }
+    if (!stampErrorsMs.empty()) {
+        std::sort(stampErrorsMs.begin(), stampErrorsMs.end());
+        double sum = 0;
+        for (double e : stampErrorsMs) {
+            sum += e;
+        }
+        report.stampErrorMeanMs = sum / stampErrorsMs.size();
+        report.stampErrorP99Ms = stampErrorsMs[std::min(stampErrorsMs.size() - 1, stampErrorsMs.size() * 99 / 100)];
+        report.stampErrorMaxMs = stampErrorsMs.back();
+    }
+    return report;
+}
+
+}  // namespace sim
+
+using namespace sim;
+
+/* Heap ***********************************************************************/
+
+// Counts what the firmware allocates while the scenario is scored, as a
+// stand-in for heap churn on the ESP32
+void *operator new(size_t size) {
+    if (running != nullptr && running->simDepth == 0 && scoring(clockUs)) {
+        report.allocations++;
+        report.allocatedBytes += size;
+    }
+    void *p = malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept {
+    free(p);
+}
+
+/* Arduino core ***************************************************************/
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+
+unsigned long millis() {
+    return (unsigned long)(clockUs / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)clockUs;
+}
+
+void delay(unsigned long ms) {
+    sleepUs((uint64_t)ms * 1000);
+}
+
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {}
+
+int HardwareSerial::printf(const char *format, ...) {
+    if (!cfg.verbose) {
+        return 0;
+    }
+    ::printf("%9.3f #%-3d ", clockUs / 1e6, runningNode ? runningNode->index : -1);
+    va_list args;
+    va_start(args, format);
+    int n = vprintf(format, args);
+    va_end(args);
+    return n;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+    if (cfg.verbose) {
+        ::printf("%9.3f #%-3d ", clockUs / 1e6, runningNode ? runningNode->index : -1);
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
+
+uint64_t EspClass::getEfuseMac() {
+    uint64_t mac = 0;
+    memcpy(&mac, runningNode->mac, sizeof(runningNode->mac));
+    return mac;
+}
+
+int esp_read_mac(uint8_t *mac, esp_mac_type_t type) {
+    memcpy(mac, runningNode->mac, sizeof(runningNode->mac));
+    return 0;
+}
+
+/* FreeRTOS *******************************************************************/
+
+struct SimQueue {
+    size_t length;
+    size_t itemSize;
+    std::deque<std::vector<uint8_t>> items;
+    std::deque<Coroutine *> receivers;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    SimQueue *queue = new SimQueue();
+    queue->length = length;
+    queue->itemSize = itemSize;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticksToWait) {
+    SimScope scope;
+    if (queue->items.size() >= queue->length) {
+        return pdFALSE;
+    }
+    const uint8_t *bytes = (const uint8_t *)item;
+    // Readings and alerts count as sent once the firmware queues them; the
+    // ones a bridge relays are already known.
+    for (const char *token : {"Hello from ", "Alert from "}) {
+        const void *text = memmem(item, queue->itemSize, token, strlen(token));
+        if (text != nullptr) {
+            recordSend((const char *)text);
+        }
+    }
+    queue->items.emplace_back(bytes, bytes + queue->itemSize);
+    while (!queue->receivers.empty()) {
+        Coroutine *receiver = queue->receivers.front();
+        queue->receivers.pop_front();
+        if (receiver->waiting) {
+            wake(receiver);
+            break;
+        }
+    }
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticksToWait) {
+    SimScope scope;
+    uint64_t deadline = ticksToWait == portMAX_DELAY ? FOREVER : clockUs + (uint64_t)ticksToWait * 1000;
+    while (queue->items.empty()) {
+        if (deadline != FOREVER && clockUs >= deadline) {
+            return pdFALSE;
+        }
+        queue->receivers.push_back(running);
+        waitUs(deadline == FOREVER ? FOREVER : deadline - clockUs);
+    }
+    memcpy(item, queue->items.front().data(), queue->itemSize);
+    queue->items.pop_front();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    return (UBaseType_t)queue->items.size();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task, const char *name, uint32_t stackDepth, void *param,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    Coroutine *co = spawn(runningNode, [task, param]() { task(param); }, clockUs);
+    if (handle != nullptr) {
+        *handle = co;
+    }
+    return pdPASS;
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(clockUs / 1000);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    Coroutine *co = (Coroutine *)task;
+    co->notifications++;
+    wake(co);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+    uint64_t deadline = ticksToWait == portMAX_DELAY ? FOREVER : clockUs + (uint64_t)ticksToWait * 1000;
+    while (running->notifications == 0) {
+        if (deadline != FOREVER && clockUs >= deadline) {
+            return 0;
+        }
+        waitUs(deadline == FOREVER ? FOREVER : deadline - clockUs);
+    }
+    uint32_t count = running->notifications;
+    running->notifications = clearCountOnExit ? 0 : count - 1;
+    return count;
+}
+
+/* WiFi station ***************************************************************/
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    return true;
+}
+
+bool WiFiClass::disconnect() {
+    runningNode->wifiConnected = false;
+    return true;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *password) {
+    SimScope scope;
+    Node *node = runningNode;
+    if (!node->wifiConnected && !node->wifiConnecting && rssiMean(node) >= cfg.piRangeDbm) {
+        node->wifiConnecting = true;
+        schedule(clockUs + (uint64_t)uniform(1.0e6, 3.0e6), [node]() {
+            node->wifiConnecting = false;
+            node->wifiConnected = true;
+        });
+    }
+    return status();
+}
+
+wl_status_t WiFiClass::status() {
+    return runningNode->wifiConnected ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+int8_t WiFiClass::RSSI() {
+    return runningNode->wifiConnected ? (int8_t)lround(rssiSample(runningNode)) : 0;
+}
+
+int32_t WiFiClass::channel() {
+    return 6;
+}
+
+IPAddress WiFiClass::localIP() {
+    if (!runningNode->wifiConnected) {
+        return IPAddress();
+    }
+    return IPAddress(192 | 168 << 8 | 4 << 16 | (uint32_t)(10 + runningNode->index % 240) << 24);
+}
+
+/* HTTP client ****************************************************************/
+
+bool HTTPClient::begin(const String &url) {
+    client = &ownClient;
+    return true;
+}
+
+bool HTTPClient::begin(WiFiClient &client, const String &url) {
+    this->client = &client;
+    return true;
+}
+
+void HTTPClient::end() {
+    if (client != nullptr && !reuse) {
+        client->stop();
+    }
+    client = nullptr;
+}
+
+int HTTPClient::GET() {
+    return request("GET", "", 0);
+}
+
+int HTTPClient::POST(const String &body) {
+    return request("POST", body.c_str(), body.length());
+}
+
+int HTTPClient::POST(uint8_t *payload, size_t size) {
+    return request("POST", (const char *)payload, size);
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED:
+        return "connection refused";
+    case HTTPC_ERROR_CONNECTION_LOST:
+        return "connection lost";
+    case HTTPC_ERROR_READ_TIMEOUT:
+        return "read Timeout";
+    default:
+        return String();
+    }
+}
+
+int HTTPClient::request(const char *method, const char *body, size_t size) {
+    SimScope scope;
+    Node *node = runningNode;
+    response = String();
+    if (client == nullptr || !node->wifiConnected) {
+        sleepUs(1000);
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+
+    // A weak link sometimes times out, like the real client's 5 s default
+    double rssi = rssiSample(node);
+    if (rssi < cfg.piRangeDbm - 3) {
+        client->stop();
+        sleepUs(5000000);
+        return HTTPC_ERROR_READ_TIMEOUT;
+    }
+
+    // The AP channel and the Flask server are one FIFO shared by all bridges
+    double rttUs = 4000 + std::max(0.0, -60 - rssi) * 200;
+    uint64_t startUs = clockUs + (uint64_t)(client->open ? rttUs / 2 : rttUs * 1.5);
+    size_t readings = std::count(body, body + size, '{');
+    double serviceUs = size * 2.0 + cfg.serverMsPerRequest * 1000 + readings * cfg.serverMsPerReading * 1000;
+    serverFreeUs = std::max(serverFreeUs, startUs) + (uint64_t)serviceUs;
+    uint64_t doneUs = serverFreeUs + (uint64_t)(rttUs / 2);
+
+    sleepUs(serverFreeUs - clockUs);
+    if (strcmp(method, "POST") == 0) {
+        serverHandle(node, std::string_view(body, size));
+        response = String(("{\"status\": \"success\", \"server_time_ms\": " + std::to_string(serverTimeMs()) + "}").c_str());
+    } else {
+        response = String(("{\"data\": [{\"server\": \"connected\"}], \"status\": \"success\", \"server_time_ms\": " +
+                           std::to_string(serverTimeMs()) + "}").c_str());
+    }
+    sleepUs(doneUs - clockUs);
+    client->open = reuse;
+    return HTTP_CODE_OK;
+}
+
+/* TaskScheduler **************************************************************/
+
+void Task::enable() {
+    enabled = true;
+    nextRunMs = millis();
+}
+
+void Scheduler::addTask(Task &task) {
+    task.next = first;
+    first = &task;
+}
+
+bool Scheduler::execute() {
+    bool ran = false;
+    for (Task *task = first; task != nullptr; task = task->next) {
+        if (!task->enabled || millis() < task->nextRunMs) {
+            continue;
+        }
+        task->nextRunMs += task->interval;
+        // Catch up like TaskScheduler, but not after long stalls
+        if (task->nextRunMs + task->interval <= millis()) {
+            task->nextRunMs = millis();
+        }
+        if (task->iterations > 0 && --task->iterations == 0) {
+            task->enabled = false;
+        }
+        ran = true;
+        if (task->callback) {
+            task->callback();
+        }
+    }
+
+    uint64_t next = UINT64_MAX;
+    for (Task *task = first; task != nullptr; task = task->next) {
+        if (task->enabled) {
+            next = std::min<uint64_t>(next, task->nextRunMs);
+        }
+    }
+    runningNode->nextTaskMs = next == UINT64_MAX ? millis() + 1000 : next;
+    return ran;
+}
+
+/* painlessMesh ***************************************************************/
+
+namespace {
+
+// painlessMesh converges every connected node on one mesh time. Here the
+// lowest-index node of each partition sets it, and the others adopt it up to
+// the residual sync error whenever their connections change.
+void syncTime(Node *node, const std::function<void(int32_t)> &adjusted) {
+    SimScope scope;
+    const Tree &tree = treeFrom(node);
+    int reference = *std::min_element(tree.order.begin(), tree.order.end());
+    if (reference == node->index) {
+        return;
+    }
+    int64_t target = nodes[reference]->clockOffsetUs + (int64_t)(uniform(-1, 1) * cfg.timeSyncErrorMs * 1000);
+    int32_t offset = (int32_t)(target - node->clockOffsetUs);
+    node->clockOffsetUs = target;
+    if (adjusted) {
+        adjusted(offset);
+    }
+}
+
+}  // namespace
+
+void painlessMesh::init(String prefix, String password, Scheduler *scheduler, uint16_t port,
+                        wifi_mode_t connectMode, wifi_auth_mode_t authMode, uint8_t channel) {
+    runningNode->meshJoined = true;
+    topologyChanged();
+}
+
+void painlessMesh::stop() {
+    runningNode->meshJoined = false;
+    runningNode->inbox.clear();
+    topologyChanged();
+}
+
+void painlessMesh::update() {
+    Node *node = runningNode;
+    if (node->connectionsChanged) {
+        node->connectionsChanged = false;
+        if (changedConnectionsCallback) {
+            changedConnectionsCallback();
+        }
+        syncTime(node, nodeTimeAdjustedCallback);
+    }
+    while (!node->inbox.empty()) {
+        Message message = std::move(node->inbox.front());
+        node->inbox.pop_front();
+        if (receivedCallback) {
+            receivedCallback(message.from, message.payload);
+        }
+    }
+}
+
+bool painlessMesh::sendSingle(uint32_t destId, String msg) {
+    SimScope scope;
+    Node *node = runningNode;
+    recordSend(msg.c_str());
+    auto it = nodesById.find(destId);
+    if (!node->meshJoined || it == nodesById.end()) {
+        return false;
+    }
+    Node *dest = it->second;
+    const Tree &tree = treeFrom(node);
+    if (tree.depth[dest->index] < 0) {
+        return false;
+    }
+
+    // Walk the path hop by hop; a lost hop loses the message
+    uint64_t at = clockUs;
+    for (int hop = 0; hop < tree.depth[dest->index]; hop++) {
+        if (scoring(clockUs)) {
+            report.hopTransmissions++;
+            report.hopBytes += msg.length();
+        }
+        at += hopDelayUs(msg.length());
+        if (chance(cfg.loss)) {
+            return true;
+        }
+    }
+    deliver(dest, node->meshId, msg, at);
+    return true;
+}
+
+bool painlessMesh::sendBroadcast(String msg, bool includeSelf) {
+    SimScope scope;
+    Node *node = runningNode;
+    recordSend(msg.c_str());
+    if (!node->meshJoined) {
+        return false;
+    }
+
+    // Flood along the tree: every node that got the message passes it on
+    const Tree &tree = treeFrom(node);
+    std::vector<uint64_t> arrival(nodes.size(), 0);
+    std::vector<bool> reached(nodes.size(), false);
+    reached[node->index] = true;
+    arrival[node->index] = clockUs;
+    for (size_t i = 1; i < tree.order.size(); i++) {
+        int index = tree.order[i];
+        int parent = tree.parent[index];
+        if (!reached[parent]) {
+            continue;
+        }
+        if (scoring(clockUs)) {
+            report.hopTransmissions++;
+            report.hopBytes += msg.length();
+        }
+        if (chance(cfg.loss)) {
+            continue;
+        }
+        reached[index] = true;
+        arrival[index] = arrival[parent] + hopDelayUs(msg.length());
+        deliver(nodes[index], node->meshId, msg, arrival[index]);
+    }
+    if (includeSelf) {
+        deliver(node, node->meshId, msg, clockUs);
+    }
+    return true;
+}
+
+uint32_t painlessMesh::getNodeId() {
+    return runningNode->meshId;
+}
+
+std::list<uint32_t> painlessMesh::getNodeList(bool includeSelf) {
+    std::list<uint32_t> list;
+    if (!runningNode->meshJoined) {
+        return list;
+    }
+    for (int index : treeFrom(runningNode).order) {
+        if (includeSelf || index != runningNode->index) {
+            list.push_back(nodes[index]->meshId);
+        }
+    }
+    return list;
+}
+
+painlessmesh::protocol::NodeTree painlessMesh::asNodeTree() {
+    const Tree &tree = treeFrom(runningNode);
+    std::vector<std::vector<int>> children(nodes.size());
+    for (int index : tree.order) {
+        if (tree.parent[index] >= 0) {
+            children[tree.parent[index]].push_back(index);
+        }
+    }
+    std::function<painlessmesh::protocol::NodeTree(int)> build = [&](int index) {
+        painlessmesh::protocol::NodeTree subtree;
+        subtree.nodeId = nodes[index]->meshId;
+        for (int child : children[index]) {
+            subtree.subs.push_back(build(child));
+        }
+        return subtree;
+    };
+    return build(runningNode->index);
+}
+
+uint32_t painlessMesh::getNodeTime() {
+    return (uint32_t)(clockUs + runningNode->clockOffsetUs);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+// Discrete-event simulation of a SafeHat mesh.
+//
+// Every node runs the unmodified firmware in src/, built into a shared
+// object against the shims in sim/shims. Each node loads its own copy of
+// that object, so the static state of MeshNode stays per node. The
+// firmware's loop() and FreeRTOS tasks run as coroutines on a virtual
+// clock. Blocking calls (delay, queue receive, HTTP) suspend the calling
+// coroutine until the simulated time has passed.
+
+#include <stdint.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include <ucontext.h>
+#include "Arduino.h"
+
+namespace sim {
+
+struct Config {
+    int nodes = 50;
+    double durationS = 300;
+    double warmupS = 60;          // Messages sent earlier are not scored
+    uint64_t seed = 1;
+    double areaM = 200;           // Nodes are placed uniformly in a square of this side
+    double meshRangeM = 45;       // Helmets closer than this are mesh neighbours
+    double hopLatencyMs = 8;      // Mean per-hop delivery time
+    double hopJitterMs = 4;       // Uniform jitter added to every hop
+    double loss = 0.0;            // Probability that one hop loses a message
+    double rssiNoiseDb = 2;       // Standard deviation of RSSI readings
+    double piX = 100, piY = 100;  // Position of the Pi access point
+    double piRangeDbm = -88;      // Weakest RSSI at which a node can associate
+    double serverMsPerRequest = 4;
+    double serverMsPerReading = 0.2;
+    double alertIntervalS = 0;    // Mean time between alerts per node, 0 for none
+    double clockSkewS = 5;        // Node clocks start up to this far off before mesh time sync
+    double timeSyncErrorMs = 2;   // Residual error of painlessMesh's time sync
+    bool verbose = false;
+};
+
+struct Report {
+    int nodes = 0;
+    int meshNodes = 0;             // Nodes that joined the mesh
+    double convergenceS = -1;      // Last change of the bridge set, -1 if none formed
+    int bridgeChanges = 0;
+    int finalBridges = 0;
+    uint64_t sent = 0;             // Scored messages sent by nodes
+    uint64_t delivered = 0;        // Scored messages that reached the server
+    uint64_t duplicates = 0;       // Extra copies of delivered messages
+    double latencyMeanMs = 0;
+    double latencyP50Ms = 0;
+    double latencyP99Ms = 0;
+    uint64_t alertsSent = 0;       // Scored alerts, counted apart from readings
+    uint64_t alertsDelivered = 0;
+    double alertLatencyMeanMs = 0;
+    double alertLatencyP99Ms = 0;
+    double alertLatencyMaxMs = 0;
+    uint64_t stamped = 0;          // Delivered messages the bridge gave a wall clock time
+    double stampErrorMeanMs = 0;   // |stamp - time the message was produced|
+    double stampErrorP99Ms = 0;
+    double stampErrorMaxMs = 0;
+    uint64_t hopTransmissions = 0; // Per-hop radio sends over the scored window
+    uint64_t hopBytes = 0;
+    std::map<uint32_t, uint64_t> bridgeReadings;  // Forwarded readings per bridge
+    uint64_t allocations = 0;      // Heap allocations made by firmware code
+    uint64_t allocatedBytes = 0;
+    double loopMaxMs = 0;          // Longest single pass of loop() on any node, warm-up included
+    double scoredS = 0;
+};
+
+struct Node;
+
+// Runs one scenario to completion and returns its measurements
+Report run(const Config &config, const std::string &nodeLibrary);
+
+// Used by the shims: the node whose code is running right now
+Node *current();
+uint64_t nowUs();
+
+}  // namespace sim
@@ -0,0 +1,99 @@
+#include "BridgeSelector.h"
+
+uint32_t BridgeSelector::cost(const Entry &entry) {
+    return entry.hops * HOP_COST + entry.queueDepth;
+}
+
+const BridgeSelector::Entry *BridgeSelector::find(uint32_t nodeId) const {
+    for (const Entry &entry : entries) {
+        if (entry.nodeId != 0 && entry.nodeId == nodeId) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void BridgeSelector::update(uint32_t nodeId, uint8_t hops, uint16_t queueDepth, int32_t rssi, uint32_t nowMs) {
+    if (nodeId == 0) {
+        return;
+    }
+
+    // Reuse the bridge's slot, else a free one, else the stalest
+    Entry *slot = nullptr;
+    for (Entry &entry : entries) {
+        if (entry.nodeId == nodeId) {
+            slot = &entry;
+            break;
+        }
+        if (slot == nullptr || (slot->nodeId != 0 &&
+                                (entry.nodeId == 0 || nowMs - entry.lastSeenMs > nowMs - slot->lastSeenMs))) {
+            slot = &entry;
+        }
+    }
+
+    slot->nodeId = nodeId;
+    slot->hops = hops;
+    slot->queueDepth = queueDepth;
+    slot->rssi = rssi;
+    slot->lastSeenMs = nowMs;
+}
+
+void BridgeSelector::remove(uint32_t nodeId) {
+    for (Entry &entry : entries) {
+        if (entry.nodeId == nodeId) {
+            entry.nodeId = 0;
+        }
+    }
+}
+
+void BridgeSelector::expire(uint32_t nowMs) {
+    for (Entry &entry : entries) {
+        if (entry.nodeId != 0 && nowMs - entry.lastSeenMs > EXPIRY_MS) {
+            entry.nodeId = 0;
+        }
+    }
+}
+
+uint32_t BridgeSelector::select(uint32_t currentId) const {
+    const Entry *best = nullptr;
+    for (const Entry &entry : entries) {
+        if (entry.nodeId == 0) {
+            continue;
+        }
+        if (best == nullptr || cost(entry) < cost(*best) ||
+            (cost(entry) == cost(*best) && entry.nodeId < best->nodeId)) {
+            best = &entry;
+        }
+    }
+    if (best == nullptr) {
+        return 0;
+    }
+
+    // Hysteresis, so nodes do not flap between two bridges of similar load
+    const Entry *current = find(currentId);
+    if (current != nullptr && cost(*current) <= cost(*best) + SWITCH_MARGIN) {
+        return current->nodeId;
+    }
+    return best->nodeId;
+}
+
+size_t BridgeSelector::count() const {
+    size_t n = 0;
+    for (const Entry &entry : entries) {
+        if (entry.nodeId != 0) {
+            n++;
+        }
+    }
+    return n;
+}
+
+size_t BridgeSelector::countBetterThan(int32_t rssi, uint32_t selfId) const {
+    size_t n = 0;
+    for (const Entry &entry : entries) {
+        if (entry.nodeId != 0 && entry.nodeId != selfId &&
+            (entry.rssi > rssi || (entry.rssi == rssi && entry.nodeId < selfId))) {
+            n++;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Table of the bridges a node has heard from, and the choice of the one to
+// send through. Kept free of Arduino and painlessMesh types so the same
+// logic can run in a host-side simulation.
+class BridgeSelector {
+public:
+    static const size_t MAX_BRIDGES = 8;        // Bridges remembered at once
+    static const uint32_t EXPIRY_MS = 10000;    // Forget a bridge not heard from for this long
+    static const uint32_t HOP_COST = 8;         // Queued messages one extra hop is worth
+    static const uint32_t SWITCH_MARGIN = 4;    // Cost advantage needed to leave the current bridge
+
+    // Records an advertisement (or election broadcast) from a bridge
+    void update(uint32_t nodeId, uint8_t hops, uint16_t queueDepth, int32_t rssi, uint32_t nowMs);
+    void remove(uint32_t nodeId);
+    void expire(uint32_t nowMs);
+
+    // Cheapest bridge by hops and load. Stays with currentId unless another
+    // bridge is cheaper by more than SWITCH_MARGIN. Returns 0 if none is known.
+    uint32_t select(uint32_t currentId) const;
+
+    size_t count() const;
+    // Number of bridges other than selfId with a better uplink RSSI
+    size_t countBetterThan(int32_t rssi, uint32_t selfId) const;
+
+private:
+    struct Entry {
+        uint32_t nodeId;
+        uint8_t hops;
+        uint16_t queueDepth;
+        int32_t rssi;
+        uint32_t lastSeenMs;
+    };
+
+    Entry entries[MAX_BRIDGES] = {};
+
+    static uint32_t cost(const Entry &entry);
+    const Entry *find(uint32_t nodeId) const;
+};
@@ -5,11 +5,27 @@ MeshNode* MeshNode::instance = nullptr;
 bool MeshNode::isBridge = false;
 bool MeshNode::meshStarted = false;
 bool MeshNode::serverReachable = false;
-String MeshNode::nodeName = "";
+char MeshNode::nodeName[16] = "";
 painlessMesh MeshNode::mesh;
 Scheduler MeshNode::userScheduler;
 uint32_t MeshNode::currentBridgeId = 0;
 int32_t MeshNode::bestRSSI = -1000;
+BridgeSelector MeshNode::bridges;
+uint32_t MeshNode::messageSeq = 0;
+QueueHandle_t MeshNode::sendQueues[TRAFFIC_CLASS_COUNT] = {};
+QueueHandle_t MeshNode::forwardQueues[TRAFFIC_CLASS_COUNT] = {};
+TaskHandle_t MeshNode::forwardTaskHandle = nullptr;
+ForwardStats MeshNode::forwardStats = {};
+uint64_t MeshNode::forwardLatencyTotalMs = 0;
+portMUX_TYPE MeshNode::forwardStatsLock = portMUX_INITIALIZER_UNLOCKED;
+char MeshNode::forwardBody[FORWARD_BODY_MAX];
+portMUX_TYPE MeshNode::uplinkLock = portMUX_INITIALIZER_UNLOCKED;
+uint8_t MeshNode::uplinkRequests = 0;
+uint8_t MeshNode::uplinkEvents = 0;
+portMUX_TYPE MeshNode::wallClockLock = portMUX_INITIALIZER_UNLOCKED;
+bool MeshNode::wallClockSynced = false;
+uint32_t MeshNode::wallAnchorMeshUs = 0;
+uint64_t MeshNode::wallAnchorUnixMs = 0;
 
 // Constants initialization
 const char* MeshNode::MESH_PREFIX = "SafeHatMesh";
@@ -35,78 +51,537 @@ void MeshNode::init() {
     WiFi.disconnect();
 
     setupMeshCallbacks();
+
+    bool queuesCreated = true;
+    for (int cls = 0; cls < TRAFFIC_CLASS_COUNT; cls++) {
+        int forwardLength = TrafficHeader::urgent((TrafficClass)cls) ? FORWARD_URGENT_QUEUE_LENGTH
+                                                                     : FORWARD_QUEUE_LENGTH;
+        sendQueues[cls] = xQueueCreate(SEND_QUEUE_LENGTH, sizeof(QueuedMessage));
+        forwardQueues[cls] = xQueueCreate(forwardLength, sizeof(QueuedMessage));
+        queuesCreated = queuesCreated && sendQueues[cls] != nullptr && forwardQueues[cls] != nullptr;
+    }
+    if (!queuesCreated ||
+        xTaskCreatePinnedToCore(forwardTask, "mesh_forward", 8192, nullptr, 1, &forwardTaskHandle, 0) != pdPASS) {
+        logError("Failed to start forwarding task");
+    }
     logMessage("Setup complete. Node ready.");
 }
 
 void MeshNode::update() {
+    applyUplinkEvents();
     if (meshStarted) {
         mesh.update();
+        flushSendQueues();
     }
 }
 
 void MeshNode::initNodeIdentity() {
     esp_read_mac(baseMac, ESP_MAC_WIFI_STA);
-    nodeName = "SafeHat-" + String(baseMac[4], HEX).substring(0, 2) +
-               String(baseMac[5], HEX).substring(0, 2);
-    fullMac = String(baseMac[0], HEX) + ":" + String(baseMac[1], HEX) + ":" +
-              String(baseMac[2], HEX) + ":" + String(baseMac[3], HEX) + ":" +
-              String(baseMac[4], HEX) + ":" + String(baseMac[5], HEX);
+    snprintf(nodeName, sizeof(nodeName), "SafeHat-%02x%02x", baseMac[4], baseMac[5]);
+    snprintf(fullMac, sizeof(fullMac), "%02x:%02x:%02x:%02x:%02x:%02x",
+             baseMac[0], baseMac[1], baseMac[2], baseMac[3], baseMac[4], baseMac[5]);
     chipId = ESP.getEfuseMac();
 }
 
-void MeshNode::logMessage(String message, String level) {
-    String role = isBridge ? "BRIDGE" : "NODE";
-    String color = isBridge ? "\033[0;36m" : (level == "ERROR" ? "\033[0;31m" : "\033[0;32m");
+void MeshNode::logMessage(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    logLine("INFO", format, args);
+    va_end(args);
+}
 
-    Serial.printf("%s[%s][%s][%s]\033[0m %s\n",
-                  color.c_str(),
-                  role.c_str(),
-                  nodeName.c_str(),
-                  level.c_str(),
-                  message.c_str());
+void MeshNode::logError(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    logLine("ERROR", format, args);
+    va_end(args);
 }
 
-bool MeshNode::checkServerConnectivity() {
-    HTTPClient http;
-    http.begin(SERVER_URL);
+void MeshNode::logLine(const char *level, const char *format, va_list args) {
+    const char *role = isBridge ? "BRIDGE" : "NODE";
+    const char *color = isBridge ? "\033[0;36m" : (strcmp(level, "ERROR") == 0 ? "\033[0;31m" : "\033[0;32m");
 
-    logMessage("Checking server connectivity...");
-    int httpResponseCode = http.GET();
+    // One byte is held back so the newline survives a cut-off line
+    char line[LOG_LINE_MAX];
+    TextBuffer out(line, sizeof(line) - 1);
+    out.appendf("%s[%s][%s][%s]\033[0m ", color, role, nodeName, level);
+    out.vappendf(format, args);
+    size_t length = out.length();
+    line[length++] = '\n';
+    Serial.write((const uint8_t *)line, length);
+}
+
+void MeshNode::requestUplink(uint8_t request) {
+    // Requests of one kind coalesce, so a slow uplink never builds a backlog
+    portENTER_CRITICAL(&uplinkLock);
+    uplinkRequests |= request;
+    portEXIT_CRITICAL(&uplinkLock);
+    if (forwardTaskHandle != nullptr) {
+        xTaskNotifyGive(forwardTaskHandle);
+    }
+}
+
+void MeshNode::reportUplink(uint8_t event) {
+    portENTER_CRITICAL(&uplinkLock);
+    uplinkEvents |= event;
+    portEXIT_CRITICAL(&uplinkLock);
+}
+
+uint8_t MeshNode::takeUplink(uint8_t &flags) {
+    portENTER_CRITICAL(&uplinkLock);
+    uint8_t taken = flags;
+    flags = 0;
+    portEXIT_CRITICAL(&uplinkLock);
+    return taken;
+}
+
+void MeshNode::applyUplinkEvents() {
+    uint8_t events = takeUplink(uplinkEvents);
+    if ((events & UPLINK_LOST) && isBridge) {
+        stepDown("Heartbeat failed");
+    }
+    if ((events & UPLINK_REGISTERED) && !serverReachable) {
+        serverReachable = true;
+        isBridge = true;
+        currentBridgeId = mesh.getNodeId();
+        logMessage("Successfully registered as bridge node");
+
+        if (!meshStarted) {
+            int channel = WiFi.channel();
+            mesh.init(MESH_PREFIX, MESH_PASSWORD, &userScheduler, MESH_PORT, WIFI_AP_STA, WIFI_AUTH_WPA2_PSK, channel);
+            meshStarted = true;
+        }
+        // The uplink RSSI now that the station is associated; bestRSSI
+        // still holds the reading from before, which is 0 dBm and would
+        // outrank every real bridge
+        char elect[40];
+        int length = snprintf(elect, sizeof(elect), "BRIDGE_ELECT:%lu:%d",
+                              (unsigned long)mesh.getNodeId(), WiFi.RSSI());
+        queueMessage(TRAFFIC_CONTROL, elect, length);
+    }
+}
+
+bool MeshNode::pushMessage(QueueHandle_t queue, uint32_t from, const char *text, size_t length,
+                           uint32_t meshTimeUs) {
+    QueuedMessage item;
+    if (queue == nullptr || length >= sizeof(item.message)) {
+        return false;
+    }
+
+    item.from = from;
+    item.queuedMs = millis();
+    item.meshTimeUs = meshTimeUs;
+    item.length = length;
+    memcpy(item.message, text, length);
+    item.message[length] = '\0';
+
+    // Never wait here: callers run inside mesh.update() and sensor tasks
+    return xQueueSend(queue, &item, 0) == pdTRUE;
+}
+
+bool MeshNode::queueMessage(TrafficClass cls, const char *text, size_t length) {
+    // Messages are queued as they are produced; queuedMs is their timestamp
+    // until sendOverMesh() turns it into mesh time
+    return cls < TRAFFIC_CLASS_COUNT && pushMessage(sendQueues[cls], 0, text, length, 0);
+}
+
+uint32_t MeshNode::producedAt(const QueuedMessage &item) {
+    // Counted back from now on the local clock, so the stamp stays right
+    // even if mesh time was adjusted while the message waited
+    return mesh.getNodeTime() - (millis() - item.queuedMs) * 1000;
+}
+
+void MeshNode::flushSendQueues() {
+    // Alerts and control messages go out in full, the lower classes at most
+    // SEND_BUDGET per pass so a backlog of them cannot hold up the loop
+    int budget = SEND_BUDGET;
+    QueuedMessage item;
+    for (int cls = 0; cls < TRAFFIC_CLASS_COUNT; cls++) {
+        bool urgent = TrafficHeader::urgent((TrafficClass)cls);
+        while ((urgent || budget > 0) && xQueueReceive(sendQueues[cls], &item, 0) == pdTRUE) {
+            if (!urgent) {
+                budget--;
+            }
+            sendOverMesh((TrafficClass)cls, item);
+        }
+    }
+}
+
+void MeshNode::sendOverMesh(TrafficClass cls, const QueuedMessage &item) {
+    // A bridge is its own uplink: its readings and alerts go straight to
+    // the forward queues and never touch the mesh
+    if (isBridge && cls != TRAFFIC_CONTROL) {
+        if (!enqueueForward(cls, mesh.getNodeId(), item.message, item.length, producedAt(item))) {
+            logError("Could not queue own %s message for the server", TrafficHeader::name(cls));
+        }
+        return;
+    }
+
+    char msg[TrafficHeader::MAX_LENGTH + sizeof(item.message)];
+    size_t headerLength = TrafficHeader::write(msg, cls, producedAt(item));
+    memcpy(msg + headerLength, item.message, item.length + 1);
+    if (cls == TRAFFIC_CONTROL) {
+        mesh.sendBroadcast(msg);
+        return;
+    }
+
+    // Readings travel one path to the elected bridge. Flooding them is
+    // only the fallback while no bridge is known or the route to the
+    // chosen one is gone; broadcast is otherwise kept for BRIDGE_*
+    // control messages.
+    if (currentBridgeId != 0) {
+        if (mesh.sendSingle(currentBridgeId, msg)) {
+            logMessage("Sending to bridge %lu: %s", (unsigned long)currentBridgeId, msg);
+            return;
+        }
+        logError("No route to bridge %lu", (unsigned long)currentBridgeId);
+        bridges.remove(currentBridgeId);
+        currentBridgeId = bridges.select(0);
+    }
+    logMessage("Sending broadcast: %s", msg);
+    mesh.sendBroadcast(msg);
+}
+
+bool MeshNode::enqueueForward(TrafficClass cls, uint32_t from, const char *msg, size_t length,
+                              uint32_t meshTimeUs) {
+    if (cls >= TRAFFIC_CLASS_COUNT || !pushMessage(forwardQueues[cls], from, msg, length, meshTimeUs)) {
+        portENTER_CRITICAL(&forwardStatsLock);
+        forwardStats.dropped++;
+        portEXIT_CRITICAL(&forwardStatsLock);
+        return false;
+    }
+    uint32_t depth = forwardDepth();
+    portENTER_CRITICAL(&forwardStatsLock);
+    forwardStats.queued++;
+    if (depth > forwardStats.queueHighWater) {
+        forwardStats.queueHighWater = depth;
+    }
+    portEXIT_CRITICAL(&forwardStatsLock);
+    if (forwardTaskHandle != nullptr) {
+        xTaskNotifyGive(forwardTaskHandle);
+    }
+    return true;
+}
 
-    if (httpResponseCode > 0) {
-        logMessage("Server response: " + String(httpResponseCode));
-        if (httpResponseCode == HTTP_CODE_OK) {
-            String payload = http.getString();
-            logMessage("Server payload: " + payload);
-            http.end();
+bool MeshNode::takeForward(TrafficClass first, TrafficClass last, QueuedMessage &item, TrafficClass &cls) {
+    for (int next = first; next <= last; next++) {
+        if (forwardQueues[next] != nullptr && xQueueReceive(forwardQueues[next], &item, 0) == pdTRUE) {
+            cls = (TrafficClass)next;
             return true;
         }
+    }
+    return false;
+}
+
+uint32_t MeshNode::forwardDepth() {
+    uint32_t depth = 0;
+    for (int cls = 0; cls < TRAFFIC_CLASS_COUNT; cls++) {
+        depth += forwardQueues[cls] ? uxQueueMessagesWaiting(forwardQueues[cls]) : 0;
+    }
+    return depth;
+}
+
+bool MeshNode::appendForwardEntry(TextBuffer &body, TrafficClass cls, const QueuedMessage &item) {
+    body.appendf("{\"from\": \"%lu\", \"class\": \"%s\", ", (unsigned long)item.from, TrafficHeader::name(cls));
+    uint64_t unixMs;
+    if (wallClockMs(item.meshTimeUs, &unixMs)) {
+        body.appendf("\"timestamp_ms\": %llu, \"time_synced\": true, ", (unsigned long long)unixMs);
     } else {
-        logMessage("Server connection failed: " + http.errorToString(httpResponseCode), "ERROR");
+        body.append("\"time_synced\": false, ");
+    }
+    body.append("\"message\": \"");
+    body.appendJsonEscaped(item.message, item.length);
+    body.append("\"}");
+    // The closing bracket of the batch still has to fit
+    return !body.overflowed() && body.remaining() > 0;
+}
+
+int MeshNode::postForward(HTTPClient &http, WiFiClient &client, const TextBuffer &body,
+                          const uint32_t *queuedMs, const TrafficClass *classes, int count) {
+    if (!isBridge || !serverReachable) {
+        portENTER_CRITICAL(&forwardStatsLock);
+        forwardStats.lost += count;
+        portEXIT_CRITICAL(&forwardStatsLock);
+        return 0;
+    }
+
+    int httpResponseCode = postUplink(http, client, body.c_str(), body.length(), FORWARD_ATTEMPTS);
+    if (httpResponseCode != HTTP_CODE_OK) {
+        portENTER_CRITICAL(&forwardStatsLock);
+        forwardStats.failures++;
+        forwardStats.lost += count;
+        portEXIT_CRITICAL(&forwardStatsLock);
+        if (instance && httpResponseCode > 0) {
+            instance->logError("Failed to forward %d messages: HTTP %d", count, httpResponseCode);
+        } else if (instance) {
+            instance->logError("Failed to forward %d messages: %s", count,
+                               HTTPClient::errorToString(httpResponseCode).c_str());
+        }
+        return httpResponseCode;
+    }
+
+    uint32_t now = millis();
+    portENTER_CRITICAL(&forwardStatsLock);
+    for (int i = 0; i < count; i++) {
+        uint32_t latency = now - queuedMs[i];
+        forwardLatencyTotalMs += latency;
+        if (latency > forwardStats.latencyMaxMs) {
+            forwardStats.latencyMaxMs = latency;
+        }
+        if (classes[i] == TRAFFIC_ALERT) {
+            forwardStats.alerts++;
+            if (latency > forwardStats.alertLatencyMaxMs) {
+                forwardStats.alertLatencyMaxMs = latency;
+            }
+        }
     }
+    forwardStats.forwarded += count;
+    forwardStats.batches++;
+    portEXIT_CRITICAL(&forwardStatsLock);
+    return httpResponseCode;
+}
 
+int MeshNode::postUplink(HTTPClient &http, WiFiClient &client, const char *body, size_t length, int attempts) {
+    int httpResponseCode = 0;
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        // The first retry goes out at once on a fresh connection, in case
+        // the server closed the kept-alive one; later ones back off
+        if (attempt > 1) {
+            delay(FORWARD_RETRY_MS * (attempt - 1));
+        }
+        http.begin(client, SERVER_URL);
+        http.addHeader("Content-Type", "application/json");
+        httpResponseCode = http.POST((uint8_t *)body, length);
+        if (httpResponseCode > 0) {
+            // Reading the response also drains it so the connection can be reused
+            syncWallClock(http.getString());
+        }
+        http.end();
+
+        // A 4xx would be refused again; only transport errors and 5xx are retried
+        if (httpResponseCode > 0 && httpResponseCode < 500) {
+            break;
+        }
+        client.stop();
+    }
+    return httpResponseCode;
+}
+
+bool MeshNode::registerBridge(HTTPClient &http, WiFiClient &client) {
+    // checkServer() has started the association; waiting for it here keeps
+    // the loop and the mesh running
+    for (int step = 0; WiFi.status() != WL_CONNECTED && step < STATION_WAIT_STEPS; step++) {
+        delay(STATION_WAIT_MS);
+    }
+    if (WiFi.status() != WL_CONNECTED || !instance) {
+        return false;
+    }
+
+    instance->logMessage("Checking server connectivity...");
+    http.begin(client, SERVER_URL);
+    int httpResponseCode = http.GET();
+    String payload = httpResponseCode > 0 ? http.getString() : String();
     http.end();
-    return false;
+    if (httpResponseCode != HTTP_CODE_OK) {
+        client.stop();
+        if (httpResponseCode > 0) {
+            instance->logError("Server response: %d", httpResponseCode);
+        } else {
+            instance->logError("Server connection failed: %s", HTTPClient::errorToString(httpResponseCode).c_str());
+        }
+        return false;
+    }
+    instance->logMessage("Server payload: %s", payload.c_str());
+    syncWallClock(payload);
+
+    char initData[96];
+    int length = snprintf(initData, sizeof(initData),
+                          "{\"node_id\": \"%s\", \"mac\": \"%s\", \"status\": \"online\"}",
+                          nodeName, instance->fullMac);
+    httpResponseCode = postUplink(http, client, initData, length, 1);
+    if (httpResponseCode <= 0) {
+        instance->logError("Failed to register: %s", HTTPClient::errorToString(httpResponseCode).c_str());
+        return false;
+    }
+    return true;
 }
 
-bool MeshNode::sendToServer(String jsonData) {
-    HTTPClient http;
-    http.begin(SERVER_URL);
-    http.addHeader("Content-Type", "application/json");
+bool MeshNode::appendHeartbeat(TextBuffer &body) {
+    body.appendf("{\"node_id\": \"%s\", \"status\": \"heartbeat\", \"rssi\": %d}", nodeName, WiFi.RSSI());
+    // The closing bracket of a batch still has to fit
+    return !body.overflowed() && body.remaining() > 0;
+}
 
-    logMessage("Sending to server: " + jsonData);
-    int httpResponseCode = http.POST(jsonData);
+bool MeshNode::carryHeartbeat(TextBuffer &body) {
+    portENTER_CRITICAL(&uplinkLock);
+    bool due = (uplinkRequests & UPLINK_HEARTBEAT) != 0;
+    portEXIT_CRITICAL(&uplinkLock);
+    if (!due || !isBridge || !serverReachable) {
+        return false;
+    }
 
-    if (httpResponseCode > 0) {
-        String response = http.getString();
-        logMessage("Server response: " + String(httpResponseCode) + " | " + response);
-        http.end();
-        return true;
-    } else {
-        logMessage("Failed to send data: " + http.errorToString(httpResponseCode), "ERROR");
-        http.end();
+    size_t mark = body.length();
+    body.append(',');
+    if (!appendHeartbeat(body)) {
+        body.rewind(mark);
         return false;
     }
+    portENTER_CRITICAL(&uplinkLock);
+    uplinkRequests &= ~UPLINK_HEARTBEAT;
+    portEXIT_CRITICAL(&uplinkLock);
+    return true;
+}
+
+void MeshNode::serveUplink(HTTPClient &http, WiFiClient &client) {
+    uint8_t requests = takeUplink(uplinkRequests);
+    if ((requests & UPLINK_CHECK) && registerBridge(http, client)) {
+        reportUplink(UPLINK_REGISTERED);
+    }
+    if ((requests & UPLINK_HEARTBEAT) && isBridge && serverReachable) {
+        char heartbeatData[80];
+        TextBuffer heartbeat(heartbeatData, sizeof(heartbeatData));
+        appendHeartbeat(heartbeat);
+        int httpResponseCode = postUplink(http, client, heartbeat.c_str(), heartbeat.length(), HEARTBEAT_ATTEMPTS);
+        if (httpResponseCode <= 0) {
+            if (instance) {
+                instance->logError("Heartbeat failed: %s", HTTPClient::errorToString(httpResponseCode).c_str());
+            }
+            reportUplink(UPLINK_LOST);
+        }
+    }
+}
+
+void MeshNode::forwardTask(void *param) {
+    // One client for the task's lifetime so the TCP connection is kept alive
+    // between batches instead of being reopened for every message
+    WiFiClient client;
+    HTTPClient http;
+    http.setReuse(true);
+
+    TextBuffer body(forwardBody, FORWARD_BODY_MAX);
+    uint32_t queuedMs[FORWARD_BATCH_MAX];
+    TrafficClass classes[FORWARD_BATCH_MAX];
+    QueuedMessage item;
+    TrafficClass cls = TRAFFIC_TELEMETRY;
+    bool carried = false;  // item did not fit the previous batch and opens this one
+
+    for (;;) {
+        // Heartbeats and server checks share the connection; they wait at
+        // most for the batch in progress
+        serveUplink(http, client);
+        if (!carried && !takeForward(TRAFFIC_ALERT, TRAFFIC_BULK, item, cls)) {
+            // Every enqueue notifies, so nothing is missed between the check
+            // and the wait
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        carried = false;
+
+        // Collect until the batch is full or the first message has waited
+        // FORWARD_FLUSH_MS. Classes are taken in priority order, and an
+        // alert ends the wait: it joins the open batch, which goes out at
+        // once with whatever else is already queued. Under load the
+        // server's request rate is the limit, so a POST of its own would
+        // cost readings.
+        TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(FORWARD_FLUSH_MS);
+        bool urgent = false;
+        int count = 0;
+        body.clear();
+        body.append('[');
+        for (;;) {
+            size_t mark = body.length();
+            if (count > 0) {
+                body.append(',');
+            }
+            if (!appendForwardEntry(body, cls, item)) {
+                body.rewind(mark);
+                if (count > 0) {
+                    carried = true;
+                } else {
+                    portENTER_CRITICAL(&forwardStatsLock);
+                    forwardStats.lost++;  // Cannot fit even on its own
+                    portEXIT_CRITICAL(&forwardStatsLock);
+                }
+                break;
+            }
+            queuedMs[count] = item.queuedMs;
+            classes[count++] = cls;
+            urgent = urgent || TrafficHeader::urgent(cls);
+            if (count >= FORWARD_BATCH_MAX) {
+                break;
+            }
+
+            bool more = false;
+            for (;;) {
+                if (takeForward(TRAFFIC_ALERT, TRAFFIC_BULK, item, cls)) {
+                    more = true;
+                    break;
+                }
+                TickType_t now = xTaskGetTickCount();
+                if (urgent || (int32_t)(deadline - now) <= 0) {
+                    break;
+                }
+                ulTaskNotifyTake(pdTRUE, deadline - now);
+            }
+            if (!more) {
+                break;
+            }
+        }
+        if (count > 0) {
+            // A heartbeat that is due rides on the batch; the server stores
+            // it like a POST of its own, but without the cost of a request
+            bool heartbeat = carryHeartbeat(body);
+            body.append(']');
+            if (postForward(http, client, body, queuedMs, classes, count) <= 0 && heartbeat) {
+                reportUplink(UPLINK_LOST);
+            }
+        }
+    }
+}
+
+void MeshNode::syncWallClock(const String &response) {
+    const char *field = strstr(response.c_str(), "\"server_time_ms\":");
+    if (field == nullptr) {
+        return;
+    }
+    uint64_t serverMs = strtoull(field + 17, nullptr, 10);
+    // The server reads its clock as it writes the response, after any time
+    // spent queued behind other bridges, so the moment the response arrives
+    // is a closer match than the middle of the round trip
+    uint32_t anchorMeshUs = mesh.getNodeTime();
+
+    portENTER_CRITICAL(&wallClockLock);
+    wallAnchorMeshUs = anchorMeshUs;
+    wallAnchorUnixMs = serverMs;
+    wallClockSynced = true;
+    portEXIT_CRITICAL(&wallClockLock);
+}
+
+bool MeshNode::wallClockMs(uint32_t meshTimeUs, uint64_t *unixMs) {
+    portENTER_CRITICAL(&wallClockLock);
+    bool synced = wallClockSynced;
+    // Mesh time wraps every ~71 minutes; the anchor is refreshed far more
+    // often, so the signed difference is always the right one
+    int32_t sinceAnchorUs = (int32_t)(meshTimeUs - wallAnchorMeshUs);
+    uint64_t anchorUnixMs = wallAnchorUnixMs;
+    portEXIT_CRITICAL(&wallClockLock);
+
+    if (synced) {
+        *unixMs = (uint64_t)((int64_t)anchorUnixMs + sinceAnchorUs / 1000);
+    }
+    return synced;
+}
+
+ForwardStats MeshNode::getForwardStats() {
+    // The forward task and the receive callback update the counters; copy
+    // them and the 64-bit latency total in one piece
+    portENTER_CRITICAL(&forwardStatsLock);
+    ForwardStats stats = forwardStats;
+    uint64_t latencyTotalMs = forwardLatencyTotalMs;
+    portEXIT_CRITICAL(&forwardStatsLock);
+    stats.queueDepth = forwardDepth();
+    stats.latencyAvgMs = stats.forwarded ? latencyTotalMs / stats.forwarded : 0;
+    return stats;
 }
 
 void MeshNode::toggleLED() {
@@ -116,9 +591,22 @@ void MeshNode::toggleLED() {
 
 void MeshNode::sendMessage() {
     if (meshStarted) {
-        String msg = "Hello from " + nodeName;
-        logMessage("Sending broadcast: " + msg);
-        mesh.sendBroadcast(msg);
+        // The sequence number makes every message distinct, so losses and
+        // duplicates can be counted at the server
+        char msg[48];
+        int length = snprintf(msg, sizeof(msg), "Hello from %s #%lu", nodeName, (unsigned long)messageSeq++);
+        if (!queueMessage(TRAFFIC_TELEMETRY, msg, length)) {
+            logError("Send queue full, reading dropped");
+        }
+    }
+}
+
+void MeshNode::sendAlert(const char *event) {
+    char msg[128];
+    TextBuffer text(msg, sizeof(msg));
+    text.appendf("Alert from %s #%lu: %s", nodeName, (unsigned long)messageSeq++, event);
+    if (!queueMessage(TRAFFIC_ALERT, text.c_str(), text.length())) {
+        logError("Could not queue alert: %s", event);
     }
 }
 
@@ -130,34 +618,12 @@ void MeshNode::checkServer() {
             bestRSSI = currentRSSI;
             
             if(WiFi.status() != WL_CONNECTED) {
-                logMessage("Connecting to Pi AP... RSSI: " + String(currentRSSI) + " dBm");
+                logMessage("Connecting to Pi AP... RSSI: %ld dBm", (long)currentRSSI);
                 WiFi.begin(PI_SSID, PI_PASSWORD);
-                int retries = 0;
-                while (WiFi.status() != WL_CONNECTED && retries < 20) {
-                    delay(500);
-                    retries++;
-                }
-            }
-
-            if (WiFi.status() == WL_CONNECTED) {
-                if (checkServerConnectivity()) {
-                    serverReachable = true;
-                    isBridge = true;
-                    currentBridgeId = mesh.getNodeId();
-                    
-                    String initData = "{\"node_id\": \"" + nodeName + "\", \"mac\": \"" + fullMac + "\", \"status\": \"online\"}";
-                    if (sendToServer(initData)) {
-                        logMessage("Successfully registered as bridge node");
-                        mesh.sendBroadcast("BRIDGE_ELECT:" + String(mesh.getNodeId()) + ":" + String(bestRSSI));
-                        
-                        if (!meshStarted) {
-                            int channel = WiFi.channel();
-                            mesh.init(MESH_PREFIX, MESH_PASSWORD, &userScheduler, MESH_PORT, WIFI_AP_STA, WIFI_AUTH_WPA2_PSK, channel);
-                            meshStarted = true;
-                        }
-                    }
-                }
             }
+            // forwardTask waits for the association, probes the server and
+            // registers; update() makes this node a bridge once it has
+            requestUplink(UPLINK_CHECK);
         }
     }
 }
@@ -166,24 +632,124 @@ void MeshNode::sendBridgeHeartbeat() {
     if (isBridge) {
         toggleLED();
         if (serverReachable) {
-            String heartbeatData = "{\"node_id\": \"" + nodeName + "\", \"status\": \"heartbeat\", \"rssi\": " + String(WiFi.RSSI()) + "}";
-            if (!sendToServer(heartbeatData)) {
-                logMessage("Heartbeat failed, relinquishing bridge role", "ERROR");
-                isBridge = false;
-                serverReachable = false;
-            }
+            requestUplink(UPLINK_HEARTBEAT);
         }
     } else {
         digitalWrite(LED_PIN, LOW);
     }
 }
 
+void MeshNode::advertiseBridge() {
+    if (!meshStarted) {
+        return;
+    }
+
+    // Bridges announce their load so nodes can rebalance; every node drops
+    // bridges it has stopped hearing from and re-picks
+    if (isBridge && serverReachable) {
+        ForwardStats stats = getForwardStats();
+        char adv[32];
+        int length = snprintf(adv, sizeof(adv), "BRIDGE_ADV:%lu:%d", (unsigned long)stats.queueDepth, WiFi.RSSI());
+        queueMessage(TRAFFIC_CONTROL, adv, length);
+    }
+
+    bridges.expire(millis());
+    uint32_t selected = bridges.select(currentBridgeId);
+    if (!isBridge && selected != currentBridgeId) {
+        logMessage("Switching bridge %lu -> %lu (%u known)", (unsigned long)currentBridgeId,
+                   (unsigned long)selected, (unsigned)bridges.count());
+        currentBridgeId = selected;
+    }
+}
+
+// Depth of nodeId below node, walking the tree in place instead of copying
+// each level of it
+static uint8_t treeDepth(const painlessmesh::protocol::NodeTree &node, uint32_t nodeId, uint8_t depth) {
+    if (node.nodeId == nodeId) {
+        return depth;
+    }
+    if (depth == UINT8_MAX - 1) {
+        return UINT8_MAX;
+    }
+    for (const auto &sub : node.subs) {
+        uint8_t found = treeDepth(sub, nodeId, depth + 1);
+        if (found != UINT8_MAX) {
+            return found;
+        }
+    }
+    return UINT8_MAX;
+}
+
+uint8_t MeshNode::hopsTo(uint32_t nodeId) {
+    // Node ids are unique in the tree, so the first match is the hop count
+    return treeDepth(mesh.asNodeTree(), nodeId, 0);
+}
+
+void MeshNode::stepDown(const char *reason) {
+    if (instance) {
+        instance->logError("%s, relinquishing bridge role", reason);
+    }
+    isBridge = false;
+    serverReachable = false;
+    currentBridgeId = bridges.select(0);
+    if (meshStarted) {
+        queueMessage(TRAFFIC_CONTROL, "BRIDGE_LEAVE", 12);
+    }
+}
+
+void MeshNode::handleBridgeMessage(uint32_t from, const char *text) {
+    if (strncmp(text, "BRIDGE_LEAVE", 12) == 0) {
+        bridges.remove(from);
+        if (currentBridgeId == from && !isBridge) {
+            currentBridgeId = bridges.select(0);
+        }
+        return;
+    }
+
+    // BRIDGE_ELECT:<id>:<rssi> when a bridge registers,
+    // BRIDGE_ADV:<queue depth>:<rssi> while it stays one
+    uint16_t queueDepth = 0;
+    if (strncmp(text, "BRIDGE_ADV:", 11) == 0) {
+        queueDepth = strtoul(text + 11, nullptr, 10);
+    } else if (strncmp(text, "BRIDGE_ELECT:", 13) != 0) {
+        return;
+    }
+    int32_t senderRSSI = strtol(strrchr(text, ':') + 1, nullptr, 10);
+    bridges.update(from, hopsTo(from), queueDepth, senderRSSI, millis());
+
+    // Several bridges share the load, but only the best few stay bridges
+    if (isBridge && bridges.countBetterThan(WiFi.RSSI(), mesh.getNodeId()) >= MAX_ACTIVE_BRIDGES) {
+        stepDown("Enough bridges with a better uplink");
+    }
+    if (!isBridge && currentBridgeId == 0) {
+        currentBridgeId = bridges.select(0);
+    }
+}
+
 void MeshNode::logTopology() {
-    String status = String("Nodes: ") + mesh.getNodeList().size() +
-                   " | RSSI: " + WiFi.RSSI() + " dBm" +
-                   " | Bridge: " + (isBridge ? nodeName : "None") +
-                   " | IP: " + WiFi.localIP().toString();
-    logMessage(status);
+    char bridge[16];
+    if (isBridge) {
+        snprintf(bridge, sizeof(bridge), "%s", nodeName);
+    } else if (currentBridgeId) {
+        snprintf(bridge, sizeof(bridge), "%lu", (unsigned long)currentBridgeId);
+    } else {
+        snprintf(bridge, sizeof(bridge), "None");
+    }
+    IPAddress ip = WiFi.localIP();
+    logMessage("Nodes: %u | RSSI: %d dBm | Bridge: %s (%u known) | IP: %u.%u.%u.%u",
+               (unsigned)mesh.getNodeList().size(), WiFi.RSSI(), bridge, (unsigned)bridges.count(),
+               ip[0], ip[1], ip[2], ip[3]);
+
+    if (isBridge) {
+        ForwardStats stats = getForwardStats();
+        logMessage("Forwarded: %lu in %lu batches | Dropped: %lu | Lost: %lu | Queue: %lu (max %lu)"
+                   " | Latency: avg %lu ms, max %lu ms | Alerts: %lu, max %lu ms",
+                   (unsigned long)stats.forwarded, (unsigned long)stats.batches, (unsigned long)stats.dropped,
+                   (unsigned long)stats.lost, (unsigned long)stats.queueDepth,
+                   (unsigned long)stats.queueHighWater, (unsigned long)stats.latencyAvgMs,
+                   (unsigned long)stats.latencyMaxMs, (unsigned long)stats.alerts,
+                   (unsigned long)stats.alertLatencyMaxMs);
+    }
 }
 
 void MeshNode::setupMeshCallbacks() {
@@ -198,36 +764,45 @@ void MeshNode::setupMeshCallbacks() {
             instance->onChangedConnectionsCallback();
         }
     });
+
+    mesh.onNodeTimeAdjusted(&onNodeTimeAdjustedCallback);
 }
 
 void MeshNode::onReceiveCallback(uint32_t from, String &msg) {
     if (!instance) return;
     
-    instance->logMessage("Received from " + String(from) + ": " + msg);
+    instance->logMessage("Received from %lu: %s", (unsigned long)from, msg.c_str());
 
-    if (msg.startsWith("BRIDGE_ELECT")) {
-        uint32_t senderId = msg.substring(12, msg.indexOf(":")).toInt();
-        int32_t senderRSSI = msg.substring(msg.lastIndexOf(":")+1).toInt();
-        
-        if (senderRSSI > bestRSSI || (senderRSSI == bestRSSI && senderId < mesh.getNodeId())) {
-            bestRSSI = senderRSSI;
-            currentBridgeId = senderId;
-            if(isBridge) {
-                isBridge = false;
-                serverReachable = false;
-            }
+    const char *payload;
+    uint32_t producedUs;
+    bool stamped;
+    TrafficClass cls = TrafficHeader::parse(msg.c_str(), &payload, &producedUs, &stamped);
+    if (strncmp(payload, "BRIDGE", 6) == 0) {
+        handleBridgeMessage(from, payload);
+    } else if (isBridge && serverReachable) {
+        // Older firmware does not stamp its messages; arrival is the best
+        // guess then
+        if (!stamped) {
+            producedUs = mesh.getNodeTime();
         }
-    }
-
-    if (isBridge && serverReachable && !msg.startsWith("BRIDGE")) {
-        String jsonData = "{\"from\": \"" + String(from) + "\", \"message\": \"" + msg + "\"}";
-        if (!instance->sendToServer(jsonData)) {
-            instance->logMessage("Failed to forward message to server", "ERROR");
+        if (!enqueueForward(cls, from, payload, msg.length() - (payload - msg.c_str()), producedUs)) {
+            instance->logError("Could not queue message for the server");
         }
     }
 }
 
 void MeshNode::onChangedConnectionsCallback() {
     if (!instance) return;
-    instance->logMessage("Connections changed. Total nodes: " + String(mesh.getNodeList().size()));
-} 
\ No newline at end of file
+    instance->logMessage("Connections changed. Total nodes: %u", (unsigned)mesh.getNodeList().size());
+}
+
+void MeshNode::onNodeTimeAdjustedCallback(int32_t offset) {
+    // Mesh time jumped by offset; move the wall clock anchor with it so
+    // readings stamped after the jump map to the same Unix time
+    portENTER_CRITICAL(&wallClockLock);
+    wallAnchorMeshUs += offset;
+    portEXIT_CRITICAL(&wallClockLock);
+    if (instance) {
+        instance->logMessage("Mesh time adjusted by %ld us", (long)offset);
+    }
+}
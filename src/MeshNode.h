@@ -8,6 +8,25 @@
 #include <Wire.h>
 #include <Adafruit_BusIO_Register.h>
 #include <Adafruit_Sensor.h>
+#include "BridgeSelector.h"
+#include "TextBuffer.h"
+#include "TrafficClass.h"
+
+// Counters of the bridge's mesh-to-server forwarding path
+struct ForwardStats {
+    uint32_t queued;          // Messages accepted into the forward queues
+    uint32_t dropped;         // Messages not queued (queue full or message too long)
+    uint32_t lost;            // Queued messages given up (failed POST or bridge role lost)
+    uint32_t forwarded;       // Messages the server accepted
+    uint32_t batches;         // Successful batched POSTs
+    uint32_t failures;        // Failed POSTs
+    uint32_t queueDepth;      // Messages waiting right now, all classes
+    uint32_t queueHighWater;  // Most messages ever waiting at once
+    uint32_t latencyAvgMs;    // Mean time from mesh receive to server ack
+    uint32_t latencyMaxMs;    // Longest time from mesh receive to server ack
+    uint32_t alerts;          // Alerts the server accepted
+    uint32_t alertLatencyMaxMs;
+};
 
 class MeshNode {
 public:
@@ -18,14 +37,19 @@ public:
     // Public methods
     void checkServer();
     void sendBridgeHeartbeat();
+    void advertiseBridge();
     void logTopology();
     void sendMessage();
+    void sendAlert(const char *event);
+    // Queues text for the mesh in its traffic class; safe from any task
+    static bool queueMessage(TrafficClass cls, const char *text, size_t length);
     void toggleLED();
-    String getNodeName() const { return nodeName; }
-    bool sendToServer(String jsonData);
-    bool checkServerConnectivity();
+    const char* getNodeName() const { return nodeName; }
     void initNodeIdentity();
-    void logMessage(String message, String level = "INFO");
+    // printf-style; lines are formatted on the stack and cut at LOG_LINE_MAX
+    void logMessage(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    void logError(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    static ForwardStats getForwardStats();
     
     // Static methods for accessing mesh
     static painlessMesh& getMesh() { return mesh; }
@@ -42,20 +66,87 @@ private:
     static bool isBridge;
     static bool meshStarted;
     static bool serverReachable;
-    static String nodeName;
+    static char nodeName[16];
     static painlessMesh mesh;
     static Scheduler userScheduler;
     static uint32_t currentBridgeId;
     static int32_t bestRSSI;
+    static BridgeSelector bridges;
+    static uint32_t messageSeq;
+
+    // One queue per traffic class on both paths. Outgoing mesh messages
+    // wait in sendQueues until update(); on a bridge, the receive callback
+    // only fills forwardQueues and forwardTask POSTs.
+    struct QueuedMessage {
+        uint32_t from;
+        uint32_t queuedMs;
+        uint32_t meshTimeUs;  // When the payload was produced; kept on the forward queues
+        uint16_t length;
+        char message[256];  // Payload without the traffic class header
+    };
+    static QueueHandle_t sendQueues[TRAFFIC_CLASS_COUNT];
+    static QueueHandle_t forwardQueues[TRAFFIC_CLASS_COUNT];
+    static TaskHandle_t forwardTaskHandle;
+    static ForwardStats forwardStats;
+    static uint64_t forwardLatencyTotalMs;
+    static portMUX_TYPE forwardStatsLock;  // Guards forwardStats and forwardLatencyTotalMs
+    static char forwardBody[];
+
+    // The loop never waits on the uplink: it sets request flags for
+    // forwardTask, which answers with event flags that update() applies
+    enum UplinkFlag : uint8_t {
+        UPLINK_CHECK = 1 << 0,       // Request: join the Pi's AP, probe the server and register
+        UPLINK_HEARTBEAT = 1 << 1,   // Request: post a heartbeat
+        UPLINK_REGISTERED = 1 << 2,  // Event: registration succeeded, become a bridge
+        UPLINK_LOST = 1 << 3,        // Event: a heartbeat failed, step down
+    };
+    static portMUX_TYPE uplinkLock;  // Guards uplinkRequests and uplinkEvents
+    static uint8_t uplinkRequests;
+    static uint8_t uplinkEvents;
+
+    // A bridge maps mesh time to Unix time through an anchor pair, taken
+    // from the server's clock in its responses
+    static portMUX_TYPE wallClockLock;
+    static bool wallClockSynced;
+    static uint32_t wallAnchorMeshUs;
+    static uint64_t wallAnchorUnixMs;
     
     // Node identification
     uint8_t baseMac[6];
-    String fullMac;
+    char fullMac[18];
     uint64_t chipId;
     bool ledState;
     
     void setupMesh();
     void setupMeshCallbacks();
+    void applyUplinkEvents();
+    static void requestUplink(uint8_t request);
+    static void reportUplink(uint8_t event);
+    static uint8_t takeUplink(uint8_t &flags);
+    static void serveUplink(HTTPClient &http, WiFiClient &client);
+    static bool appendHeartbeat(TextBuffer &body);
+    static bool carryHeartbeat(TextBuffer &body);
+    static bool registerBridge(HTTPClient &http, WiFiClient &client);
+    static int postUplink(HTTPClient &http, WiFiClient &client, const char *body, size_t length, int attempts);
+    void flushSendQueues();
+    void sendOverMesh(TrafficClass cls, const QueuedMessage &item);
+    static bool pushMessage(QueueHandle_t queue, uint32_t from, const char *text, size_t length,
+                            uint32_t meshTimeUs);
+    static bool enqueueForward(TrafficClass cls, uint32_t from, const char *msg, size_t length,
+                               uint32_t meshTimeUs);
+    static uint32_t producedAt(const QueuedMessage &item);
+    static void syncWallClock(const String &response);
+    static bool wallClockMs(uint32_t meshTimeUs, uint64_t *unixMs);
+    static bool takeForward(TrafficClass first, TrafficClass last, QueuedMessage &item, TrafficClass &cls);
+    static uint32_t forwardDepth();
+    static void forwardTask(void *param);
+    static int postForward(HTTPClient &http, WiFiClient &client, const TextBuffer &body,
+                           const uint32_t *queuedMs, const TrafficClass *classes, int count);
+    static bool appendForwardEntry(TextBuffer &body, TrafficClass cls, const QueuedMessage &item);
+    static uint8_t hopsTo(uint32_t nodeId);
+    static void handleBridgeMessage(uint32_t from, const char *msg);
+    static void stepDown(const char *reason);
+    void logLine(const char *level, const char *format, va_list args);
 
     // Constants
     static const char* MESH_PREFIX;
@@ -65,4 +156,20 @@ private:
     static const char* PI_PASSWORD;
     static const char* SERVER_URL;
     static const int LED_PIN = 2;
+    static const int SEND_QUEUE_LENGTH = 8;
+    static const int SEND_BUDGET = 4;              // Non-urgent mesh sends per update()
+    static const int FORWARD_QUEUE_LENGTH = 32;    // Telemetry and bulk, each
+    static const int FORWARD_URGENT_QUEUE_LENGTH = 8;
+    static const int FORWARD_BATCH_MAX = 24;
+    static const uint32_t FORWARD_FLUSH_MS = 250;
+    static const int FORWARD_ATTEMPTS = 3;         // POSTs of one batch before its messages are lost
+    static const uint32_t FORWARD_RETRY_MS = 250;  // Added to the pause before each further attempt
+    static const int HEARTBEAT_ATTEMPTS = 2;       // The second one on a fresh connection
+    static const int STATION_WAIT_STEPS = 20;      // Polls of the association, STATION_WAIT_MS apart
+    static const uint32_t STATION_WAIT_MS = 500;
+    static const size_t MAX_ACTIVE_BRIDGES = 3;
+    static const size_t LOG_LINE_MAX = 320;
+    // Room for a full batch of short readings; a batch that would overflow
+    // is cut short and the rest goes in the next one
+    static const size_t FORWARD_BODY_MAX = 4096;
 }; 
\ No newline at end of file
@@ -4,6 +4,7 @@ TaskManager::TaskManager(MeshNode& node) : meshNode(node),
     taskSendMessage(TASK_SECOND * 1, TASK_FOREVER, std::bind(&MeshNode::sendMessage, &meshNode)),
     taskCheckServer(TASK_SECOND * 5, TASK_FOREVER, std::bind(&MeshNode::checkServer, &meshNode)),
     taskBridgeHeartbeat(TASK_SECOND * 1, TASK_FOREVER, std::bind(&MeshNode::sendBridgeHeartbeat, &meshNode)),
+    taskAdvertiseBridge(TASK_SECOND * 2, TASK_FOREVER, std::bind(&MeshNode::advertiseBridge, &meshNode)),
     taskLogTopology(TASK_SECOND * 30, TASK_FOREVER, std::bind(&MeshNode::logTopology, &meshNode)) {
 }
 
@@ -19,10 +20,12 @@ void TaskManager::setupTasks() {
     MeshNode::getScheduler().addTask(taskSendMessage);
     MeshNode::getScheduler().addTask(taskCheckServer);
     MeshNode::getScheduler().addTask(taskBridgeHeartbeat);
+    MeshNode::getScheduler().addTask(taskAdvertiseBridge);
     MeshNode::getScheduler().addTask(taskLogTopology);
 
     taskSendMessage.enable();
     taskCheckServer.enable();
     taskBridgeHeartbeat.enable();
+    taskAdvertiseBridge.enable();
     taskLogTopology.enable();
 } 
\ No newline at end of file
@@ -13,6 +13,7 @@ private:
     Task taskSendMessage;
     Task taskCheckServer;
     Task taskBridgeHeartbeat;
+    Task taskAdvertiseBridge;
     Task taskLogTopology;
 
     void setupTasks();
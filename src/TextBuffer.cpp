@@ -0,0 +1,97 @@
+#include "TextBuffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+TextBuffer::TextBuffer(char *buffer, size_t capacity) : buffer(buffer), capacity(capacity), used(0), overflow(false) {
+    buffer[0] = '\0';
+}
+
+TextBuffer &TextBuffer::append(const char *text) {
+    return append(text, strlen(text));
+}
+
+TextBuffer &TextBuffer::append(const char *text, size_t length) {
+    if (length > remaining()) {
+        length = remaining();
+        overflow = true;
+    }
+    memcpy(buffer + used, text, length);
+    used += length;
+    buffer[used] = '\0';
+    return *this;
+}
+
+TextBuffer &TextBuffer::append(char c) {
+    return append(&c, 1);
+}
+
+TextBuffer &TextBuffer::appendf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vappendf(format, args);
+    va_end(args);
+    return *this;
+}
+
+TextBuffer &TextBuffer::vappendf(const char *format, va_list args) {
+    int written = vsnprintf(buffer + used, capacity - used, format, args);
+    if (written < 0) {
+        buffer[used] = '\0';
+        overflow = true;
+    } else if ((size_t)written > remaining()) {
+        used = capacity - 1;
+        overflow = true;
+    } else {
+        used += written;
+    }
+    return *this;
+}
+
+TextBuffer &TextBuffer::appendJsonEscaped(const char *text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = text[i];
+        char escaped[6] = {'\\', 0, 0, 0, 0, 0};
+        size_t size = 2;
+        switch (c) {
+        case '"': escaped[1] = '"'; break;
+        case '\\': escaped[1] = '\\'; break;
+        case '\n': escaped[1] = 'n'; break;
+        case '\r': escaped[1] = 'r'; break;
+        case '\t': escaped[1] = 't'; break;
+        default:
+            if (c >= 0x20) {
+                escaped[0] = c;
+                size = 1;
+            } else {
+                escaped[1] = 'u';
+                escaped[2] = '0';
+                escaped[3] = '0';
+                escaped[4] = hex[c >> 4];
+                escaped[5] = hex[c & 0xf];
+                size = 6;
+            }
+            break;
+        }
+        // Never leave half an escape sequence behind
+        if (size > remaining()) {
+            overflow = true;
+            break;
+        }
+        append(escaped, size);
+    }
+    return *this;
+}
+
+void TextBuffer::clear() {
+    rewind(0);
+}
+
+void TextBuffer::rewind(size_t mark) {
+    if (mark < used) {
+        used = mark;
+        buffer[used] = '\0';
+    }
+    overflow = false;
+}
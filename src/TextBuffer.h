@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Appends text into a caller-owned buffer, usually on the stack. Never
+// allocates: text that does not fit is cut off and overflowed() is set. The
+// contents are always NUL-terminated.
+class TextBuffer {
+public:
+    TextBuffer(char *buffer, size_t capacity);
+
+    TextBuffer &append(const char *text);
+    TextBuffer &append(const char *text, size_t length);
+    TextBuffer &append(char c);
+    TextBuffer &appendf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    TextBuffer &vappendf(const char *format, va_list args);
+    // Appends text as the inside of a JSON string: quotes, backslashes and
+    // control characters are escaped
+    TextBuffer &appendJsonEscaped(const char *text, size_t length);
+
+    void clear();
+    // Drops everything appended since length() was mark, and the overflow
+    // it may have caused
+    void rewind(size_t mark);
+
+    const char *c_str() const { return buffer; }
+    size_t length() const { return used; }
+    size_t remaining() const { return capacity - 1 - used; }
+    bool overflowed() const { return overflow; }
+
+private:
+    char *buffer;
+    size_t capacity;
+    size_t used;
+    bool overflow;
+};
@@ -0,0 +1,45 @@
+#include "TrafficClass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char TAGS[TRAFFIC_CLASS_COUNT] = {'A', 'C', 'T', 'B'};
+static const char *const NAMES[TRAFFIC_CLASS_COUNT] = {"alert", "control", "telemetry", "bulk"};
+
+char TrafficHeader::tag(TrafficClass cls) {
+    return cls < TRAFFIC_CLASS_COUNT ? TAGS[cls] : TAGS[TRAFFIC_BULK];
+}
+
+const char *TrafficHeader::name(TrafficClass cls) {
+    return cls < TRAFFIC_CLASS_COUNT ? NAMES[cls] : NAMES[TRAFFIC_BULK];
+}
+
+size_t TrafficHeader::write(char *out, TrafficClass cls, uint32_t meshTimeUs) {
+    return snprintf(out, MAX_LENGTH + 1, "%c%c%lu%c", tag(cls), SEPARATOR, (unsigned long)meshTimeUs, SEPARATOR);
+}
+
+TrafficClass TrafficHeader::parse(const char *msg, const char **payload, uint32_t *meshTimeUs, bool *stamped) {
+    *payload = msg;
+    *stamped = false;
+    if (msg[0] == '\0' || msg[1] != SEPARATOR) {
+        return TRAFFIC_TELEMETRY;
+    }
+    for (uint8_t cls = 0; cls < TRAFFIC_CLASS_COUNT; cls++) {
+        if (msg[0] != TAGS[cls]) {
+            continue;
+        }
+        *payload = msg + 2;
+        if (msg[2] < '0' || msg[2] > '9') {
+            return (TrafficClass)cls;
+        }
+        char *end;
+        unsigned long time = strtoul(msg + 2, &end, 10);
+        if (*end == SEPARATOR) {
+            *meshTimeUs = time;
+            *stamped = true;
+            *payload = end + 1;
+        }
+        return (TrafficClass)cls;
+    }
+    return TRAFFIC_TELEMETRY;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Priority of a mesh message, lowest value first. Nodes send and bridges
+// forward the classes in this order.
+enum TrafficClass : uint8_t {
+    TRAFFIC_ALERT = 0,   // Safety events; never wait for a batch
+    TRAFFIC_CONTROL,     // Bridge election and advertisements
+    TRAFFIC_TELEMETRY,   // Periodic readings
+    TRAFFIC_BULK,        // Anything that can wait for spare capacity
+    TRAFFIC_CLASS_COUNT
+};
+
+// Every mesh payload starts with a header: the class tag, '|', the mesh
+// time in microseconds at which the payload was produced, and '|' again,
+// e.g. "A|123456789|Alert from ...". Headers without the time, and
+// payloads without any header, come from older firmware; the latter are
+// taken as telemetry.
+class TrafficHeader {
+public:
+    static const char SEPARATOR = '|';
+    static const size_t MAX_LENGTH = 13;  // Tag, two separators and ten digits
+
+    static char tag(TrafficClass cls);
+    // Lower-case name, as sent to the server
+    static const char *name(TrafficClass cls);
+    // Writes the header into out, which needs MAX_LENGTH + 1 bytes, and
+    // returns its length
+    static size_t write(char *out, TrafficClass cls, uint32_t meshTimeUs);
+    // Class of msg; payload is pointed past the header, if there is one.
+    // Returns with stamped false when the header carries no time.
+    static TrafficClass parse(const char *msg, const char **payload, uint32_t *meshTimeUs, bool *stamped);
+    // Urgent classes end the bridge's batching wait
+    static bool urgent(TrafficClass cls) { return cls <= TRAFFIC_CONTROL; }
+};
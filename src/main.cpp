@@ -19,6 +19,7 @@ void setup() {
 }
 
 void loop() {
-    meshNode.update();
+    // Tasks first, so what they queue goes out in the same pass
     taskManager.execute();
+    meshNode.update();
 }